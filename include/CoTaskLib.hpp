@@ -28,11 +28,17 @@
 
 #pragma once
 #include "CoTaskLib/Core.hpp"
+#include "CoTaskLib/Channel.hpp"
+#include "CoTaskLib/Generator.hpp"
+#include "CoTaskLib/Semaphore.hpp"
+#ifndef COTASKLIB_NO_SIV3D
 #include "CoTaskLib/Scene.hpp"
 #include "CoTaskLib/Ease.hpp"
+#include "CoTaskLib/TweenSystem.hpp"
 #include "CoTaskLib/Typewriter.hpp"
 #include "CoTaskLib/Tween.hpp"
 #include "CoTaskLib/Sequence.hpp"
 #include "CoTaskLib/ScreenFade.hpp"
 #include "CoTaskLib/SimpleDialog.hpp"
 #include "CoTaskLib/S3dAsyncTask.hpp"
+#endif
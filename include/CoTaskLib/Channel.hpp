@@ -0,0 +1,230 @@
+﻿//----------------------------------------------------------------------------------------
+//
+//  CoTaskLib
+//
+//  Copyright (c) 2024 masaka
+//
+//  Licensed under the MIT License.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+//----------------------------------------------------------------------------------------
+
+#pragma once
+#include "Core.hpp"
+
+namespace cotasklib::Co
+{
+	namespace detail
+	{
+		// Channelの状態
+		// (他のスレッドからの送信時に完了キューから参照されるため、Channelとは別に確保する)
+		template <typename T>
+		class ChannelState final : public ICompletion
+		{
+		private:
+			CompletionQueue* m_pCompletionQueue;
+
+			// 他のスレッドからの送信を、所有スレッドへ通知済みかどうか
+			// (通知済みの間は、他のスレッドから送信されても重ねて通知しない)
+			std::atomic<bool> m_isNotifyPending = false;
+
+			// 完了キューから通知されるまで自身を保持する
+			std::shared_ptr<ChannelState> m_selfUntilNotified;
+
+		public:
+			BoundedMPMCQueue<T> queue;
+
+			std::thread::id ownerThreadId;
+
+			// 以下は所有スレッドでのみ参照する
+			WaitList receiveWaitList;
+
+			WaitList sendWaitList;
+
+			ChannelState(std::size_t capacity, CompletionQueue* pCompletionQueue)
+				: m_pCompletionQueue(pCompletionQueue)
+				, queue(capacity)
+				, ownerThreadId(std::this_thread::get_id())
+			{
+			}
+
+			[[nodiscard]]
+			bool isOwnerThread() const noexcept
+			{
+				return std::this_thread::get_id() == ownerThreadId;
+			}
+
+			// 送信後に呼び出し、受信を待機しているタスクを起床させる
+			void notifyReceivers(const std::shared_ptr<ChannelState>& self)
+			{
+				if (isOwnerThread())
+				{
+					receiveWaitList.wakeAll();
+					return;
+				}
+
+				// 所有スレッドが通知済みフラグを下ろしてから受信を再確認するまでの間に送信された場合も、取りこぼさないようにする
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (m_isNotifyPending.load(std::memory_order_relaxed) || m_isNotifyPending.exchange(true, std::memory_order_acq_rel))
+				{
+					return;
+				}
+				m_selfUntilNotified = self;
+
+				// 追加した時点で所有スレッドから破棄されうるため、以降はメンバを参照しない
+				m_pCompletionQueue->push(this);
+			}
+
+			void onComplete() override
+			{
+				// Channelが既に破棄されている場合、関数を抜けた時点で自身が破棄される
+				const std::shared_ptr<ChannelState> self = std::move(m_selfUntilNotified);
+				m_isNotifyPending.store(false, std::memory_order_release);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				receiveWaitList.wakeAll();
+			}
+		};
+	}
+
+	// 容量に上限のあるチャネル
+	// (送信は任意のスレッドから行え、受信は生成時のスケジューラのタスクで待機できる)
+	// Note: 生成時以外のスケジューラのタスクからsend()で待機する場合、受信時の起床は行われず毎フレーム空きを確認する
+	// Note: 生成・受信は生成時のスケジューラのスレッドで行うこと。また、スケジューラより先に破棄すること
+	template <typename T>
+	class [[nodiscard]] Channel
+	{
+		static_assert(!std::is_reference_v<T>, "T must not be a reference type");
+		static_assert(std::is_move_constructible_v<T>, "T must be move constructible");
+		static_assert(!std::is_const_v<T>, "T must not have 'const' qualifier");
+
+	private:
+		std::shared_ptr<detail::ChannelState<T>> m_state;
+
+	public:
+		// 容量は1以上であること
+		explicit Channel(std::size_t capacity)
+			: m_state(std::make_shared<detail::ChannelState<T>>(capacity, detail::Backend::CurrentCompletionQueue()))
+		{
+		}
+
+		Channel(const Channel&) = delete;
+
+		Channel& operator=(const Channel&) = delete;
+
+		Channel(Channel&&) noexcept = default;
+
+		Channel& operator=(Channel&&) = delete;
+
+		~Channel() noexcept = default;
+
+		// 任意のスレッドから呼び出せる。満杯の場合はfalseを返す(その場合、valueはムーブされない)
+		[[nodiscard]]
+		bool trySend(T&& value)
+		{
+			if (!m_state->queue.tryPush(std::move(value)))
+			{
+				return false;
+			}
+			m_state->notifyReceivers(m_state);
+			return true;
+		}
+
+		// 任意のスレッドから呼び出せる。満杯の場合はfalseを返す
+		[[nodiscard]]
+		bool trySend(const T& value) requires std::is_copy_constructible_v<T>
+		{
+			return trySend(T(value));
+		}
+
+		// 空きができるまで待機してから送信する
+		// (生成時のスケジューラのタスクからの場合は受信時に起床され、それ以外のスケジューラのタスクからの場合は毎フレーム再試行する)
+		[[nodiscard]]
+		Task<void> send(T value)
+		{
+			while (!trySend(std::move(value)))
+			{
+				if (m_state->isOwnerThread())
+				{
+					co_await m_state->sendWaitList.wait();
+				}
+				else
+				{
+					co_await NextFrame();
+				}
+			}
+		}
+
+		// 空の場合はnoneを返す
+		[[nodiscard]]
+		Optional<T> tryReceive()
+		{
+			Optional<T> value = m_state->queue.tryPop();
+			if (value)
+			{
+				m_state->sendWaitList.wakeAll();
+			}
+			return value;
+		}
+
+		// 受信するまで待機する
+		[[nodiscard]]
+		Task<T> receive()
+		{
+			while (true)
+			{
+				if (Optional<T> value = tryReceive())
+				{
+					co_return std::move(*value);
+				}
+				co_await m_state->receiveWaitList.wait();
+			}
+		}
+
+		// 1件以上受信するまで待機し、その時点で受信できるものをまとめて返す
+		[[nodiscard]]
+		Task<Array<T>> receiveAll()
+		{
+			while (true)
+			{
+				Array<T> values;
+				while (Optional<T> value = m_state->queue.tryPop())
+				{
+					values.push_back(std::move(*value));
+				}
+				if (!values.empty())
+				{
+					m_state->sendWaitList.wakeAll();
+					co_return values;
+				}
+				co_await m_state->receiveWaitList.wait();
+			}
+		}
+
+		[[nodiscard]]
+		std::size_t capacity() const noexcept
+		{
+			return m_state->queue.capacity();
+		}
+	};
+}
+
+#ifndef NO_COTASKLIB_USING
+using namespace cotasklib;
+#endif
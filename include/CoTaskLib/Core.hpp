@@ -27,8 +27,10 @@
 //----------------------------------------------------------------------------------------
 
 #pragma once
-#include <Siv3D.hpp>
+#include "Platform.hpp"
+#include "ThreadPool.hpp"
 #include <coroutine>
+#include <ranges>
 
 namespace cotasklib::Co
 {
@@ -45,32 +47,207 @@ namespace cotasklib::Co
 			virtual bool done() const = 0;
 		};
 
+		// Backendに登録するAwaiter
+		// (終了時・キャンセル時のコールバックを自身で保持する)
+		class IEntryAwaiter : public IAwaiter
+		{
+		public:
+			virtual void callEndCallback() = 0;
+		};
+
+		class PauseGroupState;
+
+		class TimeScaleGroupState;
+
 		struct AwaiterEntry
 		{
-			std::unique_ptr<IAwaiter> awaiter;
-			std::function<void(const IAwaiter*)> finishCallback;
-			std::function<void()> cancelCallback;
+			std::unique_ptr<IEntryAwaiter> awaiter;
+
+			// 所属するポーズグループ
+			std::shared_ptr<PauseGroupState> pauseGroup;
+
+			// 所属するタイムスケールグループ
+			std::shared_ptr<TimeScaleGroupState> timeScaleGroup;
 
 			void callEndCallback() const
 			{
-				if (awaiter->done())
+				awaiter->callEndCallback();
+			}
+		};
+
+		using AwaiterID = uint64;
+
+		class Backend;
+
+		// 待機リストの要素
+		// (待機ごとに振られる通し番号を持ち、既に起床したタスクや削除されたタスクの古い要素と区別する)
+		// (待機リストは複数のスケジューラのタスクから共有されうるため、待機したタスクのBackendを持つ)
+		struct Waiter
+		{
+			std::weak_ptr<Backend> backend;
+			uint32 slotIndex;
+			uint64 sleepToken;
+		};
+
+		// ポーズグループの状態
+		// (所属するエントリやタイマーからも参照されるため、Co::PauseGroupとは別に確保する)
+		class PauseGroupState : public std::enable_shared_from_this<PauseGroupState>
+		{
+		private:
+			friend class Backend;
+
+			struct SteadyClockPausedTime
+			{
+				ISteadyClock* pSteadyClock;
+
+				// 所属するタイマーのうち、この時計を使用しているものの数
+				std::size_t timerCount;
+
+				uint64 pausedMicrosec;
+				uint64 pauseStartMicrosec;
+			};
+
+			std::weak_ptr<Backend> m_backend;
+
+			bool m_isPaused = false;
+
+			// 一時停止中に実行順が来たため、実行リストから外したエントリ
+			Array<AwaiterID> m_parkedIDs;
+
+			// 一時停止していた時間の合計
+			// (所属するタイマーは、この時間を経過時間から除外する)
+			double m_pausedSceneTime = 0.0;
+			double m_pauseStartSceneTime = 0.0;
+
+			// 所属するタイマーが使用しているISteadyClockごとの、一時停止していた時間の合計
+			// (時計の数は少ない想定のため、線形探索する)
+			Array<SteadyClockPausedTime> m_steadyClockPausedTimes;
+
+		public:
+			explicit PauseGroupState(std::weak_ptr<Backend> backend) noexcept
+				: m_backend(std::move(backend))
+			{
+			}
+
+			[[nodiscard]]
+			bool isPaused() const noexcept
+			{
+				return m_isPaused;
+			}
+
+			void park(AwaiterID id)
+			{
+				m_parkedIDs.push_back(id);
+			}
+
+			[[nodiscard]]
+			double pausedSceneTime() const noexcept
+			{
+				return m_pausedSceneTime;
+			}
+
+			[[nodiscard]]
+			uint64 pausedMicrosec(ISteadyClock* pSteadyClock) const noexcept
+			{
+				for (const auto& pausedTime : m_steadyClockPausedTimes)
 				{
-					if (finishCallback)
+					if (pausedTime.pSteadyClock == pSteadyClock)
 					{
-						finishCallback(awaiter.get());
+						return pausedTime.pausedMicrosec;
 					}
 				}
-				else
+				return 0;
+			}
+
+			// 一時停止時に時刻を記録するため、所属するタイマーが使用する時計を登録する
+			// (破棄された時計を参照しないよう、タイマーの破棄時にunregisterSteadyClockを呼ぶこと)
+			void registerSteadyClock(ISteadyClock* pSteadyClock, uint64 currentMicrosec)
+			{
+				for (auto& pausedTime : m_steadyClockPausedTimes)
+				{
+					if (pausedTime.pSteadyClock == pSteadyClock)
+					{
+						++pausedTime.timerCount;
+						return;
+					}
+				}
+				m_steadyClockPausedTimes.push_back(SteadyClockPausedTime{ .pSteadyClock = pSteadyClock, .timerCount = 1, .pausedMicrosec = 0, .pauseStartMicrosec = currentMicrosec });
+			}
+
+			void unregisterSteadyClock(ISteadyClock* pSteadyClock) noexcept
+			{
+				for (auto it = m_steadyClockPausedTimes.begin(); it != m_steadyClockPausedTimes.end(); ++it)
 				{
-					if (cancelCallback)
+					if (it->pSteadyClock == pSteadyClock)
 					{
-						cancelCallback();
+						if (--it->timerCount == 0)
+						{
+							m_steadyClockPausedTimes.erase(it);
+						}
+						return;
 					}
 				}
 			}
 		};
 
-		using AwaiterID = uint64;
+		// タイムスケールグループの状態
+		// (仮想時刻を返すISteadyClockとして、所属するタイマーから参照される)
+		// (仮想時刻はBackendがupdateの開始時に1フレームにつき1回のみ進めるため、所属するタイマーの数によらず計算は1回で済む)
+		class TimeScaleGroupState : public ISteadyClock, public std::enable_shared_from_this<TimeScaleGroupState>
+		{
+		private:
+			// 親のタイムスケールグループ(nullptrの場合はScene::Timeを基準にする)
+			std::shared_ptr<TimeScaleGroupState> m_parent;
+
+			double m_timeScale;
+
+			// 仮想時刻(秒)
+			double m_time = 0.0;
+
+			// 前回仮想時刻を進めた時点の基準時刻
+			double m_prevBaseTime;
+
+		public:
+			TimeScaleGroupState(std::shared_ptr<TimeScaleGroupState> parent, double timeScale, double sceneTime)
+				: m_parent(std::move(parent))
+				, m_timeScale(timeScale)
+				, m_prevBaseTime(m_parent ? m_parent->m_time : sceneTime)
+			{
+			}
+
+			[[nodiscard]]
+			uint64 getMicrosec() override
+			{
+				return static_cast<uint64>(m_time * 1'000'000.0);
+			}
+
+			[[nodiscard]]
+			double time() const noexcept
+			{
+				return m_time;
+			}
+
+			[[nodiscard]]
+			double timeScale() const noexcept
+			{
+				return m_timeScale;
+			}
+
+			// 変更後の倍率は、次に仮想時刻を進める時点から適用される
+			void setTimeScale(double timeScale) noexcept
+			{
+				m_timeScale = timeScale;
+			}
+
+			// 前回からの基準時刻の経過時間に倍率を掛けて、仮想時刻を進める
+			// (親のタイムスケールグループがある場合は、親を先に進めておくこと)
+			void advance(double sceneTime) noexcept
+			{
+				const double baseTime = m_parent ? m_parent->m_time : sceneTime;
+				m_time += (baseTime - m_prevBaseTime) * m_timeScale;
+				m_prevBaseTime = baseTime;
+			}
+		};
 
 		using UpdaterID = uint64;
 
@@ -82,19 +259,23 @@ namespace cotasklib::Co
 		template <typename TResult>
 		struct FinishCallbackTypeTrait
 		{
-			using type = std::function<void(TResult)>;
+			using type = InplaceFunction<void(TResult)>;
 		};
 
 		template <>
 		struct FinishCallbackTypeTrait<void>
 		{
-			using type = std::function<void()>;
+			using type = InplaceFunction<void()>;
 		};
 	}
 
+	// タスク完了時・キャンセル時のコールバック
+	// (タスクの実行ごとに生成されるため、小さな関数オブジェクトは動的確保せずに格納する。ムーブのみ可能)
 	template <typename TResult>
 	using FinishCallbackType = typename detail::FinishCallbackTypeTrait<TResult>::type;
 
+	using CancelCallbackType = detail::InplaceFunction<void()>;
+
 	template <typename TResult>
 	class Task;
 
@@ -161,18 +342,131 @@ namespace cotasklib::Co
 		Debug = 255,
 	};
 
-	namespace detail
+	// レイヤーの集合(レイヤーごとに1bitを割り当てた256bitのビットマップ)
+	class LayerMask
 	{
-		struct DrawerKey
+	private:
+		static constexpr std::size_t NumWords = 4;
+
+		std::array<uint64, NumWords> m_words{};
+
+		[[nodiscard]]
+		static constexpr std::size_t WordIndexOf(Layer layer) noexcept
+		{
+			return static_cast<uint8>(layer) / 64;
+		}
+
+		[[nodiscard]]
+		static constexpr uint64 BitOf(Layer layer) noexcept
 		{
-			Layer layer;
-			int32 drawIndex;
-			DrawerID id;
+			return 1ULL << (static_cast<uint8>(layer) % 64);
+		}
 
-			[[nodiscard]]
-			auto operator<=>(const DrawerKey&) const = default;
-		};
+	public:
+		constexpr LayerMask() noexcept = default;
+
+		constexpr LayerMask(std::initializer_list<Layer> layers) noexcept
+		{
+			for (const Layer layer : layers)
+			{
+				set(layer);
+			}
+		}
+
+		constexpr void set(Layer layer) noexcept
+		{
+			m_words[WordIndexOf(layer)] |= BitOf(layer);
+		}
+
+		constexpr void reset(Layer layer) noexcept
+		{
+			m_words[WordIndexOf(layer)] &= ~BitOf(layer);
+		}
+
+		[[nodiscard]]
+		constexpr bool contains(Layer layer) const noexcept
+		{
+			return (m_words[WordIndexOf(layer)] & BitOf(layer)) != 0;
+		}
+
+		// いずれかのレイヤーが共通して含まれるかどうか
+		[[nodiscard]]
+		constexpr bool intersects(const LayerMask& other) const noexcept
+		{
+			uint64 intersection = 0;
+			for (std::size_t i = 0; i < NumWords; ++i)
+			{
+				intersection |= m_words[i] & other.m_words[i];
+			}
+			return intersection != 0;
+		}
+
+		[[nodiscard]]
+		constexpr bool isEmpty() const noexcept
+		{
+			return m_words == std::array<uint64, NumWords>{};
+		}
 
+		[[nodiscard]]
+		constexpr LayerMask operator|(const LayerMask& other) const noexcept
+		{
+			LayerMask result;
+			for (std::size_t i = 0; i < NumWords; ++i)
+			{
+				result.m_words[i] = m_words[i] | other.m_words[i];
+			}
+			return result;
+		}
+
+		[[nodiscard]]
+		constexpr LayerMask operator&(const LayerMask& other) const noexcept
+		{
+			LayerMask result;
+			for (std::size_t i = 0; i < NumWords; ++i)
+			{
+				result.m_words[i] = m_words[i] & other.m_words[i];
+			}
+			return result;
+		}
+
+		[[nodiscard]]
+		constexpr bool operator==(const LayerMask&) const noexcept = default;
+	};
+
+	// タスクの優先度
+	// (Co::SetFrameBudgetで1フレームあたりの予算を設定した場合、予算を使い切った後のタスクの実行を優先度に応じて次フレームへ持ち越す)
+	// (既定ではBackgroundのタスクのみ持ち越す)
+	enum class TaskPriority : uint8
+	{
+		// 予算を使い切っても持ち越さない
+		Critical,
+
+		// 既定では持ち越さない
+		// (Co::SetFrameBudgetで持ち越しを有効にした場合のみ持ち越す。ただし、2フレーム続けては持ち越さない)
+		Normal,
+
+		// 予算を使い切った場合に持ち越す
+		Background,
+	};
+
+	// 1フレームあたりの予算によるタスクの持ち越しの統計
+	struct FrameBudgetStats
+	{
+		// 直近のupdateで次フレームへ持ち越したタスクの数
+		int32 deferredTaskCount = 0;
+
+		// 次フレームへ持ち越したタスクの数の累計
+		uint64 totalDeferredTaskCount = 0;
+
+		// 予算を超過したupdateの回数の累計
+		uint64 overBudgetFrameCount = 0;
+
+		// 直近のupdateにかかった時間
+		Duration lastUpdateTime{ 0.0 };
+	};
+
+	namespace detail
+	{
 		class IDrawerInternal
 		{
 		public:
@@ -184,47 +478,150 @@ namespace cotasklib::Co
 		class DrawExecutor
 		{
 		private:
-			DrawerID m_nextID = 1;
-			std::map<DrawerKey, IDrawerInternal*> m_drawers;
-			std::unordered_map<DrawerID, DrawerKey> m_drawerKeyByID;
-			std::unordered_map<Layer, uint64> m_layerDrawerCount;
+			// 同一レイヤー・同一描画順序の描画の順番を決める通し番号のビット数
+			static constexpr uint32 SequenceBits = 24;
+
+			static constexpr uint32 MaxSequence = (1U << SequenceBits) - 1;
+
+			struct DrawerSlot
+			{
+				IDrawerInternal* pDrawer = nullptr;
+				uint32 generation = 1;
+				uint32 sequence = 0;
+				Layer layer = Layer::Default;
+				int32 drawIndex = 0;
+
+				[[nodiscard]]
+				uint64 sortKey() const noexcept
+				{
+					// レイヤー(8bit)・描画順序(32bit)・通し番号(24bit)の順に比較されるよう詰める
+					// (描画順序は符号ビットを反転し、符号なし整数として比較できるようにする)
+					return (static_cast<uint64>(layer) << 56)
+						| (static_cast<uint64>(static_cast<uint32>(drawIndex) ^ 0x80000000U) << SequenceBits)
+						| sequence;
+				}
+			};
+
+			struct DrawOrderItem
+			{
+				uint64 sortKey;
+				uint32 slotIndex;
+				uint32 generation;
+			};
+
+			Array<DrawerSlot> m_drawerSlots;
+			Array<uint32> m_freeDrawerSlotIndices;
+
+			// 描画順に並んだ一覧
+			// (追加・削除・描画順序の変更時は並び替えが必要な印だけ付け、次回の描画時にまとめて並び替える)
+			Array<DrawOrderItem> m_drawOrder;
+			bool m_isDrawOrderDirty = false;
+
+			uint32 m_nextSequence = 0;
+
+			// レイヤーごとの描画数と、描画が1つ以上あるレイヤーの集合
+			// (HasActiveModal等は毎フレーム多数のタスクから呼ばれうるため、ビットマップの参照のみで判定できるようにする)
+			std::array<uint64, 256> m_layerDrawerCounts{};
+			LayerMask m_activeLayers;
+
+			[[nodiscard]]
+			static DrawerID MakeDrawerID(uint32 slotIndex, uint32 generation) noexcept
+			{
+				return (static_cast<DrawerID>(generation) << 32) | slotIndex;
+			}
 
 			[[nodiscard]]
-			auto findByID(DrawerID id)
+			DrawerSlot* findDrawerSlot(DrawerID id)
 			{
-				const auto it = m_drawerKeyByID.find(id);
-				if (it == m_drawerKeyByID.end())
+				const auto slotIndex = static_cast<uint32>(id & 0xFFFFFFFFULL);
+				const auto generation = static_cast<uint32>(id >> 32);
+				if (slotIndex >= m_drawerSlots.size())
+				{
+					return nullptr;
+				}
+				auto& slot = m_drawerSlots[slotIndex];
+				if (slot.generation != generation || !slot.pDrawer)
 				{
-					return m_drawers.end();
+					return nullptr;
 				}
-				return m_drawers.find(it->second);
+				return &slot;
 			}
 
-			void incrementLayerDrawerCount(Layer layer)
+			[[nodiscard]]
+			bool isDrawOrderItemValid(const DrawOrderItem& item) const noexcept
+			{
+				const auto& slot = m_drawerSlots[item.slotIndex];
+				return slot.generation == item.generation && slot.pDrawer;
+			}
+
+			[[nodiscard]]
+			uint32 allocateSequence()
 			{
-				const auto it = m_layerDrawerCount.find(layer);
-				if (it == m_layerDrawerCount.end())
+				if (m_nextSequence > MaxSequence)
 				{
-					m_layerDrawerCount.emplace(layer, 1);
+					renumberSequences();
 				}
-				else
+				return m_nextSequence++;
+			}
+
+			// 通し番号を使い切った場合、生存中の描画の順番を保ったまま詰めて振り直す
+			void renumberSequences()
+			{
+				Array<uint32> slotIndices;
+				for (uint32 i = 0; i < m_drawerSlots.size(); ++i)
+				{
+					if (m_drawerSlots[i].pDrawer)
+					{
+						slotIndices.push_back(i);
+					}
+				}
+				std::sort(slotIndices.begin(), slotIndices.end(), [this](uint32 a, uint32 b) { return m_drawerSlots[a].sequence < m_drawerSlots[b].sequence; });
+				if (slotIndices.size() > MaxSequence)
+				{
+					throw Error{ U"DrawExecutor: Too many drawers" };
+				}
+				m_nextSequence = 0;
+				for (const uint32 slotIndex : slotIndices)
+				{
+					m_drawerSlots[slotIndex].sequence = m_nextSequence++;
+				}
+				m_isDrawOrderDirty = true;
+			}
+
+			void sortDrawOrderIfDirty()
+			{
+				if (!m_isDrawOrderDirty)
+				{
+					return;
+				}
+				m_drawOrder.remove_if([this](const DrawOrderItem& item) { return !isDrawOrderItemValid(item); });
+				for (auto& item : m_drawOrder)
+				{
+					item.sortKey = m_drawerSlots[item.slotIndex].sortKey();
+				}
+				std::sort(m_drawOrder.begin(), m_drawOrder.end(), [](const DrawOrderItem& a, const DrawOrderItem& b) { return a.sortKey < b.sortKey; });
+				m_isDrawOrderDirty = false;
+			}
+
+			void incrementLayerDrawerCount(Layer layer)
+			{
+				if (m_layerDrawerCounts[static_cast<uint8>(layer)]++ == 0)
 				{
-					++it->second;
+					m_activeLayers.set(layer);
 				}
 			}
 
 			void decrementLayerDrawerCount(Layer layer)
 			{
-				const auto it = m_layerDrawerCount.find(layer);
-				if (it == m_layerDrawerCount.end())
+				auto& count = m_layerDrawerCounts[static_cast<uint8>(layer)];
+				if (count == 0)
 				{
 					throw Error{ U"DrawExecutor::decrementLayerDrawerCount: Layer drawer count underflow (layer={})"_fmt(static_cast<uint8>(layer)) };
 				}
-				if (it->second == 0)
+				if (--count == 0)
 				{
-					throw Error{ U"DrawExecutor::decrementLayerDrawerCount: Layer drawer count underflow (layer={})"_fmt(static_cast<uint8>(layer)) };
+					m_activeLayers.reset(layer);
 				}
-				--it->second;
 			}
 
 		public:
@@ -232,39 +629,47 @@ namespace cotasklib::Co
 
 			DrawerID add(Layer layer, int32 drawIndex, IDrawerInternal* pDrawable)
 			{
-				const DrawerID id = m_nextID++;
-				DrawerKey key{ layer, drawIndex, id };
-				const auto [it, inserted] = m_drawers.try_emplace(key, pDrawable);
-				if (!inserted)
+				if (!pDrawable)
+				{
+					throw Error{ U"DrawExecutor::add: pDrawable must not be nullptr" };
+				}
+				const uint32 sequence = allocateSequence();
+				uint32 slotIndex;
+				if (m_freeDrawerSlotIndices.empty())
 				{
-					throw Error{ U"DrawExecutor::add: ID={} already exists"_fmt(id) };
+					m_drawerSlots.emplace_back();
+					slotIndex = static_cast<uint32>(m_drawerSlots.size() - 1);
 				}
-				m_drawerKeyByID.emplace(id, std::move(key));
+				else
+				{
+					slotIndex = m_freeDrawerSlotIndices.back();
+					m_freeDrawerSlotIndices.pop_back();
+				}
+				auto& slot = m_drawerSlots[slotIndex];
+				slot.pDrawer = pDrawable;
+				slot.sequence = sequence;
+				slot.layer = layer;
+				slot.drawIndex = drawIndex;
+				m_drawOrder.push_back(DrawOrderItem{ .sortKey = slot.sortKey(), .slotIndex = slotIndex, .generation = slot.generation });
+				m_isDrawOrderDirty = true;
 				incrementLayerDrawerCount(layer);
-				return id;
+				return MakeDrawerID(slotIndex, slot.generation);
 			}
 
 			void setDrawerLayer(DrawerID id, Layer layer)
 			{
-				const auto it = findByID(id);
-				if (it == m_drawers.end())
+				const auto pSlot = findDrawerSlot(id);
+				if (!pSlot)
 				{
-					throw Error{ U"DrawExecutor::remove: ID={} not found"_fmt(id) };
+					throw Error{ U"DrawExecutor::setDrawerLayer: ID={} not found"_fmt(id) };
 				}
-				if (it->first.layer == layer)
+				if (pSlot->layer == layer)
 				{
 					return;
 				}
-				const auto prevLayer = it->first.layer;
-
-				// 一度削除して再挿入
-				DrawerKey newKey = it->first;
-				newKey.layer = layer;
-				const auto pDrawable = it->second;
-				m_drawers.erase(it);
-				m_drawerKeyByID.erase(id);
-				m_drawers.emplace(newKey, pDrawable);
-				m_drawerKeyByID.emplace(id, std::move(newKey));
+				const auto prevLayer = pSlot->layer;
+				pSlot->layer = layer;
+				m_isDrawOrderDirty = true;
 
 				decrementLayerDrawerCount(prevLayer);
 				incrementLayerDrawerCount(layer);
@@ -272,98 +677,169 @@ namespace cotasklib::Co
 
 			void setDrawerDrawIndex(DrawerID id, int32 drawIndex)
 			{
-				const auto it = findByID(id);
-				if (it == m_drawers.end())
+				const auto pSlot = findDrawerSlot(id);
+				if (!pSlot)
 				{
-					throw Error{ U"DrawExecutor::remove: ID={} not found"_fmt(id) };
+					throw Error{ U"DrawExecutor::setDrawerDrawIndex: ID={} not found"_fmt(id) };
 				}
-				if (it->first.drawIndex == drawIndex)
+				if (pSlot->drawIndex == drawIndex)
 				{
 					return;
 				}
-
-				// 一度削除して再挿入
-				DrawerKey newKey = it->first;
-				newKey.drawIndex = drawIndex;
-				const auto pDrawable = it->second;
-				m_drawers.erase(it);
-				m_drawers.emplace(newKey, pDrawable);
-				m_drawerKeyByID[id].drawIndex = drawIndex;
+				pSlot->drawIndex = drawIndex;
+				m_isDrawOrderDirty = true;
 			}
 
 			void remove(DrawerID id)
 			{
-				const auto it = findByID(id);
-				if (it == m_drawers.end())
+				const auto pSlot = findDrawerSlot(id);
+				if (!pSlot)
 				{
 					throw Error{ U"DrawExecutor::remove: ID={} not found"_fmt(id) };
 				}
-				decrementLayerDrawerCount(it->first.layer);
-				m_drawers.erase(it);
-				m_drawerKeyByID.erase(id);
+				decrementLayerDrawerCount(pSlot->layer);
+
+				// Note: 描画順の一覧に残った要素は、世代番号が一致しないため次回の並び替え時に取り除かれる
+				pSlot->pDrawer = nullptr;
+				if (++pSlot->generation == 0)
+				{
+					// 世代番号0は使用しない(IDが0にならないようにするため)
+					pSlot->generation = 1;
+				}
+				m_freeDrawerSlotIndices.push_back(static_cast<uint32>(id & 0xFFFFFFFFULL));
+				m_isDrawOrderDirty = true;
 			}
 
-			void execute() const
+			void execute()
 			{
-				for (const auto& [key, pDrawer] : m_drawers)
+				sortDrawOrderIfDirty();
+
+				// Note: 描画中に描画が追加・削除されても配列の再確保で参照が壊れないよう、インデックスでアクセスする
+				// (描画中に追加された描画は次回から、描画順序の変更は次回の並び替え後に反映される)
+				const std::size_t numItems = m_drawOrder.size();
+				for (std::size_t i = 0; i < numItems; ++i)
 				{
-					pDrawer->drawInternal();
+					const DrawOrderItem item = m_drawOrder[i];
+					if (!isDrawOrderItemValid(item))
+					{
+						continue;
+					}
+					m_drawerSlots[item.slotIndex].pDrawer->drawInternal();
 				}
 			}
 
 			[[nodiscard]]
-			bool drawerExistsInLayer(Layer layer) const
+			bool drawerExistsInLayer(Layer layer) const noexcept
 			{
-				const auto it = m_layerDrawerCount.find(layer);
-				if (it == m_layerDrawerCount.end())
-				{
-					return false;
-				}
-				return it->second > 0;
+				return m_activeLayers.contains(layer);
+			}
+
+			[[nodiscard]]
+			const LayerMask& activeLayers() const noexcept
+			{
+				return m_activeLayers;
 			}
 		};
 
-		class Backend
+		// フレームごとの時刻とフレーム数のスナップショット
+		struct FrameClockSnapshot
+		{
+			double sceneTime = 0.0;
+
+			int32 frameCount = 0;
+		};
+
+		// 完了を通知する手段を持たない処理(s3d::AsyncTask等)の完了を、所有スレッドのupdate時にまとめて確認する対象
+		// (待機しているタスクは完了するまで休止し、完了を確認したものだけがonReadyで起床される)
+		class IReadyPollItem
 		{
 		private:
-			static constexpr StringView AddonName{ U"Co::BackendAddon" };
+			friend class Backend;
 
-			static inline Backend* s_pInstance = nullptr;
+			static constexpr std::size_t NotPolling = std::numeric_limits<std::size_t>::max();
 
-			// Note: draw関数がconstであることの対処用にアドオンと実体を分離し、実体はポインタで持つようにしている
-			class BackendAddon : public IAddon
-			{
-			private:
-				std::unique_ptr<Backend> m_instance;
+			// 登録先のインスタンス
+			Backend* m_pPollingBackend = nullptr;
 
-			public:
-				BackendAddon()
-					: m_instance{ std::make_unique<Backend>() }
-				{
-					if (s_pInstance)
-					{
-						throw Error{ U"Co::BackendAddon: Instance already exists" };
-					}
-					s_pInstance = m_instance.get();
-				}
+			// 登録先の確認対象の一覧での添字(未登録の場合はNotPolling)
+			std::size_t m_pollIndex = NotPolling;
 
-				virtual ~BackendAddon()
-				{
-					if (s_pInstance == m_instance.get())
-					{
-						s_pInstance = nullptr;
-					}
-				}
+		public:
+			IReadyPollItem() = default;
 
-				virtual bool update() override
+			// 登録中の要素は一覧から参照されるため、コピー・ムーブしない
+			IReadyPollItem(const IReadyPollItem&) = delete;
+
+			IReadyPollItem& operator=(const IReadyPollItem&) = delete;
+
+			virtual ~IReadyPollItem() = default;
+
+			// 所有スレッドのupdate時に、完了するまで1回ずつ呼ばれる
+			[[nodiscard]]
+			virtual bool isReady() = 0;
+
+			// 完了を確認した際に、確認対象から外した後で呼ばれる
+			virtual void onReady() = 0;
+
+			[[nodiscard]]
+			bool isPolling() const noexcept
+			{
+				return m_pollIndex != NotPolling;
+			}
+		};
+
+		// Note: ScopedTaskRunner等は登録先のBackendを弱参照で持つため、shared_ptrで保持する
+		class Backend : public std::enable_shared_from_this<Backend>
+		{
+		private:
+			// 現在のスレッドで使用するインスタンス
+			// (既定ではScopedInstanceで登録したインスタンスで、CurrentScopeの範囲内では差し替えられる)
+			static inline thread_local Backend* s_pInstance = nullptr;
+
+		public:
+			// 実体を保持し、生存期間中は現在のスレッドの既定のインスタンスとして登録する
+			// (Siv3D環境ではBackendAddonが、COTASKLIB_NO_SIV3D環境ではManualBackendが保持する)
+			class ScopedInstance
+			{
+			private:
+				std::shared_ptr<Backend> m_instance;
+
+			public:
+				explicit ScopedInstance(std::shared_ptr<Backend> instance)
+					: m_instance{ std::move(instance) }
 				{
-					m_instance->update();
-					return true;
+					if (s_pInstance)
+					{
+						throw Error{ U"Co::Backend: Instance already exists" };
+					}
+					s_pInstance = m_instance.get();
+					s_pCurrentManualClock = m_instance->manualClock();
+
+					// 最初に登録したインスタンスが、Co::PostToMainThreadで渡された関数を受け付けるキューを保持する
+					if (!MainThreadPostQueue::HasRegisteredQueue())
+					{
+						auto mainThreadPostQueue = std::make_unique<MainThreadPostQueue>();
+						if (mainThreadPostQueue->tryRegister())
+						{
+							m_instance->m_mainThreadPostQueue = std::move(mainThreadPostQueue);
+						}
+					}
 				}
 
-				virtual void draw() const override
+				ScopedInstance(const ScopedInstance&) = delete;
+
+				ScopedInstance& operator=(const ScopedInstance&) = delete;
+
+				~ScopedInstance()
 				{
-					m_instance->draw();
+					if (s_pInstance == m_instance.get())
+					{
+						s_pInstance = nullptr;
+						s_pCurrentManualClock = nullptr;
+					}
+
+					// 未実行の関数は、渡された関数の参照先が破棄されている可能性があるため実行せずに破棄する
+					m_instance->m_mainThreadPostQueue.reset();
 				}
 
 				[[nodiscard]]
@@ -373,705 +849,3094 @@ namespace cotasklib::Co
 				}
 			};
 
-			AwaiterID m_nextAwaiterID = 1;
-
-			Optional<AwaiterID> m_currentAwaiterID = none;
+			// スコープ内で、指定したインスタンスを現在のスレッドで使用するインスタンスにする
+			// (update中や、Co::ScopedCurrentSchedulerの範囲内で使用する)
+			class CurrentScope
+			{
+			private:
+				Backend* m_pPrevInstance;
+				const ManualClock* m_pPrevManualClock;
+				bool m_prevIsDirectResume;
 
-			bool m_currentAwaiterRemovalNeeded = false;
+			public:
+				explicit CurrentScope(Backend* pInstance) noexcept
+					: m_pPrevInstance(s_pInstance)
+					, m_pPrevManualClock(s_pCurrentManualClock)
+					, m_prevIsDirectResume(s_isDirectResume)
+				{
+					s_pInstance = pInstance;
+					s_pCurrentManualClock = pInstance->manualClock();
+					s_isDirectResume = false;
+				}
 
-			std::map<AwaiterID, AwaiterEntry> m_awaiterEntries;
+				CurrentScope(const CurrentScope&) = delete;
 
-			DrawExecutor m_drawExecutor;
+				CurrentScope& operator=(const CurrentScope&) = delete;
 
-			SceneFactory m_currentSceneFactory;
+				~CurrentScope() noexcept
+				{
+					s_pInstance = m_pPrevInstance;
+					s_pCurrentManualClock = m_pPrevManualClock;
+					s_isDirectResume = m_prevIsDirectResume;
+				}
+			};
 
-		public:
-			Backend() = default;
+		private:
+#ifndef COTASKLIB_NO_SIV3D
+			static constexpr StringView AddonName{ U"Co::BackendAddon" };
 
-			void update()
+			// Note: draw関数がconstであることの対処用にアドオンと実体を分離し、実体はポインタで持つようにしている
+			class BackendAddon : public IAddon
 			{
-				std::exception_ptr exceptionPtr;
-				for (auto it = m_awaiterEntries.begin(); it != m_awaiterEntries.end();)
+			private:
+				ScopedInstance m_instance{ std::make_shared<Backend>() };
+
+			public:
+				virtual bool update() override
 				{
-					m_currentAwaiterID = it->first;
+					m_instance.instance()->update();
+					return true;
+				}
 
-					const auto& entry = it->second;
-					entry.awaiter->resume();
-					if (m_currentAwaiterRemovalNeeded || entry.awaiter->done())
-					{
-						try
-						{
-							entry.callEndCallback();
-						}
-						catch (...)
-						{
-							if (!exceptionPtr)
-							{
-								exceptionPtr = std::current_exception();
-							}
-						}
-						it = m_awaiterEntries.erase(it);
-						m_currentAwaiterRemovalNeeded = false;
-					}
-					else
-					{
-						++it;
-					}
+				virtual void draw() const override
+				{
+					m_instance.instance()->draw();
 				}
-				m_currentAwaiterID.reset();
-				if (exceptionPtr)
+
+				[[nodiscard]]
+				Backend* instance() const
 				{
-					std::rethrow_exception(exceptionPtr);
+					return m_instance.instance();
 				}
-			}
+			};
+#endif
 
-			void draw()
+			// AwaiterIDは下位32ビットがスロット番号、上位32ビットが世代番号
+			// (削除済みのIDはスロットの世代番号が一致しなくなるため、木構造の探索なしに無効と判定できる)
+			enum class AwaiterState : uint8
 			{
-				m_drawExecutor.execute();
-			}
+				Free,
+				Running, // 実行リストに含まれている
+				Sleeping, // 期限まで実行リストから外れて休止している
+				Waiting, // 待機リストに登録され、起床されるまで実行リストから外れて休止している
+				Woken, // 起床済みで、実行リストへの合流待ち
+				Paused, // 所属するポーズグループが一時停止中のため、再開されるまで実行リストから外れている
+			};
 
-			static void Init()
+			// Note: 毎フレーム参照されるため、エントリ本体(m_awaiterEntries)とは分けて小さく保つ
+			struct AwaiterSlot
 			{
-				Addon::Register(AddonName, std::make_unique<BackendAddon>());
-			}
+				// 実行順(登録順に振られる通し番号)
+				uint64 order = 0;
 
-			template <typename TResult>
-			[[nodiscard]]
-			static AwaiterID Add(std::unique_ptr<TaskAwaiter<TResult>>&& awaiter, FinishCallbackType<TResult> finishCallback, std::function<void()> cancelCallback)
+				uint32 generation = 1;
+				AwaiterState state = AwaiterState::Free;
+				TaskPriority priority = TaskPriority::Normal;
+
+				// 直前のupdateで、予算超過により実行を次フレームへ持ち越したかどうか
+				bool isDeferred = false;
+
+				// 所属するポーズグループ(実体はエントリ本体が保持する)
+				PauseGroupState* pPauseGroup = nullptr;
+
+				// 所属するタイムスケールグループ(実体はエントリ本体が保持する)
+				TimeScaleGroupState* pTimeScaleGroup = nullptr;
+			};
+
+			// 休止・持ち越しの状態
+			// Note: 実行リストの走査では参照しないため、スロットとは分けて保持する
+			struct AwaiterSleepState
 			{
-				if (!awaiter)
+				// 休止ごとに振られる通し番号(期限ヒープや待機リスト内に残った古い要素と区別するため)
+				uint64 sleepToken = 0;
+
+				// 休止中の場合、期限の判定に使用する時計(nullptrの場合はScene::Time)
+				ISteadyClock* pSleepSteadyClock = nullptr;
+
+				// 予算超過により実行を持ち越した回数の累計
+				// (タイマーが持ち越されたフレームの時間を経過時間に加算するために使用する)
+				uint32 deferredFrameCount = 0;
+			};
+
+			struct RunListItem
+			{
+				uint64 order;
+				IAwaiter* pAwaiter;
+				uint32 slotIndex;
+			};
+
+			struct RunListItemOrderGreater
+			{
+				[[nodiscard]]
+				bool operator()(const RunListItem& lhs, const RunListItem& rhs) const noexcept
 				{
-					throw Error{ U"awaiter must not be nullptr" };
+					return lhs.order > rhs.order;
 				}
+			};
 
-				if (!s_pInstance)
+			template <typename TTime>
+			struct Sleeper
+			{
+				TTime deadline;
+				uint32 slotIndex;
+				uint64 sleepToken;
+
+				[[nodiscard]]
+				friend bool operator>(const Sleeper& lhs, const Sleeper& rhs) noexcept
 				{
-					throw Error{ U"Backend is not initialized" };
+					return lhs.deadline > rhs.deadline;
 				}
-				const AwaiterID id = s_pInstance->m_nextAwaiterID++;
-				std::function<void(const IAwaiter*)> finishCallbackTypeErased =
-					[finishCallback = std::move(finishCallback), cancelCallback/*コピーキャプチャ*/, id](const IAwaiter* awaiter)
-					{
-						auto fnGetResult = [awaiter, cancelCallback]() -> TResult
-							{
-								try
-								{
-									// awaiterの型がTaskAwaiter<TResult>であることは保証されるため、static_castでキャストして問題ない
-									return static_cast<const TaskAwaiter<TResult>*>(awaiter)->value();
-								}
-								catch (...)
-								{
-									// 例外を捕捉した場合はキャンセル扱いにした上で例外を投げ直す
-									if (cancelCallback)
-									{
-										cancelCallback();
-									}
-									throw;
-								}
-							};
-						if constexpr (std::is_void_v<TResult>)
-						{
-							fnGetResult(); // 例外伝搬のためにvoidでも呼び出す
-							if (finishCallback)
-							{
-								finishCallback();
-							}
-						}
-						else
-						{
-							auto result = fnGetResult();
-							if (finishCallback)
-							{
-								finishCallback(std::move(result));
-							}
-						}
-					};
-				s_pInstance->m_awaiterEntries.emplace(id,
-					AwaiterEntry
-					{
-						.awaiter = std::move(awaiter),
-						.finishCallback = std::move(finishCallbackTypeErased),
-						.cancelCallback = std::move(cancelCallback),
-					});
-				return id;
-			}
+			};
 
-			static bool Remove(AwaiterID id)
+			// 期限の早い順に取り出せるヒープ
+			// (休止中のタスクが削除された場合、要素はヒープ内に残り、取り出し時に読み捨てる)
+			template <typename TTime>
+			struct SleeperHeap
 			{
-				if (!s_pInstance)
+				Array<Sleeper<TTime>> sleepers;
+				std::size_t numSleepingAwaiters = 0;
+			};
+
+			// Scene::Timeは浮動小数点数のため、期限の計算誤差で起床が1フレーム遅れないよう、わずかに早めに起床させる
+			// (早めに起床した場合は、Delay側で期限に達していないことを確認して再度休止する)
+			static constexpr double SceneTimeWakeMargin = 1e-6;
+
+			// update時に完了を確認する対象
+			// Note: エントリの破棄時に登録が解除されるよう、エントリより前に宣言している
+			Array<IReadyPollItem*> m_readyPollItems;
+
+			Array<AwaiterSlot> m_awaiterSlots;
+
+			// スロットと同じ添字で参照するエントリ本体
+			Array<AwaiterEntry> m_awaiterEntries;
+
+			// スロットと同じ添字で参照する、エントリの終了を待機しているタスクの待機リスト
+			Array<Array<Waiter>> m_awaiterFinishWaiters;
+
+			// スロットと同じ添字で参照する、休止・持ち越しの状態
+			Array<AwaiterSleepState> m_awaiterSleepStates;
+
+			Array<uint32> m_freeAwaiterSlotIndices;
+
+			uint64 m_nextAwaiterOrder = 1;
+
+			uint64 m_nextSleepToken = 1;
+
+			// 実行順に並んだ実行中のエントリ
+			// (削除されたエントリの要素は残り、update時にまとめて詰められる)
+			Array<RunListItem> m_runList;
+
+			Array<RunListItem> m_nextRunList;
+
+			std::size_t m_staleRunListItemCount = 0;
+
+			// 起床済みのエントリ(実行順のヒープ)
+			// (update時に実行リストと実行順に合流させながら実行する)
+			Array<RunListItem> m_wokenItems;
+
+			// update中に起床したが、実行順が既に過ぎているため次回のupdateで合流させるエントリ
+			// (毎フレーム確認していた場合と同じく、次フレームで実行されるようにするため)
+			Array<RunListItem> m_deferredWokenItems;
+
+			SleeperHeap<double> m_sceneTimeSleepers;
+
+			std::unordered_map<ISteadyClock*, SleeperHeap<uint64>> m_steadyClockSleepers;
+
+			bool m_isUpdating = false;
+
+			Optional<AwaiterID> m_currentAwaiterID = none;
+
+			uint64 m_currentAwaiterOrder = 0;
+
+			bool m_currentAwaiterRemovalNeeded = false;
+
+			DrawExecutor m_drawExecutor;
+
+			SceneFactory m_currentSceneFactory;
+
+			// 時刻とフレーム数を手動で進める時計
+			// (Co::Scheduler・Co::ManualBackendの場合のみ持ち、それ以外はScene::Time・Scene::FrameCountを使用する)
+			Optional<ManualClock> m_manualClock;
+
+			// update開始時点の時刻とフレーム数
+			// (update中のタイマーは時計を個別に読み取らず、これを参照する)
+			FrameClockSnapshot m_frameClock;
+
+			// update中に読み取ったISteadyClockの時刻
+			// (時計ごとに1フレームにつき1回のみ読み取る。時計の数は少ない想定のため、線形探索する)
+			Array<std::pair<ISteadyClock*, uint64>> m_steadyClockSnapshots;
+
+			// 1フレームあたりのタスク実行の予算(0の場合は無制限)
+			uint64 m_frameBudgetMicrosec = 0;
+
+			// 予算を使い切った場合に持ち越す優先度(この優先度以下のタスクを持ち越す)
+			TaskPriority m_deferredTaskPriority = TaskPriority::Background;
+
+			// 予算の判定に使用する時計(nullptrの場合はstd::chrono::steady_clock)
+			ISteadyClock* m_pFrameBudgetClock = nullptr;
+
+			uint64 m_updateStartMicrosec = 0;
+
+			// 現在のupdateで予算を使い切ったかどうか
+			// (使い切った後は時計を読み取らない)
+			bool m_isOverBudget = false;
+
+			FrameBudgetStats m_frameBudgetStats;
+
+			// update開始時に仮想時刻を進めるタイムスケールグループ(生成順)
+			// (所属するエントリやタイマーがなくなり破棄されたものは、次回のupdate時に取り除く)
+			Array<std::weak_ptr<TimeScaleGroupState>> m_timeScaleGroups;
+
+			bool m_hasFrameClock = false;
+
+			// Co::PostToMainThreadで渡された関数を受け付けるキュー(関数を受け付けるインスタンスの場合のみ保持し、update時に実行する)
+			std::unique_ptr<MainThreadPostQueue> m_mainThreadPostQueue;
+
+			// スレッドプールやCo::Asyncで完了したジョブの通知(update時にまとめて取り出す)
+			CompletionQueue m_completionQueue;
+
+			// 最初にジョブが投入された時点で生成する
+			// Note: 実行中のジョブが完了キューへ追加し終えるまで待ってから破棄されるよう、完了キューより後に宣言している
+			std::unique_ptr<ThreadPool> m_threadPool;
+
+			// update中のみ、時刻とフレーム数のスナップショットを有効にする
+			class FrameClockScope
+			{
+			private:
+				Backend* m_pInstance;
+
+			public:
+				explicit FrameClockScope(Backend* pInstance)
+					: m_pInstance(pInstance)
 				{
-					// Note: ユーザーがインスタンスをstaticで持ってしまった場合にAddon解放後に呼ばれるケースが起こりうるので、ここでは例外を出さない
-					return false;
+					m_pInstance->m_frameClock = FrameClockSnapshot{ .sceneTime = SceneTime(), .frameCount = SceneFrameCount() };
+					m_pInstance->m_steadyClockSnapshots.clear();
+					m_pInstance->m_hasFrameClock = true;
 				}
-				if (id == s_pInstance->m_currentAwaiterID)
+
+				FrameClockScope(const FrameClockScope&) = delete;
+
+				FrameClockScope& operator=(const FrameClockScope&) = delete;
+
+				~FrameClockScope() noexcept
 				{
-					// 実行中タスクのAwaiterをここで削除するとアクセス違反やイテレータ破壊が起きるため、代わりに削除フラグを立てて実行完了時に削除
-					// (例えば、タスク実行のライフタイムをOptional<ScopedTaskRunner>型のメンバ変数として持ち、タスク実行中にそこへnoneを代入して実行を止める場合が該当)
-					if (!s_pInstance->m_currentAwaiterRemovalNeeded)
+					m_pInstance->m_hasFrameClock = false;
+				}
+			};
+
+			[[nodiscard]]
+			uint64 steadyClockSnapshot(ISteadyClock* pSteadyClock)
+			{
+				for (const auto& [pSnapshotClock, microsec] : m_steadyClockSnapshots)
+				{
+					if (pSnapshotClock == pSteadyClock)
 					{
-						s_pInstance->m_currentAwaiterRemovalNeeded = true;
-						return true;
+						return microsec;
 					}
-					return false;
 				}
-				const auto it = s_pInstance->m_awaiterEntries.find(id);
-				if (it != s_pInstance->m_awaiterEntries.end())
+				const uint64 microsec = pSteadyClock->getMicrosec();
+				m_steadyClockSnapshots.emplace_back(pSteadyClock, microsec);
+				return microsec;
+			}
+
+			// 親のタイムスケールグループは子より先に生成され登録されているため、登録順に進めれば親の仮想時刻が先に確定する
+			// Note: スナップショットのシーン時刻から仮想時刻を進めるため、updateでFrameClockScopeによりスナップショットを取得した後、エントリのresumeより前に呼ぶこと
+			void advanceTimeScaleGroups()
+			{
+				if (m_timeScaleGroups.empty())
 				{
-					it->second.callEndCallback();
-					s_pInstance->m_awaiterEntries.erase(it);
-					return true;
+					return;
 				}
-				return false;
+				const double sceneTime = m_frameClock.sceneTime;
+				m_timeScaleGroups.remove_if([sceneTime](const std::weak_ptr<TimeScaleGroupState>& timeScaleGroup)
+					{
+						const auto pTimeScaleGroup = timeScaleGroup.lock();
+						if (!pTimeScaleGroup)
+						{
+							return true;
+						}
+						pTimeScaleGroup->advance(sceneTime);
+						return false;
+					});
 			}
 
 			[[nodiscard]]
-			static bool IsDone(AwaiterID id)
+			static AwaiterID MakeAwaiterID(uint32 slotIndex, uint32 generation) noexcept
 			{
-				if (!s_pInstance)
+				return (static_cast<AwaiterID>(generation) << 32) | slotIndex;
+			}
+
+			[[nodiscard]]
+			AwaiterSlot* findAwaiterSlot(AwaiterID id)
+			{
+				const auto slotIndex = static_cast<uint32>(id & 0xFFFFFFFFULL);
+				const auto generation = static_cast<uint32>(id >> 32);
+				if (slotIndex >= m_awaiterSlots.size())
 				{
-					throw Error{ U"Backend is not initialized" };
+					return nullptr;
 				}
-				const auto it = s_pInstance->m_awaiterEntries.find(id);
-				if (it != s_pInstance->m_awaiterEntries.end())
+				auto& slot = m_awaiterSlots[slotIndex];
+				if (slot.generation != generation || slot.state == AwaiterState::Free)
 				{
-					return it->second.awaiter->done();
+					return nullptr;
 				}
-				return id < s_pInstance->m_nextAwaiterID;
+				return &slot;
 			}
 
-			static void ManualUpdate()
+			// 発行済みで、既にスロットが解放されたIDかどうか
+			// (未発行のIDや他のスケジューラのIDを、完了済みと誤判定しないため)
+			// Note: 解放ごとに世代番号を進めるため、スロットの現在の世代番号より小さければ発行済み
+			//       (同じスロットで世代番号が一周するまで再利用された場合は判定できないが、実用上は問題にならない)
+			[[nodiscard]]
+			bool isRetiredAwaiterID(AwaiterID id) const
 			{
-				if (!s_pInstance)
-				{
-					throw Error{ U"Backend is not initialized" };
-				}
-				s_pInstance->update();
+				const auto slotIndex = static_cast<uint32>(id & 0xFFFFFFFFULL);
+				const auto generation = static_cast<uint32>(id >> 32);
+				return slotIndex < m_awaiterSlots.size() && generation != 0 && generation < m_awaiterSlots[slotIndex].generation;
 			}
 
 			[[nodiscard]]
-			static DrawerID AddDrawer(IDrawerInternal* pDrawer, Layer layer, int32 drawIndex)
+			uint32 allocateAwaiterSlot()
 			{
-				if (!s_pInstance)
+				if (m_freeAwaiterSlotIndices.empty())
 				{
-					throw Error{ U"Backend is not initialized" };
+					m_awaiterSlots.emplace_back();
+					m_awaiterEntries.emplace_back();
+					m_awaiterFinishWaiters.emplace_back();
+					m_awaiterSleepStates.emplace_back();
+					return static_cast<uint32>(m_awaiterSlots.size() - 1);
 				}
-				return s_pInstance->m_drawExecutor.add(layer, drawIndex, pDrawer);
+				const uint32 slotIndex = m_freeAwaiterSlotIndices.back();
+				m_freeAwaiterSlotIndices.pop_back();
+				return slotIndex;
 			}
 
-			static void SetDrawerLayer(DrawerID id, Layer layer)
+			// スロットを解放し、取り外したエントリを返す
+			[[nodiscard]]
+			AwaiterEntry freeAwaiterSlot(uint32 slotIndex)
 			{
-				if (!s_pInstance)
+				auto& slot = m_awaiterSlots[slotIndex];
+				switch (slot.state)
 				{
-					throw Error{ U"Backend is not initialized" };
+				case AwaiterState::Running:
+					if (slotIndex != currentAwaiterSlotIndex())
+					{
+						// 実行リスト内の要素は次回のupdate時に詰められる
+						++m_staleRunListItemCount;
+					}
+					break;
+
+				case AwaiterState::Sleeping:
+					removeSleepingAwaiter(m_awaiterSleepStates[slotIndex].pSleepSteadyClock);
+					break;
+
+				default:
+					break;
 				}
-				s_pInstance->m_drawExecutor.setDrawerLayer(id, layer);
-			}
 
-			static void SetDrawerDrawIndex(DrawerID id, int32 drawIndex)
-			{
-				if (!s_pInstance)
+				// Note: 待機リストに残った要素は、起床時に通し番号が一致しないため読み捨てられる
+				AwaiterEntry entry = std::move(m_awaiterEntries[slotIndex]);
+				m_awaiterEntries[slotIndex] = AwaiterEntry{};
+				slot.state = AwaiterState::Free;
+				slot.pPauseGroup = nullptr;
+				slot.pTimeScaleGroup = nullptr;
+				slot.priority = TaskPriority::Normal;
+				slot.isDeferred = false;
+				m_awaiterSleepStates[slotIndex] = AwaiterSleepState{};
+				if (++slot.generation == 0)
 				{
-					throw Error{ U"Backend is not initialized" };
+					// 世代番号0は使用しない(IDが0にならないようにするため)
+					slot.generation = 1;
 				}
-				s_pInstance->m_drawExecutor.setDrawerDrawIndex(id, drawIndex);
+				m_freeAwaiterSlotIndices.push_back(slotIndex);
+
+				// 終了を待機しているタスクを起床させる
+				WakeWaiters(m_awaiterFinishWaiters[slotIndex]);
+
+				return entry;
 			}
 
-			static void RemoveDrawer(DrawerID id)
+			[[nodiscard]]
+			uint32 currentAwaiterSlotIndex() const noexcept
 			{
-				if (!s_pInstance)
+				if (!m_currentAwaiterID)
 				{
-					// Note: ユーザーがインスタンスをstaticで持ってしまった場合にAddon解放後に呼ばれるケースが起こりうるので、ここでは例外を出さない
-					return;
+					return std::numeric_limits<uint32>::max();
 				}
-				s_pInstance->m_drawExecutor.remove(id);
+				return static_cast<uint32>(*m_currentAwaiterID & 0xFFFFFFFFULL);
 			}
 
 			[[nodiscard]]
-			static bool HasActiveDrawerInLayer(Layer layer)
+			bool isRunListItemValid(const RunListItem& item, AwaiterState state) const noexcept
 			{
-				if (!s_pInstance)
-				{
-					throw Error{ U"Backend is not initialized" };
-				}
-				return s_pInstance->m_drawExecutor.drawerExistsInLayer(layer);
+				const auto& slot = m_awaiterSlots[item.slotIndex];
+				return slot.state == state && slot.order == item.order;
 			}
-		};
 
-		template <typename TResult>
-		[[nodiscard]]
-		Optional<AwaiterID> ResumeAwaiterOnceAndRegisterIfNotDone(TaskAwaiter<TResult>&& awaiter, FinishCallbackType<TResult> finishCallback, std::function<void()> cancelCallback)
-		{
-			const auto fnCallFinishCallback = [&]
+			void compactRunList()
+			{
+				m_runList.remove_if([this](const RunListItem& item) { return !isRunListItemValid(item, AwaiterState::Running); });
+				m_staleRunListItemCount = 0;
+			}
+
+			void removeSleepingAwaiter(ISteadyClock* pSteadyClock)
+			{
+				if (pSteadyClock)
 				{
-					if constexpr (std::is_void_v<TResult>)
+					const auto it = m_steadyClockSleepers.find(pSteadyClock);
+					if (it != m_steadyClockSleepers.end() && --it->second.numSleepingAwaiters == 0)
 					{
-						try
-						{
-							awaiter.value(); // 例外伝搬のためにvoidでも呼び出す
-						}
-						catch (...)
+						// 時計ごと解放されている可能性があるため、休止中のタスクがなくなった時計は以降参照しない
+						m_steadyClockSleepers.erase(it);
+					}
+				}
+				else if (--m_sceneTimeSleepers.numSleepingAwaiters == 0)
+				{
+					m_sceneTimeSleepers.sleepers.clear();
+				}
+			}
+
+			[[nodiscard]]
+			bool canSleepCurrentAwaiter() const noexcept
+			{
+				if (!s_isDirectResume || !m_currentAwaiterID || m_currentAwaiterRemovalNeeded)
+				{
+					return false;
+				}
+
+				// 実行済みのエントリの完了時のコールバック内で、解放したスロットが別のタスクに再利用された場合は休止させない
+				const auto& slot = m_awaiterSlots[currentAwaiterSlotIndex()];
+				return slot.state == AwaiterState::Running && slot.generation == static_cast<uint32>(*m_currentAwaiterID >> 32);
+			}
+
+			template <typename TTime>
+			void sleepCurrentAwaiter(SleeperHeap<TTime>& heap, ISteadyClock* pSteadyClock, TTime deadline)
+			{
+				const uint32 slotIndex = currentAwaiterSlotIndex();
+				auto& sleepState = m_awaiterSleepStates[slotIndex];
+				m_awaiterSlots[slotIndex].state = AwaiterState::Sleeping;
+				sleepState.sleepToken = m_nextSleepToken++;
+				sleepState.pSleepSteadyClock = pSteadyClock;
+				heap.sleepers.push_back(Sleeper<TTime>{ .deadline = deadline, .slotIndex = slotIndex, .sleepToken = sleepState.sleepToken });
+				std::push_heap(heap.sleepers.begin(), heap.sleepers.end(), std::greater<>{});
+				++heap.numSleepingAwaiters;
+			}
+
+			[[nodiscard]]
+			Waiter waitCurrentAwaiter()
+			{
+				const uint32 slotIndex = currentAwaiterSlotIndex();
+				auto& sleepState = m_awaiterSleepStates[slotIndex];
+				m_awaiterSlots[slotIndex].state = AwaiterState::Waiting;
+				sleepState.sleepToken = m_nextSleepToken++;
+				return Waiter{ .backend = weak_from_this(), .slotIndex = slotIndex, .sleepToken = sleepState.sleepToken };
+			}
+
+			[[nodiscard]]
+			bool isWaiterValid(const Waiter& waiter) const noexcept
+			{
+				return m_awaiterSlots[waiter.slotIndex].state == AwaiterState::Waiting && m_awaiterSleepStates[waiter.slotIndex].sleepToken == waiter.sleepToken;
+			}
+
+			static void AddWaiter(Array<Waiter>& waiters, const Waiter& waiter)
+			{
+				if (waiters.size() == waiters.capacity())
+				{
+					// 起床されないまま削除されたタスクの要素が溜まり続けないよう、再確保の前に古い要素を取り除く
+					waiters.remove_if([](const Waiter& w)
+						{
+							const auto pInstance = w.backend.lock();
+							return !pInstance || !pInstance->isWaiterValid(w);
+						});
+				}
+				waiters.push_back(waiter);
+			}
+
+			void wakeWaiter(const Waiter& waiter)
+			{
+				if (!isWaiterValid(waiter))
+				{
+					return;
+				}
+				m_awaiterSleepStates[waiter.slotIndex].sleepToken = 0;
+				pushWokenItem(waiter.slotIndex);
+			}
+
+			// 休止中のエントリを起床済みにし、実行リストへ合流させる
+			void pushWokenItem(uint32 slotIndex)
+			{
+				auto& slot = m_awaiterSlots[slotIndex];
+				slot.state = AwaiterState::Woken;
+
+				const RunListItem item{ .order = slot.order, .pAwaiter = m_awaiterEntries[slotIndex].awaiter.get(), .slotIndex = slotIndex };
+				if (m_isUpdating && m_currentAwaiterID && item.order <= m_currentAwaiterOrder)
+				{
+					m_deferredWokenItems.push_back(item);
+				}
+				else
+				{
+					// 実行順がまだ来ていない場合は、同一フレーム内で実行する
+					m_wokenItems.push_back(item);
+					std::push_heap(m_wokenItems.begin(), m_wokenItems.end(), RunListItemOrderGreater{});
+				}
+			}
+
+			// 一時停止中のポーズグループに所属するエントリかどうか
+			[[nodiscard]]
+			bool isRunListItemPaused(const RunListItem& item) const noexcept
+			{
+				const PauseGroupState* pPauseGroup = m_awaiterSlots[item.slotIndex].pPauseGroup;
+				return pPauseGroup && pPauseGroup->isPaused();
+			}
+
+			// 一時停止中のポーズグループに所属するエントリを、再開されるまで実行リストから外す
+			void parkRunListItem(const RunListItem& item)
+			{
+				auto& slot = m_awaiterSlots[item.slotIndex];
+				slot.state = AwaiterState::Paused;
+				slot.pPauseGroup->park(MakeAwaiterID(item.slotIndex, slot.generation));
+			}
+
+			template <typename TTime>
+			void wakeExpiredSleepers(SleeperHeap<TTime>& heap, TTime wakeTime)
+			{
+				while (!heap.sleepers.empty() && heap.sleepers.front().deadline <= wakeTime)
+				{
+					std::pop_heap(heap.sleepers.begin(), heap.sleepers.end(), std::greater<>{});
+					const Sleeper<TTime> sleeper = heap.sleepers.back();
+					heap.sleepers.pop_back();
+
+					auto& slot = m_awaiterSlots[sleeper.slotIndex];
+					auto& sleepState = m_awaiterSleepStates[sleeper.slotIndex];
+					if (slot.state != AwaiterState::Sleeping || sleepState.sleepToken != sleeper.sleepToken)
+					{
+						// 削除済みのタスク
+						continue;
+					}
+					slot.state = AwaiterState::Woken;
+					sleepState.sleepToken = 0;
+					sleepState.pSleepSteadyClock = nullptr;
+					--heap.numSleepingAwaiters;
+					m_wokenItems.push_back(RunListItem{ .order = slot.order, .pAwaiter = m_awaiterEntries[sleeper.slotIndex].awaiter.get(), .slotIndex = sleeper.slotIndex });
+					std::push_heap(m_wokenItems.begin(), m_wokenItems.end(), RunListItemOrderGreater{});
+				}
+			}
+
+			void wakeExpiredSleepers()
+			{
+				if (m_sceneTimeSleepers.numSleepingAwaiters == 0 && m_steadyClockSleepers.empty())
+				{
+					// 休止中のタスクがない場合は時刻も参照しない
+					return;
+				}
+				if (m_sceneTimeSleepers.numSleepingAwaiters > 0)
+				{
+					wakeExpiredSleepers(m_sceneTimeSleepers, m_frameClock.sceneTime + SceneTimeWakeMargin);
+				}
+				for (auto it = m_steadyClockSleepers.begin(); it != m_steadyClockSleepers.end();)
+				{
+					wakeExpiredSleepers(it->second, steadyClockSnapshot(it->first));
+					if (it->second.numSleepingAwaiters == 0)
+					{
+						it = m_steadyClockSleepers.erase(it);
+					}
+					else
+					{
+						++it;
+					}
+				}
+			}
+
+			void removeReadyPollItemAt(std::size_t index) noexcept
+			{
+				m_readyPollItems[index]->m_pollIndex = IReadyPollItem::NotPolling;
+				if (index != m_readyPollItems.size() - 1)
+				{
+					m_readyPollItems[index] = m_readyPollItems.back();
+					m_readyPollItems[index]->m_pollIndex = index;
+				}
+				m_readyPollItems.pop_back();
+			}
+
+			// 確認対象のうち完了したものを対象から外し、完了を通知する
+			// (完了の確認は所有スレッドでupdateにつき1回のみ行うため、ロックを使用しない)
+			void pollReadyItems()
+			{
+				for (std::size_t i = 0; i < m_readyPollItems.size();)
+				{
+					IReadyPollItem* const pItem = m_readyPollItems[i];
+					if (!pItem->isReady())
+					{
+						++i;
+						continue;
+					}
+
+					// 末尾の要素が添字iへ移動するため、iは進めない
+					removeReadyPollItemAt(i);
+					pItem->onReady();
+				}
+			}
+
+			// 実行リストと起床済みのエントリを、実行順に合流させながら取り出す
+			[[nodiscard]]
+			bool popNextRunListItem(std::size_t& runListIndex, RunListItem& item)
+			{
+				// 起床済みのエントリがない場合は、実行リストを順に取り出すのみ
+				// (毎フレームの大半はこの場合のため、合流させる場合の処理は別の関数に分けて小さく保つ)
+				while (m_wokenItems.empty())
+				{
+					if (runListIndex >= m_runList.size())
+					{
+						return false;
+					}
+					item = m_runList[runListIndex++];
+					if (!isRunListItemValid(item, AwaiterState::Running))
+					{
+						--m_staleRunListItemCount;
+						continue;
+					}
+					if (isRunListItemPaused(item))
+					{
+						parkRunListItem(item);
+						continue;
+					}
+					return true;
+				}
+				return popNextRunListItemMergingWokenItems(runListIndex, item);
+			}
+
+			[[nodiscard]]
+			bool popNextRunListItemMergingWokenItems(std::size_t& runListIndex, RunListItem& item)
+			{
+				while (true)
+				{
+					const bool hasRunListItem = runListIndex < m_runList.size();
+					if (!m_wokenItems.empty() && (!hasRunListItem || m_wokenItems.front().order < m_runList[runListIndex].order))
+					{
+						std::pop_heap(m_wokenItems.begin(), m_wokenItems.end(), RunListItemOrderGreater{});
+						item = m_wokenItems.back();
+						m_wokenItems.pop_back();
+						if (isRunListItemValid(item, AwaiterState::Woken))
+						{
+							m_awaiterSlots[item.slotIndex].state = AwaiterState::Running;
+							if (isRunListItemPaused(item))
+							{
+								parkRunListItem(item);
+								continue;
+							}
+							return true;
+						}
+					}
+					else if (hasRunListItem)
+					{
+						item = m_runList[runListIndex++];
+						if (isRunListItemValid(item, AwaiterState::Running))
 						{
-							if (cancelCallback)
+							if (isRunListItemPaused(item))
 							{
-								cancelCallback();
+								parkRunListItem(item);
+								continue;
 							}
-							throw;
+							return true;
+						}
+						--m_staleRunListItemCount;
+					}
+					else
+					{
+						return false;
+					}
+				}
+			}
+
+			[[nodiscard]]
+			uint64 frameBudgetClockMicrosec() const
+			{
+				if (m_pFrameBudgetClock)
+				{
+					return m_pFrameBudgetClock->getMicrosec();
+				}
+				return static_cast<uint64>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+			}
+
+			// 現在のupdateの開始からの経過時間
+			// (ユーザー指定の時計が巻き戻った場合や差し替えられた場合も、符号なしの減算で桁あふれしないよう0に丸める)
+			[[nodiscard]]
+			uint64 elapsedFrameBudgetMicrosec() const
+			{
+				const uint64 nowMicrosec = frameBudgetClockMicrosec();
+				return nowMicrosec >= m_updateStartMicrosec ? nowMicrosec - m_updateStartMicrosec : 0;
+			}
+
+			// 現在のupdateで予算(未設定の場合はDefaultTimeSliceMicrosec)を使い切ったかどうか
+			// (使い切るまでは呼び出しごとに時計を読み取る)
+			[[nodiscard]]
+			bool isOverBudget()
+			{
+				if (!m_isOverBudget)
+				{
+					const uint64 budgetMicrosec = m_frameBudgetMicrosec > 0 ? m_frameBudgetMicrosec : DefaultTimeSliceMicrosec;
+					m_isOverBudget = elapsedFrameBudgetMicrosec() >= budgetMicrosec;
+				}
+				return m_isOverBudget;
+			}
+
+			// 予算を使い切った場合、優先度に応じてエントリの実行を次フレームへ持ち越すかどうか
+			// (予算を使い切るまでは、持ち越し可能なエントリの実行前にのみ時計を読み取る)
+			[[nodiscard]]
+			bool shouldDeferRunListItem(const RunListItem& item)
+			{
+				if (m_frameBudgetMicrosec == 0)
+				{
+					return false;
+				}
+				const auto& slot = m_awaiterSlots[item.slotIndex];
+				if (slot.priority < m_deferredTaskPriority || (slot.priority == TaskPriority::Normal && slot.isDeferred))
+				{
+					return false;
+				}
+				return isOverBudget();
+			}
+
+			void deferRunListItem(const RunListItem& item)
+			{
+				m_awaiterSlots[item.slotIndex].isDeferred = true;
+				++m_awaiterSleepStates[item.slotIndex].deferredFrameCount;
+				++m_frameBudgetStats.deferredTaskCount;
+				++m_frameBudgetStats.totalDeferredTaskCount;
+			}
+
+			// エントリをresumeし、次フレームも実行リストに残す場合はtrueを返す
+			[[nodiscard]]
+			bool resumeRunListItem(const RunListItem& item, std::exception_ptr& exceptionPtr)
+			{
+				const uint32 slotIndex = item.slotIndex;
+				auto& slotBeforeResume = m_awaiterSlots[slotIndex];
+				m_currentAwaiterID = MakeAwaiterID(slotIndex, slotBeforeResume.generation);
+				m_currentAwaiterOrder = item.order;
+				slotBeforeResume.isDeferred = false;
+
+				// Note: resume中に実行開始したタスクや生成したタイマーは、同じポーズグループ・タイムスケールグループ・優先度に所属する
+				//       (エントリごとにスコープを切り替えずに済むよう、CurrentPauseGroup等が実行中のエントリのスロットを参照する)
+				item.pAwaiter->resume();
+
+				if (m_currentAwaiterRemovalNeeded || item.pAwaiter->done())
+				{
+					finishRunListItem(slotIndex, exceptionPtr);
+					return false;
+				}
+
+				// Note: resume中にタスクが追加されるとスロットの配列が再確保されうるため、参照はresumeの後に取り直す
+				return m_awaiterSlots[slotIndex].state == AwaiterState::Running;
+			}
+
+			void finishRunListItem(uint32 slotIndex, std::exception_ptr& exceptionPtr)
+			{
+				const AwaiterEntry finishedEntry = freeAwaiterSlot(slotIndex);
+				try
+				{
+					finishedEntry.callEndCallback();
+				}
+				catch (...)
+				{
+					if (!exceptionPtr)
+					{
+						exceptionPtr = std::current_exception();
+					}
+				}
+				m_currentAwaiterRemovalNeeded = false;
+			}
+
+			// 次フレームの実行リストへ追加する
+			// (m_nextRunListが空の間は、実行済みの要素の位置へ詰めて書き込むことで実行リストをその場で詰める)
+			void pushNextRunListItem(const RunListItem& item, std::size_t runListIndex, std::size_t& writeIndex)
+			{
+				if (m_nextRunList.empty())
+				{
+					if (writeIndex < runListIndex)
+					{
+						m_runList[writeIndex++] = item;
+						return;
+					}
+
+					// 起床済みのエントリの合流等で未実行の要素を上書きしてしまう場合は、詰め終えた要素を移して以降はm_nextRunListへ追加する
+					m_nextRunList.assign(m_runList.begin(), m_runList.begin() + writeIndex);
+				}
+				m_nextRunList.push_back(item);
+			}
+
+		public:
+			Backend() = default;
+
+			explicit Backend(const ManualClock& manualClock)
+				: m_manualClock(manualClock)
+			{
+			}
+
+			void update()
+			{
+				const CurrentScope currentScope{ this };
+				const FrameClockScope frameClockScope{ this };
+
+				// 各エントリのresume中は実行中のエントリの所属先を参照させるため、update外でのスコープの指定は引き継がない
+				const CurrentPauseGroupScope currentPauseGroupScope{ nullptr };
+				const CurrentTimeScaleGroupScope currentTimeScaleGroupScope{ nullptr };
+				const CurrentTaskPriorityScope currentTaskPriorityScope{ none };
+
+				// スナップショットの取得後、エントリのresumeより前に仮想時刻を進める
+				advanceTimeScaleGroups();
+
+				// Note: 予算が未設定の場合も、Co::YieldIfOverBudget等の判定のためにupdate開始時刻を記録する
+				const bool hasFrameBudget = m_frameBudgetMicrosec > 0;
+				m_updateStartMicrosec = frameBudgetClockMicrosec();
+				m_isOverBudget = false;
+				m_frameBudgetStats.deferredTaskCount = 0;
+
+				for (const RunListItem& item : m_deferredWokenItems)
+				{
+					m_wokenItems.push_back(item);
+					std::push_heap(m_wokenItems.begin(), m_wokenItems.end(), RunListItemOrderGreater{});
+				}
+				m_deferredWokenItems.clear();
+
+				if (m_mainThreadPostQueue)
+				{
+					m_mainThreadPostQueue->drain();
+				}
+
+				// スレッドプールのジョブ等の完了を待機しているタスクを起床させる
+				m_completionQueue.drain();
+
+				pollReadyItems();
+
+				wakeExpiredSleepers();
+
+				std::exception_ptr exceptionPtr;
+				m_isUpdating = true;
+				m_nextRunList.clear();
+
+				// 実行順に実行しつつ、次フレームの実行リストを作成する
+				// (実行中に追加されたエントリも同一フレーム内で実行されるよう、要素数は毎回参照する)
+				std::size_t runListIndex = 0;
+				std::size_t writeIndex = 0;
+				RunListItem item{};
+				try
+				{
+					// Note: エントリごとの休止を許可するのは実行リストからのresume中のみだが、resume以外でエントリの休止を要求する処理はないため、フラグの切り替えはエントリごとではなくupdateにつき1回とする
+					//       (実行済みのエントリの完了時のコールバック等では、スロットが解放済みのため休止は要求されない)
+					const DirectResumeScope directResumeScope;
+					while (popNextRunListItem(runListIndex, item))
+					{
+						if (shouldDeferRunListItem(item))
+						{
+							deferRunListItem(item);
+						}
+						else if (!resumeRunListItem(item, exceptionPtr))
+						{
+							continue;
 						}
+						pushNextRunListItem(item, runListIndex, writeIndex);
+					}
+				}
+				catch (...)
+				{
+					// 例外発生時は未実行のエントリを次フレームの実行リストへ引き継ぐ
+					// (起床済みのエントリはヒープに残したままにし、次フレームで合流させる)
+					if (m_nextRunList.empty())
+					{
+						m_nextRunList.assign(m_runList.begin(), m_runList.begin() + writeIndex);
+					}
+					if (isRunListItemValid(item, AwaiterState::Running))
+					{
+						m_nextRunList.push_back(item);
+					}
+					m_nextRunList.insert(m_nextRunList.end(), m_runList.begin() + runListIndex, m_runList.end());
+					m_runList.swap(m_nextRunList);
+					m_currentAwaiterID.reset();
+					m_currentAwaiterRemovalNeeded = false;
+					m_isUpdating = false;
+					throw;
+				}
+				if (m_nextRunList.empty())
+				{
+					m_runList.resize(writeIndex);
+				}
+				else
+				{
+					m_runList.swap(m_nextRunList);
+				}
+				m_currentAwaiterID.reset();
+				m_isUpdating = false;
+				if (hasFrameBudget)
+				{
+					const uint64 elapsedMicrosec = elapsedFrameBudgetMicrosec();
+					m_frameBudgetStats.lastUpdateTime = Duration{ static_cast<double>(elapsedMicrosec) / 1'000'000.0 };
+					if (elapsedMicrosec > m_frameBudgetMicrosec)
+					{
+						++m_frameBudgetStats.overBudgetFrameCount;
+					}
+				}
+				if (exceptionPtr)
+				{
+					std::rethrow_exception(exceptionPtr);
+				}
+			}
+
+			void draw()
+			{
+				const CurrentScope currentScope{ this };
+				m_drawExecutor.execute();
+			}
+
+			// 手動の時計を持つ場合、時刻とフレーム数を進める
+			void advanceManualClock(const Duration& deltaTime)
+			{
+				if (!m_manualClock)
+				{
+					throw Error{ U"Backend::advanceManualClock: Backend does not have a manual clock" };
+				}
+				m_manualClock->time += deltaTime.count();
+				++m_manualClock->frameCount;
+			}
+
+			[[nodiscard]]
+			const ManualClock* manualClock() const noexcept
+			{
+				return m_manualClock ? &*m_manualClock : nullptr;
+			}
+
+			// 現在のスレッドで使用するインスタンスを返す
+			// (ScopedTaskRunner等が登録先を覚えておくため、弱参照で返す)
+			[[nodiscard]]
+			static std::weak_ptr<Backend> Current()
+			{
+				if (!s_pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				return s_pInstance->weak_from_this();
+			}
+
+			[[nodiscard]]
+			static bool IsCurrent(const std::weak_ptr<Backend>& backend) noexcept
+			{
+				const auto pInstance = backend.lock();
+				return pInstance && pInstance.get() == s_pInstance;
+			}
+
+			// 現在の時刻(Scene::Time)
+			// (update中は、update開始時点のスナップショットを返す)
+			[[nodiscard]]
+			static double FrameSceneTime()
+			{
+				if (s_pInstance && s_pInstance->m_hasFrameClock)
+				{
+					return s_pInstance->m_frameClock.sceneTime;
+				}
+				return SceneTime();
+			}
+
+			// 現在のフレーム数(Scene::FrameCount)
+			// (update中は、update開始時点のスナップショットを返す)
+			[[nodiscard]]
+			static int32 FrameCount()
+			{
+				if (s_pInstance && s_pInstance->m_hasFrameClock)
+				{
+					return s_pInstance->m_frameClock.frameCount;
+				}
+				return SceneFrameCount();
+			}
+
+			// ISteadyClockの現在の時刻
+			// (update中は、時計ごとに最初に読み取った時刻を返す)
+			[[nodiscard]]
+			static uint64 FrameSteadyClockMicrosec(ISteadyClock* pSteadyClock)
+			{
+				if (s_pInstance && s_pInstance->m_hasFrameClock)
+				{
+					return s_pInstance->steadyClockSnapshot(pSteadyClock);
+				}
+				return pSteadyClock->getMicrosec();
+			}
+
+#ifndef COTASKLIB_NO_SIV3D
+			static void Init()
+			{
+				Addon::Register(AddonName, std::make_unique<BackendAddon>());
+			}
+#endif
+
+			// 現在のresumeが、実行リストのエントリからTaskAwaiterの親子関係のみを経由して行われているかどうか
+			// (この場合のみ、子孫のタスクが実行リストのエントリごと休止できる。update中はtrueとし、間接的にresumeする箇所のみIndirectResumeScopeでfalseにする)
+			static inline thread_local bool s_isDirectResume = false;
+
+			// スコープ内で実行リストのエントリをresumeする間、エントリごとの休止を許可する
+			class DirectResumeScope
+			{
+			private:
+				bool m_prevIsDirectResume;
+
+			public:
+				DirectResumeScope() noexcept
+					: m_prevIsDirectResume(s_isDirectResume)
+				{
+					s_isDirectResume = true;
+				}
+
+				DirectResumeScope(const DirectResumeScope&) = delete;
+
+				DirectResumeScope& operator=(const DirectResumeScope&) = delete;
+
+				~DirectResumeScope() noexcept
+				{
+					s_isDirectResume = m_prevIsDirectResume;
+				}
+			};
+
+			// 現在のスレッドで実行開始したタスクを所属させるポーズグループ
+			static inline thread_local PauseGroupState* s_pCurrentPauseGroup = nullptr;
+
+			// スコープ内で実行開始したタスクや生成したタイマーを、指定したポーズグループに所属させる
+			class CurrentPauseGroupScope
+			{
+			private:
+				PauseGroupState* m_pPrevPauseGroup;
+
+			public:
+				explicit CurrentPauseGroupScope(PauseGroupState* pPauseGroup) noexcept
+					: m_pPrevPauseGroup(s_pCurrentPauseGroup)
+				{
+					s_pCurrentPauseGroup = pPauseGroup;
+				}
+
+				CurrentPauseGroupScope(const CurrentPauseGroupScope&) = delete;
+
+				CurrentPauseGroupScope& operator=(const CurrentPauseGroupScope&) = delete;
+
+				~CurrentPauseGroupScope() noexcept
+				{
+					s_pCurrentPauseGroup = m_pPrevPauseGroup;
+				}
+			};
+
+			// 現在実行中のエントリのスロット(update外の場合はnullptr)
+			[[nodiscard]]
+			static const AwaiterSlot* CurrentAwaiterSlot() noexcept
+			{
+				if (!s_pInstance || !s_pInstance->m_currentAwaiterID)
+				{
+					return nullptr;
+				}
+				return s_pInstance->findAwaiterSlot(*s_pInstance->m_currentAwaiterID);
+			}
+
+			// スコープでの指定がない場合は、実行中のエントリが所属するポーズグループを返す
+			[[nodiscard]]
+			static PauseGroupState* CurrentPauseGroup() noexcept
+			{
+				if (s_pCurrentPauseGroup)
+				{
+					return s_pCurrentPauseGroup;
+				}
+				const AwaiterSlot* pSlot = CurrentAwaiterSlot();
+				return pSlot ? pSlot->pPauseGroup : nullptr;
+			}
+
+			// ポーズグループを一時停止・再開する
+			// (一時停止中のグループに所属するエントリは、次に実行順が来た時点で実行リストから外れ、再開時にまとめて実行リストへ戻る)
+			static void SetPauseGroupPaused(PauseGroupState& state, bool isPaused)
+			{
+				if (state.m_isPaused == isPaused)
+				{
+					return;
+				}
+				state.m_isPaused = isPaused;
+
+				if (isPaused)
+				{
+					state.m_pauseStartSceneTime = FrameSceneTime();
+					for (auto& pausedTime : state.m_steadyClockPausedTimes)
+					{
+						pausedTime.pauseStartMicrosec = FrameSteadyClockMicrosec(pausedTime.pSteadyClock);
+					}
+					return;
+				}
+
+				state.m_pausedSceneTime += FrameSceneTime() - state.m_pauseStartSceneTime;
+				for (auto& pausedTime : state.m_steadyClockPausedTimes)
+				{
+					pausedTime.pausedMicrosec += FrameSteadyClockMicrosec(pausedTime.pSteadyClock) - pausedTime.pauseStartMicrosec;
+				}
+
+				const Array<AwaiterID> parkedIDs = std::exchange(state.m_parkedIDs, Array<AwaiterID>{});
+				const auto pInstance = state.m_backend.lock();
+				if (!pInstance)
+				{
+					return;
+				}
+				for (const AwaiterID id : parkedIDs)
+				{
+					const auto pSlot = pInstance->findAwaiterSlot(id);
+					if (pSlot && pSlot->state == AwaiterState::Paused)
+					{
+						pInstance->pushWokenItem(static_cast<uint32>(id & 0xFFFFFFFFULL));
+					}
+				}
+			}
+
+			// 現在のスレッドで実行開始したタスクを所属させるタイムスケールグループ
+			static inline thread_local TimeScaleGroupState* s_pCurrentTimeScaleGroup = nullptr;
+
+			// スコープ内で実行開始したタスクや生成したタイマーを、指定したタイムスケールグループに所属させる
+			class CurrentTimeScaleGroupScope
+			{
+			private:
+				TimeScaleGroupState* m_pPrevTimeScaleGroup;
+
+			public:
+				explicit CurrentTimeScaleGroupScope(TimeScaleGroupState* pTimeScaleGroup) noexcept
+					: m_pPrevTimeScaleGroup(s_pCurrentTimeScaleGroup)
+				{
+					s_pCurrentTimeScaleGroup = pTimeScaleGroup;
+				}
+
+				CurrentTimeScaleGroupScope(const CurrentTimeScaleGroupScope&) = delete;
+
+				CurrentTimeScaleGroupScope& operator=(const CurrentTimeScaleGroupScope&) = delete;
+
+				~CurrentTimeScaleGroupScope() noexcept
+				{
+					s_pCurrentTimeScaleGroup = m_pPrevTimeScaleGroup;
+				}
+			};
+
+			// スコープでの指定がない場合は、実行中のエントリが所属するタイムスケールグループを返す
+			[[nodiscard]]
+			static TimeScaleGroupState* CurrentTimeScaleGroup() noexcept
+			{
+				if (s_pCurrentTimeScaleGroup)
+				{
+					return s_pCurrentTimeScaleGroup;
+				}
+				const AwaiterSlot* pSlot = CurrentAwaiterSlot();
+				return pSlot ? pSlot->pTimeScaleGroup : nullptr;
+			}
+
+			// タイマー等が所属先の仮想時刻を参照し続けるため、共有所有権を返す
+			[[nodiscard]]
+			static std::shared_ptr<TimeScaleGroupState> SharedCurrentTimeScaleGroup()
+			{
+				TimeScaleGroupState* const pTimeScaleGroup = CurrentTimeScaleGroup();
+				if (!pTimeScaleGroup)
+				{
+					return nullptr;
+				}
+				return pTimeScaleGroup->shared_from_this();
+			}
+
+			// 現在のスレッドで実行開始したタスクの優先度(noneの場合は指定なし)
+			static inline thread_local Optional<TaskPriority> s_currentTaskPriority = none;
+
+			// スコープ内で実行開始したタスクの優先度を指定する
+			class CurrentTaskPriorityScope
+			{
+			private:
+				Optional<TaskPriority> m_prevTaskPriority;
+
+			public:
+				explicit CurrentTaskPriorityScope(Optional<TaskPriority> taskPriority) noexcept
+					: m_prevTaskPriority(s_currentTaskPriority)
+				{
+					s_currentTaskPriority = taskPriority;
+				}
+
+				CurrentTaskPriorityScope(const CurrentTaskPriorityScope&) = delete;
+
+				CurrentTaskPriorityScope& operator=(const CurrentTaskPriorityScope&) = delete;
+
+				~CurrentTaskPriorityScope() noexcept
+				{
+					s_currentTaskPriority = m_prevTaskPriority;
+				}
+			};
+
+			// スコープでの指定がない場合は、実行中のエントリの優先度を返す
+			[[nodiscard]]
+			static TaskPriority CurrentTaskPriority() noexcept
+			{
+				if (s_currentTaskPriority)
+				{
+					return *s_currentTaskPriority;
+				}
+				const AwaiterSlot* pSlot = CurrentAwaiterSlot();
+				return pSlot ? pSlot->priority : TaskPriority::Normal;
+			}
+
+			// 予算が未設定の場合に、Co::YieldIfOverBudget等が1フレームあたりに使用する時間
+			// (60fpsの1フレームの半分程度とし、描画等の時間を残す)
+			static constexpr uint64 DefaultTimeSliceMicrosec = 8'000;
+
+			// 現在のupdateで、タスク実行の予算を使い切ったかどうか
+			// (update外ではフレームの区切りがなく経過時間を計れないため、falseを返す。現在のスレッドでスケジューラを使用していない場合も同様)
+			[[nodiscard]]
+			static bool IsOverFrameBudget()
+			{
+				if (!s_pInstance || !s_pInstance->m_isUpdating)
+				{
+					return false;
+				}
+				return s_pInstance->isOverBudget();
+			}
+
+			// 予算の判定に使用する時計の現在時刻
+			[[nodiscard]]
+			static uint64 FrameBudgetClockMicrosec()
+			{
+				if (!s_pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				return s_pInstance->frameBudgetClockMicrosec();
+			}
+
+			// 現在実行中のエントリが、予算超過により実行を持ち越された回数の累計
+			[[nodiscard]]
+			static uint32 CurrentDeferredFrameCount() noexcept
+			{
+				if (!s_pInstance || !s_pInstance->m_currentAwaiterID)
+				{
+					return 0;
+				}
+				return s_pInstance->m_awaiterSleepStates[s_pInstance->currentAwaiterSlotIndex()].deferredFrameCount;
+			}
+
+			// 1フレームあたりのタスク実行の予算を設定する(0の場合は無制限)
+			static void SetFrameBudget(uint64 budgetMicrosec, TaskPriority deferredTaskPriority, ISteadyClock* pSteadyClock)
+			{
+				if (!s_pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				if (deferredTaskPriority == TaskPriority::Critical)
+				{
+					throw Error{ U"SetFrameBudget: Critical tasks cannot be deferred" };
+				}
+				s_pInstance->m_frameBudgetMicrosec = budgetMicrosec;
+				s_pInstance->m_deferredTaskPriority = deferredTaskPriority;
+				s_pInstance->m_pFrameBudgetClock = pSteadyClock;
+			}
+
+			[[nodiscard]]
+			static uint64 FrameBudgetMicrosec()
+			{
+				if (!s_pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				return s_pInstance->m_frameBudgetMicrosec;
+			}
+
+			[[nodiscard]]
+			static const FrameBudgetStats& GetFrameBudgetStats()
+			{
+				if (!s_pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				return s_pInstance->m_frameBudgetStats;
+			}
+
+			// 仮想時刻をupdate開始時に進めるよう、タイムスケールグループを登録する
+			static void AddTimeScaleGroup(const std::shared_ptr<TimeScaleGroupState>& timeScaleGroup)
+			{
+				if (!s_pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				s_pInstance->m_timeScaleGroups.push_back(timeScaleGroup);
+			}
+
+			// スコープ内のresumeでは、エントリごとの休止を禁止する
+			// (Taskを外部から直接resumeする場合、休止するとそれ以降resumeされなくなるため)
+			class IndirectResumeScope
+			{
+			private:
+				bool m_prevIsDirectResume;
+
+			public:
+				IndirectResumeScope() noexcept
+					: m_prevIsDirectResume(s_isDirectResume)
+				{
+					s_isDirectResume = false;
+				}
+
+				IndirectResumeScope(const IndirectResumeScope&) = delete;
+
+				IndirectResumeScope& operator=(const IndirectResumeScope&) = delete;
+
+				~IndirectResumeScope() noexcept
+				{
+					s_isDirectResume = m_prevIsDirectResume;
+				}
+			};
+
+			[[nodiscard]]
+			static AwaiterID Add(std::unique_ptr<IEntryAwaiter>&& awaiter)
+			{
+				if (!awaiter)
+				{
+					throw Error{ U"awaiter must not be nullptr" };
+				}
+
+				if (!s_pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+
+				// Note: スロットの確保で配列が再確保されうるため、実行中のエントリの所属先は確保前に取得する
+				PauseGroupState* const pPauseGroup = CurrentPauseGroup();
+				TimeScaleGroupState* const pTimeScaleGroup = CurrentTimeScaleGroup();
+				const TaskPriority priority = CurrentTaskPriority();
+
+				const uint32 slotIndex = s_pInstance->allocateAwaiterSlot();
+				auto& slot = s_pInstance->m_awaiterSlots[slotIndex];
+				auto& entry = s_pInstance->m_awaiterEntries[slotIndex];
+				entry.awaiter = std::move(awaiter);
+				if (pPauseGroup)
+				{
+					entry.pauseGroup = pPauseGroup->shared_from_this();
+					slot.pPauseGroup = pPauseGroup;
+				}
+				if (pTimeScaleGroup)
+				{
+					entry.timeScaleGroup = pTimeScaleGroup->shared_from_this();
+					slot.pTimeScaleGroup = pTimeScaleGroup;
+				}
+				slot.priority = priority;
+				slot.state = AwaiterState::Running;
+				slot.order = s_pInstance->m_nextAwaiterOrder++;
+				s_pInstance->m_runList.push_back(RunListItem{ .order = slot.order, .pAwaiter = entry.awaiter.get(), .slotIndex = slotIndex });
+				return MakeAwaiterID(slotIndex, slot.generation);
+			}
+
+			static bool Remove(const std::weak_ptr<Backend>& backend, AwaiterID id)
+			{
+				const auto pInstance = backend.lock();
+				if (!pInstance)
+				{
+					// Note: ユーザーがインスタンスをstaticで持ってしまった場合にAddon解放後に呼ばれるケースが起こりうるので、ここでは例外を出さない
+					return false;
+				}
+				if (id == pInstance->m_currentAwaiterID)
+				{
+					// 実行中タスクのAwaiterをここで削除するとアクセス違反やイテレータ破壊が起きるため、代わりに削除フラグを立てて実行完了時に削除
+					// (例えば、タスク実行のライフタイムをOptional<ScopedTaskRunner>型のメンバ変数として持ち、タスク実行中にそこへnoneを代入して実行を止める場合が該当)
+					if (!pInstance->m_currentAwaiterRemovalNeeded)
+					{
+						pInstance->m_currentAwaiterRemovalNeeded = true;
+						return true;
+					}
+					return false;
+				}
+				const auto pSlot = pInstance->findAwaiterSlot(id);
+				if (!pSlot)
+				{
+					return false;
+				}
+
+				// 実行リストの途中を詰めると実行順の維持にO(n)かかるため、ここではスロットの解放のみ行い、実行リストは後でまとめて詰める
+				// (コールバック内でタスクが追加されるとスロットの配列が再確保されうるため、呼び出し前にエントリを取り外しておく)
+				const AwaiterEntry removedEntry = pInstance->freeAwaiterSlot(static_cast<uint32>(id & 0xFFFFFFFFULL));
+				if (!pInstance->m_isUpdating && pInstance->m_staleRunListItemCount * 2 > pInstance->m_runList.size())
+				{
+					pInstance->compactRunList();
+				}
+
+				// コールバック内で実行開始したタスクが、削除したタスクと同じインスタンスに登録されるようにする
+				const CurrentScope currentScope{ pInstance.get() };
+				removedEntry.callEndCallback();
+				return true;
+			}
+
+			[[nodiscard]]
+			static bool IsDone(const std::weak_ptr<Backend>& backend, AwaiterID id)
+			{
+				const auto pInstance = backend.lock();
+				if (!pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				if (pInstance->findAwaiterSlot(id))
+				{
+					return pInstance->m_awaiterEntries[static_cast<uint32>(id & 0xFFFFFFFFULL)].awaiter->done();
+				}
+				return pInstance->isRetiredAwaiterID(id);
+			}
+
+			// 現在実行中のエントリを、Scene::Timeが期限に達するまで実行リストから外して休止させる
+			// (休止できない状況の場合はfalseを返す。その場合、呼び出し元は通常通り毎フレームresumeされる)
+			[[nodiscard]]
+			static bool SleepCurrentUntil(double deadlineSceneTime)
+			{
+				if (!s_pInstance || !s_pInstance->canSleepCurrentAwaiter())
+				{
+					return false;
+				}
+				s_pInstance->sleepCurrentAwaiter(s_pInstance->m_sceneTimeSleepers, nullptr, deadlineSceneTime);
+				return true;
+			}
+
+			// 現在実行中のエントリを、ISteadyClockの時刻が期限に達するまで実行リストから外して休止させる
+			[[nodiscard]]
+			static bool SleepCurrentUntil(ISteadyClock* pSteadyClock, uint64 deadlineMicrosec)
+			{
+				if (!s_pInstance || !pSteadyClock || !s_pInstance->canSleepCurrentAwaiter())
+				{
+					return false;
+				}
+				s_pInstance->sleepCurrentAwaiter(s_pInstance->m_steadyClockSleepers[pSteadyClock], pSteadyClock, deadlineMicrosec);
+				return true;
+			}
+
+			// 現在実行中のエントリを、待機リストが起床されるまで実行リストから外して休止させる
+			// (休止できない状況の場合はfalseを返す。その場合、呼び出し元は通常通り毎フレームresumeされる)
+			[[nodiscard]]
+			static bool WaitCurrent(Array<Waiter>& waiters)
+			{
+				if (!s_pInstance || !s_pInstance->canSleepCurrentAwaiter())
+				{
+					return false;
+				}
+				AddWaiter(waiters, s_pInstance->waitCurrentAwaiter());
+				return true;
+			}
+
+			// 現在実行中のエントリを、指定したエントリのいずれかが終了するか、pWaitersの待機リストが起床されるまで実行リストから外して休止させる
+			// (起床される見込みがない場合や、休止できない状況の場合はfalseを返す)
+			[[nodiscard]]
+			static bool WaitCurrentUntilAnyDone(std::span<const AwaiterID> ids, Array<Waiter>* pWaiters = nullptr)
+			{
+				if (!s_pInstance || !s_pInstance->canSleepCurrentAwaiter())
+				{
+					return false;
+				}
+				const auto isAlive = [](AwaiterID id) { return s_pInstance->findAwaiterSlot(id) != nullptr; };
+				if (!pWaiters && std::none_of(ids.begin(), ids.end(), isAlive))
+				{
+					return false;
+				}
+				const Waiter waiter = s_pInstance->waitCurrentAwaiter();
+				if (pWaiters)
+				{
+					AddWaiter(*pWaiters, waiter);
+				}
+				for (const AwaiterID id : ids)
+				{
+					if (isAlive(id))
+					{
+						AddWaiter(s_pInstance->m_awaiterFinishWaiters[static_cast<uint32>(id & 0xFFFFFFFFULL)], waiter);
+					}
+				}
+				return true;
+			}
+
+			// 待機リストに登録されたタスクを、それぞれが待機したインスタンスで起床させる
+			// (実行中のupdateで実行順がまだ来ていないタスクは同一フレーム内で、それ以外は次回のupdateで実行される)
+			static void WakeWaiters(Array<Waiter>& waiters)
+			{
+				if (waiters.empty())
+				{
+					return;
+				}
+
+				// 起床中に同じ待機リストへ追加される場合に備え、取り外してから起床させる
+				const Array<Waiter> wakingWaiters = std::exchange(waiters, Array<Waiter>{});
+				for (const Waiter& waiter : wakingWaiters)
+				{
+					if (const auto pInstance = waiter.backend.lock())
+					{
+						pInstance->wakeWaiter(waiter);
+					}
+				}
+			}
+
+			static void ManualUpdate()
+			{
+				if (!s_pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				s_pInstance->update();
+			}
+
+			[[nodiscard]]
+			static DrawerID AddDrawer(IDrawerInternal* pDrawer, Layer layer, int32 drawIndex)
+			{
+				if (!s_pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				return s_pInstance->m_drawExecutor.add(layer, drawIndex, pDrawer);
+			}
+
+			static void SetDrawerLayer(const std::weak_ptr<Backend>& backend, DrawerID id, Layer layer)
+			{
+				const auto pInstance = backend.lock();
+				if (!pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				pInstance->m_drawExecutor.setDrawerLayer(id, layer);
+			}
+
+			static void SetDrawerDrawIndex(const std::weak_ptr<Backend>& backend, DrawerID id, int32 drawIndex)
+			{
+				const auto pInstance = backend.lock();
+				if (!pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				pInstance->m_drawExecutor.setDrawerDrawIndex(id, drawIndex);
+			}
+
+			static void RemoveDrawer(const std::weak_ptr<Backend>& backend, DrawerID id)
+			{
+				const auto pInstance = backend.lock();
+				if (!pInstance)
+				{
+					// Note: ユーザーがインスタンスをstaticで持ってしまった場合にAddon解放後に呼ばれるケースが起こりうるので、ここでは例外を出さない
+					return;
+				}
+				pInstance->m_drawExecutor.remove(id);
+			}
+
+			[[nodiscard]]
+			static bool HasActiveDrawerInLayer(Layer layer)
+			{
+				if (!s_pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				return s_pInstance->m_drawExecutor.drawerExistsInLayer(layer);
+			}
+
+			[[nodiscard]]
+			static const LayerMask& ActiveLayers()
+			{
+				if (!s_pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				return s_pInstance->m_drawExecutor.activeLayers();
+			}
+
+			// 完了の通知先は、ジョブの生成時に現在のインスタンスの完了キューを指定する
+			[[nodiscard]]
+			static CompletionQueue* CurrentCompletionQueue()
+			{
+				if (!s_pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				return &s_pInstance->m_completionQueue;
+			}
+
+			static void SubmitToThreadPool(std::shared_ptr<IThreadPoolJob> job, ThreadPoolPriority priority)
+			{
+				if (!s_pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				s_pInstance->threadPool().submit(std::move(job), priority);
+			}
+
+			// 完了の確認をupdate時に行うよう登録する
+			// (完了すると、登録時のインスタンスのupdate時にonReadyが呼ばれる)
+			static void PollReady(IReadyPollItem* pItem)
+			{
+				if (!s_pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				if (pItem->isPolling())
+				{
+					throw Error{ U"Backend::PollReady: Item is already being polled" };
+				}
+				Array<IReadyPollItem*>& items = s_pInstance->m_readyPollItems;
+				items.push_back(pItem);
+				pItem->m_pPollingBackend = s_pInstance;
+				pItem->m_pollIndex = items.size() - 1;
+			}
+
+			// 登録中であれば確認対象から外す
+			static void UnpollReady(IReadyPollItem* pItem) noexcept
+			{
+				if (pItem->isPolling())
+				{
+					pItem->m_pPollingBackend->removeReadyPollItemAt(pItem->m_pollIndex);
+				}
+			}
+
+			static void SetThreadPoolMaxConcurrency(std::size_t maxConcurrency)
+			{
+				if (!s_pInstance)
+				{
+					throw Error{ U"Backend is not initialized" };
+				}
+				s_pInstance->threadPool().setMaxConcurrency(maxConcurrency);
+			}
+
+			[[nodiscard]]
+			ThreadPool& threadPool()
+			{
+				if (!m_threadPool)
+				{
+					m_threadPool = std::make_unique<ThreadPool>();
+				}
+				return *m_threadPool;
+			}
+		};
+
+		template <typename TResult>
+		class EntryAwaiter final : public IEntryAwaiter
+		{
+		private:
+			TaskAwaiter<TResult> m_awaiter;
+			FinishCallbackType<TResult> m_finishCallback;
+			CancelCallbackType m_cancelCallback;
+
+			[[nodiscard]]
+			TResult getResult()
+			{
+				try
+				{
+					return m_awaiter.value();
+				}
+				catch (...)
+				{
+					// 例外を捕捉した場合はキャンセル扱いにした上で例外を投げ直す
+					if (m_cancelCallback)
+					{
+						m_cancelCallback();
+					}
+					throw;
+				}
+			}
+
+		public:
+			EntryAwaiter(TaskAwaiter<TResult>&& awaiter, FinishCallbackType<TResult> finishCallback, CancelCallbackType cancelCallback)
+				: m_awaiter(std::move(awaiter))
+				, m_finishCallback(std::move(finishCallback))
+				, m_cancelCallback(std::move(cancelCallback))
+			{
+			}
+
+			EntryAwaiter(const EntryAwaiter<TResult>&) = delete;
+
+			EntryAwaiter<TResult>& operator=(const EntryAwaiter<TResult>&) = delete;
+
+			EntryAwaiter(EntryAwaiter<TResult>&&) noexcept = default;
+
+			EntryAwaiter<TResult>& operator=(EntryAwaiter<TResult>&&) = delete;
+
+			// タスクの実行ごとに生成・破棄されるため、フレームと同じフリーリストから確保する
+			[[nodiscard]]
+			static void* operator new(std::size_t size);
+
+			static void operator delete(void* p, std::size_t size) noexcept;
+
+			void resume() override
+			{
+				m_awaiter.resume();
+			}
+
+			[[nodiscard]]
+			bool done() const override
+			{
+				return m_awaiter.done();
+			}
+
+			void callEndCallback() override
+			{
+				if (!m_awaiter.done())
+				{
+					if (m_cancelCallback)
+					{
+						m_cancelCallback();
+					}
+					return;
+				}
+
+				if constexpr (std::is_void_v<TResult>)
+				{
+					getResult(); // 例外伝搬のためにvoidでも呼び出す
+					if (m_finishCallback)
+					{
+						m_finishCallback();
+					}
+				}
+				else
+				{
+					auto result = getResult();
+					if (m_finishCallback)
+					{
+						m_finishCallback(std::move(result));
+					}
+				}
+			}
+		};
+
+		template <typename TResult>
+		[[nodiscard]]
+		Optional<AwaiterID> ResumeAwaiterOnceAndRegisterIfNotDone(TaskAwaiter<TResult>&& awaiter, FinishCallbackType<TResult> finishCallback, CancelCallbackType cancelCallback)
+		{
+			EntryAwaiter<TResult> entryAwaiter{ std::move(awaiter), std::move(finishCallback), std::move(cancelCallback) };
+
+			// フレーム待ちなしで終了した場合は登録不要
+			// (ここで一度resumeするのは、runScoped実行まで開始を遅延させるためにinitial_suspendをsuspend_alwaysにしているため)
+			if (entryAwaiter.done())
+			{
+				entryAwaiter.callEndCallback();
+				return none;
+			}
+			{
+				// 初回のresumeは登録前のため、実行中の別のエントリを休止させないようにする
+				const Backend::IndirectResumeScope indirectResumeScope;
+				entryAwaiter.resume();
+			}
+			if (entryAwaiter.done())
+			{
+				entryAwaiter.callEndCallback();
+				return none;
+			}
+
+			return Backend::Add(std::make_unique<EntryAwaiter<TResult>>(std::move(entryAwaiter)));
+		}
+
+		template <typename TResult>
+		Optional<AwaiterID> ResumeAwaiterOnceAndRegisterIfNotDone(const TaskAwaiter<TResult>& awaiter) = delete;
+
+		// 起床されるまで待機するタスクの一覧
+		// (Backendの実行リストから直接resumeされている場合はエントリごと休止し、それ以外の場合は次フレームまで待機する)
+		class WaitList
+		{
+		private:
+			friend class AnyDoneAwaiter;
+
+			Array<Waiter> m_waiters;
+
+		public:
+			class Awaiter
+			{
+			private:
+				WaitList* m_pWaitList;
+
+			public:
+				explicit Awaiter(WaitList* pWaitList) noexcept
+					: m_pWaitList(pWaitList)
+				{
+				}
+
+				[[nodiscard]]
+				bool await_ready() const noexcept
+				{
+					return false;
+				}
+
+				void await_suspend(std::coroutine_handle<>)
+				{
+					(void)m_pWaitList->waitCurrent();
+				}
+
+				void await_resume() const noexcept
+				{
+				}
+			};
+
+			WaitList() = default;
+
+			WaitList(const WaitList&) = delete;
+
+			WaitList& operator=(const WaitList&) = delete;
+
+			WaitList(WaitList&&) noexcept = default;
+
+			WaitList& operator=(WaitList&& rhs)
+			{
+				if (this != &rhs)
+				{
+					// 上書きされる待機リストのタスクが起床されなくならないよう、先に起床させる
+					wakeAll();
+					m_waiters = std::move(rhs.m_waiters);
+				}
+				return *this;
+			}
+
+			~WaitList() = default;
+
+			// 待機を終える条件は呼び出し元で再確認すること
+			[[nodiscard]]
+			Awaiter wait() noexcept
+			{
+				return Awaiter{ this };
+			}
+
+			// 現在実行中のエントリを、起床されるまで休止させる
+			// (co_awaitを使用できないIAwaiter::resume内などで使用する。休止できない場合はfalseを返す)
+			[[nodiscard]]
+			bool waitCurrent()
+			{
+				return Backend::WaitCurrent(m_waiters);
+			}
+
+			void wakeAll()
+			{
+				if (m_waiters.empty())
+				{
+					return;
+				}
+				Backend::WakeWaiters(m_waiters);
+			}
+		};
+
+		// 指定したエントリのいずれかが終了するか、pWaitListが起床されるまで待機する
+		// (休止できない場合は次フレームまで待機するため、終了したかどうかは呼び出し元で再確認すること)
+		class AnyDoneAwaiter
+		{
+		private:
+			std::span<const AwaiterID> m_ids;
+			WaitList* m_pWaitList;
+
+		public:
+			explicit AnyDoneAwaiter(std::span<const AwaiterID> ids, WaitList* pWaitList = nullptr) noexcept
+				: m_ids(ids)
+				, m_pWaitList(pWaitList)
+			{
+			}
+
+			[[nodiscard]]
+			bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<>)
+			{
+				(void)Backend::WaitCurrentUntilAnyDone(m_ids, m_pWaitList ? &m_pWaitList->m_waiters : nullptr);
+			}
+
+			void await_resume() const noexcept
+			{
+			}
+		};
+	}
+
+	[[nodiscard]]
+	inline auto NextFrame() noexcept
+	{
+		return std::suspend_always{};
+	}
+
+	namespace detail
+	{
+		class YieldIfOverBudgetAwaiter
+		{
+		public:
+			[[nodiscard]]
+			bool await_ready() const
+			{
+				return !Backend::IsOverFrameBudget();
+			}
+
+			void await_suspend(std::coroutine_handle<>) const noexcept
+			{
+			}
+
+			void await_resume() const noexcept
+			{
+			}
+		};
+	}
+
+	// 現在のフレームのタスク実行の予算を使い切っている場合のみ、1フレーム待機する
+	// (予算はCo::SetFrameBudgetで設定したもの。未設定の場合は8ミリ秒)
+	// (重い処理のループ内で呼ぶことで、フレームレートを保ちながら処理を複数フレームに分散できる)
+	[[nodiscard]]
+	inline auto YieldIfOverBudget() noexcept
+	{
+		return detail::YieldIfOverBudgetAwaiter{};
+	}
+
+	class MultiRunner;
+
+	class ScopedTaskRunner
+	{
+	private:
+		friend class MultiRunner;
+
+		Optional<detail::AwaiterID> m_id;
+
+		// 登録先のBackend(実行開始時に現在のスレッドで使用していたスケジューラ)
+		std::weak_ptr<detail::Backend> m_backend;
+
+	public:
+		template <typename TResult>
+		explicit ScopedTaskRunner(Task<TResult>&& task, FinishCallbackType<TResult> finishCallback = nullptr, CancelCallbackType cancelCallback = nullptr)
+			: m_id(ResumeAwaiterOnceAndRegisterIfNotDone(detail::TaskAwaiter<TResult>{ std::move(task) }, std::move(finishCallback), std::move(cancelCallback)))
+		{
+			if (m_id.has_value())
+			{
+				m_backend = detail::Backend::Current();
+			}
+		}
+
+		ScopedTaskRunner(const ScopedTaskRunner&) = delete;
+
+		ScopedTaskRunner& operator=(const ScopedTaskRunner&) = delete;
+
+		ScopedTaskRunner(ScopedTaskRunner&& rhs) noexcept
+			: m_id(rhs.m_id)
+			, m_backend(std::move(rhs.m_backend))
+		{
+			rhs.m_id.reset();
+		}
+
+		ScopedTaskRunner& operator=(ScopedTaskRunner&& rhs)
+		{
+			if (m_id.has_value())
+			{
+				detail::Backend::Remove(m_backend, *m_id);
+			}
+			m_id = rhs.m_id;
+			m_backend = std::move(rhs.m_backend);
+			rhs.m_id.reset();
+			return *this;
+		}
+
+		~ScopedTaskRunner()
+		{
+			if (m_id.has_value())
+			{
+				detail::Backend::Remove(m_backend, *m_id);
+			}
+		}
+
+		[[nodiscard]]
+		bool done() const
+		{
+			return !m_id.has_value() || detail::Backend::IsDone(m_backend, *m_id);
+		}
+
+		void forget()
+		{
+			m_id.reset();
+		}
+
+		bool requestCancel()
+		{
+			if (m_id.has_value())
+			{
+				const bool removed = detail::Backend::Remove(m_backend, *m_id);
+				m_id.reset();
+				return removed;
+			}
+			return false;
+		}
+
+		void addTo(MultiRunner& mr)&&;
+
+		[[nodiscard]]
+		Task<void> waitUntilDone() const&;
+
+		[[nodiscard]]
+		Task<void> waitUntilDone() const&& = delete;
+	};
+
+	class MultiRunner
+	{
+	private:
+		Array<ScopedTaskRunner> m_runners;
+
+		// waitUntilAnyDoneで待機しているタスク(ランナーの追加時に、待機対象を更新させるために起床させる)
+		mutable detail::WaitList m_addWaitList;
+
+	public:
+		MultiRunner() = default;
+
+		MultiRunner(const MultiRunner&) = delete;
+
+		MultiRunner& operator=(const MultiRunner&) = delete;
+
+		MultiRunner(MultiRunner&&) = default;
+
+		MultiRunner& operator=(MultiRunner&&) = default;
+
+		~MultiRunner() = default;
+
+		void add(ScopedTaskRunner&& runner)
+		{
+			m_runners.push_back(std::move(runner));
+			m_addWaitList.wakeAll();
+		}
+
+		void reserve(std::size_t size)
+		{
+			m_runners.reserve(size);
+		}
+
+		void clear()
+		{
+			m_runners.clear();
+		}
+
+		[[nodiscard]]
+		size_t size() const noexcept
+		{
+			return m_runners.size();
+		}
+
+		[[nodiscard]]
+		bool empty() const noexcept
+		{
+			return m_runners.empty();
+		}
+
+		void shrinkToFit()
+		{
+			m_runners.shrink_to_fit();
+		}
+
+		[[nodiscard]]
+		auto begin() noexcept
+		{
+			return m_runners.begin();
+		}
+
+		[[nodiscard]]
+		auto begin() const noexcept
+		{
+			return m_runners.begin();
+		}
+
+		[[nodiscard]]
+		auto end() noexcept
+		{
+			return m_runners.end();
+		}
+
+		[[nodiscard]]
+		auto end() const noexcept
+		{
+			return m_runners.end();
+		}
+
+		[[nodiscard]]
+		auto cbegin() const noexcept
+		{
+			return m_runners.cbegin();
+		}
+
+		[[nodiscard]]
+		auto cend() const noexcept
+		{
+			return m_runners.cend();
+		}
+
+		[[nodiscard]]
+		auto rbegin() noexcept
+		{
+			return m_runners.rbegin();
+		}
+
+		[[nodiscard]]
+		auto rbegin() const noexcept
+		{
+			return m_runners.rbegin();
+		}
+
+		[[nodiscard]]
+		auto rend() noexcept
+		{
+			return m_runners.rend();
+		}
+
+		[[nodiscard]]
+		auto rend() const noexcept
+		{
+			return m_runners.rend();
+		}
+
+		[[nodiscard]]
+		auto crbegin() const noexcept
+		{
+			return m_runners.crbegin();
+		}
+
+		[[nodiscard]]
+		auto crend() const noexcept
+		{
+			return m_runners.crend();
+		}
+
+		[[nodiscard]]
+		ScopedTaskRunner& operator[](size_t index)
+		{
+			return m_runners[index];
+		}
+
+		[[nodiscard]]
+		const ScopedTaskRunner& operator[](size_t index) const
+		{
+			return m_runners[index];
+		}
+
+		[[nodiscard]]
+		ScopedTaskRunner& at(size_t index)
+		{
+			return m_runners.at(index);
+		}
+
+		[[nodiscard]]
+		const ScopedTaskRunner& at(size_t index) const
+		{
+			return m_runners.at(index);
+		}
+
+		void removeDone()
+		{
+			m_runners.remove_if([](const ScopedTaskRunner& runner) { return runner.done(); });
+		}
+
+		bool requestCancelAll()
+		{
+			bool anyCanceled = false;
+			for (ScopedTaskRunner& runner : m_runners)
+			{
+				if (runner.requestCancel())
+				{
+					anyCanceled = true;
+				}
+			}
+			return anyCanceled;
+		}
+
+		[[nodiscard]]
+		bool allDone() const
+		{
+			return std::all_of(m_runners.begin(), m_runners.end(), [](const ScopedTaskRunner& runner) { return runner.done(); });
+		}
+
+		[[nodiscard]]
+		bool anyDone() const
+		{
+			return std::any_of(m_runners.begin(), m_runners.end(), [](const ScopedTaskRunner& runner) { return runner.done(); });
+		}
+
+		[[nodiscard]]
+		Task<void> waitUntilAllDone() const&;
+
+		[[nodiscard]]
+		Task<void> waitUntilAllDone() const&& = delete;
+
+		[[nodiscard]]
+		Task<void> waitUntilAnyDone() const&;
+
+		[[nodiscard]]
+		Task<void> waitUntilAnyDone() const&& = delete;
+	};
+
+	inline void ScopedTaskRunner::addTo(MultiRunner& mr)&&
+	{
+		mr.add(std::move(*this));
+	}
 
-						if (finishCallback)
-						{
-							finishCallback();
-						}
-					}
-					else
-					{
-						auto result = [&]() -> TResult
-							{
-								try
-								{
-									return awaiter.value();
-								}
-								catch (...)
-								{
-									if (cancelCallback)
-									{
-										cancelCallback();
-									}
-									throw;
-								}
-							}();
-						if (finishCallback)
-						{
-							finishCallback(std::move(result));
-						}
-					}
-				};
+	namespace DrawIndex
+	{
+		constexpr int32 Back = -1;
+		constexpr int32 Default = 0;
+		constexpr int32 Front = 1;
+	}
 
-			// フレーム待ちなしで終了した場合は登録不要
-			// (ここで一度resumeするのは、runScoped実行まで開始を遅延させるためにinitial_suspendをsuspend_alwaysにしているため)
-			if (awaiter.done())
+	class ScopedDrawer
+	{
+	private:
+		class Drawer : public detail::IDrawerInternal
+		{
+		private:
+			std::function<void()> m_func;
+
+			void drawInternal() const override
 			{
-				fnCallFinishCallback();
-				return none;
+				m_func();
 			}
-			awaiter.resume();
-			if (awaiter.done())
+
+		public:
+			explicit Drawer(std::function<void()> func)
+				: m_func(std::move(func))
 			{
-				fnCallFinishCallback();
-				return none;
 			}
 
-			return Backend::Add(std::make_unique<TaskAwaiter<TResult>>(std::move(awaiter)), std::move(finishCallback), std::move(cancelCallback));
+			Drawer(const Drawer&) = delete;
+			Drawer& operator=(const Drawer&) = delete;
+			Drawer(Drawer&&) = default;
+			Drawer& operator=(Drawer&&) = delete;
+		};
+
+		Drawer m_drawer;
+		std::weak_ptr<detail::Backend> m_backend;
+		Optional<detail::DrawerID> m_drawerID;
+
+	public:
+		ScopedDrawer(std::function<void()> func, Layer layer = Layer::Default, int32 drawIndex = DrawIndex::Default)
+			: m_drawer(std::move(func))
+			, m_backend(detail::Backend::Current())
+			, m_drawerID(detail::Backend::AddDrawer(&m_drawer, layer, drawIndex))
+		{
+		}
+
+		ScopedDrawer(const ScopedDrawer&) = delete;
+
+		ScopedDrawer& operator=(const ScopedDrawer&) = delete;
+
+		ScopedDrawer(ScopedDrawer&& rhs) noexcept
+			: m_drawer(std::move(rhs.m_drawer))
+			, m_backend(std::move(rhs.m_backend))
+			, m_drawerID(rhs.m_drawerID)
+		{
+			rhs.m_drawerID.reset();
+		}
+
+		ScopedDrawer& operator=(ScopedDrawer&& rhs) = delete;
+
+		~ScopedDrawer()
+		{
+			if (m_drawerID.has_value())
+			{
+				detail::Backend::RemoveDrawer(m_backend, *m_drawerID);
+			}
+		}
+
+		void setLayer(Layer layer)
+		{
+			if (m_drawerID.has_value())
+			{
+				detail::Backend::SetDrawerLayer(m_backend, *m_drawerID, layer);
+			}
+		}
+
+		void setDrawIndex(int32 drawIndex)
+		{
+			if (m_drawerID.has_value())
+			{
+				detail::Backend::SetDrawerDrawIndex(m_backend, *m_drawerID, drawIndex);
+			}
 		}
+	};
+
+	namespace detail
+	{
+		class ScopedDrawerInternal
+		{
+		private:
+			std::weak_ptr<Backend> m_backend;
+			DrawerID m_drawerID;
+			ScopedDrawerInternal** m_pThis;
+
+		public:
+			ScopedDrawerInternal(IDrawerInternal* pDrawer, Layer layer, int32 drawIndex, ScopedDrawerInternal** pThis)
+				: m_backend(Backend::Current())
+				, m_drawerID(Backend::AddDrawer(pDrawer, layer, drawIndex))
+				, m_pThis(pThis)
+			{
+				*m_pThis = this;
+			}
+
+			ScopedDrawerInternal(const ScopedDrawerInternal&) = delete;
+
+			ScopedDrawerInternal& operator=(const ScopedDrawerInternal&) = delete;
+
+			ScopedDrawerInternal(ScopedDrawerInternal&& rhs) = delete;
+
+			ScopedDrawerInternal& operator=(ScopedDrawerInternal&& rhs) = delete;
+
+			~ScopedDrawerInternal()
+			{
+				Backend::RemoveDrawer(m_backend, m_drawerID);
+				*m_pThis = nullptr;
+			}
+
+			void setLayer(Layer layer)
+			{
+				Backend::SetDrawerLayer(m_backend, m_drawerID, layer);
+			}
+
+			void setDrawIndex(int32 drawIndex)
+			{
+				Backend::SetDrawerDrawIndex(m_backend, m_drawerID, drawIndex);
+			}
+		};
 
 		template <typename TResult>
-		Optional<AwaiterID> ResumeAwaiterOnceAndRegisterIfNotDone(const TaskAwaiter<TResult>& awaiter) = delete;
+		class Promise;
 	}
 
-	[[nodiscard]]
-	inline auto NextFrame() noexcept
+	// コルーチンフレームのメモリ確保に関する統計
+	// (生存中のフレーム数・バイト数は全スレッドの合計、それ以外は呼び出したスレッドでの値)
+	struct FrameAllocatorStats
 	{
-		return std::suspend_always{};
-	}
+		// 生存中のフレーム数
+		std::size_t liveFrames = 0;
 
-	class MultiRunner;
+		// 生存中のフレームのバイト数(フレームのヘッダは含まない)
+		std::size_t liveBytes = 0;
 
-	class ScopedTaskRunner
+		// 再利用のためにフリーリストに保持しているバイト数
+		std::size_t cachedBytes = 0;
+
+		// フリーリストまたはフレームアリーナの確保済み領域から確保できた回数
+		uint64 hits = 0;
+
+		// ヒープから新たに確保した回数
+		uint64 misses = 0;
+	};
+
+	class FrameArena;
+
+	namespace detail
+	{
+		struct FrameArenaChunk
+		{
+			// 所属するアリーナ(アリーナが先に破棄された場合はnullptr)
+			FrameArena* pArena;
+
+			std::unique_ptr<std::byte[]> buffer;
+			std::size_t capacity;
+			std::size_t used = 0;
+			std::size_t numLiveFrames = 0;
+		};
+
+		// コルーチンフレームの直前に置くヘッダ
+		struct FrameAllocatorFrameHeader
+		{
+			// フレームを確保したチャンク(フリーリストまたはヒープから確保した場合はnullptr)
+			FrameArenaChunk* pChunk;
+		};
+
+		struct FrameAllocatorFreeBlock
+		{
+			FrameAllocatorFreeBlock* pNext;
+		};
+
+		// スレッドごとの生存中のフレーム数・バイト数
+		// (フレームは確保したスレッドとは別のスレッドで解放されうるため、各スレッドの値は確保と解放の差分とし、全スレッドの合計のみを統計として返す)
+		// (合計時に他のスレッドから読み取るためアトミック変数とするが、書き込むのは所有スレッドのみのため読み書きに排他は不要)
+		struct FrameAllocatorLiveCounters
+		{
+			enum class RegisterState : uint8
+			{
+				Unregistered,
+				Registered,
+				Exited, // スレッド終了時に登録を解除済み
+			};
+
+			std::atomic<std::size_t> liveFrames = 0;
+			std::atomic<std::size_t> liveBytes = 0;
+			RegisterState registerState = RegisterState::Unregistered;
+
+			// 登録中の全スレッドの連結リスト
+			FrameAllocatorLiveCounters* pPrev = nullptr;
+			FrameAllocatorLiveCounters* pNext = nullptr;
+
+			// 所有スレッドから呼び出す
+			void add(std::size_t numFrames, std::size_t numBytes) noexcept
+			{
+				liveFrames.store(liveFrames.load(std::memory_order_relaxed) + numFrames, std::memory_order_relaxed);
+				liveBytes.store(liveBytes.load(std::memory_order_relaxed) + numBytes, std::memory_order_relaxed);
+			}
+		};
+
+		// Note: スレッド終了時の破棄順に依存しないよう、トリビアルに破棄できる型にしている(フリーリストの領域はスレッド終了時に解放されない)
+		template <std::size_t NumSizeClasses>
+		struct FrameAllocatorThreadState
+		{
+			std::array<FrameAllocatorFreeBlock*, NumSizeClasses> freeLists{};
+			std::array<std::size_t, NumSizeClasses> numCachedBlocks{};
+			FrameAllocatorStats stats;
+			FrameAllocatorLiveCounters liveCounters;
+			FrameArena* pCurrentArena = nullptr;
+			FrameArenaChunk* pLastAllocatedChunk = nullptr;
+
+			// スレッド終了時にフリーリストを解放済みの場合、以降に解放されたブロックはフリーリストに戻さない
+			bool freeListsReleased = false;
+		};
+
+		class FrameAllocator;
+	}
+
+	// コルーチンフレームをまとめて確保するアリーナ
+	// (ScopedFrameArenaで有効にしている間に生成したタスクと、その実行中に生成された子孫のタスクのフレームはアリーナから確保される)
+	// (チャンク内のフレームがすべて解放されるとチャンクは再利用される。アリーナの破棄後もフレームが残っている場合、チャンクは最後のフレームの解放時に解放される)
+	// (アリーナから確保したフレームは、アリーナを生成したスレッドで解放する必要がある)
+	class FrameArena
 	{
+	public:
+		static constexpr std::size_t DefaultChunkSize = 64 * 1024;
+
 	private:
-		Optional<detail::AwaiterID> m_id;
+		friend class detail::FrameAllocator;
+
+		std::size_t m_chunkSize;
+		Array<detail::FrameArenaChunk*> m_chunks;
+		detail::FrameArenaChunk* m_pCurrentChunk = nullptr;
+
+		// blockSizeの領域を確保できるチャンクを返す(チャンクに収まらない大きさの場合はnullptr)
+		[[nodiscard]]
+		detail::FrameArenaChunk* chunkForBlock(std::size_t blockSize, FrameAllocatorStats& stats);
 
 	public:
-		template <typename TResult>
-		explicit ScopedTaskRunner(Task<TResult>&& task, FinishCallbackType<TResult> finishCallback = nullptr, std::function<void()> cancelCallback = nullptr)
-			: m_id(ResumeAwaiterOnceAndRegisterIfNotDone(detail::TaskAwaiter<TResult>{ std::move(task) }, std::move(finishCallback), std::move(cancelCallback)))
+		explicit FrameArena(std::size_t chunkSize = DefaultChunkSize)
+			: m_chunkSize(chunkSize)
 		{
 		}
 
-		ScopedTaskRunner(const ScopedTaskRunner&) = delete;
+		FrameArena(const FrameArena&) = delete;
 
-		ScopedTaskRunner& operator=(const ScopedTaskRunner&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
 
-		ScopedTaskRunner(ScopedTaskRunner&& rhs) noexcept
-			: m_id(rhs.m_id)
+		FrameArena(FrameArena&&) = delete;
+
+		FrameArena& operator=(FrameArena&&) = delete;
+
+		~FrameArena();
+
+		[[nodiscard]]
+		std::size_t numChunks() const noexcept
 		{
-			rhs.m_id.reset();
+			return m_chunks.size();
 		}
 
-		ScopedTaskRunner& operator=(ScopedTaskRunner&& rhs)
+		// アリーナから確保された生存中のフレーム数
+		[[nodiscard]]
+		std::size_t numLiveFrames() const noexcept
 		{
-			if (m_id.has_value())
+			std::size_t numLiveFrames = 0;
+			for (const detail::FrameArenaChunk* pChunk : m_chunks)
 			{
-				detail::Backend::Remove(*m_id);
+				numLiveFrames += pChunk->numLiveFrames;
 			}
-			m_id = rhs.m_id;
-			rhs.m_id.reset();
-			return *this;
+			return numLiveFrames;
 		}
+	};
 
-		~ScopedTaskRunner()
+	namespace detail
+	{
+		// コルーチンフレームのメモリ確保
+		// (サイズクラスごとのフリーリストで解放済みの領域を再利用し、フレームアリーナが有効な場合はアリーナから確保する)
+		// (フリーリストはスレッドごとに持つため、別スレッドで解放された領域はそのスレッドのフリーリストに入る)
+		// (フレームの直前に確保元のチャンクを記録したヘッダを置き、解放時にチャンクを探索せずに返却先を判定する)
+		class FrameAllocator
 		{
-			if (m_id.has_value())
+		public:
+			static constexpr std::size_t SizeClassGranularity = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+			// フレームのアラインメントを保つため、ヘッダはアラインメント単位の大きさで確保する
+			static constexpr std::size_t FrameHeaderSize = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+			static_assert(sizeof(FrameAllocatorFrameHeader) <= FrameHeaderSize);
+
+			static constexpr std::size_t NumSizeClasses = 64;
+
+			// サイズクラスごとにフリーリストに保持する領域の上限数(超えた分はヒープに返す)
+			static constexpr std::size_t MaxCachedBlocksPerSizeClass = 4096;
+
+		private:
+			using FreeBlock = FrameAllocatorFreeBlock;
+
+			static inline thread_local FrameAllocatorThreadState<NumSizeClasses> s_state;
+
+			// 生存中のフレーム数・バイト数の集計用(スレッドの登録・登録解除と、統計の取得時のみロックする)
+			static inline std::mutex s_liveCountersMutex;
+
+			static inline FrameAllocatorLiveCounters* s_pRegisteredLiveCounters = nullptr;
+
+			// 終了したスレッドの生存中のフレーム数・バイト数の差分
+			static inline std::size_t s_exitedLiveFrames = 0;
+
+			static inline std::size_t s_exitedLiveBytes = 0;
+
+			// スレッド終了時に、フリーリストに保持しているブロックを解放する
+			// (Co::Schedulerをワーカースレッドで使用する場合に、終了したスレッドのブロックが残り続けないようにする)
+			// (Note: s_stateはトリビアルに破棄されるため、これより後に破棄されるオブジェクトからも参照できる)
+			struct ThreadExitCleanup
+			{
+				~ThreadExitCleanup()
+				{
+					auto& state = s_state;
+					for (std::size_t sizeClass = 0; sizeClass < NumSizeClasses; ++sizeClass)
+					{
+						while (FreeBlock* pFreeBlock = PopFreeBlock(sizeClass))
+						{
+							::operator delete(pFreeBlock);
+						}
+					}
+					state.freeListsReleased = true;
+
+					UnregisterLiveCounters(state.liveCounters);
+				}
+			};
+
+			static inline thread_local ThreadExitCleanup s_threadExitCleanup;
+
+			// 初回のフレームの確保・解放時に、統計の集計対象として登録する
+			static void RegisterLiveCounters(FrameAllocatorLiveCounters& liveCounters) noexcept
 			{
-				detail::Backend::Remove(*m_id);
+				// スレッド終了時の登録解除を登録する
+				static_cast<void>(&s_threadExitCleanup);
+
+				const std::lock_guard lock{ s_liveCountersMutex };
+				liveCounters.pNext = s_pRegisteredLiveCounters;
+				if (liveCounters.pNext)
+				{
+					liveCounters.pNext->pPrev = &liveCounters;
+				}
+				s_pRegisteredLiveCounters = &liveCounters;
+				liveCounters.registerState = FrameAllocatorLiveCounters::RegisterState::Registered;
 			}
-		}
 
-		[[nodiscard]]
-		bool done() const
-		{
-			return !m_id.has_value() || detail::Backend::IsDone(*m_id);
-		}
+			static void UnregisterLiveCounters(FrameAllocatorLiveCounters& liveCounters) noexcept
+			{
+				if (liveCounters.registerState != FrameAllocatorLiveCounters::RegisterState::Registered)
+				{
+					return;
+				}
+				const std::lock_guard lock{ s_liveCountersMutex };
+				if (liveCounters.pPrev)
+				{
+					liveCounters.pPrev->pNext = liveCounters.pNext;
+				}
+				else
+				{
+					s_pRegisteredLiveCounters = liveCounters.pNext;
+				}
+				if (liveCounters.pNext)
+				{
+					liveCounters.pNext->pPrev = liveCounters.pPrev;
+				}
+				s_exitedLiveFrames += liveCounters.liveFrames.load(std::memory_order_relaxed);
+				s_exitedLiveBytes += liveCounters.liveBytes.load(std::memory_order_relaxed);
+				liveCounters.registerState = FrameAllocatorLiveCounters::RegisterState::Exited;
+			}
 
-		void forget()
-		{
-			m_id.reset();
-		}
+			// 生存中のフレーム数・バイト数を加算する(減算時は符号なし整数の桁あふれにより差分を表す)
+			static void AddLiveCounters(std::size_t numFrames, std::size_t numBytes) noexcept
+			{
+				auto& liveCounters = s_state.liveCounters;
+				if (liveCounters.registerState != FrameAllocatorLiveCounters::RegisterState::Registered) [[unlikely]]
+				{
+					AddLiveCountersSlow(liveCounters, numFrames, numBytes);
+					return;
+				}
+				liveCounters.add(numFrames, numBytes);
+			}
+
+			static void AddLiveCountersSlow(FrameAllocatorLiveCounters& liveCounters, std::size_t numFrames, std::size_t numBytes) noexcept
+			{
+				if (liveCounters.registerState == FrameAllocatorLiveCounters::RegisterState::Exited)
+				{
+					// スレッドの終了処理中に解放された場合
+					const std::lock_guard lock{ s_liveCountersMutex };
+					s_exitedLiveFrames += numFrames;
+					s_exitedLiveBytes += numBytes;
+					return;
+				}
+				RegisterLiveCounters(liveCounters);
+				liveCounters.add(numFrames, numBytes);
+			}
+
+			[[nodiscard]]
+			static constexpr std::size_t SizeClassOf(std::size_t size) noexcept
+			{
+				return (size + SizeClassGranularity - 1) / SizeClassGranularity - 1;
+			}
+
+			[[nodiscard]]
+			static constexpr std::size_t BlockSizeOf(std::size_t sizeClass) noexcept
+			{
+				return (sizeClass + 1) * SizeClassGranularity;
+			}
 
-		bool requestCancel()
-		{
-			if (m_id.has_value())
+			[[nodiscard]]
+			static void* AllocateFromArena(FrameArena& arena, std::size_t size)
 			{
-				const bool removed = detail::Backend::Remove(*m_id);
-				m_id.reset();
-				return removed;
+				// 後続のフレームのアラインメントを保つため、切り上げて確保する
+				const std::size_t blockSize = BlockSizeOf(SizeClassOf(size));
+				FrameArenaChunk* pChunk = arena.chunkForBlock(blockSize, s_state.stats);
+				if (!pChunk)
+				{
+					return nullptr;
+				}
+				std::byte* pBlock = pChunk->buffer.get() + pChunk->used;
+				pChunk->used += blockSize;
+				++pChunk->numLiveFrames;
+				s_state.pLastAllocatedChunk = pChunk;
+				return pBlock;
 			}
-			return false;
-		}
 
-		void addTo(MultiRunner& mr)&&;
+			[[nodiscard]]
+			static FreeBlock* PopFreeBlock(std::size_t sizeClass) noexcept
+			{
+				auto& state = s_state;
+				FreeBlock* pFreeBlock = state.freeLists[sizeClass];
+				if (pFreeBlock)
+				{
+					state.freeLists[sizeClass] = pFreeBlock->pNext;
+					--state.numCachedBlocks[sizeClass];
+					state.stats.cachedBytes -= BlockSizeOf(sizeClass);
+				}
+				return pFreeBlock;
+			}
 
-		[[nodiscard]]
-		Task<void> waitUntilDone() const&;
+			[[nodiscard]]
+			static void* AllocateFromPool(std::size_t size)
+			{
+				auto& state = s_state;
+				state.pLastAllocatedChunk = nullptr;
 
-		[[nodiscard]]
-		Task<void> waitUntilDone() const&& = delete;
-	};
+				const std::size_t sizeClass = SizeClassOf(size);
+				if (sizeClass >= NumSizeClasses)
+				{
+					++state.stats.misses;
+					return ::operator new(size);
+				}
+				if (FreeBlock* pFreeBlock = PopFreeBlock(sizeClass))
+				{
+					++state.stats.hits;
+					return pFreeBlock;
+				}
+				++state.stats.misses;
+				return ::operator new(BlockSizeOf(sizeClass));
+			}
 
-	class MultiRunner
-	{
-	private:
-		Array<ScopedTaskRunner> m_runners;
+			static void DeallocateToPool(void* pFrame, std::size_t size) noexcept
+			{
+				auto& state = s_state;
+				const std::size_t sizeClass = SizeClassOf(size);
+				if (sizeClass >= NumSizeClasses || state.numCachedBlocks[sizeClass] >= MaxCachedBlocksPerSizeClass || state.freeListsReleased)
+				{
+					::operator delete(pFrame);
+					return;
+				}
 
-	public:
-		MultiRunner() = default;
+				// スレッド終了時の解放を登録する
+				static_cast<void>(&s_threadExitCleanup);
 
-		MultiRunner(const MultiRunner&) = delete;
+				auto* pFreeBlock = static_cast<FreeBlock*>(pFrame);
+				pFreeBlock->pNext = state.freeLists[sizeClass];
+				state.freeLists[sizeClass] = pFreeBlock;
+				++state.numCachedBlocks[sizeClass];
+				state.stats.cachedBytes += BlockSizeOf(sizeClass);
+			}
 
-		MultiRunner& operator=(const MultiRunner&) = delete;
+		public:
+			[[nodiscard]]
+			static void* Allocate(std::size_t size)
+			{
+				auto& state = s_state;
+				const std::size_t blockSize = FrameHeaderSize + size;
+				void* pBlock = nullptr;
+				if (state.pCurrentArena)
+				{
+					pBlock = AllocateFromArena(*state.pCurrentArena, blockSize);
+				}
+				if (!pBlock)
+				{
+					pBlock = AllocateFromPool(blockSize);
+				}
+				new (pBlock) FrameAllocatorFrameHeader{ .pChunk = state.pLastAllocatedChunk };
+				AddLiveCounters(1, size);
+				return static_cast<std::byte*>(pBlock) + FrameHeaderSize;
+			}
 
-		MultiRunner(MultiRunner&&) = default;
+			static void Deallocate(void* pFrame, std::size_t size) noexcept
+			{
+				AddLiveCounters(static_cast<std::size_t>(-1), static_cast<std::size_t>(0) - size);
 
-		MultiRunner& operator=(MultiRunner&&) = default;
+				void* pBlock = static_cast<std::byte*>(pFrame) - FrameHeaderSize;
+				if (FrameArenaChunk* pChunk = static_cast<FrameAllocatorFrameHeader*>(pBlock)->pChunk)
+				{
+					if (--pChunk->numLiveFrames == 0 && !pChunk->pArena)
+					{
+						// アリーナが破棄済みのチャンク
+						DestroyArenaChunk(pChunk);
+					}
+					return;
+				}
+				DeallocateToPool(pBlock, FrameHeaderSize + size);
+			}
 
-		~MultiRunner() = default;
+			// コルーチンフレーム以外の小さなオブジェクトのメモリ確保
+			// (フレームアリーナは使用せず、フリーリストのみ使用する。フレームの統計には含めない)
+			[[nodiscard]]
+			static void* AllocateObject(std::size_t size)
+			{
+				const std::size_t sizeClass = SizeClassOf(size);
+				if (sizeClass >= NumSizeClasses)
+				{
+					return ::operator new(size);
+				}
+				if (FreeBlock* pFreeBlock = PopFreeBlock(sizeClass))
+				{
+					return pFreeBlock;
+				}
+				return ::operator new(BlockSizeOf(sizeClass));
+			}
 
-		void add(ScopedTaskRunner&& runner)
-		{
-			m_runners.push_back(std::move(runner));
-		}
+			static void DeallocateObject(void* p, std::size_t size) noexcept
+			{
+				DeallocateToPool(p, size);
+			}
 
-		void reserve(std::size_t size)
-		{
-			m_runners.reserve(size);
-		}
+			[[nodiscard]]
+			static FrameArenaChunk* CreateArenaChunk(FrameArena* pArena, std::size_t capacity)
+			{
+				return new FrameArenaChunk{ .pArena = pArena, .buffer = std::make_unique<std::byte[]>(capacity), .capacity = capacity };
+			}
 
-		void clear()
-		{
-			m_runners.clear();
-		}
+			static void DestroyArenaChunk(FrameArenaChunk* pChunk) noexcept
+			{
+				delete pChunk;
+			}
 
-		[[nodiscard]]
-		size_t size() const noexcept
-		{
-			return m_runners.size();
-		}
+			// 直前にAllocateで確保したフレームのチャンク(Promiseのコンストラクタで記録するために使用)
+			[[nodiscard]]
+			static FrameArenaChunk* LastAllocatedChunk() noexcept
+			{
+				return s_state.pLastAllocatedChunk;
+			}
 
-		[[nodiscard]]
-		bool empty() const noexcept
-		{
-			return m_runners.empty();
-		}
+			[[nodiscard]]
+			static FrameArena* CurrentArena() noexcept
+			{
+				return s_state.pCurrentArena;
+			}
 
-		void shrinkToFit()
-		{
-			m_runners.shrink_to_fit();
-		}
+			static FrameArena* ExchangeCurrentArena(FrameArena* pArena) noexcept
+			{
+				return std::exchange(s_state.pCurrentArena, pArena);
+			}
 
-		[[nodiscard]]
-		auto begin() noexcept
-		{
-			return m_runners.begin();
-		}
+			// 生存中のフレーム数・バイト数は全スレッドの合計、それ以外は現在のスレッドの値を返す
+			[[nodiscard]]
+			static FrameAllocatorStats Stats()
+			{
+				FrameAllocatorStats stats = s_state.stats;
+				const std::lock_guard lock{ s_liveCountersMutex };
+				stats.liveFrames = s_exitedLiveFrames;
+				stats.liveBytes = s_exitedLiveBytes;
+				for (const FrameAllocatorLiveCounters* pLiveCounters = s_pRegisteredLiveCounters; pLiveCounters; pLiveCounters = pLiveCounters->pNext)
+				{
+					stats.liveFrames += pLiveCounters->liveFrames.load(std::memory_order_relaxed);
+					stats.liveBytes += pLiveCounters->liveBytes.load(std::memory_order_relaxed);
+				}
+				return stats;
+			}
+		};
 
-		[[nodiscard]]
-		auto begin() const noexcept
+		// フレームアリーナから確保されたタスクのresume中に、同じアリーナを有効にする
+		// (タスクの実行中に生成される子孫のタスクのフレームも同じアリーナから確保するため)
+		class FrameArenaResumeScope
 		{
-			return m_runners.begin();
-		}
+		private:
+			FrameArena* m_pPrevArena;
+			bool m_isChanged;
 
-		[[nodiscard]]
-		auto end() noexcept
-		{
-			return m_runners.end();
-		}
+		public:
+			explicit FrameArenaResumeScope(const FrameArenaChunk* pChunk) noexcept
+			{
+				FrameArena* pArena = pChunk ? pChunk->pArena : nullptr;
+				m_pPrevArena = FrameAllocator::CurrentArena();
+				m_isChanged = pArena != m_pPrevArena;
+				if (m_isChanged)
+				{
+					FrameAllocator::ExchangeCurrentArena(pArena);
+				}
+			}
 
-		[[nodiscard]]
-		auto end() const noexcept
-		{
-			return m_runners.end();
-		}
+			FrameArenaResumeScope(const FrameArenaResumeScope&) = delete;
 
-		[[nodiscard]]
-		auto cbegin() const noexcept
-		{
-			return m_runners.cbegin();
-		}
+			FrameArenaResumeScope& operator=(const FrameArenaResumeScope&) = delete;
 
-		[[nodiscard]]
-		auto cend() const noexcept
-		{
-			return m_runners.cend();
-		}
+			~FrameArenaResumeScope() noexcept
+			{
+				if (m_isChanged)
+				{
+					FrameAllocator::ExchangeCurrentArena(m_pPrevArena);
+				}
+			}
+		};
+	}
 
-		[[nodiscard]]
-		auto rbegin() noexcept
+	inline detail::FrameArenaChunk* FrameArena::chunkForBlock(std::size_t blockSize, FrameAllocatorStats& stats)
+	{
+		if (blockSize > m_chunkSize)
 		{
-			return m_runners.rbegin();
+			return nullptr;
 		}
-
-		[[nodiscard]]
-		auto rbegin() const noexcept
+		if (m_pCurrentChunk && m_pCurrentChunk->used + blockSize <= m_pCurrentChunk->capacity)
 		{
-			return m_runners.rbegin();
+			++stats.hits;
+			return m_pCurrentChunk;
 		}
 
-		[[nodiscard]]
-		auto rend() noexcept
+		// 全フレームが解放済みのチャンクがあれば再利用する
+		const auto it = std::find_if(m_chunks.begin(), m_chunks.end(), [](const detail::FrameArenaChunk* pChunk) { return pChunk->numLiveFrames == 0; });
+		if (it != m_chunks.end())
 		{
-			return m_runners.rend();
+			++stats.hits;
+			m_pCurrentChunk = *it;
+			m_pCurrentChunk->used = 0;
+			return m_pCurrentChunk;
 		}
 
-		[[nodiscard]]
-		auto rend() const noexcept
-		{
-			return m_runners.rend();
-		}
+		++stats.misses;
+		m_pCurrentChunk = detail::FrameAllocator::CreateArenaChunk(this, m_chunkSize);
+		m_chunks.push_back(m_pCurrentChunk);
+		return m_pCurrentChunk;
+	}
 
-		[[nodiscard]]
-		auto crbegin() const noexcept
+	inline FrameArena::~FrameArena()
+	{
+		for (detail::FrameArenaChunk* pChunk : m_chunks)
 		{
-			return m_runners.crbegin();
+			if (pChunk->numLiveFrames == 0)
+			{
+				detail::FrameAllocator::DestroyArenaChunk(pChunk);
+			}
+			else
+			{
+				// 生存中のフレームがあるチャンクは切り離し、最後のフレームの解放時に解放する
+				pChunk->pArena = nullptr;
+			}
 		}
+	}
 
-		[[nodiscard]]
-		auto crend() const noexcept
+	namespace detail
+	{
+		template <typename TResult>
+		void* EntryAwaiter<TResult>::operator new(std::size_t size)
 		{
-			return m_runners.crend();
+			return FrameAllocator::AllocateObject(size);
 		}
 
-		[[nodiscard]]
-		ScopedTaskRunner& operator[](size_t index)
+		template <typename TResult>
+		void EntryAwaiter<TResult>::operator delete(void* p, std::size_t size) noexcept
 		{
-			return m_runners[index];
+			FrameAllocator::DeallocateObject(p, size);
 		}
+	}
 
-		[[nodiscard]]
-		const ScopedTaskRunner& operator[](size_t index) const
-		{
-			return m_runners[index];
-		}
+	// スコープ内で生成したタスクのフレームを、指定したフレームアリーナから確保する
+	class ScopedFrameArena
+	{
+	private:
+		FrameArena* m_pPrevArena;
 
-		[[nodiscard]]
-		ScopedTaskRunner& at(size_t index)
+	public:
+		explicit ScopedFrameArena(FrameArena& arena) noexcept
+			: m_pPrevArena(detail::FrameAllocator::ExchangeCurrentArena(&arena))
 		{
-			return m_runners.at(index);
 		}
 
-		[[nodiscard]]
-		const ScopedTaskRunner& at(size_t index) const
-		{
-			return m_runners.at(index);
-		}
+		ScopedFrameArena(const ScopedFrameArena&) = delete;
 
-		void removeDone()
-		{
-			m_runners.remove_if([](const ScopedTaskRunner& runner) { return runner.done(); });
-		}
+		ScopedFrameArena& operator=(const ScopedFrameArena&) = delete;
 
-		bool requestCancelAll()
-		{
-			bool anyCanceled = false;
-			for (ScopedTaskRunner& runner : m_runners)
-			{
-				if (runner.requestCancel())
-				{
-					anyCanceled = true;
-				}
-			}
-			return anyCanceled;
-		}
+		ScopedFrameArena(ScopedFrameArena&&) = delete;
 
-		[[nodiscard]]
-		bool allDone() const
-		{
-			return std::all_of(m_runners.begin(), m_runners.end(), [](const ScopedTaskRunner& runner) { return runner.done(); });
-		}
+		ScopedFrameArena& operator=(ScopedFrameArena&&) = delete;
 
-		[[nodiscard]]
-		bool anyDone() const
+		~ScopedFrameArena() noexcept
 		{
-			return std::any_of(m_runners.begin(), m_runners.end(), [](const ScopedTaskRunner& runner) { return runner.done(); });
+			detail::FrameAllocator::ExchangeCurrentArena(m_pPrevArena);
 		}
-
-		[[nodiscard]]
-		Task<void> waitUntilAllDone() const&;
-
-		[[nodiscard]]
-		Task<void> waitUntilAllDone() const&& = delete;
-
-		[[nodiscard]]
-		Task<void> waitUntilAnyDone() const&;
-
-		[[nodiscard]]
-		Task<void> waitUntilAnyDone() const&& = delete;
 	};
 
-	inline void ScopedTaskRunner::addTo(MultiRunner& mr)&&
+	[[nodiscard]]
+	inline FrameAllocatorStats GetFrameAllocatorStats()
 	{
-		mr.add(std::move(*this));
+		return detail::FrameAllocator::Stats();
 	}
 
-	namespace DrawIndex
+	enum class WithTiming : uint8
 	{
-		constexpr int32 Back = -1;
-		constexpr int32 Default = 0;
-		constexpr int32 Front = 1;
-	}
+		Before,
+		After,
+	};
 
-	class ScopedDrawer
+	namespace detail
 	{
-	private:
-		class Drawer : public detail::IDrawerInternal
+		class PromiseBase;
+
+		class ConcurrentTaskList;
+
+		// Task::withで追加された同時実行タスク
+		// (結果は使用しないため、コルーチンハンドルを型消去して保持する)
+		class ConcurrentTask
 		{
 		private:
-			std::function<void()> m_func;
-
-			void drawInternal() const override
-			{
-				m_func();
-			}
+			std::coroutine_handle<> m_handle;
+			PromiseBase* m_pPromise = nullptr;
+			std::unique_ptr<ConcurrentTaskList> m_concurrentTasks;
+			WithTiming m_timing = WithTiming::After;
 
 		public:
-			explicit Drawer(std::function<void()> func)
-				: m_func(std::move(func))
-			{
-			}
+			ConcurrentTask() = default;
 
-			Drawer(const Drawer&) = delete;
-			Drawer& operator=(const Drawer&) = delete;
-			Drawer(Drawer&&) = default;
-			Drawer& operator=(Drawer&&) = delete;
-		};
+			ConcurrentTask(std::coroutine_handle<> handle, PromiseBase* pPromise, std::unique_ptr<ConcurrentTaskList>&& concurrentTasks, WithTiming timing) noexcept;
 
-		Drawer m_drawer;
-		Optional<detail::DrawerID> m_drawerID;
+			ConcurrentTask(const ConcurrentTask&) = delete;
 
-	public:
-		ScopedDrawer(std::function<void()> func, Layer layer = Layer::Default, int32 drawIndex = DrawIndex::Default)
-			: m_drawer(std::move(func))
-			, m_drawerID(detail::Backend::AddDrawer(&m_drawer, layer, drawIndex))
-		{
-		}
+			ConcurrentTask& operator=(const ConcurrentTask&) = delete;
 
-		ScopedDrawer(const ScopedDrawer&) = delete;
+			ConcurrentTask(ConcurrentTask&& rhs) noexcept;
 
-		ScopedDrawer& operator=(const ScopedDrawer&) = delete;
+			ConcurrentTask& operator=(ConcurrentTask&& rhs) noexcept;
 
-		ScopedDrawer(ScopedDrawer&& rhs) noexcept
-			: m_drawer(std::move(rhs.m_drawer))
-			, m_drawerID(rhs.m_drawerID)
-		{
-			rhs.m_drawerID.reset();
-		}
+			~ConcurrentTask();
 
-		ScopedDrawer& operator=(ScopedDrawer&& rhs) = delete;
+			void resume();
 
-		~ScopedDrawer()
-		{
-			if (m_drawerID.has_value())
+			[[nodiscard]]
+			bool done() const noexcept
 			{
-				detail::Backend::RemoveDrawer(*m_drawerID);
+				return !m_handle || m_handle.done();
 			}
-		}
 
-		void setLayer(Layer layer)
-		{
-			if (m_drawerID.has_value())
+			[[nodiscard]]
+			WithTiming timing() const noexcept
 			{
-				detail::Backend::SetDrawerLayer(*m_drawerID, layer);
+				return m_timing;
 			}
-		}
+		};
 
-		void setDrawIndex(int32 drawIndex)
+		// 同時実行タスクの一覧
+		// (大半のタスクは同時実行タスクを持たないため、Task側では使用時のみ確保する)
+		// (1〜2個の場合はそのまま保持し、3個目以降のみ配列を使用する)
+		class ConcurrentTaskList
 		{
-			if (m_drawerID.has_value())
+		private:
+			static constexpr std::size_t NumInlineTasks = 2;
+
+			std::array<ConcurrentTask, NumInlineTasks> m_inlineTasks;
+			std::size_t m_numInlineTasks = 0;
+			Array<ConcurrentTask> m_overflowTasks;
+
+			template <typename Func>
+			void forEachTask(Func func)
 			{
-				detail::Backend::SetDrawerDrawIndex(*m_drawerID, drawIndex);
+				for (std::size_t i = 0; i < m_numInlineTasks; ++i)
+				{
+					func(m_inlineTasks[i]);
+				}
+				for (auto& task : m_overflowTasks)
+				{
+					func(task);
+				}
 			}
-		}
-	};
-
-	namespace detail
-	{
-		class ScopedDrawerInternal
-		{
-		private:
-			DrawerID m_drawerID;
-			ScopedDrawerInternal** m_pThis;
 
-		public:
-			ScopedDrawerInternal(IDrawerInternal* pDrawer, Layer layer, int32 drawIndex, ScopedDrawerInternal** pThis)
-				: m_drawerID(Backend::AddDrawer(pDrawer, layer, drawIndex))
-				, m_pThis(pThis)
+			void resumeTasks(WithTiming timing)
 			{
-				*m_pThis = this;
+				forEachTask([timing](ConcurrentTask& task)
+					{
+						if (task.timing() == timing)
+						{
+							task.resume();
+						}
+					});
 			}
 
-			ScopedDrawerInternal(const ScopedDrawerInternal&) = delete;
+			[[nodiscard]]
+			bool hasRunningTasks()
+			{
+				bool isRunning = false;
+				forEachTask([&isRunning](const ConcurrentTask& task) { isRunning = isRunning || !task.done(); });
+				return isRunning;
+			}
 
-			ScopedDrawerInternal& operator=(const ScopedDrawerInternal&) = delete;
+		public:
+			ConcurrentTaskList() = default;
 
-			ScopedDrawerInternal(ScopedDrawerInternal&& rhs) = delete;
+			ConcurrentTaskList(const ConcurrentTaskList&) = delete;
 
-			ScopedDrawerInternal& operator=(ScopedDrawerInternal&& rhs) = delete;
+			ConcurrentTaskList& operator=(const ConcurrentTaskList&) = delete;
 
-			~ScopedDrawerInternal()
+			[[nodiscard]]
+			static void* operator new(std::size_t size)
 			{
-				Backend::RemoveDrawer(m_drawerID);
-				*m_pThis = nullptr;
+				return FrameAllocator::AllocateObject(size);
 			}
 
-			void setLayer(Layer layer)
+			static void operator delete(void* p, std::size_t size) noexcept
 			{
-				Backend::SetDrawerLayer(m_drawerID, layer);
+				FrameAllocator::DeallocateObject(p, size);
 			}
 
-			void setDrawIndex(int32 drawIndex)
+			void add(ConcurrentTask&& task)
 			{
-				Backend::SetDrawerDrawIndex(m_drawerID, drawIndex);
+				if (m_numInlineTasks < NumInlineTasks)
+				{
+					m_inlineTasks[m_numInlineTasks++] = std::move(task);
+				}
+				else
+				{
+					m_overflowTasks.push_back(std::move(task));
+				}
 			}
+
+			// 同時実行タスクとともに本体のタスクをresumeする
+			void resumeWith(PromiseBase& promise);
 		};
 
-		template <typename TResult>
-		class Promise;
-	}
+		inline ConcurrentTask::ConcurrentTask(std::coroutine_handle<> handle, PromiseBase* pPromise, std::unique_ptr<ConcurrentTaskList>&& concurrentTasks, WithTiming timing) noexcept
+			: m_handle(handle)
+			, m_pPromise(pPromise)
+			, m_concurrentTasks(std::move(concurrentTasks))
+			, m_timing(timing)
+		{
+		}
 
-	enum class WithTiming : uint8
-	{
-		Before,
-		After,
-	};
+		inline ConcurrentTask::ConcurrentTask(ConcurrentTask&& rhs) noexcept
+			: m_handle(std::exchange(rhs.m_handle, nullptr))
+			, m_pPromise(rhs.m_pPromise)
+			, m_concurrentTasks(std::move(rhs.m_concurrentTasks))
+			, m_timing(rhs.m_timing)
+		{
+		}
+
+		inline ConcurrentTask& ConcurrentTask::operator=(ConcurrentTask&& rhs) noexcept
+		{
+			if (this != &rhs)
+			{
+				if (m_handle)
+				{
+					m_handle.destroy();
+				}
+				m_handle = std::exchange(rhs.m_handle, nullptr);
+				m_pPromise = rhs.m_pPromise;
+				m_concurrentTasks = std::move(rhs.m_concurrentTasks);
+				m_timing = rhs.m_timing;
+			}
+			return *this;
+		}
+
+		inline ConcurrentTask::~ConcurrentTask()
+		{
+			if (m_handle)
+			{
+				m_handle.destroy();
+			}
+		}
+	}
 
 	class [[nodiscard]] ITask
 	{
@@ -1099,8 +3964,54 @@ namespace cotasklib::Co
 
 	private:
 		handle_type m_handle;
-		Array<std::unique_ptr<ITask>> m_concurrentTasksBefore;
-		Array<std::unique_ptr<ITask>> m_concurrentTasksAfter;
+		std::unique_ptr<detail::ConcurrentTaskList> m_concurrentTasks;
+
+		template <typename TResultOther>
+		friend class detail::TaskAwaiter;
+
+		template <typename TResultOther>
+		friend class Task;
+
+		[[nodiscard]]
+		bool hasConcurrentTasks() const noexcept
+		{
+			return m_concurrentTasks != nullptr;
+		}
+
+		template <typename TResultOther>
+		void addConcurrentTask(Task<TResultOther>&& task, WithTiming timing)
+		{
+			if (!task.m_handle)
+			{
+				// 空のタスクは実行するものがないため追加不要
+				return;
+			}
+			if (!m_concurrentTasks)
+			{
+				m_concurrentTasks = std::make_unique<detail::ConcurrentTaskList>();
+			}
+			detail::PromiseBase* const pPromise = &task.m_handle.promise();
+			m_concurrentTasks->add(detail::ConcurrentTask{ std::exchange(task.m_handle, nullptr), pPromise, std::move(task.m_concurrentTasks), timing });
+		}
+
+		// TaskAwaiter経由でのresume
+		// (Backendの実行リストから直接resumeされている場合、子孫のタスクはエントリごと休止できる)
+		void resumeFromAwaiter()
+		{
+			if (!m_handle || m_handle.done())
+			{
+				return;
+			}
+
+			if (m_concurrentTasks)
+			{
+				m_concurrentTasks->resumeWith(m_handle.promise());
+			}
+			else
+			{
+				m_handle.promise().resumeInnermost();
+			}
+		}
 
     public:
 		explicit Task(handle_type h)
@@ -1114,8 +4025,7 @@ namespace cotasklib::Co
 
 		Task(Task<TResult>&& rhs) noexcept
             : m_handle(rhs.m_handle)
-            , m_concurrentTasksBefore(std::move(rhs.m_concurrentTasksBefore))
-            , m_concurrentTasksAfter(std::move(rhs.m_concurrentTasksAfter))
+            , m_concurrentTasks(std::move(rhs.m_concurrentTasks))
         {
             rhs.m_handle = nullptr;
         }
@@ -1132,25 +4042,9 @@ namespace cotasklib::Co
 
 		virtual void resume() override
 		{
-			if (!m_handle || m_handle.done())
-			{
-				return;
-			}
-
-			for (auto& task : m_concurrentTasksBefore)
-			{
-				task->resume();
-			}
-
-			if (!m_handle.promise().resumeSubAwaiter())
-			{
-				m_handle.resume();
-			}
-
-			for (auto& task : m_concurrentTasksAfter)
-			{
-				task->resume();
-			}
+			// 外部から直接resumeされる場合(pausedWhileやCo::Allなど)、子孫のタスクがエントリごと休止すると以降resumeされなくなるため、休止を禁止する
+			const detail::Backend::IndirectResumeScope indirectResumeScope;
+			resumeFromAwaiter();
 		}
 
 		[[nodiscard]]
@@ -1199,7 +4093,7 @@ namespace cotasklib::Co
 			{
 				return std::move(*this);
 			}
-			m_concurrentTasksAfter.push_back(std::make_unique<Task<TResultOther>>(std::move(task)));
+			addConcurrentTask(std::move(task), WithTiming::After);
 			return std::move(*this);
 		}
 
@@ -1219,11 +4113,8 @@ namespace cotasklib::Co
 			switch (timing)
 			{
 			case WithTiming::Before:
-				m_concurrentTasksBefore.push_back(std::make_unique<Task<TResultOther>>(std::move(task)));
-				break;
-
 			case WithTiming::After:
-				m_concurrentTasksAfter.push_back(std::make_unique<Task<TResultOther>>(std::move(task)));
+				addConcurrentTask(std::move(task), timing);
 				break;
 
 			default:
@@ -1254,12 +4145,12 @@ namespace cotasklib::Co
 		}
 
 		[[nodiscard]]
-		ScopedTaskRunner runScoped(FinishCallbackType<TResult> finishCallback = nullptr, std::function<void()> cancelCallback = nullptr)&&
+		ScopedTaskRunner runScoped(FinishCallbackType<TResult> finishCallback = nullptr, CancelCallbackType cancelCallback = nullptr)&&
 		{
 			return ScopedTaskRunner{ std::move(*this), std::move(finishCallback), std::move(cancelCallback) };
 		}
 
-		void runAddTo(MultiRunner& mr, FinishCallbackType<TResult> finishCallback = nullptr, std::function<void()> cancelCallback = nullptr)&&
+		void runAddTo(MultiRunner& mr, FinishCallbackType<TResult> finishCallback = nullptr, CancelCallbackType cancelCallback = nullptr)&&
 		{
 			mr.add(ScopedTaskRunner{ std::move(*this), std::move(finishCallback), std::move(cancelCallback) });
 		}
@@ -1330,7 +4221,7 @@ namespace cotasklib::Co
 
 			void resume() override
 			{
-				m_task.resume();
+				m_task.resumeFromAwaiter();
 			}
 
 			[[nodiscard]]
@@ -1345,8 +4236,8 @@ namespace cotasklib::Co
 				return m_task.done();
 			}
 
-			template <typename TResultOther>
-			bool await_suspend(std::coroutine_handle<detail::Promise<TResultOther>> handle)
+			template <typename TPromise>
+			bool await_suspend(std::coroutine_handle<TPromise> handle) requires std::derived_from<TPromise, PromiseBase>
 			{
 				resume();
 				if (m_task.done())
@@ -1355,6 +4246,11 @@ namespace cotasklib::Co
 					return false;
 				}
 				handle.promise().setSubAwaiter(this);
+				if (!m_task.hasConcurrentTasks())
+				{
+					// 同時実行タスクを持たないタスクは、親を経由せず末端のコルーチンを直接resumeできるよう連結する
+					handle.promise().linkSubPromise(m_task.m_handle.promise());
+				}
 				return true;
 			}
 
@@ -1370,21 +4266,122 @@ namespace cotasklib::Co
 			}
 		};
 
+		// タスクの結果を動的確保せずに格納する領域
+		// (値の生存期間は手動で管理する)
+		template <typename T>
+		class ResultStorage
+		{
+		private:
+			union
+			{
+				T m_value;
+			};
+
+			bool m_hasValue = false;
+
+		public:
+			ResultStorage() noexcept
+			{
+			}
+
+			ResultStorage(const ResultStorage&) = delete;
+
+			ResultStorage& operator=(const ResultStorage&) = delete;
+
+			ResultStorage(ResultStorage&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>)
+			{
+				if (rhs.m_hasValue)
+				{
+					emplace(std::move(rhs.m_value));
+					rhs.reset();
+				}
+			}
+
+			ResultStorage& operator=(ResultStorage&&) = delete;
+
+			~ResultStorage()
+			{
+				reset();
+			}
+
+			template <typename... Args>
+			void emplace(Args&&... args)
+			{
+				reset();
+				new (std::addressof(m_value)) T(std::forward<Args>(args)...);
+				m_hasValue = true;
+			}
+
+			void reset() noexcept
+			{
+				if (m_hasValue)
+				{
+					m_value.~T();
+					m_hasValue = false;
+				}
+			}
+
+			[[nodiscard]]
+			bool hasValue() const noexcept
+			{
+				return m_hasValue;
+			}
+
+			// 値をムーブして取り出し、領域を空にする
+			[[nodiscard]]
+			T release()
+			{
+				T value = std::move(m_value);
+				reset();
+				return value;
+			}
+		};
+
 		class PromiseBase
 		{
 		protected:
+			std::coroutine_handle<> m_handle;
+
 			IAwaiter* m_pSubAwaiter = nullptr;
 
+			// 同時実行タスクを持たない子タスクをco_awaitで待機中の場合、その子タスクのPromise
+			PromiseBase* m_pSubPromise = nullptr;
+
+			// 親タスクからm_pSubPromiseとして連結されている場合、親タスクのPromise
+			PromiseBase* m_pParentPromise = nullptr;
+
+			// このタスクから末端方向へm_pSubPromiseを辿った先のPromise(前回のresume時点)
+			// (毎フレーム子孫のタスクを1段ずつresumeせず、末端のコルーチンを直接resumeするために使用)
+			PromiseBase* m_pInnermostPromise = this;
+
+			// フレームをフレームアリーナから確保した場合のチャンク
+			// (Note: フレームの確保直後にPromiseが構築されるため、直前に確保したチャンクを記録する)
+			FrameArenaChunk* m_pFrameArenaChunk = FrameAllocator::LastAllocatedChunk();
+
 		public:
 			PromiseBase() = default;
 
+			[[nodiscard]]
+			static void* operator new(std::size_t size)
+			{
+				return FrameAllocator::Allocate(size);
+			}
+
+			static void operator delete(void* pFrame, std::size_t size) noexcept
+			{
+				FrameAllocator::Deallocate(pFrame, size);
+			}
+
 			PromiseBase(const PromiseBase&) = delete;
 
 			PromiseBase& operator=(const PromiseBase&) = delete;
 
 			PromiseBase(PromiseBase&& rhs) noexcept
-				: m_pSubAwaiter(rhs.m_pSubAwaiter)
+				: m_handle(rhs.m_handle)
+				, m_pSubAwaiter(rhs.m_pSubAwaiter)
+				, m_pFrameArenaChunk(rhs.m_pFrameArenaChunk)
 			{
+				rhs.m_handle = nullptr;
 				rhs.m_pSubAwaiter = nullptr;
 			}
 
@@ -1421,17 +4418,120 @@ namespace cotasklib::Co
 					return false;
 				}
 
-				return true;
+				return true;
+			}
+
+			void setSubAwaiter(IAwaiter* pSubAwaiter) noexcept
+			{
+				m_pSubAwaiter = pSubAwaiter;
+			}
+
+			void linkSubPromise(PromiseBase& subPromise) noexcept
+			{
+				m_pSubPromise = &subPromise;
+				subPromise.m_pParentPromise = this;
+			}
+
+			void resumeHandle()
+			{
+				// フレームアリーナから確保されたタスクの実行中は、子孫のタスクのフレームも同じアリーナから確保する
+				const FrameArenaResumeScope frameArenaResumeScope{ m_pFrameArenaChunk };
+				m_handle.resume();
+			}
+
+			// 待機中の末端のコルーチンを直接resumeし、完了したら親のコルーチンへ順に戻ってresumeする
+			// (resumeSubAwaiterで子孫のTaskAwaiterを1段ずつ辿る場合と実行順序は同じ)
+			void resumeInnermost()
+			{
+				PromiseBase* pPromise = m_pInnermostPromise;
+				while (pPromise->m_pSubPromise)
+				{
+					pPromise = pPromise->m_pSubPromise;
+				}
+
+				while (true)
+				{
+					if (pPromise->resumeSubAwaiter())
+					{
+						// 同時実行タスクを持つ子タスクやSiv3Dの非同期タスク等を待機中
+						break;
+					}
+
+					pPromise->resumeHandle();
+
+					if (!pPromise->m_handle.done())
+					{
+						// resume中に新たに子タスクの待機を開始した場合は、その末端まで辿る
+						while (pPromise->m_pSubPromise)
+						{
+							pPromise = pPromise->m_pSubPromise;
+						}
+						break;
+					}
+
+					if (pPromise == this)
+					{
+						break;
+					}
+
+					// 完了した子タスクの結果を受け取るため、親のコルーチンをresumeする
+					// (Note: 親のresume中に子タスクのフレームは破棄されるため、以降pPromiseの子側には触れない)
+					PromiseBase* const pParentPromise = pPromise->m_pParentPromise;
+					pParentPromise->m_pSubAwaiter = nullptr;
+					pParentPromise->m_pSubPromise = nullptr;
+					pPromise = pParentPromise;
+					m_pInnermostPromise = pPromise;
+				}
+
+				m_pInnermostPromise = pPromise;
 			}
 
-			void setSubAwaiter(IAwaiter* pSubAwaiter) noexcept
+			[[nodiscard]]
+			const FrameArenaChunk* frameArenaChunk() const noexcept
 			{
-				m_pSubAwaiter = pSubAwaiter;
+				return m_pFrameArenaChunk;
 			}
 		};
 
 		inline PromiseBase::~PromiseBase() = default;
 
+		inline void ConcurrentTask::resume()
+		{
+			if (done())
+			{
+				return;
+			}
+
+			// 外部から直接resumeされる場合と同様、子孫のタスクがエントリごと休止すると以降resumeされなくなるため、休止を禁止する
+			const Backend::IndirectResumeScope indirectResumeScope;
+			if (m_concurrentTasks)
+			{
+				m_concurrentTasks->resumeWith(*m_pPromise);
+			}
+			else
+			{
+				m_pPromise->resumeInnermost();
+			}
+		}
+
+		inline void ConcurrentTaskList::resumeWith(PromiseBase& promise)
+		{
+			resumeTasks(WithTiming::Before);
+
+			if (hasRunningTasks())
+			{
+				// 同時実行タスクの実行中に本体側がエントリごと休止すると、同時実行タスクもresumeされなくなるため、休止を禁止する
+				const Backend::IndirectResumeScope indirectResumeScope;
+				promise.resumeInnermost();
+			}
+			else
+			{
+				promise.resumeInnermost();
+			}
+
+			resumeTasks(WithTiming::After);
+		}
+
 		template <typename TResult>
 		class Promise : public PromiseBase
 		{
@@ -1440,7 +4540,7 @@ namespace cotasklib::Co
 			static_assert(!std::is_const_v<TResult>, "TResult must not have 'const' qualifier");
 
 		private:
-			std::unique_ptr<TResult> m_value;
+			ResultStorage<TResult> m_value;
 			std::exception_ptr m_exception;
 			bool m_resultConsumed = false;
 
@@ -1453,18 +4553,18 @@ namespace cotasklib::Co
 
 			void return_value(const TResult& v) requires std::is_copy_constructible_v<TResult>
 			{
-				m_value = std::make_unique<TResult>(v);
+				m_value.emplace(v);
 			}
 
 			void return_value(TResult&& v)
 			{
-				m_value = std::make_unique<TResult>(std::move(v));
+				m_value.emplace(std::move(v));
 			}
 
 			[[nodiscard]]
 			TResult value()
 			{
-				if (!m_value && !m_exception)
+				if (!m_value.hasValue() && !m_exception)
 				{
 					throw Error{ U"Task is not completed. Make sure that all paths in the coroutine return a value." };
 				}
@@ -1477,13 +4577,15 @@ namespace cotasklib::Co
 				{
 					std::rethrow_exception(m_exception);
 				}
-				return std::move(*m_value);
+				return m_value.release();
 			}
 
 			[[nodiscard]]
 			Task<TResult> get_return_object()
 			{
-				return Task<TResult>{ Task<TResult>::handle_type::from_promise(*this) };
+				const auto handle = Task<TResult>::handle_type::from_promise(*this);
+				m_handle = handle;
+				return Task<TResult>{ handle };
 			}
 
 			void unhandled_exception()
@@ -1532,7 +4634,9 @@ namespace cotasklib::Co
 			[[nodiscard]]
 			Task<void> get_return_object()
 			{
-				return Task<void>{ Task<void>::handle_type::from_promise(*this) };
+				const auto handle = Task<void>::handle_type::from_promise(*this);
+				m_handle = handle;
+				return Task<void>{ handle };
 			}
 
 			void unhandled_exception()
@@ -1546,7 +4650,14 @@ namespace cotasklib::Co
 	{
 		while (!done())
 		{
-			co_await NextFrame();
+			if (!detail::Backend::IsCurrent(m_backend))
+			{
+				// 別のスケジューラのタスクは終了時に起床させられないため、毎フレーム確認する
+				co_await NextFrame();
+				continue;
+			}
+			const detail::AwaiterID id = *m_id;
+			co_await detail::AnyDoneAwaiter{ std::span{ &id, 1 } };
 		}
 	}
 
@@ -1554,96 +4665,409 @@ namespace cotasklib::Co
 	{
 		while (!allDone())
 		{
-			co_await NextFrame();
+			// 終了していないランナーを1つずつ待機する
+			// (待機中にランナーの配列が変更されうるため、IDはコピーして持つ)
+			const auto it = std::find_if(m_runners.begin(), m_runners.end(), [](const ScopedTaskRunner& runner) { return !runner.done(); });
+			if (!detail::Backend::IsCurrent(it->m_backend))
+			{
+				// 別のスケジューラのタスクは終了時に起床させられないため、毎フレーム確認する
+				co_await NextFrame();
+				continue;
+			}
+			const detail::AwaiterID id = *it->m_id;
+			co_await detail::AnyDoneAwaiter{ std::span{ &id, 1 } };
 		}
 	}
 
 	inline Task<void> MultiRunner::waitUntilAnyDone() const&
 	{
+		Array<detail::AwaiterID> ids;
 		while (!anyDone())
 		{
-			co_await NextFrame();
+			ids.clear();
+			bool hasRunnerInOtherScheduler = false;
+			for (const ScopedTaskRunner& runner : m_runners)
+			{
+				ids.push_back(*runner.m_id);
+				hasRunnerInOtherScheduler = hasRunnerInOtherScheduler || !detail::Backend::IsCurrent(runner.m_backend);
+			}
+			if (hasRunnerInOtherScheduler)
+			{
+				// 別のスケジューラのタスクは終了時に起床させられないため、毎フレーム確認する
+				co_await NextFrame();
+				continue;
+			}
+			co_await detail::AnyDoneAwaiter{ ids, &m_addWaitList };
+		}
+	}
+
+	template <typename TResult = void>
+	class [[nodiscard]] TaskFinishSource
+	{
+		static_assert(!std::is_reference_v<TResult>, "TResult must not be a reference type");
+		static_assert(std::is_move_constructible_v<TResult> || std::is_void_v<TResult>, "TResult must be move constructible");
+		static_assert(!std::is_const_v<TResult>, "TResult must not have 'const' qualifier");
+
+	private:
+		detail::ResultStorage<TResult> m_result;
+		bool m_resultConsumed = false;
+
+		// 終了を待機しているタスク(requestFinish時に起床させる)
+		mutable detail::WaitList m_waitList;
+
+	public:
+		TaskFinishSource() = default;
+
+		TaskFinishSource(const TaskFinishSource&) = delete;
+
+		TaskFinishSource& operator=(const TaskFinishSource&) = delete;
+
+		TaskFinishSource(TaskFinishSource&&) noexcept = default;
+
+		TaskFinishSource& operator=(TaskFinishSource&&) = delete;
+
+		~TaskFinishSource() noexcept = default;
+
+		bool requestFinish(const TResult& result) requires std::is_copy_constructible_v<TResult>
+		{
+			if (m_resultConsumed || hasResult())
+			{
+				return false;
+			}
+			m_result.emplace(result);
+			m_waitList.wakeAll();
+			return true;
+		}
+
+		bool requestFinish(TResult&& result)
+		{
+			if (m_resultConsumed || hasResult())
+			{
+				return false;
+			}
+			m_result.emplace(std::move(result));
+			m_waitList.wakeAll();
+			return true;
+		}
+
+		[[nodiscard]]
+		bool hasResult() const noexcept
+		{
+			return m_result.hasValue();
+		}
+
+		// hasResult()がtrueを返す場合のみ呼び出し可能。1回だけ取得でき、2回目以降の呼び出しは例外を投げる
+		[[nodiscard]]
+		TResult result()
+		{
+			if (m_resultConsumed)
+			{
+				throw Error{ U"TaskFinishSource: result can be get only once. Make sure to check if hasResult() returns true before calling result()." };
+			}
+			if (!m_result.hasValue())
+			{
+				throw Error{ U"TaskFinishSource: TaskFinishSource does not have a result. Make sure to check if hasResult() returns true before calling result()." };
+			}
+			m_resultConsumed = true;
+			return m_result.release();
+		}
+
+		[[nodiscard]]
+		Task<TResult> waitForResult()
+		{
+			while (!done())
+			{
+				co_await m_waitList.wait();
+			}
+			co_return result();
+		}
+
+		[[nodiscard]]
+		Task<void> waitUntilDone() const
+		{
+			while (!done())
+			{
+				co_await m_waitList.wait();
+			}
+		}
+
+		[[nodiscard]]
+		bool done() const noexcept
+		{
+			return m_result.hasValue() || m_resultConsumed;
+		}
+	};
+
+	template <>
+	class [[nodiscard]] TaskFinishSource<void>
+	{
+	private:
+		bool m_finishRequested = false;
+
+		// 終了を待機しているタスク(requestFinish時に起床させる)
+		mutable detail::WaitList m_waitList;
+
+	public:
+		TaskFinishSource() = default;
+
+		TaskFinishSource(const TaskFinishSource&) = delete;
+
+		TaskFinishSource& operator=(const TaskFinishSource&) = delete;
+
+		TaskFinishSource(TaskFinishSource&&) noexcept = default;
+
+		TaskFinishSource& operator=(TaskFinishSource&&) = delete;
+
+		~TaskFinishSource() noexcept = default;
+
+		bool requestFinish()
+		{
+			if (m_finishRequested)
+			{
+				return false;
+			}
+			m_finishRequested = true;
+			m_waitList.wakeAll();
+			return true;
+		}
+
+		[[nodiscard]]
+		Task<void> waitUntilDone() const
+		{
+			while (!done())
+			{
+				co_await m_waitList.wait();
+			}
+		}
+
+		[[nodiscard]]
+		bool done() const noexcept
+		{
+			return m_finishRequested;
 		}
+	};
+
+	namespace detail
+	{
+		// ThreadSafeTaskFinishSourceの状態のうち、結果の型に依存しない部分
+		// (完了キューから参照されるため、ThreadSafeTaskFinishSourceとは別に確保する)
+		class ThreadSafeFinishStateBase : public ICompletion
+		{
+		private:
+			enum class FinishState : uint8
+			{
+				Empty,
+				Writing, // いずれかのスレッドが結果を書き込み中
+				Finished,
+				Consumed,
+			};
+
+			std::atomic<FinishState> m_finishState = FinishState::Empty;
+
+			CompletionQueue* m_pCompletionQueue;
+
+			// 完了キューから通知されるまで自身を保持する
+			std::shared_ptr<ThreadSafeFinishStateBase> m_selfUntilNotified;
+
+		protected:
+			[[nodiscard]]
+			bool tryBeginFinish() noexcept
+			{
+				FinishState expected = FinishState::Empty;
+				return m_finishState.compare_exchange_strong(expected, FinishState::Writing, std::memory_order_acquire, std::memory_order_relaxed);
+			}
+
+			void abortFinish() noexcept
+			{
+				m_finishState.store(FinishState::Empty, std::memory_order_relaxed);
+			}
+
+			void endFinish(std::shared_ptr<ThreadSafeFinishStateBase> self) noexcept
+			{
+				// Finishedを公開した時点で所有スレッドからThreadSafeTaskFinishSourceが破棄されうるため、自身の保持は公開より前に行う
+				m_selfUntilNotified = std::move(self);
+				m_finishState.store(FinishState::Finished, std::memory_order_release);
+
+				// 追加した時点で所有スレッドから通知・破棄されうるため、以降はメンバを参照しない
+				m_pCompletionQueue->push(this);
+			}
+
+			[[nodiscard]]
+			bool tryConsume() noexcept
+			{
+				FinishState expected = FinishState::Finished;
+				return m_finishState.compare_exchange_strong(expected, FinishState::Consumed, std::memory_order_acquire, std::memory_order_relaxed);
+			}
+
+		public:
+			// 以下は所有スレッドでのみ参照する
+			WaitList waitList;
+
+			explicit ThreadSafeFinishStateBase(CompletionQueue* pCompletionQueue) noexcept
+				: m_pCompletionQueue(pCompletionQueue)
+			{
+			}
+
+			void onComplete() override final
+			{
+				waitList.wakeAll();
+
+				// ThreadSafeTaskFinishSourceが既に破棄されている場合、ここで自身が破棄される
+				const std::shared_ptr<ThreadSafeFinishStateBase> self = std::move(m_selfUntilNotified);
+			}
+
+			[[nodiscard]]
+			bool hasResult() const noexcept
+			{
+				return m_finishState.load(std::memory_order_acquire) == FinishState::Finished;
+			}
+
+			[[nodiscard]]
+			bool done() const noexcept
+			{
+				const FinishState finishState = m_finishState.load(std::memory_order_acquire);
+				return finishState == FinishState::Finished || finishState == FinishState::Consumed;
+			}
+
+			[[nodiscard]]
+			bool consumed() const noexcept
+			{
+				return m_finishState.load(std::memory_order_acquire) == FinishState::Consumed;
+			}
+		};
+
+		template <typename TResult>
+		class ThreadSafeFinishState final : public ThreadSafeFinishStateBase
+		{
+		private:
+			ResultStorage<TResult> m_result;
+
+		public:
+			using ThreadSafeFinishStateBase::ThreadSafeFinishStateBase;
+
+			template <typename TResultArg>
+			[[nodiscard]]
+			bool finish(std::shared_ptr<ThreadSafeFinishStateBase> self, TResultArg&& result)
+			{
+				if (!tryBeginFinish())
+				{
+					return false;
+				}
+				try
+				{
+					m_result.emplace(std::forward<TResultArg>(result));
+				}
+				catch (...)
+				{
+					abortFinish();
+					throw;
+				}
+				endFinish(std::move(self));
+				return true;
+			}
+
+			[[nodiscard]]
+			bool tryRelease(Optional<TResult>& result)
+			{
+				if (!tryConsume())
+				{
+					return false;
+				}
+				result.emplace(m_result.release());
+				return true;
+			}
+		};
+
+		template <>
+		class ThreadSafeFinishState<void> final : public ThreadSafeFinishStateBase
+		{
+		public:
+			using ThreadSafeFinishStateBase::ThreadSafeFinishStateBase;
+
+			[[nodiscard]]
+			bool finish(std::shared_ptr<ThreadSafeFinishStateBase> self) noexcept
+			{
+				if (!tryBeginFinish())
+				{
+					return false;
+				}
+				endFinish(std::move(self));
+				return true;
+			}
+		};
 	}
 
+	// 任意のスレッドからrequestFinishを呼び出せるTaskFinishSource
+	// (待機しているタスクは、生成時のスケジューラのupdate時に起床される)
+	// Note: 生成・待機・結果の取得は、生成時のスケジューラのスレッドで行うこと。また、スケジューラより先に破棄すること
 	template <typename TResult = void>
-	class [[nodiscard]] TaskFinishSource
+	class [[nodiscard]] ThreadSafeTaskFinishSource
 	{
 		static_assert(!std::is_reference_v<TResult>, "TResult must not be a reference type");
 		static_assert(std::is_move_constructible_v<TResult> || std::is_void_v<TResult>, "TResult must be move constructible");
 		static_assert(!std::is_const_v<TResult>, "TResult must not have 'const' qualifier");
 
 	private:
-		std::unique_ptr<TResult> m_result;
-		bool m_resultConsumed = false;
+		std::shared_ptr<detail::ThreadSafeFinishState<TResult>> m_state;
 
 	public:
-		TaskFinishSource() = default;
+		ThreadSafeTaskFinishSource()
+			: m_state(std::make_shared<detail::ThreadSafeFinishState<TResult>>(detail::Backend::CurrentCompletionQueue()))
+		{
+		}
 
-		TaskFinishSource(const TaskFinishSource&) = delete;
+		ThreadSafeTaskFinishSource(const ThreadSafeTaskFinishSource&) = delete;
 
-		TaskFinishSource& operator=(const TaskFinishSource&) = delete;
+		ThreadSafeTaskFinishSource& operator=(const ThreadSafeTaskFinishSource&) = delete;
 
-		TaskFinishSource(TaskFinishSource&&) noexcept = default;
+		ThreadSafeTaskFinishSource(ThreadSafeTaskFinishSource&&) noexcept = default;
 
-		TaskFinishSource& operator=(TaskFinishSource&&) = delete;
+		ThreadSafeTaskFinishSource& operator=(ThreadSafeTaskFinishSource&&) = delete;
 
-		~TaskFinishSource() noexcept = default;
+		~ThreadSafeTaskFinishSource() noexcept = default;
 
+		// 任意のスレッドから呼び出せる
 		bool requestFinish(const TResult& result) requires std::is_copy_constructible_v<TResult>
 		{
-			if (m_resultConsumed || hasResult())
-			{
-				return false;
-			}
-			m_result = std::make_unique<TResult>(result);
-			return true;
+			return m_state->finish(m_state, result);
 		}
 
+		// 任意のスレッドから呼び出せる
 		bool requestFinish(TResult&& result)
 		{
-			if (m_resultConsumed || hasResult())
-			{
-				return false;
-			}
-			m_result = std::make_unique<TResult>(std::move(result));
-			return true;
+			return m_state->finish(m_state, std::move(result));
 		}
 
 		[[nodiscard]]
 		bool hasResult() const noexcept
 		{
-			return m_result != nullptr;
+			return m_state->hasResult();
 		}
 
 		// hasResult()がtrueを返す場合のみ呼び出し可能。1回だけ取得でき、2回目以降の呼び出しは例外を投げる
 		[[nodiscard]]
 		TResult result()
 		{
-			if (m_resultConsumed)
+			Optional<TResult> result;
+			if (!m_state->tryRelease(result))
 			{
-				throw Error{ U"TaskFinishSource: result can be get only once. Make sure to check if hasResult() returns true before calling result()." };
-			}
-			if (m_result == nullptr)
-			{
-				throw Error{ U"TaskFinishSource: TaskFinishSource does not have a result. Make sure to check if hasResult() returns true before calling result()." };
+				if (m_state->consumed())
+				{
+					throw Error{ U"ThreadSafeTaskFinishSource: result can be get only once. Make sure to check if hasResult() returns true before calling result()." };
+				}
+				throw Error{ U"ThreadSafeTaskFinishSource: ThreadSafeTaskFinishSource does not have a result. Make sure to check if hasResult() returns true before calling result()." };
 			}
-			m_resultConsumed = true;
-
-			auto result = std::move(*m_result);
-			m_result.reset();
-			return result;
+			return std::move(*result);
 		}
 
 		[[nodiscard]]
 		Task<TResult> waitForResult()
 		{
-			while (!hasResult())
+			while (!done())
 			{
-				co_await NextFrame();
+				co_await m_state->waitList.wait();
 			}
-			m_resultConsumed = true;
-			co_return *m_result;
+			co_return result();
 		}
 
 		[[nodiscard]]
@@ -1651,44 +5075,43 @@ namespace cotasklib::Co
 		{
 			while (!done())
 			{
-				co_await NextFrame();
+				co_await m_state->waitList.wait();
 			}
 		}
 
 		[[nodiscard]]
 		bool done() const noexcept
 		{
-			return m_result != nullptr || m_resultConsumed;
+			return m_state->done();
 		}
 	};
 
 	template <>
-	class [[nodiscard]] TaskFinishSource<void>
+	class [[nodiscard]] ThreadSafeTaskFinishSource<void>
 	{
 	private:
-		bool m_finishRequested = false;
+		std::shared_ptr<detail::ThreadSafeFinishState<void>> m_state;
 
 	public:
-		TaskFinishSource() = default;
+		ThreadSafeTaskFinishSource()
+			: m_state(std::make_shared<detail::ThreadSafeFinishState<void>>(detail::Backend::CurrentCompletionQueue()))
+		{
+		}
 
-		TaskFinishSource(const TaskFinishSource&) = delete;
+		ThreadSafeTaskFinishSource(const ThreadSafeTaskFinishSource&) = delete;
 
-		TaskFinishSource& operator=(const TaskFinishSource&) = delete;
+		ThreadSafeTaskFinishSource& operator=(const ThreadSafeTaskFinishSource&) = delete;
 
-		TaskFinishSource(TaskFinishSource&&) noexcept = default;
+		ThreadSafeTaskFinishSource(ThreadSafeTaskFinishSource&&) noexcept = default;
 
-		TaskFinishSource& operator=(TaskFinishSource&&) = delete;
+		ThreadSafeTaskFinishSource& operator=(ThreadSafeTaskFinishSource&&) = delete;
 
-		~TaskFinishSource() noexcept = default;
+		~ThreadSafeTaskFinishSource() noexcept = default;
 
-		bool requestFinish()
+		// 任意のスレッドから呼び出せる
+		bool requestFinish() noexcept
 		{
-			if (m_finishRequested)
-			{
-				return false;
-			}
-			m_finishRequested = true;
-			return true;
+			return m_state->finish(m_state);
 		}
 
 		[[nodiscard]]
@@ -1696,17 +5119,34 @@ namespace cotasklib::Co
 		{
 			while (!done())
 			{
-				co_await NextFrame();
+				co_await m_state->waitList.wait();
 			}
 		}
 
 		[[nodiscard]]
 		bool done() const noexcept
 		{
-			return m_finishRequested;
+			return m_state->done();
 		}
 	};
 
+	// 任意のスレッドから、関数をメインスレッド(Co::InitまたはCo::ManualBackendを実行したスレッド)で実行するよう依頼する
+	// (関数は次回のフレーム更新の開始時に実行される。同じスレッドから渡した関数や、スレッド間で同期を取って順番に渡した関数は、渡した順に実行される)
+	// (メインスレッドのCo::InitまたはCo::ManualBackendが存在しない場合はfalseを返し、関数は実行されない。終了時に未実行の関数も実行されずに破棄される)
+	// Note: 小さな関数オブジェクトは動的確保なしで渡される。キューが満杯の場合のみロックを使用する
+	template <typename TFunc>
+	bool PostToMainThread(TFunc&& func)
+		requires std::invocable<std::decay_t<TFunc>&>
+	{
+		detail::PostedFunction postedFunc{ std::forward<TFunc>(func) };
+		if (!postedFunc)
+		{
+			// 空の関数(nullptrの関数ポインタや空のstd::function)は実行するものがないため渡さない
+			return detail::MainThreadPostQueue::HasRegisteredQueue();
+		}
+		return detail::MainThreadPostQueue::Post(std::move(postedFunc));
+	}
+
 	[[nodiscard]]
 	inline Task<void> UpdaterTask(std::function<void()> updateFunc)
 	{
@@ -1760,10 +5200,324 @@ namespace cotasklib::Co
 	template <typename TResult>
 	auto operator co_await(const Task<TResult>& rhs) = delete;
 
+#ifndef COTASKLIB_NO_SIV3D
 	inline void Init()
 	{
 		detail::Backend::Init();
 	}
+#else
+	// Siv3Dを使用しない環境で、Co::Initの代わりに生成してフレーム更新を手動で行う
+	// (生成したスレッドの既定のスケジューラとして登録され、updateを呼ぶたびに時刻とフレーム数を進めてタスクを実行する)
+	class ManualBackend
+	{
+	public:
+		static constexpr Duration DefaultDeltaTime{ 1.0 / 60 };
+
+	private:
+		detail::Backend::ScopedInstance m_instance{ std::make_shared<detail::Backend>(detail::ManualClock{}) };
+
+	public:
+		ManualBackend() = default;
+
+		ManualBackend(const ManualBackend&) = delete;
+
+		ManualBackend& operator=(const ManualBackend&) = delete;
+
+		void update(const Duration& deltaTime = DefaultDeltaTime)
+		{
+			m_instance.instance()->advanceManualClock(deltaTime);
+			m_instance.instance()->update();
+		}
+
+		void draw()
+		{
+			m_instance.instance()->draw();
+		}
+
+		[[nodiscard]]
+		double time() const noexcept
+		{
+			return m_instance.instance()->manualClock()->time;
+		}
+
+		[[nodiscard]]
+		int32 frameCount() const noexcept
+		{
+			return m_instance.instance()->manualClock()->frameCount;
+		}
+	};
+#endif
+
+	// 既定のスケジューラ(Co::InitまたはCo::ManualBackend)から独立したタスクの実行環境
+	// (スレッドごとに別のスケジューラを生成して更新することで、複数の実行環境を並列に動かせる)
+	// (時刻とフレーム数はスケジューラごとに持ち、updateを呼ぶたびに進める)
+	class Scheduler
+	{
+	public:
+		static constexpr Duration DefaultDeltaTime{ 1.0 / 60 };
+
+	private:
+		friend class ScopedCurrentScheduler;
+
+		std::shared_ptr<detail::Backend> m_instance = std::make_shared<detail::Backend>(detail::ManualClock{});
+
+	public:
+		Scheduler() = default;
+
+		Scheduler(const Scheduler&) = delete;
+
+		Scheduler& operator=(const Scheduler&) = delete;
+
+		Scheduler(Scheduler&&) noexcept = default;
+
+		Scheduler& operator=(Scheduler&&) noexcept = default;
+
+		~Scheduler() = default;
+
+		void update(const Duration& deltaTime = DefaultDeltaTime)
+		{
+			m_instance->advanceManualClock(deltaTime);
+			m_instance->update();
+		}
+
+		void draw()
+		{
+			m_instance->draw();
+		}
+
+		[[nodiscard]]
+		double time() const noexcept
+		{
+			return m_instance->manualClock()->time;
+		}
+
+		[[nodiscard]]
+		int32 frameCount() const noexcept
+		{
+			return m_instance->manualClock()->frameCount;
+		}
+	};
+
+	// スコープ内で、指定したスケジューラを現在のスレッドで使用するスケジューラにする
+	// (スコープ内で実行開始したタスクや生成したScopedDrawerは、このスケジューラに登録される)
+	// (Schedulerより先に破棄すること)
+	class [[nodiscard]] ScopedCurrentScheduler
+	{
+	private:
+		detail::Backend::CurrentScope m_currentScope;
+
+	public:
+		explicit ScopedCurrentScheduler(Scheduler& scheduler) noexcept
+			: m_currentScope{ scheduler.m_instance.get() }
+		{
+		}
+
+		ScopedCurrentScheduler(const ScopedCurrentScheduler&) = delete;
+
+		ScopedCurrentScheduler& operator=(const ScopedCurrentScheduler&) = delete;
+	};
+
+	// 所属するタスクをまとめて一時停止・再開するためのグループ
+	// (一時停止中は、所属するタスクが実行リストから外れるため、毎フレームの処理負荷は発生しない)
+	// (所属するタスク内のCo::Delay等のタイマーは、一時停止していた時間を経過時間に含めない)
+	class [[nodiscard]] PauseGroup
+	{
+	private:
+		friend class ScopedCurrentPauseGroup;
+
+		std::shared_ptr<detail::PauseGroupState> m_state;
+
+	public:
+		PauseGroup()
+			: m_state(std::make_shared<detail::PauseGroupState>(detail::Backend::Current()))
+		{
+		}
+
+		PauseGroup(const PauseGroup&) = delete;
+
+		PauseGroup& operator=(const PauseGroup&) = delete;
+
+		PauseGroup(PauseGroup&&) noexcept = default;
+
+		PauseGroup& operator=(PauseGroup&&) = delete;
+
+		~PauseGroup()
+		{
+			// 所属するタスクが再開されなくならないよう、破棄時に再開する
+			if (m_state)
+			{
+				resume();
+			}
+		}
+
+		// 所属するタスクは、次に実行順が来た時点から再開されるまで実行されなくなる
+		void pause()
+		{
+			detail::Backend::SetPauseGroupPaused(*m_state, true);
+		}
+
+		void resume()
+		{
+			detail::Backend::SetPauseGroupPaused(*m_state, false);
+		}
+
+		void setPaused(bool isPaused)
+		{
+			detail::Backend::SetPauseGroupPaused(*m_state, isPaused);
+		}
+
+		[[nodiscard]]
+		bool isPaused() const noexcept
+		{
+			return m_state->isPaused();
+		}
+	};
+
+	// スコープ内で実行開始したタスクを、指定したポーズグループに所属させる
+	// (所属するタスクの実行中に実行開始したタスクは、自動的に同じポーズグループに所属する)
+	// Note: コルーチン内で使用する場合、co_awaitをまたいで保持しないこと
+	class [[nodiscard]] ScopedCurrentPauseGroup
+	{
+	private:
+		detail::Backend::CurrentPauseGroupScope m_currentPauseGroupScope;
+
+	public:
+		explicit ScopedCurrentPauseGroup(PauseGroup& pauseGroup) noexcept
+			: m_currentPauseGroupScope{ pauseGroup.m_state.get() }
+		{
+		}
+
+		ScopedCurrentPauseGroup(const ScopedCurrentPauseGroup&) = delete;
+
+		ScopedCurrentPauseGroup& operator=(const ScopedCurrentPauseGroup&) = delete;
+	};
+
+	// 所属するタスク内のタイマーの時間の進み方を、まとめて変更するためのグループ
+	// (スローモーションや早送りに使用する。所属するタスク内で時計を指定せずに使用したCo::Delay・Co::Ease等は、グループの仮想時刻で動作する)
+	// (仮想時刻はフレームごとに1回のみ進められ、所属するタイマー間で共有される)
+	class [[nodiscard]] TimeScaleGroup
+	{
+	private:
+		friend class ScopedCurrentTimeScaleGroup;
+
+		std::shared_ptr<detail::TimeScaleGroupState> m_state;
+
+		static void ValidateTimeScale(double timeScale)
+		{
+			if (!(timeScale >= 0.0))
+			{
+				throw Error{ U"TimeScaleGroup: timeScale must be non-negative" };
+			}
+		}
+
+	public:
+		// 生成時に実行中のタスクがタイムスケールグループに所属している場合、その仮想時刻を基準にする(倍率は掛け合わされる)
+		explicit TimeScaleGroup(double timeScale = 1.0)
+		{
+			ValidateTimeScale(timeScale);
+			m_state = std::make_shared<detail::TimeScaleGroupState>(detail::Backend::SharedCurrentTimeScaleGroup(), timeScale, detail::Backend::FrameSceneTime());
+			detail::Backend::AddTimeScaleGroup(m_state);
+		}
+
+		TimeScaleGroup(const TimeScaleGroup&) = delete;
+
+		TimeScaleGroup& operator=(const TimeScaleGroup&) = delete;
+
+		TimeScaleGroup(TimeScaleGroup&&) noexcept = default;
+
+		TimeScaleGroup& operator=(TimeScaleGroup&&) = delete;
+
+		~TimeScaleGroup() = default;
+
+		// 変更後の倍率は、次フレームの時間経過から適用される
+		// (0の場合、所属するタイマーは停止する)
+		void setTimeScale(double timeScale)
+		{
+			ValidateTimeScale(timeScale);
+			m_state->setTimeScale(timeScale);
+		}
+
+		[[nodiscard]]
+		double timeScale() const noexcept
+		{
+			return m_state->timeScale();
+		}
+
+		// 仮想時刻(グループの生成時点を0とした経過時間)
+		[[nodiscard]]
+		Duration time() const noexcept
+		{
+			return Duration{ m_state->time() };
+		}
+
+		// 仮想時刻を返す時計
+		// (スコープ外のタスクへ明示的に渡す場合、そのタスクはグループより先に破棄すること)
+		[[nodiscard]]
+		ISteadyClock* clock() const noexcept
+		{
+			return m_state.get();
+		}
+	};
+
+	// スコープ内で実行開始したタスクを、指定したタイムスケールグループに所属させる
+	// (所属するタスクの実行中に実行開始したタスクは、自動的に同じタイムスケールグループに所属する)
+	// Note: コルーチン内で使用する場合、co_awaitをまたいで保持しないこと
+	class [[nodiscard]] ScopedCurrentTimeScaleGroup
+	{
+	private:
+		detail::Backend::CurrentTimeScaleGroupScope m_currentTimeScaleGroupScope;
+
+	public:
+		explicit ScopedCurrentTimeScaleGroup(TimeScaleGroup& timeScaleGroup) noexcept
+			: m_currentTimeScaleGroupScope{ timeScaleGroup.m_state.get() }
+		{
+		}
+
+		ScopedCurrentTimeScaleGroup(const ScopedCurrentTimeScaleGroup&) = delete;
+
+		ScopedCurrentTimeScaleGroup& operator=(const ScopedCurrentTimeScaleGroup&) = delete;
+	};
+
+	// スコープ内で実行開始したタスクの優先度を指定する
+	// (所属するタスクの実行中に実行開始したタスクは、自動的に同じ優先度になる)
+	// Note: コルーチン内で使用する場合、co_awaitをまたいで保持しないこと
+	class [[nodiscard]] ScopedCurrentTaskPriority
+	{
+	private:
+		detail::Backend::CurrentTaskPriorityScope m_currentTaskPriorityScope;
+
+	public:
+		explicit ScopedCurrentTaskPriority(TaskPriority taskPriority) noexcept
+			: m_currentTaskPriorityScope{ taskPriority }
+		{
+		}
+
+		ScopedCurrentTaskPriority(const ScopedCurrentTaskPriority&) = delete;
+
+		ScopedCurrentTaskPriority& operator=(const ScopedCurrentTaskPriority&) = delete;
+	};
+
+	// 現在のスレッドで使用するスケジューラに、1フレームあたりのタスク実行の予算を設定する
+	// (予算を使い切った後は、deferredTaskPriority以下の優先度のタスクの実行を次フレームへ持ち越す。0以下の場合は無制限)
+	// (既定ではBackgroundのタスクのみ持ち越す。Normalを指定した場合、既定の優先度のタスクも持ち越す)
+	// (pSteadyClockを指定した場合、その時計で経過時間を判定する)
+	inline void SetFrameBudget(const Duration& budget, TaskPriority deferredTaskPriority = TaskPriority::Background, ISteadyClock* pSteadyClock = nullptr)
+	{
+		const auto budgetMicrosec = DurationCast<std::chrono::microseconds>(budget).count();
+		detail::Backend::SetFrameBudget(budgetMicrosec > 0 ? static_cast<uint64>(budgetMicrosec) : 0, deferredTaskPriority, pSteadyClock);
+	}
+
+	[[nodiscard]]
+	inline Duration GetFrameBudget()
+	{
+		return Duration{ static_cast<double>(detail::Backend::FrameBudgetMicrosec()) / 1'000'000.0 };
+	}
+
+	[[nodiscard]]
+	inline FrameBudgetStats GetFrameBudgetStats()
+	{
+		return detail::Backend::GetFrameBudgetStats();
+	}
 
 	[[nodiscard]]
 	inline bool HasActiveDrawerInLayer(Layer layer)
@@ -1771,6 +5525,14 @@ namespace cotasklib::Co
 		return detail::Backend::HasActiveDrawerInLayer(layer);
 	}
 
+	// 描画が1つ以上あるレイヤーの集合を返す
+	// (複数のレイヤーをまとめて判定する場合、LayerMask::intersectsを使用するとHasActiveDrawerInLayerを複数回呼ぶより高速)
+	[[nodiscard]]
+	inline LayerMask ActiveLayersMask()
+	{
+		return detail::Backend::ActiveLayers();
+	}
+
 	[[nodiscard]]
 	inline bool HasActiveModal()
 	{
@@ -1780,7 +5542,8 @@ namespace cotasklib::Co
 	[[nodiscard]]
 	inline bool HasActiveTransition()
 	{
-		return HasActiveDrawerInLayer(Layer::Transition_FadeIn) || HasActiveDrawerInLayer(Layer::Transition_General) || HasActiveDrawerInLayer(Layer::Transition_FadeOut);
+		constexpr LayerMask TransitionLayers{ Layer::Transition_FadeIn, Layer::Transition_General, Layer::Transition_FadeOut };
+		return detail::Backend::ActiveLayers().intersects(TransitionLayers);
 	}
 
 	[[nodiscard]]
@@ -1828,15 +5591,114 @@ namespace cotasklib::Co
 			TInnerDuration m_elapsed = TInnerDuration{ 0 };
 			TInnerDuration m_prevTime;
 			int32 m_prevFrameCount;
+			uint32 m_prevDeferredFrameCount;
+			bool m_isSleeping = false;
+
+			// 生成時に実行中のタスクが所属するポーズグループ
+			// (ポーズグループが一時停止していた時間は、経過時間に加算しない)
+			std::shared_ptr<PauseGroupState> m_pauseGroup;
+			ISteadyClock* m_pSteadyClock;
+			TInnerDuration m_prevPausedTime = TInnerDuration{ 0 };
+
+			[[nodiscard]]
+			TInnerDuration pausedTime() const
+			{
+				if (!m_pauseGroup)
+				{
+					return TInnerDuration{ 0 };
+				}
+				if constexpr (std::is_floating_point_v<typename TInnerDuration::rep>)
+				{
+					return TInnerDuration{ m_pauseGroup->pausedSceneTime() };
+				}
+				else
+				{
+					return TInnerDuration{ m_pauseGroup->pausedMicrosec(m_pSteadyClock) };
+				}
+			}
+
+			[[nodiscard]]
+			bool trySleep(ISteadyClock* pSteadyClock)
+			{
+				// 前回の更新時刻から残り時間が経過した時点が期限となる
+				const TInnerDuration deadline = m_prevTime + (m_duration - m_elapsed);
+				if constexpr (std::is_floating_point_v<typename TInnerDuration::rep>)
+				{
+					return Backend::SleepCurrentUntil(deadline.count());
+				}
+				else
+				{
+					return Backend::SleepCurrentUntil(pSteadyClock, deadline.count());
+				}
+			}
 
 		public:
 			using InnerDurationRep = typename TInnerDuration::rep;
 
-			DeltaAggregateTimerImpl(Duration duration, InnerDurationRep initialTime)
+			class SleepAwaiter
+			{
+			private:
+				DeltaAggregateTimerImpl* m_pTimer;
+				ISteadyClock* m_pSteadyClock;
+
+			public:
+				SleepAwaiter(DeltaAggregateTimerImpl* pTimer, ISteadyClock* pSteadyClock) noexcept
+					: m_pTimer(pTimer)
+					, m_pSteadyClock(pSteadyClock)
+				{
+				}
+
+				[[nodiscard]]
+				bool await_ready() const noexcept
+				{
+					return false;
+				}
+
+				void await_suspend(std::coroutine_handle<>)
+				{
+					m_pTimer->m_isSleeping = m_pTimer->trySleep(m_pSteadyClock);
+				}
+
+				void await_resume() const noexcept
+				{
+				}
+			};
+
+			DeltaAggregateTimerImpl(Duration duration, InnerDurationRep initialTime, ISteadyClock* pSteadyClock = nullptr)
 				: m_duration(DurationCast<TInnerDuration>(duration))
 				, m_prevTime(initialTime)
-				, m_prevFrameCount(Scene::FrameCount())
+				, m_prevFrameCount(Backend::FrameCount())
+				, m_prevDeferredFrameCount(Backend::CurrentDeferredFrameCount())
+				, m_pSteadyClock(pSteadyClock)
+			{
+				if (PauseGroupState* const pPauseGroup = Backend::CurrentPauseGroup())
+				{
+					m_pauseGroup = pPauseGroup->shared_from_this();
+					if constexpr (!std::is_floating_point_v<InnerDurationRep>)
+					{
+						m_pauseGroup->registerSteadyClock(m_pSteadyClock, initialTime);
+					}
+					m_prevPausedTime = pausedTime();
+				}
+			}
+
+			DeltaAggregateTimerImpl(const DeltaAggregateTimerImpl&) = delete;
+
+			DeltaAggregateTimerImpl& operator=(const DeltaAggregateTimerImpl&) = delete;
+
+			DeltaAggregateTimerImpl(DeltaAggregateTimerImpl&&) noexcept = default;
+
+			DeltaAggregateTimerImpl& operator=(DeltaAggregateTimerImpl&&) = delete;
+
+			~DeltaAggregateTimerImpl()
 			{
+				if constexpr (!std::is_floating_point_v<InnerDurationRep>)
+				{
+					if (m_pauseGroup)
+					{
+						m_pauseGroup->unregisterSteadyClock(m_pSteadyClock);
+					}
+				}
 			}
 
 			[[nodiscard]]
@@ -1845,20 +5707,43 @@ namespace cotasklib::Co
 				return m_elapsed >= m_duration;
 			}
 
+			// 次フレームまで待機する
+			// (Backendの実行リストから直接resumeされている場合は、期限に達するまで実行リストのエントリごと休止する)
+			// (SecondsFの場合はScene::Time、それ以外の場合は与えられたISteadyClockの時刻で期限を判定する)
+			[[nodiscard]]
+			SleepAwaiter sleepUntilReachedZero(ISteadyClock* pSteadyClock = nullptr) noexcept
+			{
+				return SleepAwaiter{ this, pSteadyClock };
+			}
+
 			void update(InnerDurationRep timeRep)
 			{
-				const int32 frameCount = Scene::FrameCount();
+				const int32 frameCount = Backend::FrameCount();
 				const TInnerDuration time = TInnerDuration{ timeRep };
 
 				// ポーズ中や同一フレーム内での多重更新は時間を進行させない
 				// (ポーズ前後の1フレーム分の時間を加算していないのは仕様で、ISteadyClockの場合に絶対時間しか取得できず加算しようがないため)
-				if (frameCount - m_prevFrameCount == 1)
+				// (エントリごと休止していた場合は、休止中も毎フレーム更新されていたものとみなして休止中の時間を加算する)
+				// (予算超過によりエントリの実行が持ち越されたフレームも、更新されていたものとみなす)
+				const uint32 deferredFrameCount = Backend::CurrentDeferredFrameCount();
+				const int32 frameCountDiff = frameCount - m_prevFrameCount - static_cast<int32>(deferredFrameCount - m_prevDeferredFrameCount);
+				const TInnerDuration pausedTime = this->pausedTime();
+				if (frameCountDiff == 1 || (m_isSleeping && frameCountDiff > 1))
 				{
-					m_elapsed += time - m_prevTime;
+					// 所属するポーズグループが一時停止していた時間は除外する
+					const TInnerDuration delta = time - m_prevTime;
+					const TInnerDuration pausedDelta = pausedTime - m_prevPausedTime;
+					if (pausedDelta < delta)
+					{
+						m_elapsed += delta - pausedDelta;
+					}
 				}
 
 				m_prevFrameCount = frameCount;
+				m_prevDeferredFrameCount = deferredFrameCount;
 				m_prevTime = time;
+				m_prevPausedTime = pausedTime;
+				m_isSleeping = false;
 			}
 
 			[[nodiscard]]
@@ -1875,63 +5760,126 @@ namespace cotasklib::Co
 		class DeltaAggregateTimer
 		{
 		private:
-			std::variant<DeltaAggregateTimerImpl<SecondsF>, DeltaAggregateTimerImpl<std::chrono::duration<uint64, std::micro>>> m_impl;
+			using SceneTimeImpl = DeltaAggregateTimerImpl<SecondsF>;
+			using SteadyClockImpl = DeltaAggregateTimerImpl<std::chrono::duration<uint64, std::micro>>;
+
+			// 時計が指定されず、生成時に実行中のタスクがタイムスケールグループに所属する場合、グループの仮想時刻を時計として使用する
+			std::shared_ptr<TimeScaleGroupState> m_timeScaleGroup;
 			ISteadyClock* m_pSteadyClock;
+			std::variant<SceneTimeImpl, SteadyClockImpl> m_impl;
+
+			// 使用する実装は生成時に確定しているため、std::visitを経由せずm_pSteadyClockの有無で分岐する
+			template <typename TFunc>
+			decltype(auto) withImpl(TFunc&& func)
+			{
+				if (m_pSteadyClock)
+				{
+					return func(*std::get_if<SteadyClockImpl>(&m_impl));
+				}
+				return func(*std::get_if<SceneTimeImpl>(&m_impl));
+			}
+
+			template <typename TFunc>
+			decltype(auto) withImpl(TFunc&& func) const
+			{
+				if (m_pSteadyClock)
+				{
+					return func(*std::get_if<SteadyClockImpl>(&m_impl));
+				}
+				return func(*std::get_if<SceneTimeImpl>(&m_impl));
+			}
 
 		public:
 			DeltaAggregateTimer(Duration duration, ISteadyClock* pSteadyClock)
-				: m_impl(pSteadyClock
-					? decltype(m_impl){ DeltaAggregateTimerImpl<std::chrono::duration<uint64, std::micro>>{ duration, pSteadyClock->getMicrosec() } }
-					: decltype(m_impl){ DeltaAggregateTimerImpl<SecondsF>{ duration, Scene::Time() } })
-				, m_pSteadyClock(pSteadyClock)
+				: m_timeScaleGroup(pSteadyClock ? nullptr : Backend::SharedCurrentTimeScaleGroup())
+				, m_pSteadyClock(pSteadyClock ? pSteadyClock : m_timeScaleGroup.get())
+				, m_impl(m_pSteadyClock
+					? decltype(m_impl){ SteadyClockImpl{ duration, Backend::FrameSteadyClockMicrosec(m_pSteadyClock), m_pSteadyClock } }
+					: decltype(m_impl){ SceneTimeImpl{ duration, Backend::FrameSceneTime() } })
 			{
 			}
 
 			[[nodiscard]]
 			bool reachedZero() const
 			{
-				return std::visit([](const auto& impl) { return impl.reachedZero(); }, m_impl);
+				return withImpl([](const auto& impl) { return impl.reachedZero(); });
+			}
+
+			// 次フレームまで待機する
+			// (Backendの実行リストから直接resumeされている場合は、期限に達するまで実行リストのエントリごと休止する)
+			[[nodiscard]]
+			auto sleepUntilReachedZero() noexcept
+			{
+				struct SleepAwaiter
+				{
+					DeltaAggregateTimer* pTimer;
+
+					[[nodiscard]]
+					bool await_ready() const noexcept
+					{
+						return false;
+					}
+
+					void await_suspend(std::coroutine_handle<> handle)
+					{
+						pTimer->withImpl([&](auto& impl) { impl.sleepUntilReachedZero(pTimer->m_pSteadyClock).await_suspend(handle); });
+					}
+
+					void await_resume() const noexcept
+					{
+					}
+				};
+				return SleepAwaiter{ this };
 			}
 
 			void update()
 			{
 				if (m_pSteadyClock)
 				{
-					std::get<DeltaAggregateTimerImpl<std::chrono::duration<uint64, std::micro>>>(m_impl).update(m_pSteadyClock->getMicrosec());
+					std::get_if<SteadyClockImpl>(&m_impl)->update(Backend::FrameSteadyClockMicrosec(m_pSteadyClock));
 				}
 				else
 				{
-					std::get<DeltaAggregateTimerImpl<SecondsF>>(m_impl).update(Scene::Time());
+					std::get_if<SceneTimeImpl>(&m_impl)->update(Backend::FrameSceneTime());
 				}
 			}
 
 			[[nodiscard]]
 			double progress0_1() const
 			{
-				return std::visit([](const auto& impl) { return impl.progress0_1(); }, m_impl);
+				return withImpl([](const auto& impl) { return impl.progress0_1(); });
 			}
 		};
 	}
 
+	// Note: 実行リストから直接resumeされている間は期限まで実行リストのエントリごと休止する
+	//       (Co::All・Co::Any・pausedWhileの中や、with()の同時実行タスクの実行中は休止できないため、毎フレームresumeされて期限を確認する)
 	[[nodiscard]]
-	inline Task<void> Delay(const Duration duration)
+	inline Task<void> Delay(const Duration duration, ISteadyClock* pSteadyClock)
 	{
-		detail::DeltaAggregateTimerImpl<SecondsF> timer{ duration, Scene::Time() };
+		detail::DeltaAggregateTimer timer{ duration, pSteadyClock };
 		while (!timer.reachedZero())
 		{
-			co_await NextFrame();
-			timer.update(Scene::Time());
+			co_await timer.sleepUntilReachedZero();
+			timer.update();
 		}
 	}
 
 	[[nodiscard]]
-	inline Task<void> Delay(const Duration duration, ISteadyClock* pSteadyClock)
+	inline Task<void> Delay(const Duration duration)
 	{
-		detail::DeltaAggregateTimer timer{ duration, pSteadyClock };
+		if (detail::Backend::CurrentTimeScaleGroup())
+		{
+			// タイムスケールグループに所属するタスク内では、グループの仮想時刻で待機する
+			co_await Delay(duration, nullptr);
+			co_return;
+		}
+
+		detail::DeltaAggregateTimerImpl<SecondsF> timer{ duration, detail::Backend::FrameSceneTime() };
 		while (!timer.reachedZero())
 		{
-			co_await NextFrame();
-			timer.update();
+			co_await timer.sleepUntilReachedZero();
+			timer.update(detail::Backend::FrameSceneTime());
 		}
 	}
 
@@ -1957,6 +5905,208 @@ namespace cotasklib::Co
 			}(std::move(*this), duration, pSteadyClock);
 	}
 
+	namespace detail
+	{
+		// スレッドプールで実行するジョブのうち、結果の型に依存しない部分
+		// (Co::Asyncでは、s3d::Asyncで生成したスレッドからrunを呼び出す)
+		class ThreadPoolJobBase : public IThreadPoolJob, public ICompletion
+		{
+		private:
+			CompletionQueue* m_pCompletionQueue;
+
+			std::atomic<bool> m_isCancelRequested = false;
+
+			// 完了キューから通知されるまで自身を保持する
+			std::shared_ptr<IThreadPoolJob> m_selfUntilCompleted;
+
+			// 以下は所有スレッドでのみ参照する
+			bool m_isCompleted = false;
+
+			WaitList m_waitList;
+
+			void pushCompletion(std::shared_ptr<IThreadPoolJob>&& self) noexcept
+			{
+				m_selfUntilCompleted = std::move(self);
+
+				// 追加した時点で所有スレッドから破棄されうるため、以降はメンバを参照しない
+				m_pCompletionQueue->push(this);
+			}
+
+		protected:
+			std::exception_ptr m_exceptionPtr;
+
+			virtual void invoke() = 0;
+
+			void rethrowIfFailed() const
+			{
+				if (m_exceptionPtr)
+				{
+					std::rethrow_exception(m_exceptionPtr);
+				}
+			}
+
+		public:
+			explicit ThreadPoolJobBase(CompletionQueue* pCompletionQueue) noexcept
+				: m_pCompletionQueue(pCompletionQueue)
+			{
+			}
+
+			void run(std::shared_ptr<IThreadPoolJob>&& self) noexcept override final
+			{
+				if (!m_isCancelRequested.load(std::memory_order_relaxed))
+				{
+					try
+					{
+						invoke();
+					}
+					catch (...)
+					{
+						m_exceptionPtr = std::current_exception();
+					}
+				}
+				pushCompletion(std::move(self));
+			}
+
+			void cancel(std::shared_ptr<IThreadPoolJob>&& self) noexcept override final
+			{
+				m_exceptionPtr = std::make_exception_ptr(Error{ U"RunOnThreadPool: Thread pool was destroyed before the job was run" });
+				pushCompletion(std::move(self));
+			}
+
+			void onComplete() override final
+			{
+				m_isCompleted = true;
+				m_waitList.wakeAll();
+
+				// 待機していたタスクが既に破棄されている場合、ここで自身が破棄される
+				const std::shared_ptr<IThreadPoolJob> self = std::move(m_selfUntilCompleted);
+			}
+
+			// 未実行であれば、実行せずに完了させる
+			void requestCancel() noexcept
+			{
+				m_isCancelRequested.store(true, std::memory_order_relaxed);
+			}
+
+			[[nodiscard]]
+			bool isCompleted() const noexcept
+			{
+				return m_isCompleted;
+			}
+
+			[[nodiscard]]
+			WaitList& waitList() noexcept
+			{
+				return m_waitList;
+			}
+		};
+
+		template <typename TResult, typename TFunc>
+		class ThreadPoolJob final : public ThreadPoolJobBase
+		{
+		private:
+			TFunc m_func;
+
+			ResultStorage<TResult> m_result;
+
+			void invoke() override
+			{
+				m_result.emplace(m_func());
+			}
+
+		public:
+			ThreadPoolJob(TFunc&& func, CompletionQueue* pCompletionQueue)
+				: ThreadPoolJobBase(pCompletionQueue)
+				, m_func(std::move(func))
+			{
+			}
+
+			// 完了後に所有スレッドから呼び出す
+			[[nodiscard]]
+			TResult release()
+			{
+				rethrowIfFailed();
+				return m_result.release();
+			}
+		};
+
+		template <typename TFunc>
+		class ThreadPoolJob<void, TFunc> final : public ThreadPoolJobBase
+		{
+		private:
+			TFunc m_func;
+
+			void invoke() override
+			{
+				m_func();
+			}
+
+		public:
+			ThreadPoolJob(TFunc&& func, CompletionQueue* pCompletionQueue)
+				: ThreadPoolJobBase(pCompletionQueue)
+				, m_func(std::move(func))
+			{
+			}
+
+			// 完了後に所有スレッドから呼び出す
+			void release() const
+			{
+				rethrowIfFailed();
+			}
+		};
+
+		// 完了前に待機中のタスクが破棄された場合、未実行のジョブを実行しないようにする
+		class ThreadPoolJobCancelGuard
+		{
+		private:
+			ThreadPoolJobBase* m_pJob;
+
+		public:
+			explicit ThreadPoolJobCancelGuard(ThreadPoolJobBase* pJob) noexcept
+				: m_pJob(pJob)
+			{
+			}
+
+			ThreadPoolJobCancelGuard(const ThreadPoolJobCancelGuard&) = delete;
+
+			ThreadPoolJobCancelGuard& operator=(const ThreadPoolJobCancelGuard&) = delete;
+
+			~ThreadPoolJobCancelGuard()
+			{
+				if (!m_pJob->isCompleted())
+				{
+					m_pJob->requestCancel();
+				}
+			}
+		};
+	}
+
+	// 関数をスレッドプールで実行し、完了まで待機して結果を返す
+	// (完了はupdate時にまとめて通知されるため、関数内で例外が発生した場合は待機しているタスクへ再送出される)
+	// Note: 関数はメインスレッド以外で実行されるため、関数内でCo名前空間の機能やSiv3Dの描画機能などを使用しないこと
+	template <typename TFunc>
+	[[nodiscard]]
+	Task<std::invoke_result_t<TFunc&>> RunOnThreadPool(TFunc func, ThreadPoolPriority priority = ThreadPoolPriority::Normal)
+	{
+		using Job = detail::ThreadPoolJob<std::invoke_result_t<TFunc&>, TFunc>;
+		const auto job = std::make_shared<Job>(std::move(func), detail::Backend::CurrentCompletionQueue());
+		const detail::ThreadPoolJobCancelGuard cancelGuard{ job.get() };
+		detail::Backend::SubmitToThreadPool(job, priority);
+
+		while (!job->isCompleted())
+		{
+			co_await job->waitList().wait();
+		}
+		co_return job->release();
+	}
+
+	// 現在のスケジューラのスレッドプールで、同時に実行するジョブ数の上限を設定する
+	// (上限はスレッドプールのスレッド数を超えない)
+	inline void SetThreadPoolMaxConcurrency(std::size_t maxConcurrency)
+	{
+		detail::Backend::SetThreadPoolMaxConcurrency(maxConcurrency);
+	}
+
 	[[nodiscard]]
 	inline Task<void> WaitForever()
 	{
@@ -1992,6 +6142,45 @@ namespace cotasklib::Co
 		}
 	}
 
+	namespace detail
+	{
+		template <typename TView, typename TFunc>
+		[[nodiscard]]
+		Task<void> ForEachTimeSlicedImpl(TView view, TFunc func, uint64 budgetMicrosec)
+		{
+			uint64 sliceStartMicrosec = Backend::FrameBudgetClockMicrosec();
+			auto it = std::ranges::begin(view);
+			const auto end = std::ranges::end(view);
+			while (it != end)
+			{
+				func(*it);
+				++it;
+
+				// 指定した予算か、フレーム全体の予算を使い切った場合、残りの要素は次フレームへ持ち越す
+				// (時計が巻き戻った場合は、経過時間を0として扱う)
+				if (it != end
+					&& ((budgetMicrosec > 0 && Backend::FrameBudgetClockMicrosec() >= sliceStartMicrosec + budgetMicrosec) || Backend::IsOverFrameBudget()))
+				{
+					co_await NextFrame();
+					sliceStartMicrosec = Backend::FrameBudgetClockMicrosec();
+				}
+			}
+		}
+	}
+
+	// rangeの各要素に対してfuncを実行する。1フレームあたりの予算に収まる数の要素のみ処理し、残りは次フレーム以降に持ち越す
+	// (budgetを省略した場合は、Co::YieldIfOverBudgetと同様にフレーム全体の予算で判定する。update外ではフレーム全体の予算による持ち越しは行わない)
+	// (1フレームにつき最低1要素は処理する)
+	// Note: 左辺値のrangeは参照で保持するため、タスクの完了まで破棄しないこと
+	template <std::ranges::viewable_range TRange, typename TFunc>
+		requires std::invocable<TFunc&, std::ranges::range_reference_t<TRange>>
+	[[nodiscard]]
+	Task<void> ForEachTimeSliced(TRange&& range, TFunc func, const Duration& budget = Duration{ 0.0 })
+	{
+		const auto budgetMicrosec = DurationCast<std::chrono::microseconds>(budget).count();
+		return detail::ForEachTimeSlicedImpl(std::views::all(std::forward<TRange>(range)), std::move(func), budgetMicrosec > 0 ? static_cast<uint64>(budgetMicrosec) : 0);
+	}
+
 	template <typename T>
 	[[nodiscard]]
 	Task<T> WaitForResult(const std::optional<T>* pOptional)
@@ -2045,6 +6234,7 @@ namespace cotasklib::Co
 		}
 	}
 
+#ifndef COTASKLIB_NO_SIV3D
 	[[nodiscard]]
 	inline Task<void> WaitForTimer(const Timer* pTimer)
 	{
@@ -2053,6 +6243,7 @@ namespace cotasklib::Co
 			co_await NextFrame();
 		}
 	}
+#endif
 
 	template <class TInput>
 	[[nodiscard]]
@@ -2094,6 +6285,7 @@ namespace cotasklib::Co
 		}
 	}
 
+#ifndef COTASKLIB_NO_SIV3D
 	template <class TArea>
 	[[nodiscard]]
 	Task<void> WaitUntilLeftClickedThenReleased(const TArea area)
@@ -2111,6 +6303,7 @@ namespace cotasklib::Co
 			co_await NextFrame();
 		}
 	}
+#endif
 
 	template <class TArea>
 	[[nodiscard]]
@@ -2132,6 +6325,7 @@ namespace cotasklib::Co
 		}
 	}
 
+#ifndef COTASKLIB_NO_SIV3D
 	template <class TArea>
 	[[nodiscard]]
 	Task<void> WaitUntilRightClickedThenReleased(const TArea area)
@@ -2149,6 +6343,7 @@ namespace cotasklib::Co
 			co_await NextFrame();
 		}
 	}
+#endif
 
 	template <class TArea>
 	[[nodiscard]]
@@ -2253,6 +6448,84 @@ namespace cotasklib::Co
 			co_await NextFrame();
 		}
 	}
+
+	template <typename TResult>
+	auto All(Array<Task<TResult>> tasks) -> Task<Array<detail::VoidResultTypeReplace<TResult>>>
+	{
+		// 完了していないタスクのインデックス
+		// (完了したタスクは取り除き、毎フレーム残りのタスクのみresumeする)
+		Array<std::size_t> runningIndices;
+		runningIndices.reserve(tasks.size());
+		for (std::size_t i = 0; i < tasks.size(); ++i)
+		{
+			if (!tasks[i].done())
+			{
+				runningIndices.push_back(i);
+			}
+		}
+
+		while (!runningIndices.empty())
+		{
+			for (const std::size_t index : runningIndices)
+			{
+				tasks[index].resume();
+			}
+			runningIndices.remove_if([&tasks](std::size_t index) { return tasks[index].done(); });
+			if (runningIndices.empty())
+			{
+				break;
+			}
+			co_await NextFrame();
+		}
+
+		Array<detail::VoidResultTypeReplace<TResult>> results;
+		results.reserve(tasks.size());
+		for (const auto& task : tasks)
+		{
+			results.push_back(detail::ConvertVoidResult(task));
+		}
+		co_return results;
+	}
+
+	// 最初に完了したタスクのインデックスと結果を返す(同一フレームで複数完了した場合はインデックスが小さい方)
+	template <typename TResult>
+	auto Any(Array<Task<TResult>> tasks) -> Task<std::pair<std::size_t, detail::VoidResultTypeReplace<TResult>>>
+	{
+		if (tasks.empty())
+		{
+			// 完了するタスクが存在しないため、永久に待機することになる
+			throw Error{ U"Co::Any: tasks must not be empty" };
+		}
+
+		const auto fnFindDone = [&tasks]() -> Optional<std::size_t>
+			{
+				for (std::size_t i = 0; i < tasks.size(); ++i)
+				{
+					if (tasks[i].done())
+					{
+						return i;
+					}
+				}
+				return none;
+			};
+
+		Optional<std::size_t> doneIndex = fnFindDone();
+		while (!doneIndex)
+		{
+			for (auto& task : tasks)
+			{
+				task.resume();
+			}
+			doneIndex = fnFindDone();
+			if (doneIndex)
+			{
+				break;
+			}
+			co_await NextFrame();
+		}
+
+		co_return std::make_pair(*doneIndex, detail::ConvertVoidResult(tasks[*doneIndex]));
+	}
 }
 
 #ifndef NO_COTASKLIB_USING
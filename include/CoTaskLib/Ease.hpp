@@ -28,6 +28,7 @@
 
 #pragma once
 #include "Core.hpp"
+#include "TweenSystem.hpp"
 
 namespace cotasklib::Co
 {
@@ -103,6 +104,8 @@ namespace cotasklib::Co
 	class [[nodiscard]] EaseTaskBuilder
 	{
 	private:
+		friend class TweenSystem;
+
 		std::function<void(T)> m_callback;
 		Duration m_duration;
 		T m_from;
@@ -110,14 +113,19 @@ namespace cotasklib::Co
 		double(*m_easeFunc)(double);
 		ISteadyClock* m_pSteadyClock;
 
+		// 値のポインタを指定して生成された場合の代入先(TweenSystemでの再生に使用)
+		T* m_pTarget;
+		TweenSystem* m_pTweenSystem = nullptr;
+
 	public:
-		explicit EaseTaskBuilder(std::function<void(T)> callback, Duration duration, T from, T to, double(*easeFunc)(double), ISteadyClock* pSteadyClock)
+		explicit EaseTaskBuilder(std::function<void(T)> callback, Duration duration, T from, T to, double(*easeFunc)(double), ISteadyClock* pSteadyClock, T* pTarget = nullptr)
 			: m_callback(std::move(callback))
 			, m_duration(duration)
 			, m_from(std::move(from))
 			, m_to(std::move(to))
 			, m_easeFunc(easeFunc)
 			, m_pSteadyClock(pSteadyClock)
+			, m_pTarget(pTarget)
 		{
 		}
 
@@ -205,8 +213,24 @@ namespace cotasklib::Co
 			return *this;
 		}
 
+		// TweenSystemでまとめて更新する
+		// (値のポインタを指定して生成した場合のみ有効。時刻はTweenSystemの時計で判定される)
+		EaseTaskBuilder& setTweenSystem(TweenSystem* pTweenSystem)
+		{
+			m_pTweenSystem = pTweenSystem;
+			return *this;
+		}
+
 		Task<void> play()
 		{
+			if constexpr (detail::TweenSystemValue<T>)
+			{
+				if (m_pTweenSystem && m_pTarget)
+				{
+					return m_pTweenSystem->play(*this);
+				}
+			}
+
 			auto lerpedCallback = [from = m_from, to = m_to, callback = m_callback](double t)
 				{
 					callback(detail::GenericLerp(from, to, t));
@@ -229,7 +253,7 @@ namespace cotasklib::Co
 	[[nodiscard]]
 	EaseTaskBuilder<T> Ease(T* pValue, Duration duration = 0s, double easeFunc(double) = EaseOutQuad, ISteadyClock* pSteadyClock = nullptr)
 	{
-		return EaseTaskBuilder<T>([pValue](T value) { *pValue = value; }, duration, *pValue, *pValue, easeFunc, pSteadyClock);
+		return EaseTaskBuilder<T>([pValue](T value) { *pValue = value; }, duration, *pValue, *pValue, easeFunc, pSteadyClock, pValue);
 	}
 
 	template <detail::Lerpable T>
@@ -243,7 +267,7 @@ namespace cotasklib::Co
 	[[nodiscard]]
 	EaseTaskBuilder<T> LinearEase(T* pValue, Duration duration = 0s, ISteadyClock* pSteadyClock = nullptr)
 	{
-		return EaseTaskBuilder<T>([pValue](T value) { *pValue = value; }, duration, *pValue, *pValue, Easing::Linear, pSteadyClock);
+		return EaseTaskBuilder<T>([pValue](T value) { *pValue = value; }, duration, *pValue, *pValue, Easing::Linear, pSteadyClock, pValue);
 	}
 
 	template <detail::Lerpable T>
@@ -0,0 +1,256 @@
+﻿//----------------------------------------------------------------------------------------
+//
+//  CoTaskLib
+//
+//  Copyright (c) 2024 masaka
+//
+//  Licensed under the MIT License.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+//----------------------------------------------------------------------------------------
+
+#pragma once
+#include "Core.hpp"
+
+namespace cotasklib::Co
+{
+	template <typename T>
+	class Generator;
+
+	namespace detail
+	{
+		template <typename T>
+		class GeneratorPromise : public PromiseBase
+		{
+			static_assert(!std::is_reference_v<T>, "T must not be a reference type");
+			static_assert(std::is_move_constructible_v<T>, "T must be move constructible");
+			static_assert(!std::is_const_v<T>, "T must not have 'const' qualifier");
+
+		private:
+			// co_yieldされた値
+			// (コルーチンのフレーム内に格納されるため、値ごとの動的確保は発生しない)
+			ResultStorage<T> m_yieldedValue;
+			std::exception_ptr m_exception;
+
+		public:
+			GeneratorPromise() = default;
+
+			GeneratorPromise(GeneratorPromise<T>&&) noexcept = default;
+
+			GeneratorPromise<T>& operator=(GeneratorPromise<T>&&) = delete;
+
+			auto yield_value(const T& v) requires std::is_copy_constructible_v<T>
+			{
+				m_yieldedValue.emplace(v);
+				return std::suspend_always{};
+			}
+
+			auto yield_value(T&& v)
+			{
+				m_yieldedValue.emplace(std::move(v));
+				return std::suspend_always{};
+			}
+
+			void return_void()
+			{
+			}
+
+			[[nodiscard]]
+			Generator<T> get_return_object()
+			{
+				const auto handle = Generator<T>::handle_type::from_promise(*this);
+				m_handle = handle;
+				return Generator<T>{ handle };
+			}
+
+			void unhandled_exception()
+			{
+				m_exception = std::current_exception();
+			}
+
+			[[nodiscard]]
+			bool hasYieldedValue() const noexcept
+			{
+				return m_yieldedValue.hasValue() || m_exception;
+			}
+
+			// co_yieldされた値を取り出す(終了済みの場合はnoneを返す)
+			[[nodiscard]]
+			Optional<T> takeYieldedValue()
+			{
+				if (m_exception)
+				{
+					std::rethrow_exception(std::exchange(m_exception, nullptr));
+				}
+				if (!m_yieldedValue.hasValue())
+				{
+					return none;
+				}
+				return m_yieldedValue.release();
+			}
+		};
+
+		template <typename T>
+		class [[nodiscard]] GeneratorNextAwaiter : public IAwaiter
+		{
+		private:
+			using handle_type = std::coroutine_handle<GeneratorPromise<T>>;
+
+			handle_type m_handle;
+
+		public:
+			explicit GeneratorNextAwaiter(handle_type handle) noexcept
+				: m_handle(handle)
+			{
+			}
+
+			GeneratorNextAwaiter(const GeneratorNextAwaiter<T>&) = delete;
+
+			GeneratorNextAwaiter<T>& operator=(const GeneratorNextAwaiter<T>&) = delete;
+
+			GeneratorNextAwaiter(GeneratorNextAwaiter<T>&&) noexcept = default;
+
+			GeneratorNextAwaiter<T>& operator=(GeneratorNextAwaiter<T>&&) = delete;
+
+			void resume() override
+			{
+				if (done())
+				{
+					return;
+				}
+
+				// 次のco_yieldまたは終了までジェネレータを進める
+				// (ジェネレータ内でフレーム待ちをしている場合は、待機中の末端のコルーチンがresumeされる)
+				m_handle.promise().resumeInnermost();
+			}
+
+			[[nodiscard]]
+			bool done() const override
+			{
+				return !m_handle || m_handle.done() || m_handle.promise().hasYieldedValue();
+			}
+
+			[[nodiscard]]
+			bool await_ready() const
+			{
+				return done();
+			}
+
+			template <typename TPromise>
+			bool await_suspend(std::coroutine_handle<TPromise> handle) requires std::derived_from<TPromise, PromiseBase>
+			{
+				resume();
+				if (done())
+				{
+					// フレーム待ちなしで値が得られた場合は登録不要
+					return false;
+				}
+
+				// Note: co_yieldしてもジェネレータのコルーチン自体は完了しないため、
+				//       linkSubPromiseで連結せず、毎回このAwaiterを経由してresumeする
+				handle.promise().setSubAwaiter(this);
+				return true;
+			}
+
+			[[nodiscard]]
+			Optional<T> await_resume()
+			{
+				if (!m_handle)
+				{
+					return none;
+				}
+				return m_handle.promise().takeYieldedValue();
+			}
+		};
+	}
+
+	template <typename T>
+	class [[nodiscard]] Generator
+	{
+		static_assert(!std::is_reference_v<T>, "T must not be a reference type");
+		static_assert(std::is_move_constructible_v<T>, "T must be move constructible");
+		static_assert(!std::is_const_v<T>, "T must not have 'const' qualifier");
+
+	public:
+		using promise_type = detail::GeneratorPromise<T>;
+		using handle_type = std::coroutine_handle<promise_type>;
+		using value_type = T;
+
+	private:
+		handle_type m_handle;
+
+	public:
+		explicit Generator(handle_type h)
+			: m_handle(std::move(h))
+		{
+		}
+
+		Generator(const Generator<T>&) = delete;
+
+		Generator<T>& operator=(const Generator<T>&) = delete;
+
+		Generator(Generator<T>&& rhs) noexcept
+			: m_handle(std::exchange(rhs.m_handle, nullptr))
+		{
+		}
+
+		Generator<T>& operator=(Generator<T>&& rhs) = delete;
+
+		~Generator()
+		{
+			if (m_handle)
+			{
+				m_handle.destroy();
+			}
+		}
+
+		// 次にco_yieldされる値を待機する(ジェネレータが終了した場合はnoneを返す)
+		[[nodiscard]]
+		detail::GeneratorNextAwaiter<T> next()&
+		{
+			return detail::GeneratorNextAwaiter<T>{ m_handle };
+		}
+
+		[[nodiscard]]
+		bool done() const
+		{
+			return !m_handle || m_handle.done();
+		}
+
+		// co_yieldされた値ごとに関数を呼び出す
+		// (C++20ではfor co_awaitのようなループ構文がないため、範囲for文の代わりに使用する)
+		template <typename TFunc>
+		[[nodiscard]]
+		Task<void> forEach(TFunc func)&& requires std::invocable<TFunc&, T&&>
+		{
+			return [](Generator<T> generator, TFunc func) -> Task<void>
+				{
+					while (auto value = co_await generator.next())
+					{
+						func(std::move(*value));
+					}
+				}(std::move(*this), std::move(func));
+		}
+	};
+}
+
+#ifndef NO_COTASKLIB_USING
+using namespace cotasklib;
+#endif
@@ -0,0 +1,295 @@
+﻿//----------------------------------------------------------------------------------------
+//
+//  CoTaskLib
+//
+//  Copyright (c) 2024 masaka
+//
+//  Licensed under the MIT License.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+// COTASKLIB_NO_SIV3Dを定義すると、Siv3Dに依存せずにコア部分(Core.hpp)のみを使用できる
+// (その場合、Co::Initの代わりにCo::ManualBackendを生成し、フレーム更新を手動で行う)
+#ifndef COTASKLIB_NO_SIV3D
+
+#include <Siv3D.hpp>
+
+#else
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace cotasklib
+{
+	// コア部分が使用するSiv3Dの型の最小限の代替
+
+	using int8 = std::int8_t;
+	using int16 = std::int16_t;
+	using int32 = std::int32_t;
+	using int64 = std::int64_t;
+	using uint8 = std::uint8_t;
+	using uint16 = std::uint16_t;
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	template <typename T, typename Allocator = std::allocator<T>>
+	class Array : public std::vector<T, Allocator>
+	{
+	public:
+		using std::vector<T, Allocator>::vector;
+
+		template <typename Fty>
+		Array& remove_if(Fty f)
+		{
+			this->erase(std::remove_if(this->begin(), this->end(), f), this->end());
+			return *this;
+		}
+
+		[[nodiscard]]
+		bool isEmpty() const noexcept
+		{
+			return this->empty();
+		}
+	};
+
+	// Note: std::optionalとオーバーロードを区別できるよう、別名ではなく派生クラスとする
+	template <typename T>
+	class Optional : public std::optional<T>
+	{
+	public:
+		using std::optional<T>::optional;
+
+		template <typename U>
+		Optional& operator=(U&& value)
+		{
+			std::optional<T>::operator=(std::forward<U>(value));
+			return *this;
+		}
+
+		[[nodiscard]]
+		bool isEmpty() const noexcept
+		{
+			return !this->has_value();
+		}
+	};
+
+	inline constexpr std::nullopt_t none = std::nullopt;
+
+	template <typename T>
+	[[nodiscard]]
+	constexpr Optional<std::decay_t<T>> MakeOptional(T&& value)
+	{
+		return Optional<std::decay_t<T>>{ std::forward<T>(value) };
+	}
+
+	template <typename T>
+	[[nodiscard]]
+	constexpr const T& Min(const T& a, const T& b) noexcept
+	{
+		return (b < a) ? b : a;
+	}
+
+	using String = std::u32string;
+
+	using StringView = std::u32string_view;
+
+	using Duration = std::chrono::duration<double>;
+
+	using SecondsF = std::chrono::duration<double>;
+
+	template <typename TTo, typename TFrom>
+	[[nodiscard]]
+	constexpr TTo DurationCast(const TFrom& duration)
+	{
+		return std::chrono::duration_cast<TTo>(duration);
+	}
+
+	class ISteadyClock
+	{
+	public:
+		virtual ~ISteadyClock() = default;
+
+		[[nodiscard]]
+		virtual uint64 getMicrosec() = 0;
+	};
+
+	class Error : public std::exception
+	{
+	private:
+		String m_message;
+		std::string m_what;
+
+	public:
+		Error() = default;
+
+		explicit Error(StringView message)
+			: m_message(message)
+		{
+			// Note: ライブラリ内のメッセージはASCIIのみのため、UTF-8への変換は行わない
+			m_what.reserve(m_message.size());
+			for (const char32_t ch : m_message)
+			{
+				m_what.push_back(ch < 0x80 ? static_cast<char>(ch) : '?');
+			}
+		}
+
+		[[nodiscard]]
+		const char* what() const noexcept override
+		{
+			return m_what.c_str();
+		}
+
+		[[nodiscard]]
+		const String& messageW() const noexcept
+		{
+			return m_message;
+		}
+	};
+
+	// U"..."_fmt(args...)の代替(プレースホルダ"{}"に整数・文字列を順に埋め込む)
+	class FormatString
+	{
+	private:
+		StringView m_format;
+
+		static void AppendArg(String& dest, StringView arg)
+		{
+			dest.append(arg);
+		}
+
+		template <typename T>
+			requires std::is_integral_v<T>
+		static void AppendArg(String& dest, T arg)
+		{
+			for (const char ch : std::to_string(arg))
+			{
+				dest.push_back(static_cast<char32_t>(ch));
+			}
+		}
+
+		template <typename T>
+		void appendUntilArg(String& dest, std::size_t& pos, const T& arg) const
+		{
+			const std::size_t placeholderPos = m_format.find(U"{}", pos);
+			if (placeholderPos == StringView::npos)
+			{
+				return;
+			}
+			dest.append(m_format.substr(pos, placeholderPos - pos));
+			AppendArg(dest, arg);
+			pos = placeholderPos + 2;
+		}
+
+	public:
+		explicit constexpr FormatString(StringView format) noexcept
+			: m_format(format)
+		{
+		}
+
+		template <typename... Args>
+		[[nodiscard]]
+		String operator()(const Args&... args) const
+		{
+			String result;
+			std::size_t pos = 0;
+			(appendUntilArg(result, pos, args), ...);
+			result.append(m_format.substr(pos));
+			return result;
+		}
+	};
+
+	inline namespace Literals
+	{
+		[[nodiscard]]
+		constexpr FormatString operator""_fmt(const char32_t* s, std::size_t length) noexcept
+		{
+			return FormatString{ StringView{ s, length } };
+		}
+	}
+
+	using namespace std::literals;
+}
+
+#endif
+
+namespace cotasklib::Co::detail
+{
+	// 時刻とフレーム数を手動で進める時計(Co::Scheduler・Co::ManualBackendが保持する)
+	struct ManualClock
+	{
+		double time = 0.0;
+
+		int32 frameCount = 0;
+	};
+
+	// 現在のスレッドで実行中のスケジューラの時計
+	// (nullptrの場合、Siv3D環境ではScene::Time・Scene::FrameCountを使用する)
+	inline thread_local const ManualClock* s_pCurrentManualClock = nullptr;
+
+	[[nodiscard]]
+	inline double SceneTime()
+	{
+		if (s_pCurrentManualClock)
+		{
+			return s_pCurrentManualClock->time;
+		}
+#ifndef COTASKLIB_NO_SIV3D
+		return Scene::Time();
+#else
+		return 0.0;
+#endif
+	}
+
+	[[nodiscard]]
+	inline int32 SceneFrameCount()
+	{
+		if (s_pCurrentManualClock)
+		{
+			return s_pCurrentManualClock->frameCount;
+		}
+#ifndef COTASKLIB_NO_SIV3D
+		return Scene::FrameCount();
+#else
+		return 0;
+#endif
+	}
+}
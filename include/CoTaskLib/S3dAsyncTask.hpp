@@ -33,26 +33,53 @@ namespace cotasklib::Co
 {
 	namespace detail
 	{
-		template <typename TResult>
-		class S3dAsyncTaskAwaiter : public IAwaiter
+		// Siv3Dの非同期タスクの完了をupdate時にまとめて確認し、完了したものだけを起床させるAwaiterの共通部分
+		// (完了するまでの間、エントリは実行リストから外れて休止するため、待機中のタスクはresumeされない)
+		// Note: s3d::AsyncTaskやs3d::AsyncHTTPTaskは完了を通知する手段を持たないため、完了の確認はポーリングで行う。
+		//       確認は所有スレッドのみで行うため、非同期タスクは所有スレッド以外から参照されない
+		template <typename TAsyncTask>
+		class S3dAsyncAwaiterBase : public IAwaiter, public IReadyPollItem
 		{
 		private:
-			AsyncTask<TResult> m_asyncTask;
+			TAsyncTask m_asyncTask;
+
+			WaitList m_waitList;
+
 			bool m_isDone = false;
 
-		public:
-			explicit S3dAsyncTaskAwaiter(AsyncTask<TResult>&& asyncTask)
+		protected:
+			explicit S3dAsyncAwaiterBase(TAsyncTask&& asyncTask)
 				: m_asyncTask(std::move(asyncTask))
 			{
 			}
 
-			S3dAsyncTaskAwaiter(const S3dAsyncTaskAwaiter<TResult>&) = delete;
+			// 確認対象の一覧から参照されるため、コピー・ムーブしない
+			S3dAsyncAwaiterBase(const S3dAsyncAwaiterBase&) = delete;
 
-			S3dAsyncTaskAwaiter<TResult>& operator=(const S3dAsyncTaskAwaiter<TResult>&) = delete;
+			S3dAsyncAwaiterBase& operator=(const S3dAsyncAwaiterBase&) = delete;
+
+			~S3dAsyncAwaiterBase()
+			{
+				Backend::UnpollReady(this);
+			}
 
-			S3dAsyncTaskAwaiter(S3dAsyncTaskAwaiter<TResult>&&) noexcept = default;
+			[[nodiscard]]
+			TAsyncTask& asyncTask() noexcept
+			{
+				return m_asyncTask;
+			}
 
-			S3dAsyncTaskAwaiter<TResult>& operator=(S3dAsyncTaskAwaiter<TResult>&&) = delete;
+		public:
+			bool isReady() override
+			{
+				return m_asyncTask.isReady();
+			}
+
+			void onReady() override
+			{
+				m_isDone = true;
+				m_waitList.wakeAll();
+			}
 
 			void resume() override
 			{
@@ -60,7 +87,21 @@ namespace cotasklib::Co
 				{
 					return;
 				}
-				m_isDone = m_asyncTask.isReady();
+
+				if (!isPolling())
+				{
+					if (m_asyncTask.isReady())
+					{
+						m_isDone = true;
+						return;
+					}
+
+					// 以降、完了の確認はupdate時にまとめて行う
+					Backend::PollReady(this);
+				}
+
+				// 完了が確認されるまでエントリごと休止する(休止できない場合は毎フレームresumeされる)
+				(void)m_waitList.waitCurrent();
 			}
 
 			bool done() const override
@@ -73,8 +114,8 @@ namespace cotasklib::Co
 				return m_isDone;
 			}
 
-			template <typename TResultOther>
-			bool await_suspend(std::coroutine_handle<detail::Promise<TResultOther>> handle)
+			template <typename TPromise>
+			bool await_suspend(std::coroutine_handle<TPromise> handle) requires std::derived_from<TPromise, PromiseBase>
 			{
 				resume();
 				if (m_isDone)
@@ -85,77 +126,79 @@ namespace cotasklib::Co
 				handle.promise().setSubAwaiter(this);
 				return true;
 			}
+		};
+
+		template <typename TResult>
+		class S3dAsyncTaskAwaiter : public S3dAsyncAwaiterBase<AsyncTask<TResult>>
+		{
+		public:
+			explicit S3dAsyncTaskAwaiter(AsyncTask<TResult>&& asyncTask)
+				: S3dAsyncAwaiterBase<AsyncTask<TResult>>(std::move(asyncTask))
+			{
+			}
+
+			S3dAsyncTaskAwaiter(const S3dAsyncTaskAwaiter<TResult>&) = delete;
+
+			S3dAsyncTaskAwaiter<TResult>& operator=(const S3dAsyncTaskAwaiter<TResult>&) = delete;
 
 			TResult await_resume()
 			{
-				return m_asyncTask.get();
+				return this->asyncTask().get();
 			}
 		};
 
-		class S3dAsyncHTTPTaskAwaiter : public IAwaiter
+		class S3dAsyncHTTPTaskAwaiter : public S3dAsyncAwaiterBase<AsyncHTTPTask>
 		{
-		private:
-			AsyncHTTPTask m_asyncHTTPTask;
-			bool m_isDone = false;
-
 		public:
 			explicit S3dAsyncHTTPTaskAwaiter(AsyncHTTPTask&& asyncHTTPTask)
-				: m_asyncHTTPTask(std::move(asyncHTTPTask))
+				: S3dAsyncAwaiterBase<AsyncHTTPTask>(std::move(asyncHTTPTask))
 			{
 			}
 
 			explicit S3dAsyncHTTPTaskAwaiter(const AsyncHTTPTask& asyncHTTPTask)
-				: m_asyncHTTPTask(asyncHTTPTask)
+				: S3dAsyncAwaiterBase<AsyncHTTPTask>(AsyncHTTPTask{ asyncHTTPTask })
 			{
 			}
 
-			// AwaitHTTPTaskはコピー可能だが、他に合わせて保守的にコピー・ムーブ代入禁止にしている
-
 			S3dAsyncHTTPTaskAwaiter(const S3dAsyncHTTPTaskAwaiter&) = delete;
 
 			S3dAsyncHTTPTaskAwaiter& operator=(const S3dAsyncHTTPTaskAwaiter&) = delete;
 
-			S3dAsyncHTTPTaskAwaiter(S3dAsyncHTTPTaskAwaiter&&) = default;
-
-			S3dAsyncHTTPTaskAwaiter& operator=(S3dAsyncHTTPTaskAwaiter&&) = delete;
-
-			void resume() override
-			{
-				if (m_isDone)
-				{
-					return;
-				}
-				m_isDone = m_asyncHTTPTask.isReady();
-			}
-
-			bool done() const override
+			HTTPResponse await_resume()
 			{
-				return m_isDone;
+				return asyncTask().getResponse();
 			}
+		};
+	}
 
-			bool await_ready() const
+	// s3d::Asyncで関数を別スレッドで実行し、完了まで待機して結果を返す
+	// (関数を実行したスレッドから完了を通知するため、s3d::AsyncTaskをco_awaitする場合と異なり完了の確認は行わない。関数内で発生した例外は待機しているタスクへ再送出される)
+	// Note: 関数はメインスレッド以外で実行されるため、関数内でCo名前空間の機能やSiv3Dの描画機能などを使用しないこと
+	template <typename TFunc, typename... TArgs>
+	[[nodiscard]]
+	Task<std::invoke_result_t<TFunc&, TArgs&...>> Async(TFunc func, TArgs... args)
+	{
+		using TResult = std::invoke_result_t<TFunc&, TArgs&...>;
+		auto boundFunc = [func = std::move(func), ...args = std::move(args)]() mutable -> TResult
 			{
-				return m_isDone;
-			}
+				return std::invoke(func, args...);
+			};
+		using Job = detail::ThreadPoolJob<TResult, decltype(boundFunc)>;
+		const auto job = std::make_shared<Job>(std::move(boundFunc), detail::Backend::CurrentCompletionQueue());
 
-			template <typename TResult>
-			bool await_suspend(std::coroutine_handle<detail::Promise<TResult>> handle)
+		// Note: タスクの破棄時は、未実行であれば関数を実行しないよう要求してから、s3d::AsyncTaskの破棄によりスレッドの終了を待つ
+		const AsyncTask<void> asyncTask = s3d::Async([self = std::shared_ptr<detail::IThreadPoolJob>{ job }]() mutable
 			{
-				resume();
-				if (m_isDone)
-				{
-					// フレーム待ちなしで終了した場合は登録不要
-					return false;
-				}
-				handle.promise().setSubAwaiter(this);
-				return true;
-			}
+				detail::IThreadPoolJob* const pJob = self.get();
+				pJob->run(std::move(self));
+			});
+		const detail::ThreadPoolJobCancelGuard cancelGuard{ job.get() };
 
-			HTTPResponse await_resume()
-			{
-				return m_asyncHTTPTask.getResponse();
-			}
-		};
+		while (!job->isCompleted())
+		{
+			co_await job->waitList().wait();
+		}
+		co_return job->release();
 	}
 }
 
@@ -77,6 +77,8 @@ namespace cotasklib::Co
 
 		TaskFinishSource<SceneFactory> m_taskFinishSource;
 
+		std::unique_ptr<FrameArena> m_frameArena;
+
 		[[nodiscard]]
 		Task<void> startAndFadeOut()
 		{
@@ -209,6 +211,13 @@ namespace cotasklib::Co
 			}
 		}
 
+		// シーン内で生成されるタスクのフレームを、シーン専用のフレームアリーナから確保する
+		// (シーンの開始前に有効にする必要があるため、コンストラクタ内で呼び出すこと)
+		void enableFrameArena(std::size_t chunkSize = FrameArena::DefaultChunkSize)
+		{
+			m_frameArena = std::make_unique<FrameArena>(chunkSize);
+		}
+
 	public:
 		explicit SceneBase(Layer layer = Layer::Default, int32 drawIndex = DrawIndex::Default)
 			: m_layer(layer)
@@ -274,6 +283,13 @@ namespace cotasklib::Co
 
 		// 右辺値参照の場合はタスク実行中にthisがダングリングポインタになるため、使用しようとした場合はコンパイルエラーとする
 		Task<SceneFactory> playInternal() && = delete;
+
+		// ライブラリ内部で使用するためのフレームアリーナ取得関数
+		[[nodiscard]]
+		FrameArena* frameArenaInternal() const noexcept
+		{
+			return m_frameArena.get();
+		}
 	};
 
 	// 毎フレーム呼ばれるupdate関数を記述するタイプのシーン基底クラス
@@ -320,6 +336,18 @@ namespace cotasklib::Co
 
 	namespace detail
 	{
+		// シーンのフレームアリーナが有効な場合は、シーン内で生成されるタスクのフレームをアリーナから確保する
+		[[nodiscard]]
+		inline Task<SceneFactory> PlaySceneInternal(SceneBase& scene)
+		{
+			if (FrameArena* pFrameArena = scene.frameArenaInternal())
+			{
+				const ScopedFrameArena scopedFrameArena{ *pFrameArena };
+				return scene.playInternal();
+			}
+			return scene.playInternal();
+		}
+
 		[[nodiscard]]
 		inline Task<void> ScenePtrToTask(std::unique_ptr<SceneBase> scene)
 		{
@@ -327,7 +355,7 @@ namespace cotasklib::Co
 
 			while (true)
 			{
-				const SceneFactory nextSceneFactory = co_await currentScene->playInternal();
+				const SceneFactory nextSceneFactory = co_await PlaySceneInternal(*currentScene);
 
 				// 次シーンがなければ抜ける
 				if (nextSceneFactory == nullptr)
@@ -0,0 +1,366 @@
+﻿//----------------------------------------------------------------------------------------
+//
+//  CoTaskLib
+//
+//  Copyright (c) 2024 masaka
+//
+//  Licensed under the MIT License.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+//----------------------------------------------------------------------------------------
+
+#pragma once
+#include "Core.hpp"
+
+namespace cotasklib::Co
+{
+	class ScopedSemaphorePermit;
+
+	namespace detail
+	{
+		// 許可を待機中のタスク
+		// (acquireのコルーチンのフレーム内に確保される)
+		struct SemaphoreWaiter
+		{
+			WaitList waitList;
+
+			// 解放された許可が譲渡されたかどうか
+			bool isGranted = false;
+		};
+
+		// セマフォの状態
+		// (待機中のタスクや許可がセマフォより長く生存しうるため、セマフォとは別に確保する)
+		class SemaphoreState
+		{
+		private:
+			std::size_t m_available;
+
+			std::size_t m_maxCount;
+
+			// 許可を待機中のタスク(待機開始順)
+			std::deque<SemaphoreWaiter*> m_waiters;
+
+		public:
+			explicit SemaphoreState(std::size_t maxCount)
+				: m_available(maxCount)
+				, m_maxCount(maxCount)
+			{
+			}
+
+			[[nodiscard]]
+			bool tryAcquire() noexcept
+			{
+				// Note: 待機中のタスクがある場合、解放された許可は直接譲渡されるためm_availableは0のまま
+				if (m_available == 0)
+				{
+					return false;
+				}
+				--m_available;
+				return true;
+			}
+
+			void release()
+			{
+				if (m_waiters.empty())
+				{
+					if (m_available >= m_maxCount)
+					{
+						throw Error{ U"Semaphore: released more than acquired" };
+					}
+					++m_available;
+					return;
+				}
+
+				// 先頭の待機中タスクにのみ許可を譲渡して起床させる
+				SemaphoreWaiter* const pWaiter = m_waiters.front();
+				m_waiters.pop_front();
+				pWaiter->isGranted = true;
+				pWaiter->waitList.wakeAll();
+			}
+
+			void addWaiter(SemaphoreWaiter* pWaiter)
+			{
+				m_waiters.push_back(pWaiter);
+			}
+
+			// 許可の譲渡前に待機をやめた場合に呼び出す
+			void removeWaiter(SemaphoreWaiter* pWaiter)
+			{
+				const auto it = std::find(m_waiters.begin(), m_waiters.end(), pWaiter);
+				if (it != m_waiters.end())
+				{
+					m_waiters.erase(it);
+				}
+			}
+
+			[[nodiscard]]
+			std::size_t available() const noexcept
+			{
+				return m_available;
+			}
+
+			[[nodiscard]]
+			std::size_t waiterCount() const noexcept
+			{
+				return m_waiters.size();
+			}
+		};
+
+		// 許可の待機を終える前にタスクが破棄された場合に、待機列から外す
+		class SemaphoreWaitGuard
+		{
+		private:
+			SemaphoreState* m_pState;
+			SemaphoreWaiter* m_pWaiter;
+			bool m_isPermitTaken = false;
+
+		public:
+			SemaphoreWaitGuard(SemaphoreState* pState, SemaphoreWaiter* pWaiter)
+				: m_pState(pState)
+				, m_pWaiter(pWaiter)
+			{
+				m_pState->addWaiter(m_pWaiter);
+			}
+
+			SemaphoreWaitGuard(const SemaphoreWaitGuard&) = delete;
+
+			SemaphoreWaitGuard& operator=(const SemaphoreWaitGuard&) = delete;
+
+			~SemaphoreWaitGuard()
+			{
+				if (m_isPermitTaken)
+				{
+					return;
+				}
+
+				if (m_pWaiter->isGranted)
+				{
+					// 譲渡された許可を受け取る前に破棄された場合は、次の待機中タスクへ譲渡する
+					m_pState->release();
+				}
+				else
+				{
+					m_pState->removeWaiter(m_pWaiter);
+				}
+			}
+
+			void takePermit() noexcept
+			{
+				m_isPermitTaken = true;
+			}
+		};
+	}
+
+	// セマフォの許可
+	// (破棄時に許可を解放する)
+	class [[nodiscard]] ScopedSemaphorePermit
+	{
+	private:
+		std::shared_ptr<detail::SemaphoreState> m_state;
+
+	public:
+		ScopedSemaphorePermit() = default;
+
+		explicit ScopedSemaphorePermit(std::shared_ptr<detail::SemaphoreState> state) noexcept
+			: m_state(std::move(state))
+		{
+		}
+
+		ScopedSemaphorePermit(const ScopedSemaphorePermit&) = delete;
+
+		ScopedSemaphorePermit& operator=(const ScopedSemaphorePermit&) = delete;
+
+		ScopedSemaphorePermit(ScopedSemaphorePermit&&) noexcept = default;
+
+		ScopedSemaphorePermit& operator=(ScopedSemaphorePermit&& rhs)
+		{
+			if (this != &rhs)
+			{
+				release();
+				m_state = std::move(rhs.m_state);
+			}
+			return *this;
+		}
+
+		~ScopedSemaphorePermit()
+		{
+			release();
+		}
+
+		// 破棄を待たずに許可を解放する
+		void release()
+		{
+			if (m_state)
+			{
+				std::exchange(m_state, nullptr)->release();
+			}
+		}
+
+		[[nodiscard]]
+		bool owns() const noexcept
+		{
+			return m_state != nullptr;
+		}
+
+		[[nodiscard]]
+		explicit operator bool() const noexcept
+		{
+			return owns();
+		}
+	};
+
+	using ScopedMutexLock = ScopedSemaphorePermit;
+
+	namespace detail
+	{
+		[[nodiscard]]
+		inline Task<ScopedSemaphorePermit> SemaphoreAcquire(std::shared_ptr<SemaphoreState> state)
+		{
+			if (state->tryAcquire())
+			{
+				co_return ScopedSemaphorePermit{ std::move(state) };
+			}
+
+			SemaphoreWaiter waiter;
+			SemaphoreWaitGuard waitGuard{ state.get(), &waiter };
+			while (!waiter.isGranted)
+			{
+				// 許可が譲渡された時点で起床される
+				co_await waiter.waitList.wait();
+			}
+			waitGuard.takePermit();
+			co_return ScopedSemaphorePermit{ std::move(state) };
+		}
+	}
+
+	// 同時に許可を保持できるタスク数に上限のあるセマフォ
+	// (許可を待機中のタスクは待機開始順に並び、許可が解放されると先頭のタスクのみが起床される)
+	// Note: 生成・待機・許可の解放は同じスケジューラのスレッドで行うこと
+	class [[nodiscard]] Semaphore
+	{
+	private:
+		std::shared_ptr<detail::SemaphoreState> m_state;
+
+	public:
+		explicit Semaphore(std::size_t maxCount)
+			: m_state(std::make_shared<detail::SemaphoreState>(maxCount))
+		{
+			if (maxCount == 0)
+			{
+				throw Error{ U"Semaphore: maxCount must be greater than 0" };
+			}
+		}
+
+		Semaphore(const Semaphore&) = delete;
+
+		Semaphore& operator=(const Semaphore&) = delete;
+
+		Semaphore(Semaphore&&) noexcept = default;
+
+		Semaphore& operator=(Semaphore&&) = delete;
+
+		~Semaphore() noexcept = default;
+
+		// 許可を取得できるまで待機する
+		[[nodiscard]]
+		Task<ScopedSemaphorePermit> acquire()
+		{
+			return detail::SemaphoreAcquire(m_state);
+		}
+
+		// 許可を取得できない場合はnoneを返す
+		[[nodiscard]]
+		Optional<ScopedSemaphorePermit> tryAcquire()
+		{
+			if (!m_state->tryAcquire())
+			{
+				return none;
+			}
+			return ScopedSemaphorePermit{ m_state };
+		}
+
+		// 現在取得可能な許可の数
+		[[nodiscard]]
+		std::size_t available() const noexcept
+		{
+			return m_state->available();
+		}
+
+		// 許可を待機中のタスクの数
+		[[nodiscard]]
+		std::size_t waiterCount() const noexcept
+		{
+			return m_state->waiterCount();
+		}
+	};
+
+	// タスク間の排他制御を行うミューテックス
+	// (ロックを待機中のタスクは待機開始順に並び、ロックが解放されると先頭のタスクのみが起床される)
+	// Note: 生成・待機・ロックの解放は同じスケジューラのスレッドで行うこと
+	class [[nodiscard]] Mutex
+	{
+	private:
+		Semaphore m_semaphore{ 1 };
+
+	public:
+		Mutex() = default;
+
+		Mutex(const Mutex&) = delete;
+
+		Mutex& operator=(const Mutex&) = delete;
+
+		Mutex(Mutex&&) noexcept = default;
+
+		Mutex& operator=(Mutex&&) = delete;
+
+		~Mutex() noexcept = default;
+
+		// ロックを取得できるまで待機する
+		[[nodiscard]]
+		Task<ScopedMutexLock> lock()
+		{
+			return m_semaphore.acquire();
+		}
+
+		// ロックを取得できない場合はnoneを返す
+		[[nodiscard]]
+		Optional<ScopedMutexLock> tryLock()
+		{
+			return m_semaphore.tryAcquire();
+		}
+
+		[[nodiscard]]
+		bool isLocked() const noexcept
+		{
+			return m_semaphore.available() == 0;
+		}
+
+		// ロックを待機中のタスクの数
+		[[nodiscard]]
+		std::size_t waiterCount() const noexcept
+		{
+			return m_semaphore.waiterCount();
+		}
+	};
+}
+
+#ifndef NO_COTASKLIB_USING
+using namespace cotasklib;
+#endif
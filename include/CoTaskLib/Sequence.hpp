@@ -271,20 +271,20 @@ namespace cotasklib::Co
 		Task<TResult> play() && = delete;
 
 		[[nodiscard]]
-		ScopedTaskRunner playScoped(FinishCallbackType<TResult> finishCallback = nullptr, std::function<void()> cancelCallback = nullptr)&
+		ScopedTaskRunner playScoped(FinishCallbackType<TResult> finishCallback = nullptr, CancelCallbackType cancelCallback = nullptr)&
 		{
 			return play().runScoped(std::move(finishCallback), std::move(cancelCallback));
 		}
 
 		[[nodiscard]]
-		ScopedTaskRunner playScoped(FinishCallbackType<TResult> finishCallback = nullptr, std::function<void()> cancelCallback = nullptr) && = delete;
+		ScopedTaskRunner playScoped(FinishCallbackType<TResult> finishCallback = nullptr, CancelCallbackType cancelCallback = nullptr) && = delete;
 
-		void playAddTo(MultiRunner& mr, FinishCallbackType<TResult> finishCallback = nullptr, std::function<void()> cancelCallback = nullptr)&
+		void playAddTo(MultiRunner& mr, FinishCallbackType<TResult> finishCallback = nullptr, CancelCallbackType cancelCallback = nullptr)&
 		{
 			play().runAddTo(mr, std::move(finishCallback), std::move(cancelCallback));
 		}
 
-		void playAddTo(MultiRunner& mr, FinishCallbackType<TResult> finishCallback = nullptr, std::function<void()> cancelCallback = nullptr) && = delete;
+		void playAddTo(MultiRunner& mr, FinishCallbackType<TResult> finishCallback = nullptr, CancelCallbackType cancelCallback = nullptr) && = delete;
 
 		[[nodiscard]]
 		bool done() const
@@ -0,0 +1,857 @@
+﻿//----------------------------------------------------------------------------------------
+//
+//  CoTaskLib
+//
+//  Copyright (c) 2024 masaka
+//
+//  Licensed under the MIT License.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+//----------------------------------------------------------------------------------------
+
+#pragma once
+#include "Platform.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+
+namespace cotasklib::Co
+{
+	// スレッドプールで実行するジョブの優先度
+	// (優先度の高いジョブから順に取り出して実行する)
+	enum class ThreadPoolPriority : uint8
+	{
+		Low,
+		Normal,
+		High,
+	};
+
+	namespace detail
+	{
+		inline constexpr std::size_t ThreadPoolPriorityCount = 3;
+
+		// 別スレッドで完了し、所有スレッドのCompletionQueueから通知される処理
+		class ICompletion
+		{
+		private:
+			friend class CompletionQueue;
+
+			ICompletion* m_pNextCompletion = nullptr;
+
+		public:
+			virtual ~ICompletion() = default;
+
+			// 所有スレッドでCompletionQueue::drainを呼んだ際に呼ばれる
+			virtual void onComplete() = 0;
+		};
+
+		// 任意のスレッドから完了を追加し、所有スレッドでまとめて取り出すキュー
+		// (追加はロックフリーで、取り出しは所有スレッドのみが行う)
+		class CompletionQueue
+		{
+		private:
+			std::atomic<ICompletion*> m_pHead = nullptr;
+
+		public:
+			CompletionQueue() = default;
+
+			CompletionQueue(const CompletionQueue&) = delete;
+
+			CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+			~CompletionQueue()
+			{
+				drain();
+			}
+
+			// 任意のスレッドから呼び出せる
+			void push(ICompletion* pCompletion) noexcept
+			{
+				ICompletion* pHead = m_pHead.load(std::memory_order_relaxed);
+				do
+				{
+					pCompletion->m_pNextCompletion = pHead;
+				} while (!m_pHead.compare_exchange_weak(pHead, pCompletion, std::memory_order_release, std::memory_order_relaxed));
+			}
+
+			[[nodiscard]]
+			bool isEmpty() const noexcept
+			{
+				return m_pHead.load(std::memory_order_relaxed) == nullptr;
+			}
+
+			// 所有スレッドから呼び出し、追加された順にonCompleteを呼ぶ
+			void drain()
+			{
+				ICompletion* pHead = m_pHead.exchange(nullptr, std::memory_order_acquire);
+				if (pHead == nullptr)
+				{
+					return;
+				}
+
+				// 後から追加したものが先頭に来ているため、逆順にしてから通知する
+				ICompletion* pReversed = nullptr;
+				while (pHead)
+				{
+					ICompletion* const pNext = pHead->m_pNextCompletion;
+					pHead->m_pNextCompletion = pReversed;
+					pReversed = pHead;
+					pHead = pNext;
+				}
+
+				while (pReversed)
+				{
+					// onComplete内で自身が破棄される場合があるため、先に次の要素を取得しておく
+					ICompletion* const pNext = pReversed->m_pNextCompletion;
+					pReversed->m_pNextCompletion = nullptr;
+					pReversed->onComplete();
+					pReversed = pNext;
+				}
+			}
+		};
+
+		// 固定容量のロックフリーなキュー
+		// (任意のスレッドから追加・取り出しでき、要素の領域は生成時にまとめて確保する)
+		template <typename T>
+		class BoundedMPMCQueue
+		{
+		private:
+			struct Cell
+			{
+				// 追加・取り出しの順番を表す通し番号(要素が有効かどうかの判定に使用する)
+				std::atomic<std::size_t> sequence;
+
+				alignas(T) std::byte storage[sizeof(T)];
+
+				[[nodiscard]]
+				T* value() noexcept
+				{
+					return std::launder(reinterpret_cast<T*>(storage));
+				}
+			};
+
+			std::unique_ptr<Cell[]> m_cells;
+
+			std::size_t m_mask;
+
+			// 要求された容量(セル数が2のべき乗に切り上げられた場合は、要素数をこの値までに制限する)
+			std::size_t m_capacity;
+
+			alignas(64) std::atomic<std::size_t> m_enqueuePos = 0;
+
+			alignas(64) std::atomic<std::size_t> m_dequeuePos = 0;
+
+			// セル数は2のべき乗とする(1セルでは満杯と空の区別がつかないため、最小2セル)
+			[[nodiscard]]
+			static std::size_t RoundUpCellCount(std::size_t capacity)
+			{
+				if (capacity == 0)
+				{
+					throw Error{ U"BoundedMPMCQueue: capacity must be greater than 0" };
+				}
+				std::size_t roundedCapacity = 2;
+				while (roundedCapacity < capacity)
+				{
+					roundedCapacity *= 2;
+				}
+				return roundedCapacity;
+			}
+
+		public:
+			// 容量が2のべき乗でない場合も、要素数は容量までに制限する
+			explicit BoundedMPMCQueue(std::size_t capacity)
+				: m_cells(std::make_unique<Cell[]>(RoundUpCellCount(capacity)))
+				, m_mask(RoundUpCellCount(capacity) - 1)
+				, m_capacity(capacity)
+			{
+				for (std::size_t i = 0; i <= m_mask; ++i)
+				{
+					m_cells[i].sequence.store(i, std::memory_order_relaxed);
+				}
+			}
+
+			BoundedMPMCQueue(const BoundedMPMCQueue&) = delete;
+
+			BoundedMPMCQueue& operator=(const BoundedMPMCQueue&) = delete;
+
+			~BoundedMPMCQueue()
+			{
+				while (tryPop())
+				{
+				}
+			}
+
+			// 満杯の場合はfalseを返す(その場合、valueはムーブされない)
+			[[nodiscard]]
+			bool tryPush(T&& value) noexcept(std::is_nothrow_move_constructible_v<T>)
+			{
+				std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+				Cell* pCell;
+				while (true)
+				{
+					pCell = &m_cells[pos & m_mask];
+					const std::size_t sequence = pCell->sequence.load(std::memory_order_acquire);
+					const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+					if (diff == 0)
+					{
+						// 取り出し位置は増加する一方のため、古い値を読んだ場合も要素数が容量を超えることはない
+						// (セル数と容量が一致する場合は、セルの通し番号の判定のみで足りる)
+						if (m_capacity <= m_mask && pos - m_dequeuePos.load(std::memory_order_relaxed) >= m_capacity)
+						{
+							return false;
+						}
+						if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						{
+							break;
+						}
+					}
+					else if (diff < 0)
+					{
+						return false;
+					}
+					else
+					{
+						pos = m_enqueuePos.load(std::memory_order_relaxed);
+					}
+				}
+				new (pCell->storage) T(std::move(value));
+				pCell->sequence.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+
+			// 空の場合はnoneを返す
+			[[nodiscard]]
+			Optional<T> tryPop()
+			{
+				std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+				Cell* pCell;
+				while (true)
+				{
+					pCell = &m_cells[pos & m_mask];
+					const std::size_t sequence = pCell->sequence.load(std::memory_order_acquire);
+					const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+					if (diff == 0)
+					{
+						if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						{
+							break;
+						}
+					}
+					else if (diff < 0)
+					{
+						return none;
+					}
+					else
+					{
+						pos = m_dequeuePos.load(std::memory_order_relaxed);
+					}
+				}
+				Optional<T> value{ std::move(*pCell->value()) };
+				pCell->value()->~T();
+				pCell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+				return value;
+			}
+
+			[[nodiscard]]
+			std::size_t capacity() const noexcept
+			{
+				return m_capacity;
+			}
+		};
+
+		template <typename TSignature, std::size_t InlineSizeValue = 48>
+		class InplaceFunction;
+
+		// ムーブのみ可能な関数オブジェクトの型消去
+		// (小さな関数オブジェクトは動的確保せずに内部の領域へ格納する)
+		template <typename TResult, typename... TArgs, std::size_t InlineSizeValue>
+		class InplaceFunction<TResult(TArgs...), InlineSizeValue>
+		{
+		public:
+			static constexpr std::size_t InlineSize = InlineSizeValue;
+
+		private:
+			struct Operations
+			{
+				TResult (*invoke)(void* pStorage, TArgs&&... args);
+				void (*moveTo)(void* pSrcStorage, void* pDstStorage) noexcept;
+				void (*destroy)(void* pStorage) noexcept;
+			};
+
+			template <typename TFunc>
+			static constexpr bool IsInline = sizeof(TFunc) <= InlineSize
+				&& alignof(TFunc) <= alignof(std::max_align_t)
+				&& std::is_nothrow_move_constructible_v<TFunc>;
+
+			template <typename TFunc>
+			struct InlineOperations
+			{
+				static TResult Invoke(void* pStorage, TArgs&&... args)
+				{
+					return (*static_cast<TFunc*>(pStorage))(std::forward<TArgs>(args)...);
+				}
+
+				static void MoveTo(void* pSrcStorage, void* pDstStorage) noexcept
+				{
+					new (pDstStorage) TFunc(std::move(*static_cast<TFunc*>(pSrcStorage)));
+					static_cast<TFunc*>(pSrcStorage)->~TFunc();
+				}
+
+				static void Destroy(void* pStorage) noexcept
+				{
+					static_cast<TFunc*>(pStorage)->~TFunc();
+				}
+
+				static constexpr Operations Value{ &Invoke, &MoveTo, &Destroy };
+			};
+
+			// 内部の領域に収まらない関数オブジェクトは、動的確保してポインタを格納する
+			template <typename TFunc>
+			struct HeapOperations
+			{
+				static TResult Invoke(void* pStorage, TArgs&&... args)
+				{
+					return (**static_cast<TFunc**>(pStorage))(std::forward<TArgs>(args)...);
+				}
+
+				static void MoveTo(void* pSrcStorage, void* pDstStorage) noexcept
+				{
+					*static_cast<TFunc**>(pDstStorage) = *static_cast<TFunc**>(pSrcStorage);
+				}
+
+				static void Destroy(void* pStorage) noexcept
+				{
+					delete *static_cast<TFunc**>(pStorage);
+				}
+
+				static constexpr Operations Value{ &Invoke, &MoveTo, &Destroy };
+			};
+
+			// 関数ポインタやstd::functionなど、空の状態を持つ関数オブジェクトか
+			template <typename TFunc>
+			static constexpr bool IsNullable = std::is_pointer_v<TFunc>
+				|| std::is_member_pointer_v<TFunc>
+				|| std::is_same_v<TFunc, std::function<TResult(TArgs...)>>;
+
+			alignas(std::max_align_t) std::byte m_storage[InlineSize];
+
+			const Operations* m_pOperations = nullptr;
+
+		public:
+			InplaceFunction() = default;
+
+			InplaceFunction(std::nullptr_t) noexcept
+			{
+			}
+
+			template <typename TFunc>
+				requires (!std::same_as<std::remove_cvref_t<TFunc>, InplaceFunction>) && std::is_invocable_r_v<TResult, std::decay_t<TFunc>&, TArgs...>
+			InplaceFunction(TFunc&& func)
+			{
+				using Func = std::decay_t<TFunc>;
+				if constexpr (IsNullable<Func>)
+				{
+					if (!func)
+					{
+						// 空の関数オブジェクトは空として扱う
+						return;
+					}
+				}
+				if constexpr (IsInline<Func>)
+				{
+					new (m_storage) Func(std::forward<TFunc>(func));
+					m_pOperations = &InlineOperations<Func>::Value;
+				}
+				else
+				{
+					*reinterpret_cast<Func**>(m_storage) = new Func(std::forward<TFunc>(func));
+					m_pOperations = &HeapOperations<Func>::Value;
+				}
+			}
+
+			InplaceFunction(const InplaceFunction&) = delete;
+
+			InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+			InplaceFunction(InplaceFunction&& rhs) noexcept
+				: m_pOperations(std::exchange(rhs.m_pOperations, nullptr))
+			{
+				if (m_pOperations)
+				{
+					m_pOperations->moveTo(rhs.m_storage, m_storage);
+				}
+			}
+
+			InplaceFunction& operator=(InplaceFunction&& rhs) noexcept
+			{
+				if (this != &rhs)
+				{
+					reset();
+					m_pOperations = std::exchange(rhs.m_pOperations, nullptr);
+					if (m_pOperations)
+					{
+						m_pOperations->moveTo(rhs.m_storage, m_storage);
+					}
+				}
+				return *this;
+			}
+
+			~InplaceFunction()
+			{
+				reset();
+			}
+
+			void reset() noexcept
+			{
+				if (m_pOperations)
+				{
+					m_pOperations->destroy(m_storage);
+					m_pOperations = nullptr;
+				}
+			}
+
+			TResult operator()(TArgs... args)
+			{
+				return m_pOperations->invoke(m_storage, std::forward<TArgs>(args)...);
+			}
+
+			[[nodiscard]]
+			explicit operator bool() const noexcept
+			{
+				return m_pOperations != nullptr;
+			}
+		};
+
+		// 他のスレッドからメインスレッドへ渡す関数
+		using PostedFunction = InplaceFunction<void()>;
+
+		// 任意のスレッドからメインスレッドへ関数を渡すキュー
+		// (Co::InitまたはCo::ManualBackendで最初に登録されたインスタンスが保持し、update時にまとめて実行する)
+		// (同じスレッドから渡した関数や、スレッド間で同期を取って順番に渡した関数は、渡した順に実行される。同期を取らずに複数のスレッドから渡した関数同士の順序は保証しない)
+		class MainThreadPostQueue
+		{
+		public:
+			static constexpr std::size_t Capacity = 1024;
+
+		private:
+			// 関数を受け付けるキュー(保持するインスタンスが登録されている間のみ設定される)
+			static inline std::atomic<MainThreadPostQueue*> s_pRegisteredQueue = nullptr;
+
+			// post中のスレッド数(登録の解除時に、post中のスレッドがキューを参照し終えるまで待つため)
+			static inline std::atomic<std::size_t> s_numPostingThreads = 0;
+
+			BoundedMPMCQueue<PostedFunction> m_queue{ Capacity };
+
+			// キューが満杯の場合の退避先
+			// (メインスレッドでも退避先が空でない場合のみロックし、空の間はアトミック変数の確認のみ行う)
+			std::mutex m_overflowMutex;
+
+			std::vector<PostedFunction> m_overflowFunctions;
+
+			std::atomic<bool> m_hasOverflow = false;
+
+			bool m_isRegistered = false;
+
+			void push(PostedFunction&& func)
+			{
+				if (!m_hasOverflow.load(std::memory_order_acquire) && m_queue.tryPush(std::move(func)))
+				{
+					return;
+				}
+
+				// 実行順を保つため、退避先が空になるまでは以降の関数も退避先へ追加する
+				const std::lock_guard lock{ m_overflowMutex };
+				m_overflowFunctions.push_back(std::move(func));
+				m_hasOverflow.store(true, std::memory_order_release);
+			}
+
+		public:
+			MainThreadPostQueue() = default;
+
+			MainThreadPostQueue(const MainThreadPostQueue&) = delete;
+
+			MainThreadPostQueue& operator=(const MainThreadPostQueue&) = delete;
+
+			// 未実行の関数は実行せずに破棄する
+			~MainThreadPostQueue()
+			{
+				unregister();
+			}
+
+			// 任意のスレッドから呼び出せる
+			// (関数を受け付けるキューが登録されていない場合はfalseを返す。その場合、関数は実行されずに破棄される)
+			static bool Post(PostedFunction&& func)
+			{
+				// Note: 登録の解除とすれ違わないよう、キューの取得より前にpost中であることを公開する
+				s_numPostingThreads.fetch_add(1, std::memory_order_seq_cst);
+				MainThreadPostQueue* const pQueue = s_pRegisteredQueue.load(std::memory_order_seq_cst);
+				try
+				{
+					if (pQueue)
+					{
+						pQueue->push(std::move(func));
+					}
+				}
+				catch (...)
+				{
+					s_numPostingThreads.fetch_sub(1, std::memory_order_release);
+					throw;
+				}
+				s_numPostingThreads.fetch_sub(1, std::memory_order_release);
+				return pQueue != nullptr;
+			}
+
+			[[nodiscard]]
+			static bool HasRegisteredQueue() noexcept
+			{
+				return s_pRegisteredQueue.load(std::memory_order_acquire) != nullptr;
+			}
+
+			// 関数を受け付けるキューとして登録する(既に他のキューが登録されている場合はfalseを返す)
+			[[nodiscard]]
+			bool tryRegister() noexcept
+			{
+				MainThreadPostQueue* expected = nullptr;
+				m_isRegistered = s_pRegisteredQueue.compare_exchange_strong(expected, this, std::memory_order_seq_cst);
+				return m_isRegistered;
+			}
+
+			// 登録を解除し、post中のスレッドがキューを参照し終えるまで待つ
+			void unregister() noexcept
+			{
+				if (!m_isRegistered)
+				{
+					return;
+				}
+				m_isRegistered = false;
+				s_pRegisteredQueue.store(nullptr, std::memory_order_seq_cst);
+				while (s_numPostingThreads.load(std::memory_order_acquire) != 0)
+				{
+					std::this_thread::yield();
+				}
+			}
+
+			// 登録したインスタンスのスレッドから呼び出し、渡された関数を渡された順に実行する
+			// (実行中に追加された関数が際限なく実行されないよう、1回に実行する数はキューの容量までとする)
+			void drain()
+			{
+				for (std::size_t i = 0; i < Capacity; ++i)
+				{
+					Optional<PostedFunction> func = m_queue.tryPop();
+					if (!func)
+					{
+						if (!m_hasOverflow.load(std::memory_order_acquire))
+						{
+							return;
+						}
+
+						// 退避先の関数より前に渡された関数がキューに残っていないことを、退避先の確認後に再確認する
+						func = m_queue.tryPop();
+						if (!func)
+						{
+							drainOverflow();
+							return;
+						}
+					}
+					(*func)();
+				}
+			}
+
+		private:
+			void drainOverflow()
+			{
+				std::vector<PostedFunction> functions;
+				{
+					const std::lock_guard lock{ m_overflowMutex };
+					functions.swap(m_overflowFunctions);
+					m_hasOverflow.store(false, std::memory_order_release);
+				}
+				for (std::size_t i = 0; i < functions.size(); ++i)
+				{
+					try
+					{
+						functions[i]();
+					}
+					catch (...)
+					{
+						// 未実行の関数は次回に実行されるよう戻す
+						const std::lock_guard lock{ m_overflowMutex };
+						m_overflowFunctions.insert(m_overflowFunctions.begin(), std::make_move_iterator(functions.begin() + i + 1), std::make_move_iterator(functions.end()));
+						m_hasOverflow.store(true, std::memory_order_release);
+						throw;
+					}
+				}
+			}
+		};
+
+		class IThreadPoolJob
+		{
+		public:
+			virtual ~IThreadPoolJob() = default;
+
+			// ワーカースレッドから呼ばれる
+			// (ジョブ自身の所有権を受け取り、ワーカースレッドでは破棄されないよう完了の通知先へ引き渡す)
+			virtual void run(std::shared_ptr<IThreadPoolJob>&& self) noexcept = 0;
+
+			// 実行されないままスレッドプールが破棄される場合に、破棄するスレッドから呼ばれる
+			// (完了を待機している側が起床されなくならないよう、実行せずに失敗として完了させる)
+			virtual void cancel(std::shared_ptr<IThreadPoolJob>&& self) noexcept = 0;
+		};
+
+		// ワーカーごとにジョブのキューを持つスレッドプール
+		// (ジョブは投入時にワーカーへ順番に割り振り、自身のキューが空のワーカーは他のワーカーのキューの末尾から盗んで実行する)
+		class ThreadPool
+		{
+		private:
+			struct WorkerQueue
+			{
+				std::mutex mutex;
+
+				// 優先度ごとのキュー
+				std::array<std::deque<std::shared_ptr<IThreadPoolJob>>, ThreadPoolPriorityCount> jobs;
+			};
+
+			std::vector<std::unique_ptr<WorkerQueue>> m_workerQueues;
+
+			std::vector<std::thread> m_threads;
+
+			// ワーカーの休止・起床用
+			std::mutex m_mutex;
+
+			std::condition_variable m_condition;
+
+			std::atomic<std::size_t> m_numQueuedJobs = 0;
+
+			std::atomic<std::size_t> m_numRunningJobs = 0;
+
+			// 同時に実行するジョブ数の上限
+			std::atomic<std::size_t> m_maxConcurrency;
+
+			std::atomic<std::size_t> m_nextWorkerIndex = 0;
+
+			// 変更はm_mutexのロック中に行う(ワーカーは新たなジョブを取り出す前にも参照する)
+			std::atomic<bool> m_stopRequested = false;
+
+			[[nodiscard]]
+			static std::size_t DefaultThreadCount() noexcept
+			{
+				// メインスレッドの分を空けておく
+				const std::size_t hardwareConcurrency = std::thread::hardware_concurrency();
+				return (hardwareConcurrency > 2) ? (hardwareConcurrency - 1) : 2;
+			}
+
+			// 指定したワーカーのキューから取り出す(他のワーカーのキューからは末尾から盗む)
+			[[nodiscard]]
+			std::shared_ptr<IThreadPoolJob> popJobFrom(std::size_t queueIndex, std::size_t priorityIndex, bool isOwnQueue)
+			{
+				WorkerQueue& queue = *m_workerQueues[queueIndex];
+				const std::lock_guard lock{ queue.mutex };
+				auto& jobs = queue.jobs[priorityIndex];
+				if (jobs.empty())
+				{
+					return nullptr;
+				}
+				std::shared_ptr<IThreadPoolJob> job;
+				if (isOwnQueue)
+				{
+					job = std::move(jobs.front());
+					jobs.pop_front();
+				}
+				else
+				{
+					job = std::move(jobs.back());
+					jobs.pop_back();
+				}
+				return job;
+			}
+
+			// 優先度の高いジョブから、自身のキュー・他のワーカーのキューの順に探す
+			[[nodiscard]]
+			std::shared_ptr<IThreadPoolJob> popJob(std::size_t workerIndex)
+			{
+				const std::size_t numWorkers = m_workerQueues.size();
+				for (std::size_t priorityIndex = ThreadPoolPriorityCount; priorityIndex-- > 0;)
+				{
+					for (std::size_t i = 0; i < numWorkers; ++i)
+					{
+						const std::size_t queueIndex = (workerIndex + i) % numWorkers;
+						if (auto job = popJobFrom(queueIndex, priorityIndex, i == 0))
+						{
+							m_numQueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+							return job;
+						}
+					}
+				}
+				return nullptr;
+			}
+
+			// 上限に達していなければ実行数を1つ確保する
+			[[nodiscard]]
+			bool tryAcquireRunningSlot() noexcept
+			{
+				std::size_t numRunningJobs = m_numRunningJobs.load(std::memory_order_relaxed);
+				do
+				{
+					if (numRunningJobs >= m_maxConcurrency.load(std::memory_order_relaxed))
+					{
+						return false;
+					}
+				} while (!m_numRunningJobs.compare_exchange_weak(numRunningJobs, numRunningJobs + 1, std::memory_order_acquire, std::memory_order_relaxed));
+				return true;
+			}
+
+			void releaseRunningSlot()
+			{
+				m_numRunningJobs.fetch_sub(1, std::memory_order_release);
+
+				// 上限により休止していたワーカーを起床させる
+				if (m_numQueuedJobs.load(std::memory_order_relaxed) > 0)
+				{
+					notifyOne();
+				}
+			}
+
+			void notifyOne()
+			{
+				{
+					// 休止の判定と起床通知が入れ違わないよう、ロックを経由する
+					const std::lock_guard lock{ m_mutex };
+				}
+				m_condition.notify_one();
+			}
+
+			void workerMain(std::size_t workerIndex)
+			{
+				while (!m_stopRequested.load(std::memory_order_relaxed))
+				{
+					if (tryAcquireRunningSlot())
+					{
+						if (auto job = popJob(workerIndex))
+						{
+							IThreadPoolJob* const pJob = job.get();
+							pJob->run(std::move(job));
+							releaseRunningSlot();
+							continue;
+						}
+						releaseRunningSlot();
+					}
+
+					std::unique_lock lock{ m_mutex };
+					m_condition.wait(lock, [this]
+						{
+							return m_stopRequested.load(std::memory_order_relaxed)
+								|| (m_numQueuedJobs.load(std::memory_order_relaxed) > 0
+									&& m_numRunningJobs.load(std::memory_order_relaxed) < m_maxConcurrency.load(std::memory_order_relaxed));
+						});
+				}
+			}
+
+		public:
+			explicit ThreadPool(std::size_t numThreads = DefaultThreadCount())
+				: m_maxConcurrency(std::max(numThreads, std::size_t{ 1 }))
+			{
+				numThreads = std::max(numThreads, std::size_t{ 1 });
+				m_workerQueues.reserve(numThreads);
+				for (std::size_t i = 0; i < numThreads; ++i)
+				{
+					m_workerQueues.push_back(std::make_unique<WorkerQueue>());
+				}
+				m_threads.reserve(numThreads);
+				for (std::size_t i = 0; i < numThreads; ++i)
+				{
+					m_threads.emplace_back([this, i] { workerMain(i); });
+				}
+			}
+
+			ThreadPool(const ThreadPool&) = delete;
+
+			ThreadPool& operator=(const ThreadPool&) = delete;
+
+			// 実行中のジョブの完了を待ち、未実行のジョブは実行せずに取り消す
+			// (取り消したジョブも完了の通知先へ通知されるため、完了を待機している側が起床されなくなることはない)
+			~ThreadPool()
+			{
+				{
+					const std::lock_guard lock{ m_mutex };
+					m_stopRequested.store(true, std::memory_order_relaxed);
+				}
+				m_condition.notify_all();
+				for (auto& thread : m_threads)
+				{
+					thread.join();
+				}
+
+				for (const auto& pWorkerQueue : m_workerQueues)
+				{
+					for (auto& jobs : pWorkerQueue->jobs)
+					{
+						for (auto& job : jobs)
+						{
+							IThreadPoolJob* const pJob = job.get();
+							pJob->cancel(std::move(job));
+						}
+					}
+				}
+			}
+
+			void submit(std::shared_ptr<IThreadPoolJob> job, ThreadPoolPriority priority)
+			{
+				const std::size_t workerIndex = m_nextWorkerIndex.fetch_add(1, std::memory_order_relaxed) % m_workerQueues.size();
+				{
+					WorkerQueue& queue = *m_workerQueues[workerIndex];
+					const std::lock_guard lock{ queue.mutex };
+					queue.jobs[static_cast<std::size_t>(priority)].push_back(std::move(job));
+				}
+				m_numQueuedJobs.fetch_add(1, std::memory_order_relaxed);
+				notifyOne();
+			}
+
+			// 同時に実行するジョブ数の上限を設定する(ワーカースレッド数を上限とする)
+			void setMaxConcurrency(std::size_t maxConcurrency)
+			{
+				if (maxConcurrency == 0)
+				{
+					throw Error{ U"ThreadPool::setMaxConcurrency: maxConcurrency must be greater than 0" };
+				}
+				m_maxConcurrency.store(std::min(maxConcurrency, m_threads.size()), std::memory_order_relaxed);
+				{
+					const std::lock_guard lock{ m_mutex };
+				}
+				m_condition.notify_all();
+			}
+
+			[[nodiscard]]
+			std::size_t maxConcurrency() const noexcept
+			{
+				return m_maxConcurrency.load(std::memory_order_relaxed);
+			}
+
+			[[nodiscard]]
+			std::size_t numThreads() const noexcept
+			{
+				return m_threads.size();
+			}
+		};
+	}
+}
@@ -0,0 +1,549 @@
+﻿//----------------------------------------------------------------------------------------
+//
+//  CoTaskLib
+//
+//  Copyright (c) 2024 masaka
+//
+//  Licensed under the MIT License.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+//----------------------------------------------------------------------------------------
+
+#pragma once
+#include "Core.hpp"
+
+namespace cotasklib::Co
+{
+	class TweenSystem;
+
+	template <typename T>
+	class [[nodiscard]] EaseTaskBuilder;
+
+	namespace detail
+	{
+		// TweenSystemで一括更新できる値の型
+		template <typename T>
+		concept TweenSystemValue = std::same_as<T, double> || std::same_as<T, Vec2> || std::same_as<T, ColorF>;
+
+		template <typename T>
+		[[nodiscard]]
+		T TweenLerp(const T& a, const T& b, double t)
+		{
+			if constexpr (std::is_floating_point_v<T>)
+			{
+				// std::lerpと同様、t=1の場合は終了値と厳密に一致させる
+				return (t == 1.0) ? b : (a + (b - a) * t);
+			}
+			else
+			{
+				return a.lerp(b, t);
+			}
+		}
+
+		// イージング関数を進行度の配列へまとめて適用する関数
+		// (easeFuncは関数ポインタ経由で呼び出す汎用の実装でのみ使用する)
+		using TweenEaseKernel = void(*)(double(*easeFunc)(double), const double* progresses, double* easedProgresses, std::size_t size);
+
+		// イージング関数をループ内に展開して適用する
+		// (分岐や関数呼び出しを含まないイージング関数であれば、ループはベクトル化できる)
+		template <double(*EaseFunc)(double)>
+		void ApplyTweenEase(double(*)(double), const double* progresses, double* easedProgresses, std::size_t size)
+		{
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				easedProgresses[i] = EaseFunc(progresses[i]);
+			}
+		}
+
+		inline void ApplyTweenEaseGeneric(double(*easeFunc)(double), const double* progresses, double* easedProgresses, std::size_t size)
+		{
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				easedProgresses[i] = easeFunc(progresses[i]);
+			}
+		}
+
+		// イージング関数に対応する適用関数を返す
+		// (Siv3Dの多項式のイージング関数は展開した実装を使用し、それ以外は関数ポインタ経由で呼び出す)
+		[[nodiscard]]
+		inline TweenEaseKernel FindTweenEaseKernel(double easeFunc(double))
+		{
+			using Entry = std::pair<double(*)(double), TweenEaseKernel>;
+			static const std::array<Entry, 16> Entries{ {
+				{ Easing::Linear, &ApplyTweenEase<Easing::Linear> },
+				{ EaseInQuad, &ApplyTweenEase<EaseInQuad> },
+				{ EaseOutQuad, &ApplyTweenEase<EaseOutQuad> },
+				{ EaseInOutQuad, &ApplyTweenEase<EaseInOutQuad> },
+				{ EaseInCubic, &ApplyTweenEase<EaseInCubic> },
+				{ EaseOutCubic, &ApplyTweenEase<EaseOutCubic> },
+				{ EaseInOutCubic, &ApplyTweenEase<EaseInOutCubic> },
+				{ EaseInQuart, &ApplyTweenEase<EaseInQuart> },
+				{ EaseOutQuart, &ApplyTweenEase<EaseOutQuart> },
+				{ EaseInOutQuart, &ApplyTweenEase<EaseInOutQuart> },
+				{ EaseInQuint, &ApplyTweenEase<EaseInQuint> },
+				{ EaseOutQuint, &ApplyTweenEase<EaseOutQuint> },
+				{ EaseInOutQuint, &ApplyTweenEase<EaseInOutQuint> },
+				{ EaseInSine, &ApplyTweenEase<EaseInSine> },
+				{ EaseOutSine, &ApplyTweenEase<EaseOutSine> },
+				{ EaseInOutSine, &ApplyTweenEase<EaseInOutSine> },
+			} };
+			for (const auto& [func, kernel] : Entries)
+			{
+				if (func == easeFunc)
+				{
+					return kernel;
+				}
+			}
+			return &ApplyTweenEaseGeneric;
+		}
+
+		// TweenSystemで再生中のトゥイーンを待機するタスクの情報
+		// (待機するタスクのコルーチンのフレーム内に確保される)
+		struct TweenWaiter
+		{
+			WaitList waitList;
+
+			// TweenLane内でのグループの添字と、グループ内での現在の添字
+			std::size_t groupIndex = 0;
+			std::size_t index = 0;
+
+			bool isDone = false;
+		};
+
+		// 値の型ごとに、再生中のトゥイーンをイージング関数ごとのグループに分けて構造体配列(SoA)形式で保持する
+		template <typename T>
+		class TweenLane
+		{
+		private:
+			// 同じイージング関数のトゥイーンをまとめたグループ
+			// (イージング関数はグループ単位で適用するため、要素ごとに関数ポインタを経由しない)
+			struct EaseGroup
+			{
+				double(*easeFunc)(double);
+				TweenEaseKernel applyEase;
+				Array<T*> targets;
+				Array<T> fromValues;
+				Array<T> toValues;
+				Array<double> startTimes;
+				Array<double> invDurations;
+
+				// 待機するタスクがない場合はnullptr
+				Array<TweenWaiter*> waiters;
+			};
+
+			// Note: イージング関数の種類は少ない想定のため、空になったグループも削除せずに線形探索する
+			Array<EaseGroup> m_groups;
+
+			std::size_t m_size = 0;
+
+			// 更新時の作業領域
+			Array<double> m_progresses;
+			Array<double> m_easedProgresses;
+			Array<T> m_values;
+
+			[[nodiscard]]
+			std::size_t groupIndexOf(double easeFunc(double))
+			{
+				for (std::size_t groupIndex = 0; groupIndex < m_groups.size(); ++groupIndex)
+				{
+					if (m_groups[groupIndex].easeFunc == easeFunc)
+					{
+						return groupIndex;
+					}
+				}
+				m_groups.push_back(EaseGroup{ .easeFunc = easeFunc, .applyEase = FindTweenEaseKernel(easeFunc) });
+				return m_groups.size() - 1;
+			}
+
+			void finish(std::size_t groupIndex, std::size_t index)
+			{
+				TweenWaiter* const pWaiter = m_groups[groupIndex].waiters[index];
+				remove(groupIndex, index);
+				if (pWaiter)
+				{
+					pWaiter->isDone = true;
+					pWaiter->waitList.wakeAll();
+				}
+			}
+
+			void updateGroup(std::size_t groupIndex, double time)
+			{
+				EaseGroup& group = m_groups[groupIndex];
+				const std::size_t size = group.waiters.size();
+				if (size == 0)
+				{
+					return;
+				}
+
+				// 進行度の計算・イージング関数の適用・補間・代入をそれぞれ1つのループで行う
+				// (いずれのループも要素ごとの分岐や間接呼び出しを含まず、ベクトル化できる形にしている)
+				m_progresses.resize(size);
+				for (std::size_t i = 0; i < size; ++i)
+				{
+					m_progresses[i] = std::min((time - group.startTimes[i]) * group.invDurations[i], 1.0);
+				}
+
+				m_easedProgresses.resize(size);
+				group.applyEase(group.easeFunc, m_progresses.data(), m_easedProgresses.data(), size);
+
+				m_values.resize(size);
+				for (std::size_t i = 0; i < size; ++i)
+				{
+					m_values[i] = TweenLerp(group.fromValues[i], group.toValues[i], m_easedProgresses[i]);
+				}
+
+				for (std::size_t i = 0; i < size; ++i)
+				{
+					*group.targets[i] = m_values[i];
+				}
+
+				// 終了したトゥイーンを削除する(入れ替えで削除するため末尾から走査する)
+				for (std::size_t i = size; i-- > 0;)
+				{
+					if (m_progresses[i] >= 1.0)
+					{
+						finish(groupIndex, i);
+					}
+				}
+			}
+
+		public:
+			TweenLane() = default;
+
+			TweenLane(const TweenLane&) = delete;
+
+			TweenLane& operator=(const TweenLane&) = delete;
+
+			~TweenLane()
+			{
+				// 待機中のタスクは終了扱いにする
+				for (const EaseGroup& group : m_groups)
+				{
+					for (TweenWaiter* pWaiter : group.waiters)
+					{
+						if (pWaiter)
+						{
+							pWaiter->isDone = true;
+							pWaiter->waitList.wakeAll();
+						}
+					}
+				}
+			}
+
+			// 待機するタスクがない場合、pWaiterにはnullptrを指定する
+			void add(TweenWaiter* pWaiter, T* pTarget, const T& from, const T& to, double startTime, double invDuration, double easeFunc(double))
+			{
+				const std::size_t groupIndex = groupIndexOf(easeFunc);
+				EaseGroup& group = m_groups[groupIndex];
+				if (pWaiter)
+				{
+					pWaiter->groupIndex = groupIndex;
+					pWaiter->index = group.waiters.size();
+				}
+				group.targets.push_back(pTarget);
+				group.fromValues.push_back(from);
+				group.toValues.push_back(to);
+				group.startTimes.push_back(startTime);
+				group.invDurations.push_back(invDuration);
+				group.waiters.push_back(pWaiter);
+				++m_size;
+
+				// 開始時点で初期値を代入する
+				*pTarget = TweenLerp(from, to, easeFunc(0.0));
+			}
+
+			// 末尾の要素と入れ替えて削除する
+			void remove(std::size_t groupIndex, std::size_t index)
+			{
+				EaseGroup& group = m_groups[groupIndex];
+				const std::size_t lastIndex = group.waiters.size() - 1;
+				if (index != lastIndex)
+				{
+					group.targets[index] = group.targets[lastIndex];
+					group.fromValues[index] = std::move(group.fromValues[lastIndex]);
+					group.toValues[index] = std::move(group.toValues[lastIndex]);
+					group.startTimes[index] = group.startTimes[lastIndex];
+					group.invDurations[index] = group.invDurations[lastIndex];
+					group.waiters[index] = group.waiters[lastIndex];
+					if (group.waiters[index])
+					{
+						group.waiters[index]->index = index;
+					}
+				}
+				group.targets.pop_back();
+				group.fromValues.pop_back();
+				group.toValues.pop_back();
+				group.startTimes.pop_back();
+				group.invDurations.pop_back();
+				group.waiters.pop_back();
+				--m_size;
+			}
+
+			// 指定した値を対象とするトゥイーンを、値をそのままにして終了させる
+			void stop(const T* pTarget)
+			{
+				for (std::size_t groupIndex = 0; groupIndex < m_groups.size(); ++groupIndex)
+				{
+					for (std::size_t i = m_groups[groupIndex].targets.size(); i-- > 0;)
+					{
+						if (m_groups[groupIndex].targets[i] == pTarget)
+						{
+							finish(groupIndex, i);
+						}
+					}
+				}
+			}
+
+			void update(double time)
+			{
+				for (std::size_t groupIndex = 0; groupIndex < m_groups.size(); ++groupIndex)
+				{
+					updateGroup(groupIndex, time);
+				}
+			}
+
+			[[nodiscard]]
+			std::size_t size() const noexcept
+			{
+				return m_size;
+			}
+		};
+
+		// トゥイーンの終了前に待機するタスクが破棄された場合に、TweenLaneから削除する
+		template <typename T>
+		class TweenWaitGuard
+		{
+		private:
+			TweenLane<T>* m_pLane;
+			TweenWaiter* m_pWaiter;
+
+		public:
+			TweenWaitGuard(TweenLane<T>* pLane, TweenWaiter* pWaiter) noexcept
+				: m_pLane(pLane)
+				, m_pWaiter(pWaiter)
+			{
+			}
+
+			TweenWaitGuard(const TweenWaitGuard&) = delete;
+
+			TweenWaitGuard& operator=(const TweenWaitGuard&) = delete;
+
+			~TweenWaitGuard()
+			{
+				if (!m_pWaiter->isDone)
+				{
+					m_pLane->remove(m_pWaiter->groupIndex, m_pWaiter->index);
+				}
+			}
+		};
+	}
+
+	// 多数のトゥイーンを値の型ごとにまとめて保持し、毎フレーム一括で更新する
+	// (再生中のトゥイーンを待機するタスクは、終了時まで実行リストのエントリごと休止する)
+	// Note: 生成・再生は同じスケジューラのスレッドで行うこと。また、再生したタスクより後に破棄すること
+	class TweenSystem
+	{
+	private:
+		// 時計が指定されず、生成時に実行中のタスクがタイムスケールグループに所属する場合、グループの仮想時刻を時計として使用する
+		std::shared_ptr<detail::TimeScaleGroupState> m_timeScaleGroup;
+		ISteadyClock* m_pSteadyClock;
+
+		// TweenSystem内の経過時間
+		// (Co::Easeと同様、ポーズ中や同一フレーム内での多重更新は時間を進行させない)
+		double m_time = 0.0;
+		double m_prevClockTime;
+		int32 m_prevFrameCount;
+
+		std::tuple<detail::TweenLane<double>, detail::TweenLane<Vec2>, detail::TweenLane<ColorF>> m_lanes;
+
+		// 再生中のトゥイーンがない間、更新タスクを休止させる
+		detail::WaitList m_updateWaitList;
+
+		// Note: 再生したタスクより先に更新タスクが実行されるよう、メンバの中で最後に初期化する
+		ScopedTaskRunner m_updateRunner;
+
+		[[nodiscard]]
+		double clockTime() const
+		{
+			if (m_pSteadyClock)
+			{
+				return static_cast<double>(detail::Backend::FrameSteadyClockMicrosec(m_pSteadyClock)) / 1'000'000.0;
+			}
+			return detail::Backend::FrameSceneTime();
+		}
+
+		// 経過時間の更新は1フレームにつき1回のみ行う
+		void syncClock()
+		{
+			const int32 frameCount = detail::Backend::FrameCount();
+			if (frameCount == m_prevFrameCount)
+			{
+				return;
+			}
+			const double time = clockTime();
+			if (frameCount - m_prevFrameCount == 1)
+			{
+				m_time += time - m_prevClockTime;
+			}
+			m_prevFrameCount = frameCount;
+			m_prevClockTime = time;
+		}
+
+		[[nodiscard]]
+		Task<void> updateLoop()
+		{
+			while (true)
+			{
+				if (size() == 0)
+				{
+					co_await m_updateWaitList.wait();
+					continue;
+				}
+
+				syncClock();
+				std::apply([this](auto&... lanes) { (lanes.update(m_time), ...); }, m_lanes);
+				co_await NextFrame();
+			}
+		}
+
+		// トゥイーンを追加する(終了済みとして追加しなかった場合はnullptrを返す)
+		template <detail::TweenSystemValue T>
+		[[nodiscard]]
+		detail::TweenLane<T>* addTween(detail::TweenWaiter* pWaiter, T* pTarget, const T& from, const T& to, Duration duration, double easeFunc(double))
+		{
+			syncClock();
+
+			const double durationSec = DurationCast<SecondsF>(duration).count();
+			if (durationSec <= 0.0)
+			{
+				*pTarget = to;
+				return nullptr;
+			}
+
+			auto& lane = std::get<detail::TweenLane<T>>(m_lanes);
+			lane.add(pWaiter, pTarget, from, to, m_time, 1.0 / durationSec, easeFunc);
+			m_updateWaitList.wakeAll();
+			return &lane;
+		}
+
+		template <typename T>
+		[[nodiscard]]
+		static T* BuilderTarget(const EaseTaskBuilder<T>& builder)
+		{
+			if (!builder.m_pTarget)
+			{
+				throw Error{ U"TweenSystem: EaseTaskBuilder must be created with a pointer to the value" };
+			}
+			return builder.m_pTarget;
+		}
+
+		// Co::SetFrameBudgetでNormalのタスクの持ち越しを有効にした場合も経過時間の更新が失われないよう、更新タスクは持ち越さない優先度で実行する
+		[[nodiscard]]
+		ScopedTaskRunner runUpdateLoop()
+		{
+			const ScopedCurrentTaskPriority scopedTaskPriority{ TaskPriority::Critical };
+			return updateLoop().runScoped();
+		}
+
+	public:
+		explicit TweenSystem(ISteadyClock* pSteadyClock = nullptr)
+			: m_timeScaleGroup(pSteadyClock ? nullptr : detail::Backend::SharedCurrentTimeScaleGroup())
+			, m_pSteadyClock(pSteadyClock ? pSteadyClock : m_timeScaleGroup.get())
+			, m_prevClockTime(clockTime())
+			, m_prevFrameCount(detail::Backend::FrameCount())
+			, m_updateRunner(runUpdateLoop())
+		{
+		}
+
+		TweenSystem(const TweenSystem&) = delete;
+
+		TweenSystem& operator=(const TweenSystem&) = delete;
+
+		// 更新タスクが自身を参照するため、ムーブは不可
+		TweenSystem(TweenSystem&&) = delete;
+
+		TweenSystem& operator=(TweenSystem&&) = delete;
+
+		~TweenSystem() = default;
+
+		// pTargetの値をfromからtoまで推移させる
+		template <detail::TweenSystemValue T>
+		[[nodiscard]]
+		Task<void> play(T* pTarget, T from, T to, Duration duration, double easeFunc(double) = EaseOutQuad)
+		{
+			detail::TweenWaiter waiter;
+			detail::TweenLane<T>* const pLane = addTween(&waiter, pTarget, from, to, duration, easeFunc);
+			if (!pLane)
+			{
+				co_return;
+			}
+			const detail::TweenWaitGuard<T> waitGuard{ pLane, &waiter };
+
+			while (!waiter.isDone)
+			{
+				// 終了時に起床される
+				co_await waiter.waitList.wait();
+			}
+		}
+
+		// EaseTaskBuilderで指定した開始値・目標値・時間・イージング関数で再生する
+		// (値のポインタを指定して生成したEaseTaskBuilderのみ指定できる。setClockで指定した時計は使用されない)
+		template <detail::TweenSystemValue T>
+		[[nodiscard]]
+		Task<void> play(const EaseTaskBuilder<T>& builder)
+		{
+			return play(BuilderTarget(builder), builder.m_from, builder.m_to, builder.m_duration, builder.m_easeFunc);
+		}
+
+		// 待機用のタスクを生成せずに再生を開始する
+		// (コルーチンのフレームを確保しないため、終了を待機する必要がない多数のトゥイーンの開始に使用する)
+		// Note: pTargetは終了するか、stopを呼ぶまで参照される
+		template <detail::TweenSystemValue T>
+		void start(T* pTarget, T from, T to, Duration duration, double easeFunc(double) = EaseOutQuad)
+		{
+			(void)addTween(nullptr, pTarget, from, to, duration, easeFunc);
+		}
+
+		template <detail::TweenSystemValue T>
+		void start(const EaseTaskBuilder<T>& builder)
+		{
+			start(BuilderTarget(builder), builder.m_from, builder.m_to, builder.m_duration, builder.m_easeFunc);
+		}
+
+		// pTargetを対象とする再生中のトゥイーンを、値を現在の値のままにして終了させる
+		// (playで再生したトゥイーンを待機しているタスクも終了する)
+		template <detail::TweenSystemValue T>
+		void stop(const T* pTarget)
+		{
+			std::get<detail::TweenLane<T>>(m_lanes).stop(pTarget);
+		}
+
+		// 再生中のトゥイーンの数
+		[[nodiscard]]
+		std::size_t size() const noexcept
+		{
+			return std::apply([](const auto&... lanes) { return (lanes.size() + ...); }, m_lanes);
+		}
+	};
+}
+
+#ifndef NO_COTASKLIB_USING
+using namespace cotasklib;
+#endif
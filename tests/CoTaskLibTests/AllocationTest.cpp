@@ -0,0 +1,111 @@
+﻿// ヒープ確保回数の計測用のテスト
+// (グローバルのoperator new/deleteを置き換えるため、他のテストとは別の実行ファイルにしている)
+#include <array>
+#include <cstdint>
+#define CATCH_CONFIG_RUNNER
+#include <catch2/catch.hpp>
+#include <CoTaskLib.hpp>
+
+#ifdef COTASKLIB_NO_SIV3D
+// Siv3Dを使用しない環境では、System::Updateの代わりにManualBackendでフレームを進める
+namespace
+{
+	Co::ManualBackend* s_pManualBackend = nullptr;
+}
+
+namespace System
+{
+	bool Update()
+	{
+		s_pManualBackend->draw();
+		s_pManualBackend->update();
+		return true;
+	}
+}
+#endif
+
+// グローバルのoperator new/deleteによるヒープ確保回数(CountedAllocation.cppで定義)
+[[nodiscard]]
+std::int64_t NumHeapAllocations() noexcept;
+
+TEST_CASE("runScoped without heap allocation")
+{
+	int32 finishCount = 0;
+	int32 cancelCount = 0;
+
+	// フリーリストや実行リストの領域を確保済みの状態にするため、先に一度実行しておく
+	for (int32 i = 0; i < 2; ++i)
+	{
+		const auto runner = Co::DelayFrame(1).runScoped();
+		const auto runnerWithCallbacks = Co::DelayFrame(1).runScoped([&] { ++finishCount; }, [&] { ++cancelCount; });
+		const auto runnerWithConcurrentTask = Co::DelayFrame(1).with(Co::DelayFrame(2), Co::WithTiming::Before).runScoped();
+		System::Update();
+	}
+
+	// コールバックなしの場合はヒープ確保しない
+	const int64 numAllocationsBefore = NumHeapAllocations();
+	for (int32 i = 0; i < 10; ++i)
+	{
+		const auto runner = Co::DelayFrame(1).runScoped();
+	}
+	for (int32 i = 0; i < 10; ++i)
+	{
+		const auto runner = Co::DelayFrame(1).runScoped();
+		System::Update();
+		REQUIRE(runner.done() == true);
+	}
+	REQUIRE(NumHeapAllocations() == numAllocationsBefore);
+
+	// 小さなコールバックであればヒープ確保しない
+	for (int32 i = 0; i < 10; ++i)
+	{
+		const auto runner = Co::DelayFrame(1).runScoped([&] { ++finishCount; }, [&] { ++cancelCount; });
+		if (i % 2 == 0)
+		{
+			System::Update();
+		}
+	}
+	REQUIRE(NumHeapAllocations() == numAllocationsBefore);
+	REQUIRE(finishCount == 2 + 5);
+	REQUIRE(cancelCount == 5);
+
+	// std::functionの内部領域に収まらない大きさのキャプチャでも、コールバックの内部領域に収まればヒープ確保しない
+	{
+		const std::array<int32*, 4> pCounts{ &finishCount, &cancelCount, &finishCount, &cancelCount };
+		const auto runner = Co::DelayFrame(1).runScoped([pCounts] { ++*pCounts[0]; }, [pCounts] { ++*pCounts[1]; });
+		System::Update();
+	}
+	REQUIRE(NumHeapAllocations() == numAllocationsBefore);
+	REQUIRE(finishCount == 2 + 5 + 1);
+	REQUIRE(cancelCount == 5);
+
+	// 同時実行タスクが1〜2個の場合はヒープ確保しない
+	for (int32 i = 0; i < 10; ++i)
+	{
+		const auto runner = Co::DelayFrame(1).with(Co::DelayFrame(2), Co::WithTiming::Before).runScoped();
+		System::Update();
+	}
+	REQUIRE(NumHeapAllocations() == numAllocationsBefore);
+}
+
+#ifdef COTASKLIB_NO_SIV3D
+int main(int argc, char* argv[])
+{
+	Co::ManualBackend manualBackend;
+	s_pManualBackend = &manualBackend;
+
+	return Catch::Session().run(argc, argv);
+}
+#else
+void Main()
+{
+	Co::Init();
+
+	Console.open();
+	Catch::Session().run();
+
+	while (System::Update())
+	{
+	}
+}
+#endif
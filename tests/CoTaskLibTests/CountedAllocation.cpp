@@ -0,0 +1,169 @@
+﻿// ヒープ確保回数を計測するため、グローバルのoperator new/deleteを置き換える
+// (確保と解放の組み合わせが標準のものと混ざらないよう、配列版・nothrow版・アラインメント指定版もすべて置き換える)
+// (置き換えた関数がテストのコードにインライン展開されないよう、別の翻訳単位にしている)
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<std::int64_t> g_numHeapAllocations = 0;
+
+	[[nodiscard]]
+	void* CountedAllocate(std::size_t size) noexcept
+	{
+		++g_numHeapAllocations;
+		return std::malloc(size == 0 ? 1 : size);
+	}
+
+	[[nodiscard]]
+	void* CountedAlignedAllocate(std::size_t size, std::align_val_t alignment) noexcept
+	{
+		++g_numHeapAllocations;
+		const auto alignmentValue = static_cast<std::size_t>(alignment);
+#ifdef _MSC_VER
+		return _aligned_malloc(size == 0 ? 1 : size, alignmentValue);
+#else
+		// aligned_allocはサイズがアラインメントの倍数である必要があるため、切り上げる
+		return std::aligned_alloc(alignmentValue, (std::max<std::size_t>(size, 1) + alignmentValue - 1) / alignmentValue * alignmentValue);
+#endif
+	}
+
+	void CountedFree(void* p) noexcept
+	{
+		std::free(p);
+	}
+
+	void CountedAlignedFree(void* p) noexcept
+	{
+#ifdef _MSC_VER
+		_aligned_free(p);
+#else
+		std::free(p);
+#endif
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	if (void* p = CountedAllocate(size))
+	{
+		return p;
+	}
+	throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size)
+{
+	if (void* p = CountedAllocate(size))
+	{
+		return p;
+	}
+	throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAllocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	if (void* p = CountedAlignedAllocate(size, alignment))
+	{
+		return p;
+	}
+	throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	if (void* p = CountedAlignedAllocate(size, alignment))
+	{
+		return p;
+	}
+	throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return CountedAlignedAllocate(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return CountedAlignedAllocate(size, alignment);
+}
+
+void operator delete(void* p) noexcept
+{
+	CountedFree(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	CountedFree(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	CountedFree(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+	CountedFree(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+	CountedFree(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+	CountedFree(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+	CountedAlignedFree(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+	CountedAlignedFree(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+	CountedAlignedFree(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+	CountedAlignedFree(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	CountedAlignedFree(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	CountedAlignedFree(p);
+}
+
+std::int64_t NumHeapAllocations() noexcept
+{
+	return g_numHeapAllocations.load();
+}
@@ -1,8 +1,31 @@
-﻿#include <compare>
+﻿#include <atomic>
+#include <compare>
+#include <mutex>
+#include <numeric>
+#include <thread>
 #define CATCH_CONFIG_RUNNER
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include <catch2/catch.hpp>
 #include <CoTaskLib.hpp>
 
+#ifdef COTASKLIB_NO_SIV3D
+// Siv3Dを使用しない環境では、System::Updateの代わりにManualBackendでフレームを進める
+namespace
+{
+	Co::ManualBackend* s_pManualBackend = nullptr;
+}
+
+namespace System
+{
+	bool Update()
+	{
+		s_pManualBackend->draw();
+		s_pManualBackend->update();
+		return true;
+	}
+}
+#endif
+
 Co::Task<void> FromResultTest(int32* pValue)
 {
 	*pValue = co_await Co::FromResult(42);
@@ -288,2587 +311,4801 @@ TEST_CASE("Task::delayed")
 	REQUIRE(runner.done() == true);
 }
 
-TEST_CASE("Finish callback")
+Co::Task<void> NestedDelayTimeTest(int32* pValue, ISteadyClock* pSteadyClock)
 {
-	int32 finishCallbackCount = 0;
-	int32 cancelCallbackCount = 0;
-	auto runner = Co::DelayFrame(3).runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
+	co_await DelayTimeTest(pValue, pSteadyClock);
+	*pValue = 4;
+}
 
-	REQUIRE(finishCallbackCount == 0);
-	REQUIRE(cancelCallbackCount == 0);
+TEST_CASE("Delay time in nested task")
+{
+	TestClock clock;
+	int32 value = 0;
 
-	System::Update();
+	const auto runner = NestedDelayTimeTest(&value, &clock).runScoped();
+	REQUIRE(value == 1);
 
-	REQUIRE(finishCallbackCount == 0);
-	REQUIRE(cancelCallbackCount == 0);
+	// 待機中のタスクは休止するが、期限に達したフレームで再開される
+	for (const uint64 microsec : { 0ULL, 100'000ULL, 500'000ULL, 999'000ULL })
+	{
+		clock.microsec = microsec;
+		System::Update();
+		REQUIRE(value == 1);
+		REQUIRE(runner.done() == false);
+	}
 
+	clock.microsec = 1'001'000;
 	System::Update();
+	REQUIRE(value == 2);
+	REQUIRE(runner.done() == false);
 
-	REQUIRE(finishCallbackCount == 0);
-	REQUIRE(cancelCallbackCount == 0);
-
+	clock.microsec = 4'000'000;
 	System::Update();
+	REQUIRE(value == 2);
+	REQUIRE(runner.done() == false);
 
-	REQUIRE(finishCallbackCount == 1); // 3フレーム後に呼ばれる
-	REQUIRE(cancelCallbackCount == 0);
-
+	// 子タスクの完了後、親タスクも同一フレーム内で再開される
+	clock.microsec = 4'002'000;
 	System::Update();
-
-	REQUIRE(finishCallbackCount == 1); // 多重に呼ばれない
-	REQUIRE(cancelCallbackCount == 0);
+	REQUIRE(value == 4);
+	REQUIRE(runner.done() == true);
 }
 
-TEST_CASE("Finish callback with empty task")
+TEST_CASE("Delay with concurrent task")
 {
-	int32 finishCallbackCount = 0;
-	int32 cancelCallbackCount = 0;
-	auto runner = Co::EmptyTask().runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
+	TestClock clock;
+	int32 frameCount = 0;
 
-	// 空のタスクは即座に完了扱いとなる
-	REQUIRE(finishCallbackCount == 1);
-	REQUIRE(cancelCallbackCount == 0);
-}
+	const auto runner = Co::Delay(1s, &clock)
+		.with(Co::UpdaterTask([&] { ++frameCount; }))
+		.runScoped();
+	REQUIRE(frameCount == 1);
 
-TEST_CASE("Cancel callback")
-{
-	int32 finishCallbackCount = 0;
-	int32 cancelCallbackCount = 0;
+	// Delayの待機中も、同時実行タスクは毎フレーム実行される
+	for (int32 i = 0; i < 5; ++i)
 	{
-		const auto runner = Co::DelayFrame(3).runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
-
-		REQUIRE(finishCallbackCount == 0);
-		REQUIRE(cancelCallbackCount == 0);
-
-		System::Update();
-
-		REQUIRE(finishCallbackCount == 0);
-		REQUIRE(cancelCallbackCount == 0);
-
+		clock.microsec += 100'000;
 		System::Update();
+		REQUIRE(frameCount == 2 + i);
+		REQUIRE(runner.done() == false);
+	}
 
-		REQUIRE(finishCallbackCount == 0);
-		REQUIRE(cancelCallbackCount == 0);
+	clock.microsec = 1'000'000;
+	System::Update();
+	REQUIRE(runner.done() == true);
+}
 
-		// 2フレーム目でキャンセル
-	}
+TEST_CASE("Delay inside Co::All and pausedWhile")
+{
+	TestClock clock;
 
-	REQUIRE(finishCallbackCount == 0);
-	REQUIRE(cancelCallbackCount == 1); // キャンセルされたタイミングで即座に呼ばれる
+	// エントリごと休止できない場合も毎フレーム期限を確認し、休止する場合と同じフレームで完了する
+	const auto allRunner = Co::All(Co::Delay(1s, &clock), Co::Delay(2s, &clock)).runScoped();
+	const auto pausedWhileRunner = Co::Delay(1s, &clock).pausedWhile([] { return false; }).runScoped();
+	const auto directRunner = Co::Delay(1s, &clock).runScoped();
 
+	clock.microsec = 999'000;
 	System::Update();
+	REQUIRE(allRunner.done() == false);
+	REQUIRE(pausedWhileRunner.done() == false);
+	REQUIRE(directRunner.done() == false);
 
-	REQUIRE(finishCallbackCount == 0); // キャンセルされたので呼ばれない
-	REQUIRE(cancelCallbackCount == 1);
-
+	clock.microsec = 1'000'000;
 	System::Update();
+	REQUIRE(allRunner.done() == false);
+	REQUIRE(pausedWhileRunner.done() == true);
+	REQUIRE(directRunner.done() == true);
 
-	REQUIRE(finishCallbackCount == 0);
-	REQUIRE(cancelCallbackCount == 1);
+	clock.microsec = 2'000'000;
+	System::Update();
+	REQUIRE(allRunner.done() == true);
 }
 
-Co::Task<int32> CoReturnTest()
+Co::Task<void> WithOrderTestTask(Array<String>* pLog, String name, int32 frames)
 {
-	co_return 42;
+	for (int32 i = 0; i < frames; ++i)
+	{
+		pLog->push_back(name);
+		co_await Co::NextFrame();
+	}
 }
 
-Co::Task<void> CoReturnTestCaller(int32* pValue)
+TEST_CASE("Task::with execution order")
 {
-	*pValue = co_await CoReturnTest();
+	Array<String> log;
+
+	// 同時実行タスクはタイミングごとに追加した順に実行される
+	const auto runner = WithOrderTestTask(&log, U"main", 2)
+		.with(WithOrderTestTask(&log, U"after1", 3))
+		.with(WithOrderTestTask(&log, U"before1", 3), Co::WithTiming::Before)
+		.with(WithOrderTestTask(&log, U"after2", 3), Co::WithTiming::After)
+		.with(WithOrderTestTask(&log, U"before2", 3), Co::WithTiming::Before)
+		.with(WithOrderTestTask(&log, U"after3", 1))
+		.runScoped();
+	REQUIRE(log == Array<String>{ U"before1", U"before2", U"main", U"after1", U"after2", U"after3" });
+
+	log.clear();
+	System::Update();
+	REQUIRE(log == Array<String>{ U"before1", U"before2", U"main", U"after1", U"after2" });
+
+	// 本体のタスクが完了した時点で同時実行タスクも終了する
+	log.clear();
+	System::Update();
+	REQUIRE(log == Array<String>{ U"before1", U"before2", U"after1", U"after2" });
+	REQUIRE(runner.done() == true);
 }
 
-TEST_CASE("co_return")
+TEST_CASE("Task::with nested concurrent tasks")
 {
-	int32 value = 0;
+	Array<String> log;
 
-	auto task = CoReturnTestCaller(&value);
-	REQUIRE(value == 0); // タスク生成時点ではまだ実行されない
-	const auto runner = std::move(task).runScoped();
-	REQUIRE(value == 42); // runScopedにより実行が開始される
+	const auto runner = WithOrderTestTask(&log, U"main", 3)
+		.with(WithOrderTestTask(&log, U"child", 3)
+			.with(WithOrderTestTask(&log, U"grandchild", 3), Co::WithTiming::Before))
+		.runScoped();
+	REQUIRE(log == Array<String>{ U"main", U"grandchild", U"child" });
+
+	log.clear();
+	System::Update();
+	REQUIRE(log == Array<String>{ U"main", U"grandchild", U"child" });
+	REQUIRE(runner.done() == false);
 }
 
-TEST_CASE("co_return with pausedWhile")
+TEST_CASE("Delay canceled while waiting")
 {
-	int32 value = 0;
-	bool isPaused = true; // 初めからポーズにする
-
-	auto task = CoReturnTestCaller(&value).pausedWhile([&isPaused] { return isPaused; });
+	int32 cancelCallbackCount = 0;
 
-	const auto runner = std::move(task).runScoped();
-	REQUIRE(value == 0); // ポーズ中なのでrunScopedにより実行されない
+	{
+		TestClock clock;
+		Optional<Co::ScopedTaskRunner> runner = Co::Delay(1s, &clock).runScoped(nullptr, [&] { ++cancelCallbackCount; });
 
-	// ポーズ中なので変化しない 1フレーム目
-	System::Update();
-	REQUIRE(value == 0); // 変化なし
+		clock.microsec = 100'000;
+		System::Update();
+		clock.microsec = 200'000;
+		System::Update();
+		REQUIRE(runner->done() == false);
 
-	// ポーズ中なので変化しない 2フレーム目
-	System::Update();
-	REQUIRE(value == 0); // 変化なし
+		// 待機中にキャンセル
+		runner = none;
+		REQUIRE(cancelCallbackCount == 1);
+	}
 
-	// ポーズ解除 3フレーム目
-	isPaused = false;
+	// キャンセル済みのタスクの時計は、破棄後に参照されない
 	System::Update();
-	REQUIRE(value == 42); // ポーズ解除されたので実行される
-}
-
-Co::Task<int32> CoReturnWithDelayTest()
-{
-	co_await Co::NextFrame();
-	co_return 42;
+	REQUIRE(cancelCallbackCount == 1);
 }
 
-Co::Task<void> CoReturnWithDelayTestCaller(int32* pValue)
+TEST_CASE("Delay reads each clock once per frame")
 {
-	*pValue = 1;
-	*pValue = co_await CoReturnWithDelayTest();
-}
+	struct CountingTestClock : ISteadyClock
+	{
+		uint64 microsec = 0;
+		int32 readCount = 0;
 
-TEST_CASE("co_return with delay")
-{
-	int32 value = 0;
+		uint64 getMicrosec() override
+		{
+			++readCount;
+			return microsec;
+		}
+	};
 
-	auto task = CoReturnWithDelayTestCaller(&value);
-	REQUIRE(value == 0); // タスク生成時点ではまだ実行されない
+	CountingTestClock clock;
 
-	const auto runner = std::move(task).runScoped();
-	REQUIRE(value == 1); // runScopedにより実行が開始される
+	// pausedWhileで包み、エントリごと休止せず毎フレームタイマーを更新させる
+	Co::MultiRunner mr;
+	for (int32 i = 0; i < 100; ++i)
+	{
+		Co::Delay(1s, &clock).pausedWhile([] { return false; }).runAddTo(mr);
+	}
 
+	clock.microsec = 500'000;
+	clock.readCount = 0;
 	System::Update();
-	REQUIRE(value == 42); // NextFrame()の後が実行され、co_awaitで受け取った値が返る
 
+	// 時計はフレームごとに1回のみ読み取られる
+	REQUIRE(clock.readCount == 1);
+	REQUIRE(mr.allDone() == false);
+
+	clock.microsec = 1'001'000;
+	clock.readCount = 0;
 	System::Update();
-	REQUIRE(value == 42); // すでに完了しているので何も起こらない
+	REQUIRE(clock.readCount == 1);
+	REQUIRE(mr.allDone() == true);
 }
 
-TEST_CASE("co_return with delay and pausedWhile #1")
+Co::Task<void> PauseGroupCountTest(int32* pCount)
 {
-	int32 value = 0;
-	bool isPaused = false;
+	while (true)
+	{
+		++*pCount;
+		co_await Co::NextFrame();
+	}
+}
 
-	auto task = CoReturnWithDelayTestCaller(&value).pausedWhile([&isPaused] { return isPaused; });
+Co::Task<void> PauseGroupSpawnTest(int32* pCount, Optional<Co::ScopedTaskRunner>* pChildRunner)
+{
+	// 所属するタスクの実行中に実行開始したタスクは、同じポーズグループに所属する
+	pChildRunner->emplace(PauseGroupCountTest(pCount).runScoped());
+	co_await Co::WaitForever();
+}
 
-	const auto runner = std::move(task).runScoped();
-	REQUIRE(value == 1); // runScopedにより実行が開始される
+TEST_CASE("Co::PauseGroup")
+{
+	Co::PauseGroup pauseGroup;
 
-	// ポーズ中なので変化しない 1フレーム目
-	isPaused = true;
-	System::Update();
-	REQUIRE(value == 1); // 変化なし
+	int32 count1 = 0;
+	int32 count2 = 0;
+	int32 outsideCount = 0;
+	Optional<Co::ScopedTaskRunner> childRunner;
+	Co::MultiRunner mr;
+	{
+		const Co::ScopedCurrentPauseGroup scopedPauseGroup{ pauseGroup };
+		PauseGroupCountTest(&count1).runAddTo(mr);
+		PauseGroupSpawnTest(&count2, &childRunner).runAddTo(mr);
+	}
+	PauseGroupCountTest(&outsideCount).runAddTo(mr);
+	REQUIRE(count1 == 1);
+	REQUIRE(count2 == 1);
+	REQUIRE(outsideCount == 1);
 
-	// ポーズ中なので変化しない 2フレーム目
-	isPaused = true;
 	System::Update();
-	REQUIRE(value == 1); // 変化なし
+	REQUIRE(count1 == 2);
+	REQUIRE(count2 == 2);
+	REQUIRE(outsideCount == 2);
 
-	// ポーズ解除 3フレーム目
-	// NextFrame()の後が実行され、co_awaitで受け取った値が返る
-	isPaused = false;
-	System::Update();
-	REQUIRE(value == 42);
+	// 一時停止中は所属するタスクのみ実行されない
+	pauseGroup.pause();
+	REQUIRE(pauseGroup.isPaused() == true);
+	for (int32 i = 0; i < 3; ++i)
+	{
+		System::Update();
+	}
+	REQUIRE(count1 == 2);
+	REQUIRE(count2 == 2);
+	REQUIRE(outsideCount == 5);
 
-	// すでに完了しているので何も起こらない
+	// 再開すると次の更新から実行される
+	pauseGroup.resume();
+	REQUIRE(pauseGroup.isPaused() == false);
+	REQUIRE(count1 == 2);
 	System::Update();
-	REQUIRE(value == 42);
+	REQUIRE(count1 == 3);
+	REQUIRE(count2 == 3);
+	REQUIRE(outsideCount == 6);
 }
 
-TEST_CASE("co_return with delay and pausedWhile #2")
+TEST_CASE("Co::PauseGroup with Delay")
 {
-	int32 value = 0;
-	bool isPaused = true; // 初めからポーズにする
-
-	auto task = CoReturnWithDelayTestCaller(&value).pausedWhile([&isPaused] { return isPaused; });
+	TestClock clock;
+	Co::PauseGroup pauseGroup;
 
-	const auto runner = std::move(task).runScoped();
-	REQUIRE(value == 0); // ポーズ中なのでrunScopedにより実行されない
+	int32 value = 0;
+	Optional<Co::ScopedTaskRunner> runner;
+	{
+		const Co::ScopedCurrentPauseGroup scopedPauseGroup{ pauseGroup };
+		runner.emplace(DelayTimeTest(&value, &clock).runScoped());
+	}
+	REQUIRE(value == 1);
 
-	// ポーズ中なので変化しない 1フレーム目
+	clock.microsec = 500'000;
 	System::Update();
-	REQUIRE(value == 0); // 変化なし
+	REQUIRE(value == 1);
 
-	// ポーズ中なので変化しない 2フレーム目
+	// 0.5秒の時点から2秒間一時停止する
+	pauseGroup.pause();
+	clock.microsec = 2'000'000;
 	System::Update();
-	REQUIRE(value == 0); // 変化なし
-
-	// ポーズ解除 3フレーム目
-	isPaused = false;
+	clock.microsec = 2'500'000;
 	System::Update();
-	REQUIRE(value == 1); // ポーズ解除されたので実行が開始される
+	REQUIRE(value == 1);
+	pauseGroup.resume();
 
-	// NextFrame()の後が実行され、co_awaitで受け取った値が返る
+	// 一時停止していた時間は経過時間に含まれない
+	clock.microsec = 2'900'000;
 	System::Update();
-	REQUIRE(value == 42);
+	REQUIRE(value == 1);
 
-	// すでに完了しているので何も起こらない
+	clock.microsec = 3'001'000;
 	System::Update();
-	REQUIRE(value == 42);
+	REQUIRE(value == 2);
 }
 
-Co::Task<std::unique_ptr<int32>> CoReturnWithMoveOnlyTypeTest()
+TEST_CASE("Co::PauseGroup destroyed while paused")
 {
-	co_return std::make_unique<int32>(42);
+	int32 count = 0;
+	Optional<Co::ScopedTaskRunner> runner;
+	{
+		Co::PauseGroup pauseGroup;
+		{
+			const Co::ScopedCurrentPauseGroup scopedPauseGroup{ pauseGroup };
+			runner.emplace(PauseGroupCountTest(&count).runScoped());
+		}
+		pauseGroup.pause();
+		System::Update();
+		REQUIRE(count == 1);
+	}
+
+	// 破棄時に再開される
+	System::Update();
+	REQUIRE(count == 2);
 }
 
-Co::Task<void> CoReturnWithMoveOnlyTypeTestCaller(int32* pValue)
+Co::Task<void> TimeScaleGroupSpawnTest(int32* pValue, Optional<Co::ScopedTaskRunner>* pChildRunner)
 {
-	auto ptr = co_await CoReturnWithMoveOnlyTypeTest();
-	*pValue = *ptr;
+	// 所属するタスクの実行中に実行開始したタスクは、同じタイムスケールグループに所属する
+	pChildRunner->emplace(Co::Delay(1s).runScoped([pValue] { *pValue = 1; }));
+	co_await Co::WaitForever();
 }
 
-TEST_CASE("co_return with move-only type")
+TEST_CASE("Co::TimeScaleGroup")
 {
+	Co::Scheduler scheduler;
+	const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+	Co::TimeScaleGroup timeScaleGroup{ 0.5 };
+
 	int32 value = 0;
+	int32 childValue = 0;
+	int32 outsideValue = 0;
+	Optional<Co::ScopedTaskRunner> childRunner;
+	Co::MultiRunner mr;
+	{
+		const Co::ScopedCurrentTimeScaleGroup scopedTimeScaleGroup{ timeScaleGroup };
+		Co::Delay(1s).runAddTo(mr, [&] { value = 1; });
+		TimeScaleGroupSpawnTest(&childValue, &childRunner).runAddTo(mr);
+	}
+	Co::Delay(1s).runAddTo(mr, [&] { outsideValue = 1; });
 
-	auto task = CoReturnWithMoveOnlyTypeTestCaller(&value);
-	REQUIRE(value == 0); // タスク生成時点ではまだ実行されない
+	scheduler.update(0.6s);
+	REQUIRE(timeScaleGroup.time().count() == Approx(0.3));
+	REQUIRE(value == 0);
+	REQUIRE(outsideValue == 0);
 
-	const auto runner = std::move(task).runScoped();
-	REQUIRE(value == 42); // runScopedにより実行が開始される
+	// 所属するタスクのみ、0.5倍の速さで時間が進む
+	scheduler.update(0.6s);
+	REQUIRE(timeScaleGroup.time().count() == Approx(0.6));
+	REQUIRE(value == 0);
+	REQUIRE(childValue == 0);
+	REQUIRE(outsideValue == 1);
+
+	// 倍率の変更は次フレームの時間経過から適用される
+	timeScaleGroup.setTimeScale(2.0);
+	REQUIRE(timeScaleGroup.timeScale() == 2.0);
+	scheduler.update(0.25s);
+	REQUIRE(timeScaleGroup.time().count() == Approx(1.1));
+	REQUIRE(value == 1);
+	REQUIRE(childValue == 1);
 }
 
-Co::Task<void> CoReturnWithMoveOnlyTypeTestCallerWithPausedWhile(int32* pValue, std::function<bool()> fnIsPaused)
+TEST_CASE("Co::TimeScaleGroup nested")
 {
-	auto ptr = co_await CoReturnWithMoveOnlyTypeTest().pausedWhile(std::move(fnIsPaused));
-	*pValue = *ptr;
-}
+	Co::Scheduler scheduler;
+	const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+	Co::TimeScaleGroup parentGroup{ 0.5 };
+	const Co::ScopedCurrentTimeScaleGroup scopedParentGroup{ parentGroup };
 
-TEST_CASE("co_return with move-only type and pausedWhile")
-{
-	int32 value = 0;
-	bool isPaused = true; // 初めからポーズにする
+	// 親のタイムスケールグループの仮想時刻を基準にするため、倍率は掛け合わされる
+	Co::TimeScaleGroup childGroup{ 0.5 };
 
-	auto task = CoReturnWithMoveOnlyTypeTestCallerWithPausedWhile(&value, [&isPaused] { return isPaused; });
+	int32 value = 0;
+	Optional<Co::ScopedTaskRunner> runner;
+	{
+		const Co::ScopedCurrentTimeScaleGroup scopedChildGroup{ childGroup };
+		runner.emplace(Co::Delay(1s).runScoped([&] { value = 1; }));
+	}
 
-	const auto runner = std::move(task).runScoped();
-	REQUIRE(value == 0); // ポーズ中なのでrunScopedにより実行されない
+	scheduler.update(2s);
+	REQUIRE(parentGroup.time().count() == Approx(1.0));
+	REQUIRE(childGroup.time().count() == Approx(0.5));
+	REQUIRE(value == 0);
 
-	// ポーズ中なので変化しない 1フレーム目
-	System::Update();
-	REQUIRE(value == 0); // 変化なし
+	scheduler.update(2.1s);
+	REQUIRE(childGroup.time().count() == Approx(1.025));
+	REQUIRE(value == 1);
 
-	// ポーズ中なので変化しない 2フレーム目
-	System::Update();
-	REQUIRE(value == 0); // 変化なし
+	// 倍率0では時間が進まない
+	childGroup.setTimeScale(0.0);
+	scheduler.update(1s);
+	REQUIRE(childGroup.time().count() == Approx(1.025));
 
-	// ポーズ解除 3フレーム目
-	isPaused = false;
-	System::Update();
-	REQUIRE(value == 42); // ポーズ解除されたので実行される
+	REQUIRE_THROWS_WITH(childGroup.setTimeScale(-1.0), "TimeScaleGroup: timeScale must be non-negative");
 }
 
-Co::Task<std::unique_ptr<int32>> CoReturnWithMoveOnlyTypeAndDelayTest()
+Co::Task<void> FrameBudgetWorkTest(TestClock* pClock, uint64 costMicrosec, int32* pCount)
 {
-	co_await Co::NextFrame();
-	co_return std::make_unique<int32>(42);
+	while (true)
+	{
+		// 実行ごとに処理時間を消費したものとして時計を進める
+		pClock->microsec += costMicrosec;
+		++*pCount;
+		co_await Co::NextFrame();
+	}
 }
 
-Co::Task<void> CoReturnWithMoveOnlyTypeAndDelayTestCaller(int32* pValue)
+TEST_CASE("Co::SetFrameBudget")
 {
-	auto ptr = co_await CoReturnWithMoveOnlyTypeAndDelayTest();
-	*pValue = *ptr;
-}
+	Co::Scheduler scheduler;
+	const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+	TestClock clock;
+	Co::SetFrameBudget(10ms, Co::TaskPriority::Background, &clock);
+	REQUIRE(Co::GetFrameBudget().count() == Approx(0.01));
+
+	int32 heavyCount = 0;
+	int32 criticalCount = 0;
+	int32 normalCount = 0;
+	int32 backgroundCount = 0;
+	Optional<Co::ScopedTaskRunner> heavyRunner = FrameBudgetWorkTest(&clock, 15'000, &heavyCount).runScoped();
+	Co::MultiRunner mr;
+	{
+		const Co::ScopedCurrentTaskPriority scopedTaskPriority{ Co::TaskPriority::Critical };
+		FrameBudgetWorkTest(&clock, 0, &criticalCount).runAddTo(mr);
+	}
+	FrameBudgetWorkTest(&clock, 0, &normalCount).runAddTo(mr);
+	{
+		const Co::ScopedCurrentTaskPriority scopedTaskPriority{ Co::TaskPriority::Background };
+		FrameBudgetWorkTest(&clock, 0, &backgroundCount).runAddTo(mr);
+	}
 
-TEST_CASE("co_return with move-only type and delay")
-{
-	int32 value = 0;
+	// 既定では、予算を使い切った後はBackgroundのタスクのみ次フレームへ持ち越す
+	scheduler.update();
+	REQUIRE(heavyCount == 2);
+	REQUIRE(criticalCount == 2);
+	REQUIRE(normalCount == 2);
+	REQUIRE(backgroundCount == 1);
+	REQUIRE(Co::GetFrameBudgetStats().deferredTaskCount == 1);
+
+	scheduler.update();
+	REQUIRE(criticalCount == 3);
+	REQUIRE(normalCount == 3);
+	REQUIRE(backgroundCount == 1);
+
+	// Normalのタスクの持ち越しを有効にした場合、Normalのタスクは2フレーム続けては持ち越さない
+	Co::SetFrameBudget(10ms, Co::TaskPriority::Normal, &clock);
+	scheduler.update();
+	REQUIRE(criticalCount == 4);
+	REQUIRE(normalCount == 3);
+	REQUIRE(backgroundCount == 1);
+	REQUIRE(Co::GetFrameBudgetStats().deferredTaskCount == 2);
+
+	scheduler.update();
+	REQUIRE(criticalCount == 5);
+	REQUIRE(normalCount == 4);
+	REQUIRE(backgroundCount == 1);
+	REQUIRE(Co::GetFrameBudgetStats().deferredTaskCount == 1);
+
+	// 予算内に収まれば全てのタスクが実行される
+	heavyRunner.reset();
+	scheduler.update();
+	REQUIRE(criticalCount == 6);
+	REQUIRE(normalCount == 5);
+	REQUIRE(backgroundCount == 2);
+
+	const Co::FrameBudgetStats stats = Co::GetFrameBudgetStats();
+	REQUIRE(stats.deferredTaskCount == 0);
+	REQUIRE(stats.totalDeferredTaskCount == 5);
+	REQUIRE(stats.overBudgetFrameCount == 4);
+	REQUIRE(stats.lastUpdateTime.count() == 0.0);
+
+	// Criticalのタスクは持ち越しの対象にできない
+	REQUIRE_THROWS_WITH(Co::SetFrameBudget(10ms, Co::TaskPriority::Critical), "SetFrameBudget: Critical tasks cannot be deferred");
+}
+
+TEST_CASE("Co::SetFrameBudget with Delay")
+{
+	Co::Scheduler scheduler;
+	const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+	TestClock clock;
+	Co::SetFrameBudget(10ms, Co::TaskPriority::Background, &clock);
 
-	auto task = CoReturnWithMoveOnlyTypeAndDelayTestCaller(&value);
-	REQUIRE(value == 0); // タスク生成時点ではまだ実行されない
+	int32 heavyCount = 0;
+	Optional<Co::ScopedTaskRunner> heavyRunner = FrameBudgetWorkTest(&clock, 15'000, &heavyCount).runScoped();
 
-	const auto runner = std::move(task).runScoped();
-	REQUIRE(value == 0); // runScopedにより実行が開始される
+	// pausedWhileで包み、エントリごと休止せず毎フレームタイマーを更新させる
+	int32 value = 0;
+	Optional<Co::ScopedTaskRunner> runner;
+	{
+		const Co::ScopedCurrentTaskPriority scopedTaskPriority{ Co::TaskPriority::Background };
+		runner.emplace(Co::Delay(1s).pausedWhile([] { return false; }).runScoped([&] { value = 1; }));
+	}
 
-	System::Update();
-	REQUIRE(value == 42); // NextFrame()の後が実行され、co_awaitで受け取った値が返る
+	for (int32 i = 0; i < 3; ++i)
+	{
+		scheduler.update(0.25s);
+	}
+	REQUIRE(value == 0);
+	REQUIRE(Co::GetFrameBudgetStats().totalDeferredTaskCount == 3);
 
-	System::Update();
-	REQUIRE(value == 42); // すでに完了しているので何も起こらない
+	// 持ち越されたフレームの時間も経過時間に加算される
+	heavyRunner.reset();
+	scheduler.update(0.25s);
+	REQUIRE(value == 1);
 }
 
-Co::Task<void> CoReturnWithMoveOnlyTypeAndDelayTestCallerWithPausedWhile(int32* pValue, std::function<bool()> fnIsPaused)
+Co::Task<void> FrameBudgetRewindClockTest(TestClock* pClock, int32* pCount)
 {
-	auto ptr = co_await CoReturnWithMoveOnlyTypeAndDelayTest().pausedWhile(std::move(fnIsPaused));
-	*pValue = *ptr;
+	while (true)
+	{
+		// 時計を巻き戻す
+		pClock->microsec -= 1'000;
+		++*pCount;
+		co_await Co::NextFrame();
+	}
 }
 
-TEST_CASE("co_return with move-only type and delay and pausedWhile")
+TEST_CASE("Co::SetFrameBudget with clock going backwards")
 {
-	int32 value = 0;
-	bool isPaused = true; // 初めからポーズにする
-
-	auto task = CoReturnWithMoveOnlyTypeAndDelayTestCallerWithPausedWhile(&value, [&isPaused] { return isPaused; });
-
-	const auto runner = std::move(task).runScoped();
-	REQUIRE(value == 0); // ポーズ中なのでrunScopedにより実行されない
-
-	// ポーズ中なので変化しない 1フレーム目
-	System::Update();
-	REQUIRE(value == 0); // 変化なし
+	Co::Scheduler scheduler;
+	const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+	TestClock clock;
+	clock.microsec = 1'000'000;
+	Co::SetFrameBudget(10ms, Co::TaskPriority::Background, &clock);
 
-	// ポーズ中なので変化しない 2フレーム目
-	System::Update();
-	REQUIRE(value == 0); // 変化なし
+	int32 rewindCount = 0;
+	int32 backgroundCount = 0;
+	const auto rewindRunner = FrameBudgetRewindClockTest(&clock, &rewindCount).runScoped();
+	Co::MultiRunner mr;
+	{
+		const Co::ScopedCurrentTaskPriority scopedTaskPriority{ Co::TaskPriority::Background };
+		FrameBudgetWorkTest(&clock, 0, &backgroundCount).runAddTo(mr);
+	}
 
-	// ポーズ解除 3フレーム目
-	isPaused = false;
-	System::Update();
-	REQUIRE(value == 0); // ポーズ解除されたので実行が開始され、NextFrame()が実行されるため変化なし
+	// 時計が巻き戻っても経過時間は0として扱われ、予算超過にはならない
+	for (int32 i = 0; i < 3; ++i)
+	{
+		scheduler.update();
+	}
+	REQUIRE(rewindCount == 4);
+	REQUIRE(backgroundCount == 4);
 
-	// NextFrame()の後が実行され、co_awaitで受け取った値が返る
-	System::Update();
-	REQUIRE(value == 42);
+	const Co::FrameBudgetStats stats = Co::GetFrameBudgetStats();
+	REQUIRE(stats.totalDeferredTaskCount == 0);
+	REQUIRE(stats.overBudgetFrameCount == 0);
 }
 
-Co::Task<void> ThrowExceptionTest()
+Co::Task<void> YieldIfOverBudgetTest(TestClock* pClock, int32* pCount)
 {
-	throw std::runtime_error("test exception");
-	co_return;
+	for (int32 i = 0; i < 10; ++i)
+	{
+		pClock->microsec += 3'000;
+		++*pCount;
+		co_await Co::YieldIfOverBudget();
+	}
 }
 
-TEST_CASE("Throw exception")
+Co::Task<void> YieldIfOverBudgetOnUpdateTest(TestClock* pClock, int32* pCount)
 {
-	int32 finishCallbackCount = 0;
-	int32 cancelCallbackCount = 0;
+	co_await Co::NextFrame();
+	co_await YieldIfOverBudgetTest(pClock, pCount);
+}
 
-	auto task = ThrowExceptionTest();
+TEST_CASE("Co::YieldIfOverBudget")
+{
+	Co::Scheduler scheduler;
+	const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+	TestClock clock;
+	Co::SetFrameBudget(10ms, Co::TaskPriority::Background, &clock);
 
-	REQUIRE_THROWS_WITH(std::move(task).runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; }), "test exception");
+	// update外ではフレームの区切りがなく経過時間を計れないため、待機しない
+	int32 count = 0;
+	auto runner = YieldIfOverBudgetTest(&clock, &count).runScoped();
+	REQUIRE(count == 10);
+	REQUIRE(runner.done() == true);
 
-	REQUIRE(finishCallbackCount == 0);
-	REQUIRE(cancelCallbackCount == 1);
+	// update中は予算を使い切るまでは待機しない
+	int32 countOnUpdate = 0;
+	auto runnerOnUpdate = YieldIfOverBudgetOnUpdateTest(&clock, &countOnUpdate).runScoped();
+	REQUIRE(countOnUpdate == 0);
+	scheduler.update();
+	REQUIRE(countOnUpdate == 4);
+	scheduler.update();
+	REQUIRE(countOnUpdate == 8);
+	scheduler.update();
+	REQUIRE(countOnUpdate == 10);
+	REQUIRE(runnerOnUpdate.done() == true);
 }
 
-Co::Task<int32> ThrowExceptionWithNonVoidResultTest()
+Co::Task<void> IsOverFrameBudgetTest(bool* pResultOnRunScoped, bool* pResultOnUpdate)
 {
-	throw std::runtime_error("test exception");
-	co_return 42;
+	*pResultOnRunScoped = Co::detail::Backend::IsOverFrameBudget();
+	co_await Co::NextFrame();
+	*pResultOnUpdate = Co::detail::Backend::IsOverFrameBudget();
 }
 
-TEST_CASE("Throw exception with non-void result")
+TEST_CASE("Backend::IsOverFrameBudget")
 {
-	int32 finishCallbackCount = 0;
-	int32 cancelCallbackCount = 0;
+	Co::Scheduler scheduler;
+	const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+	TestClock clock;
+	Co::SetFrameBudget(10ms, Co::TaskPriority::Background, &clock);
 
-	auto task = ThrowExceptionWithNonVoidResultTest();
+	// update外ではフレームの区切りがなく経過時間を計れないため、予算を設定していてもfalse
+	clock.microsec += 20'000;
+	REQUIRE(Co::detail::Backend::IsOverFrameBudget() == false);
 
-	REQUIRE_THROWS_WITH(std::move(task).runScoped([&](int32) { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; }), "test exception");
+	// runScoped時の最初のresumeもupdate外として扱い、update中は予算を使い切るまでfalse
+	bool resultOnRunScoped = true;
+	bool resultOnUpdate = true;
+	auto runner = IsOverFrameBudgetTest(&resultOnRunScoped, &resultOnUpdate).runScoped();
+	REQUIRE(resultOnRunScoped == false);
+	scheduler.update();
+	REQUIRE(resultOnUpdate == false);
 
-	REQUIRE(finishCallbackCount == 0);
-	REQUIRE(cancelCallbackCount == 1);
+	// スケジューラを使用していないスレッドでもfalse
+	bool resultOnOtherThread = true;
+	std::thread{ [&] { resultOnOtherThread = Co::detail::Backend::IsOverFrameBudget(); } }.join();
+	REQUIRE(resultOnOtherThread == false);
 }
 
-Co::Task<void> ThrowExceptionWithDelayTest()
+TEST_CASE("Co::ForEachTimeSliced")
 {
-	co_await Co::NextFrame();
-	throw std::runtime_error("test exception");
+	Co::Scheduler scheduler;
+	const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+	TestClock clock;
+	Co::SetFrameBudget(100ms, Co::TaskPriority::Background, &clock);
+
+	const Array<int32> values = { 1, 2, 3, 4, 5 };
+	Array<int32> processed;
+	auto runner = Co::ForEachTimeSliced(values, [&](int32 value)
+		{
+			clock.microsec += 3'000;
+			processed.push_back(value);
+		}, 5ms).runScoped();
+
+	// 指定した予算はupdate外でも適用され、使い切るまで処理する
+	REQUIRE(processed == Array<int32>{ 1, 2 });
+	scheduler.update();
+	REQUIRE(processed == Array<int32>{ 1, 2, 3, 4 });
+	REQUIRE(runner.done() == false);
+	scheduler.update();
+	REQUIRE(processed == Array<int32>{ 1, 2, 3, 4, 5 });
+	REQUIRE(runner.done() == true);
+
+	// 予算を省略した場合、update外ではフレーム全体の予算による持ち越しは行わない
+	// (右辺値のrangeはタスク内に保持される)
+	int32 sum = 0;
+	auto runner2 = Co::ForEachTimeSliced(Array<int32>{ 10, 20, 30 }, [&](int32 value) { clock.microsec += 50'000; sum += value; }).runScoped();
+	REQUIRE(sum == 60);
+	REQUIRE(runner2.done() == true);
 }
 
-TEST_CASE("Throw exception with delay")
+TEST_CASE("Finish callback")
 {
 	int32 finishCallbackCount = 0;
 	int32 cancelCallbackCount = 0;
+	auto runner = Co::DelayFrame(3).runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
 
-	auto task = ThrowExceptionWithDelayTest();
+	REQUIRE(finishCallbackCount == 0);
+	REQUIRE(cancelCallbackCount == 0);
 
-	const auto runner = std::move(task).runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
+	System::Update();
 
-	// System::Update内で例外が発生すると以降のテスト実行に影響が出る可能性があるため、手動resumeでテスト
-	REQUIRE_THROWS_WITH(Co::detail::Backend::ManualUpdate(), "test exception");
+	REQUIRE(finishCallbackCount == 0);
+	REQUIRE(cancelCallbackCount == 0);
+
+	System::Update();
 
 	REQUIRE(finishCallbackCount == 0);
-	REQUIRE(cancelCallbackCount == 1);
-}
+	REQUIRE(cancelCallbackCount == 0);
 
-Co::Task<int32> ThrowExceptionWithDelayAndNonVoidResultTest()
-{
-	co_await Co::NextFrame();
-	throw std::runtime_error("test exception");
-	co_return 42;
+	System::Update();
+
+	REQUIRE(finishCallbackCount == 1); // 3フレーム後に呼ばれる
+	REQUIRE(cancelCallbackCount == 0);
+
+	System::Update();
+
+	REQUIRE(finishCallbackCount == 1); // 多重に呼ばれない
+	REQUIRE(cancelCallbackCount == 0);
 }
 
-TEST_CASE("Throw exception with delay and non-void result")
+TEST_CASE("Finish callback with empty task")
 {
 	int32 finishCallbackCount = 0;
 	int32 cancelCallbackCount = 0;
+	auto runner = Co::EmptyTask().runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
 
-	auto task = ThrowExceptionWithDelayAndNonVoidResultTest();
-
-	const auto runner = std::move(task).runScoped([&](int32) { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
+	// 空のタスクは即座に完了扱いとなる
+	REQUIRE(finishCallbackCount == 1);
+	REQUIRE(cancelCallbackCount == 0);
+}
 
-	// System::Update内で例外が発生すると以降のテスト実行に影響が出る可能性があるため、手動resumeでテスト
-	REQUIRE_THROWS_WITH(Co::detail::Backend::ManualUpdate(), "test exception");
+TEST_CASE("Finish callback with std::function and large function object")
+{
+	// 空のstd::functionはコールバックなしとして扱われる
+	{
+		const auto runner = Co::DelayFrame(1).runScoped(std::function<void()>{}, std::function<void()>{});
+		System::Update();
+		REQUIRE(runner.done() == true);
+	}
 
-	REQUIRE(finishCallbackCount == 0);
-	REQUIRE(cancelCallbackCount == 1);
+	// std::functionや、内部の領域に収まらない関数オブジェクトも指定できる
+	std::array<int32, 64> values{};
+	values.back() = 42;
+	int32 result = 0;
+	int32 cancelCallbackCount = 0;
+	{
+		const auto runner = Co::FromResult(1).runScoped([&result, values](int32 value) { result = values.back() + value; }, std::function<void()>{ [&] { ++cancelCallbackCount; } });
+		REQUIRE(result == 43);
+	}
+	{
+		const auto runner = Co::DelayFrame(1).runScoped(nullptr, [&cancelCallbackCount, values] { cancelCallbackCount += values.back(); });
+	}
+	REQUIRE(cancelCallbackCount == 42);
 }
 
-TEST_CASE("TaskFinishSource<void>")
+TEST_CASE("Cancel callback")
 {
-	Co::TaskFinishSource<void> taskFinishSource;
-	REQUIRE(taskFinishSource.done() == false);
+	int32 finishCallbackCount = 0;
+	int32 cancelCallbackCount = 0;
+	{
+		const auto runner = Co::DelayFrame(3).runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
 
-	// 初回のリクエストではtrueが返る
-	REQUIRE(taskFinishSource.requestFinish() == true);
-	REQUIRE(taskFinishSource.done() == true);
+		REQUIRE(finishCallbackCount == 0);
+		REQUIRE(cancelCallbackCount == 0);
 
-	// 2回目以降のリクエストは受け付けない
-	REQUIRE(taskFinishSource.requestFinish() == false);
-	REQUIRE(taskFinishSource.done() == true);
-}
+		System::Update();
 
-TEST_CASE("TaskFinishSource<void>::waitUntilDone")
-{
-	Co::TaskFinishSource<void> taskFinishSource;
-	const auto runner = taskFinishSource.waitUntilDone().runScoped();
+		REQUIRE(finishCallbackCount == 0);
+		REQUIRE(cancelCallbackCount == 0);
 
-	// まだ完了していない
-	REQUIRE(runner.done() == false);
-	REQUIRE(taskFinishSource.done() == false);
+		System::Update();
 
-	// 完了リクエスト
-	taskFinishSource.requestFinish();
+		REQUIRE(finishCallbackCount == 0);
+		REQUIRE(cancelCallbackCount == 0);
 
-	// System::Updateが呼ばれるまでは完了しない
-	REQUIRE(runner.done() == false);
-	REQUIRE(taskFinishSource.done() == true);
+		// 2フレーム目でキャンセル
+	}
+
+	REQUIRE(finishCallbackCount == 0);
+	REQUIRE(cancelCallbackCount == 1); // キャンセルされたタイミングで即座に呼ばれる
 
 	System::Update();
 
-	// System::Updateが呼ばれたら完了する
-	REQUIRE(runner.done() == true);
-	REQUIRE(taskFinishSource.done() == true);
+	REQUIRE(finishCallbackCount == 0); // キャンセルされたので呼ばれない
+	REQUIRE(cancelCallbackCount == 1);
+
+	System::Update();
+
+	REQUIRE(finishCallbackCount == 0);
+	REQUIRE(cancelCallbackCount == 1);
 }
 
-TEST_CASE("TaskFinishSource<int32>")
+Co::Task<int32> CoReturnTest()
 {
-	Co::TaskFinishSource<int32> taskFinishSource;
-	REQUIRE(taskFinishSource.done() == false);
-	REQUIRE(taskFinishSource.hasResult() == false);
+	co_return 42;
+}
 
-	// 結果が入るまではresultは例外を投げる
-	REQUIRE_THROWS_AS(taskFinishSource.result(), Error);
+Co::Task<void> CoReturnTestCaller(int32* pValue)
+{
+	*pValue = co_await CoReturnTest();
+}
 
-	// 初回のリクエストではtrueが返る
-	REQUIRE(taskFinishSource.requestFinish(42) == true);
-	REQUIRE(taskFinishSource.done() == true);
-
-	// 結果が取得できる
-	REQUIRE(taskFinishSource.hasResult() == true);
-	REQUIRE(taskFinishSource.result() == 42);
-
-	// 2回目以降の結果取得はできない
-	REQUIRE(taskFinishSource.hasResult() == false);
-	REQUIRE_THROWS_AS(taskFinishSource.result(), Error);
-	REQUIRE(taskFinishSource.done() == true);
+TEST_CASE("co_return")
+{
+	int32 value = 0;
 
-	// 2回目以降のリクエストは受け付けない
-	REQUIRE(taskFinishSource.requestFinish(4242) == false);
-	REQUIRE(taskFinishSource.hasResult() == false);
-	REQUIRE_THROWS_AS(taskFinishSource.result(), Error);
-	REQUIRE(taskFinishSource.done() == true);
+	auto task = CoReturnTestCaller(&value);
+	REQUIRE(value == 0); // タスク生成時点ではまだ実行されない
+	const auto runner = std::move(task).runScoped();
+	REQUIRE(value == 42); // runScopedにより実行が開始される
 }
 
-TEST_CASE("TaskFinishSource<int32>::waitUntilDone")
+TEST_CASE("co_return with pausedWhile")
 {
-	Co::TaskFinishSource<int32> taskFinishSource;
-	const auto runner = taskFinishSource.waitUntilDone().runScoped();
+	int32 value = 0;
+	bool isPaused = true; // 初めからポーズにする
 
-	// まだ完了していない
-	REQUIRE(runner.done() == false);
-	REQUIRE(taskFinishSource.done() == false);
+	auto task = CoReturnTestCaller(&value).pausedWhile([&isPaused] { return isPaused; });
 
-	// 完了リクエスト
-	taskFinishSource.requestFinish(42);
+	const auto runner = std::move(task).runScoped();
+	REQUIRE(value == 0); // ポーズ中なのでrunScopedにより実行されない
 
-	// System::Updateが呼ばれるまでは完了しない
-	REQUIRE(runner.done() == false);
-	REQUIRE(taskFinishSource.done() == true);
+	// ポーズ中なので変化しない 1フレーム目
+	System::Update();
+	REQUIRE(value == 0); // 変化なし
 
+	// ポーズ中なので変化しない 2フレーム目
 	System::Update();
+	REQUIRE(value == 0); // 変化なし
 
-	// System::Updateが呼ばれたら完了する
-	REQUIRE(runner.done() == true);
-	REQUIRE(taskFinishSource.done() == true);
-	REQUIRE(taskFinishSource.hasResult() == true);
-	REQUIRE(taskFinishSource.result() == 42);
+	// ポーズ解除 3フレーム目
+	isPaused = false;
+	System::Update();
+	REQUIRE(value == 42); // ポーズ解除されたので実行される
 }
 
-TEST_CASE("TaskFinishSource<int32>::waitForResult")
+Co::Task<int32> CoReturnWithDelayTest()
 {
-	Co::TaskFinishSource<int32> taskFinishSource;
-	Optional<int32> result = none;
-	const auto runner = taskFinishSource.waitForResult().runScoped([&](int32 r) { result = r; });
+	co_await Co::NextFrame();
+	co_return 42;
+}
 
-	// まだ完了していない
-	REQUIRE(runner.done() == false);
-	REQUIRE(taskFinishSource.done() == false);
-	REQUIRE(result == none);
+Co::Task<void> CoReturnWithDelayTestCaller(int32* pValue)
+{
+	*pValue = 1;
+	*pValue = co_await CoReturnWithDelayTest();
+}
 
-	// 完了リクエスト
-	taskFinishSource.requestFinish(42);
+TEST_CASE("co_return with delay")
+{
+	int32 value = 0;
 
-	// System::Updateが呼ばれるまでは完了しない
-	REQUIRE(runner.done() == false);
-	REQUIRE(taskFinishSource.done() == true);
-	REQUIRE(result == none);
+	auto task = CoReturnWithDelayTestCaller(&value);
+	REQUIRE(value == 0); // タスク生成時点ではまだ実行されない
 
-	System::Update();
+	const auto runner = std::move(task).runScoped();
+	REQUIRE(value == 1); // runScopedにより実行が開始される
 
-	// System::Updateが呼ばれたら完了する
-	REQUIRE(runner.done() == true);
-	REQUIRE(taskFinishSource.done() == true);
-	REQUIRE(result == 42);
+	System::Update();
+	REQUIRE(value == 42); // NextFrame()の後が実行され、co_awaitで受け取った値が返る
 
-	// 2回目以降の結果取得はできない
-	// (waitForResult内で既に結果取得しているため2回目となる)
-	REQUIRE_THROWS_AS(taskFinishSource.result(), Error);
-	REQUIRE(taskFinishSource.done() == true);
+	System::Update();
+	REQUIRE(value == 42); // すでに完了しているので何も起こらない
 }
 
-TEST_CASE("ScopedTaskRunner::requestCancel")
+TEST_CASE("co_return with delay and pausedWhile #1")
 {
-	int32 finishCallbackCount = 0;
-	int32 cancelCallbackCount = 0;
-
-	auto runner = Co::DelayFrame(3).runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
-
-	REQUIRE(runner.done() == false);
-
-	// キャンセル
-	const bool canceled = runner.requestCancel();
-	REQUIRE(canceled == true);
+	int32 value = 0;
+	bool isPaused = false;
 
-	// 即時でキャンセルされる
-	REQUIRE(runner.done() == true);
-	REQUIRE(finishCallbackCount == 0);
-	REQUIRE(cancelCallbackCount == 1);
+	auto task = CoReturnWithDelayTestCaller(&value).pausedWhile([&isPaused] { return isPaused; });
 
-	// 2回目以降のキャンセルは通らない
-	const bool canceled2 = runner.requestCancel();
-	REQUIRE(canceled2 == false);
-	REQUIRE(finishCallbackCount == 0);
-	REQUIRE(cancelCallbackCount == 1);
-}
+	const auto runner = std::move(task).runScoped();
+	REQUIRE(value == 1); // runScopedにより実行が開始される
 
-TEST_CASE("ScopedTaskRunner::requestCancel after finished")
-{
-	int32 finishCallbackCount = 0;
-	int32 cancelCallbackCount = 0;
+	// ポーズ中なので変化しない 1フレーム目
+	isPaused = true;
+	System::Update();
+	REQUIRE(value == 1); // 変化なし
 
-	auto runner = Co::DelayFrame(3).runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
-	for (int32 i = 0; i < 3; ++i)
-	{
-		REQUIRE(runner.done() == false);
-		System::Update();
-	}
+	// ポーズ中なので変化しない 2フレーム目
+	isPaused = true;
+	System::Update();
+	REQUIRE(value == 1); // 変化なし
 
-	// 完了済みである
-	REQUIRE(runner.done() == true);
-	REQUIRE(finishCallbackCount == 1);
-	REQUIRE(cancelCallbackCount == 0);
+	// ポーズ解除 3フレーム目
+	// NextFrame()の後が実行され、co_awaitで受け取った値が返る
+	isPaused = false;
+	System::Update();
+	REQUIRE(value == 42);
 
-	// 完了済みの場合はキャンセル要求は通らない
-	const bool canceled = runner.requestCancel();
-	REQUIRE(canceled == false);
-	REQUIRE(finishCallbackCount == 1);
-	REQUIRE(cancelCallbackCount == 0);
+	// すでに完了しているので何も起こらない
+	System::Update();
+	REQUIRE(value == 42);
 }
 
-TEST_CASE("ScopedTaskRunner::waitUntilDone")
+TEST_CASE("co_return with delay and pausedWhile #2")
 {
-	const auto runner = Co::DelayFrame(3).runScoped();
-	const auto runner2 = runner.waitUntilDone().runScoped();
+	int32 value = 0;
+	bool isPaused = true; // 初めからポーズにする
 
-	REQUIRE(runner.done() == false);
-	REQUIRE(runner2.done() == false);
+	auto task = CoReturnWithDelayTestCaller(&value).pausedWhile([&isPaused] { return isPaused; });
 
+	const auto runner = std::move(task).runScoped();
+	REQUIRE(value == 0); // ポーズ中なのでrunScopedにより実行されない
+
+	// ポーズ中なので変化しない 1フレーム目
 	System::Update();
+	REQUIRE(value == 0); // 変化なし
 
-	REQUIRE(runner.done() == false);
-	REQUIRE(runner2.done() == false);
+	// ポーズ中なので変化しない 2フレーム目
+	System::Update();
+	REQUIRE(value == 0); // 変化なし
 
+	// ポーズ解除 3フレーム目
+	isPaused = false;
 	System::Update();
+	REQUIRE(value == 1); // ポーズ解除されたので実行が開始される
 
-	REQUIRE(runner.done() == false);
-	REQUIRE(runner2.done() == false);
+	// NextFrame()の後が実行され、co_awaitで受け取った値が返る
+	System::Update();
+	REQUIRE(value == 42);
 
+	// すでに完了しているので何も起こらない
 	System::Update();
+	REQUIRE(value == 42);
+}
 
-	REQUIRE(runner.done() == true);
-	REQUIRE(runner2.done() == true);
+Co::Task<std::unique_ptr<int32>> CoReturnWithMoveOnlyTypeTest()
+{
+	co_return std::make_unique<int32>(42);
 }
 
-TEST_CASE("ScopedTaskRunner::waitUntilDone immediate")
+Co::Task<void> CoReturnWithMoveOnlyTypeTestCaller(int32* pValue)
 {
-	const auto runner = Co::DelayFrame(0).runScoped();
-	const auto runner2 = runner.waitUntilDone().runScoped();
+	auto ptr = co_await CoReturnWithMoveOnlyTypeTest();
+	*pValue = *ptr;
+}
 
-	REQUIRE(runner.done() == true);
-	REQUIRE(runner2.done() == true);
+TEST_CASE("co_return with move-only type")
+{
+	int32 value = 0;
+
+	auto task = CoReturnWithMoveOnlyTypeTestCaller(&value);
+	REQUIRE(value == 0); // タスク生成時点ではまだ実行されない
+
+	const auto runner = std::move(task).runScoped();
+	REQUIRE(value == 42); // runScopedにより実行が開始される
 }
 
-TEST_CASE("ScopedTaskRunner::waitUntilDone canceled")
+Co::Task<void> CoReturnWithMoveOnlyTypeTestCallerWithPausedWhile(int32* pValue, std::function<bool()> fnIsPaused)
 {
-	Optional<Co::ScopedTaskRunner> runner = Co::DelayFrame(3).runScoped();
-	const auto runner2 = runner->waitUntilDone().runScoped();
+	auto ptr = co_await CoReturnWithMoveOnlyTypeTest().pausedWhile(std::move(fnIsPaused));
+	*pValue = *ptr;
+}
 
-	REQUIRE(runner->done() == false);
-	REQUIRE(runner2.done() == false);
+TEST_CASE("co_return with move-only type and pausedWhile")
+{
+	int32 value = 0;
+	bool isPaused = true; // 初めからポーズにする
 
-	System::Update();
+	auto task = CoReturnWithMoveOnlyTypeTestCallerWithPausedWhile(&value, [&isPaused] { return isPaused; });
 
-	// キャンセル
-	runner = none;
+	const auto runner = std::move(task).runScoped();
+	REQUIRE(value == 0); // ポーズ中なのでrunScopedにより実行されない
 
-	// キャンセルされてもSystem::Updateが呼ばれるまでは完了しない
-	REQUIRE(runner2.done() == false);
+	// ポーズ中なので変化しない 1フレーム目
+	System::Update();
+	REQUIRE(value == 0); // 変化なし
 
+	// ポーズ中なので変化しない 2フレーム目
 	System::Update();
+	REQUIRE(value == 0); // 変化なし
 
-	// System::Updateが呼ばれたら完了する(doneとは、finishまたはcancelのことを指す)
-	REQUIRE(runner2.done() == true);
+	// ポーズ解除 3フレーム目
+	isPaused = false;
+	System::Update();
+	REQUIRE(value == 42); // ポーズ解除されたので実行される
 }
 
-TEST_CASE("ScopedTaskRunner move assignment")
+Co::Task<std::unique_ptr<int32>> CoReturnWithMoveOnlyTypeAndDelayTest()
 {
-	int32 runner1FinishCount = 0;
-	int32 runner1CancelCount = 0;
-	int32 runner2FinishCount = 0;
-	int32 runner2CancelCount = 0;
-
-	Co::ScopedTaskRunner runner = Co::DelayFrame(2).runScoped([&] { ++runner1FinishCount; }, [&] { ++runner1CancelCount; });
+	co_await Co::NextFrame();
+	co_return std::make_unique<int32>(42);
+}
 
-	REQUIRE(runner.done() == false);
-	REQUIRE(runner1FinishCount == 0);
-	REQUIRE(runner1CancelCount == 0);
-	REQUIRE(runner2FinishCount == 0);
-	REQUIRE(runner2CancelCount == 0);
+Co::Task<void> CoReturnWithMoveOnlyTypeAndDelayTestCaller(int32* pValue)
+{
+	auto ptr = co_await CoReturnWithMoveOnlyTypeAndDelayTest();
+	*pValue = *ptr;
+}
 
-	// 別のタスク実行をムーブ代入
-	runner = Co::DelayFrame(1).runScoped([&] { ++runner2FinishCount; }, [&] { ++runner2CancelCount; });
+TEST_CASE("co_return with move-only type and delay")
+{
+	int32 value = 0;
 
-	// 1個目のタスクはキャンセルされる
-	REQUIRE(runner.done() == false);
-	REQUIRE(runner1FinishCount == 0);
-	REQUIRE(runner1CancelCount == 1);
-	REQUIRE(runner2FinishCount == 0);
-	REQUIRE(runner2CancelCount == 0);
+	auto task = CoReturnWithMoveOnlyTypeAndDelayTestCaller(&value);
+	REQUIRE(value == 0); // タスク生成時点ではまだ実行されない
 
-	System::Update();
+	const auto runner = std::move(task).runScoped();
+	REQUIRE(value == 0); // runScopedにより実行が開始される
 
-	// 2個目のタスクが完了
-	REQUIRE(runner.done() == true);
-	REQUIRE(runner1FinishCount == 0);
-	REQUIRE(runner1CancelCount == 1);
-	REQUIRE(runner2FinishCount == 1);
-	REQUIRE(runner2CancelCount == 0);
+	System::Update();
+	REQUIRE(value == 42); // NextFrame()の後が実行され、co_awaitで受け取った値が返る
 
 	System::Update();
+	REQUIRE(value == 42); // すでに完了しているので何も起こらない
+}
 
-	// すでに完了しているので何も起こらない
-	REQUIRE(runner.done() == true);
-	REQUIRE(runner1FinishCount == 0);
-	REQUIRE(runner1CancelCount == 1);
-	REQUIRE(runner2FinishCount == 1);
-	REQUIRE(runner2CancelCount == 0);
+Co::Task<void> CoReturnWithMoveOnlyTypeAndDelayTestCallerWithPausedWhile(int32* pValue, std::function<bool()> fnIsPaused)
+{
+	auto ptr = co_await CoReturnWithMoveOnlyTypeAndDelayTest().pausedWhile(std::move(fnIsPaused));
+	*pValue = *ptr;
 }
 
-TEST_CASE("MultiRunner finish")
+TEST_CASE("co_return with move-only type and delay and pausedWhile")
 {
-	Co::MultiRunner mr;
-	int32 runner1FinishCount = 0;
-	int32 runner1CancelCount = 0;
-	int32 runner2FinishCount = 0;
-	int32 runner2CancelCount = 0;
+	int32 value = 0;
+	bool isPaused = true; // 初めからポーズにする
 
-	Co::DelayFrame(1).runAddTo(mr, [&] { ++runner1FinishCount; }, [&] { ++runner1CancelCount; });
-	Co::DelayFrame(2).runAddTo(mr, [&] { ++runner2FinishCount; }, [&] { ++runner2CancelCount; });
+	auto task = CoReturnWithMoveOnlyTypeAndDelayTestCallerWithPausedWhile(&value, [&isPaused] { return isPaused; });
 
-	// まだ完了していない
-	REQUIRE(runner1FinishCount == 0);
-	REQUIRE(runner1CancelCount == 0);
-	REQUIRE(runner2FinishCount == 0);
-	REQUIRE(runner2CancelCount == 0);
-	REQUIRE(mr.allDone() == false);
-	REQUIRE(mr.anyDone() == false);
+	const auto runner = std::move(task).runScoped();
+	REQUIRE(value == 0); // ポーズ中なのでrunScopedにより実行されない
 
+	// ポーズ中なので変化しない 1フレーム目
 	System::Update();
+	REQUIRE(value == 0); // 変化なし
 
-	// 1個目のタスクが完了
-	REQUIRE(runner1FinishCount == 1);
-	REQUIRE(runner1CancelCount == 0);
-	REQUIRE(runner2FinishCount == 0);
-	REQUIRE(runner2CancelCount == 0);
-	REQUIRE(mr.allDone() == false);
-	REQUIRE(mr.anyDone() == true);
+	// ポーズ中なので変化しない 2フレーム目
+	System::Update();
+	REQUIRE(value == 0); // 変化なし
 
+	// ポーズ解除 3フレーム目
+	isPaused = false;
 	System::Update();
+	REQUIRE(value == 0); // ポーズ解除されたので実行が開始され、NextFrame()が実行されるため変化なし
 
-	// 2個目のタスクが完了
-	REQUIRE(runner1FinishCount == 1);
-	REQUIRE(runner1CancelCount == 0);
-	REQUIRE(runner2FinishCount == 1);
-	REQUIRE(runner2CancelCount == 0);
-	REQUIRE(mr.allDone() == true);
-	REQUIRE(mr.anyDone() == true);
+	// NextFrame()の後が実行され、co_awaitで受け取った値が返る
+	System::Update();
+	REQUIRE(value == 42);
 }
 
-TEST_CASE("MultiRunner removeDone")
+Co::Task<void> ThrowExceptionTest()
 {
-	Co::MultiRunner mr;
-	Co::DelayFrame(1).runAddTo(mr);
-	Co::DelayFrame(2).runAddTo(mr);
+	throw std::runtime_error("test exception");
+	co_return;
+}
 
-	REQUIRE(mr.size() == 2);
+TEST_CASE("Throw exception")
+{
+	int32 finishCallbackCount = 0;
+	int32 cancelCallbackCount = 0;
 
-	// 完了していないのでremoveDoneを呼んでも削除されない
-	mr.removeDone();
-	REQUIRE(mr.size() == 2);
+	auto task = ThrowExceptionTest();
 
-	System::Update();
+	REQUIRE_THROWS_WITH(std::move(task).runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; }), "test exception");
 
-	// 1個目のタスクが完了
-	REQUIRE(mr.size() == 2);
-	mr.removeDone();
-	REQUIRE(mr.size() == 1);
+	REQUIRE(finishCallbackCount == 0);
+	REQUIRE(cancelCallbackCount == 1);
+}
 
-	System::Update();
+Co::Task<int32> ThrowExceptionWithNonVoidResultTest()
+{
+	throw std::runtime_error("test exception");
+	co_return 42;
+}
 
-	// 2個目のタスクが完了
-	REQUIRE(mr.size() == 1);
-	mr.removeDone();
-	REQUIRE(mr.size() == 0);
+TEST_CASE("Throw exception with non-void result")
+{
+	int32 finishCallbackCount = 0;
+	int32 cancelCallbackCount = 0;
 
-	// すでに空なので何も起こらない
-	mr.removeDone();
-	REQUIRE(mr.size() == 0);
+	auto task = ThrowExceptionWithNonVoidResultTest();
+
+	REQUIRE_THROWS_WITH(std::move(task).runScoped([&](int32) { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; }), "test exception");
+
+	REQUIRE(finishCallbackCount == 0);
+	REQUIRE(cancelCallbackCount == 1);
 }
 
-TEST_CASE("MultiRunner::requestCancelAll")
+Co::Task<void> ThrowExceptionWithDelayTest()
 {
-	Co::MultiRunner mr;
-	int32 runner1FinishCount = 0;
-	int32 runner1CancelCount = 0;
-	int32 runner2FinishCount = 0;
-	int32 runner2CancelCount = 0;
-	int32 runner3FinishCount = 0;
-	int32 runner3CancelCount = 0;
-
-	Co::DelayFrame(1).runAddTo(mr, [&] { ++runner1FinishCount; }, [&] { ++runner1CancelCount; });
-	Co::DelayFrame(2).runAddTo(mr, [&] { ++runner2FinishCount; }, [&] { ++runner2CancelCount; });
-	Co::DelayFrame(3).runAddTo(mr, [&] { ++runner3FinishCount; }, [&] { ++runner3CancelCount; });
+	co_await Co::NextFrame();
+	throw std::runtime_error("test exception");
+}
 
-	// まだ完了していない
-	REQUIRE(runner1FinishCount == 0);
-	REQUIRE(runner1CancelCount == 0);
-	REQUIRE(runner2FinishCount == 0);
-	REQUIRE(runner2CancelCount == 0);
-	REQUIRE(runner3FinishCount == 0);
-	REQUIRE(runner3CancelCount == 0);
-	REQUIRE(mr.allDone() == false);
-	REQUIRE(mr.anyDone() == false);
+TEST_CASE("Throw exception with delay")
+{
+	int32 finishCallbackCount = 0;
+	int32 cancelCallbackCount = 0;
 
-	System::Update();
+	auto task = ThrowExceptionWithDelayTest();
 
-	// 1個目のタスクが完了
-	REQUIRE(runner1FinishCount == 1);
-	REQUIRE(runner1CancelCount == 0);
-	REQUIRE(runner2FinishCount == 0);
-	REQUIRE(runner2CancelCount == 0);
-	REQUIRE(runner3FinishCount == 0);
-	REQUIRE(runner3CancelCount == 0);
-	REQUIRE(mr.allDone() == false);
-	REQUIRE(mr.anyDone() == true);
+	const auto runner = std::move(task).runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
 
-	// キャンセル
-	const bool canceled = mr.requestCancelAll();
-	REQUIRE(canceled == true);
+	// System::Update内で例外が発生すると以降のテスト実行に影響が出る可能性があるため、手動resumeでテスト
+	REQUIRE_THROWS_WITH(Co::detail::Backend::ManualUpdate(), "test exception");
 
-	// キャンセルされたので2個目のタスクは完了しない
-	REQUIRE(runner1FinishCount == 1);
-	REQUIRE(runner1CancelCount == 0);
-	REQUIRE(runner2FinishCount == 0);
-	REQUIRE(runner2CancelCount == 1);
-	REQUIRE(runner3FinishCount == 0);
-	REQUIRE(runner3CancelCount == 1);
-	REQUIRE(mr.allDone() == true);
-	REQUIRE(mr.anyDone() == true);
+	REQUIRE(finishCallbackCount == 0);
+	REQUIRE(cancelCallbackCount == 1);
+}
 
-	// 2回目以降のキャンセルは通らない
-	const bool canceled2 = mr.requestCancelAll();
-	REQUIRE(canceled2 == false);
-	REQUIRE(runner1FinishCount == 1);
-	REQUIRE(runner1CancelCount == 0);
-	REQUIRE(runner2FinishCount == 0);
-	REQUIRE(runner2CancelCount == 1);
-	REQUIRE(runner3FinishCount == 0);
-	REQUIRE(runner3CancelCount == 1);
+Co::Task<int32> ThrowExceptionWithDelayAndNonVoidResultTest()
+{
+	co_await Co::NextFrame();
+	throw std::runtime_error("test exception");
+	co_return 42;
 }
 
-TEST_CASE("MultiRunner::waitUntilAllDone")
+TEST_CASE("Throw exception with delay and non-void result")
 {
-	Co::MultiRunner mr;
-	Co::DelayFrame(3).runAddTo(mr);
-	Co::DelayFrame(1).runAddTo(mr);
-	Co::DelayFrame(2).runAddTo(mr);
+	int32 finishCallbackCount = 0;
+	int32 cancelCallbackCount = 0;
 
-	const auto runner = mr.waitUntilAllDone().runScoped();
+	auto task = ThrowExceptionWithDelayAndNonVoidResultTest();
 
-	// まだ完了していない
-	REQUIRE(runner.done() == false);
+	const auto runner = std::move(task).runScoped([&](int32) { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
 
-	System::Update();
+	// System::Update内で例外が発生すると以降のテスト実行に影響が出る可能性があるため、手動resumeでテスト
+	REQUIRE_THROWS_WITH(Co::detail::Backend::ManualUpdate(), "test exception");
 
-	// 1個のタスクが完了
-	REQUIRE(runner.done() == false);
+	REQUIRE(finishCallbackCount == 0);
+	REQUIRE(cancelCallbackCount == 1);
+}
+
+Co::Task<int32> DeeplyNestedTaskTest(int32 depth, Array<String>* pLog)
+{
+	pLog->push_back(U"enter {}"_fmt(depth));
+	if (depth == 0)
+	{
+		co_await Co::DelayFrame(2);
+		pLog->push_back(U"leaf");
+		co_return 1;
+	}
+
+	// 子タスクを2回続けて待機する
+	const int32 first = co_await DeeplyNestedTaskTest(depth - 1, pLog);
+	const int32 second = co_await DeeplyNestedTaskTest(depth - 1, pLog);
+	pLog->push_back(U"exit {}"_fmt(depth));
+	co_return first + second;
+}
+
+TEST_CASE("Deeply nested task")
+{
+	Array<String> log;
+	int32 result = 0;
+
+	const auto runner = DeeplyNestedTaskTest(2, &log).runScoped([&](int32 r) { result = r; });
+	REQUIRE(log == Array<String>{ U"enter 2", U"enter 1", U"enter 0" });
 
 	System::Update();
+	REQUIRE(log.size() == 3);
 
-	// 2個のタスクが完了
-	REQUIRE(runner.done() == false);
+	// 末端のタスクの完了後、同一フレーム内で親タスクへ順に戻り、次の子タスクの待機を開始する
+	log.clear();
+	System::Update();
+	REQUIRE(log == Array<String>{ U"leaf", U"enter 0" });
 
 	System::Update();
+	System::Update();
+	REQUIRE(log == Array<String>{ U"leaf", U"enter 0", U"leaf", U"exit 1", U"enter 1", U"enter 0" });
 
-	// 3個のタスクが完了
+	log.clear();
+	for (int32 i = 0; i < 4; ++i)
+	{
+		REQUIRE(runner.done() == false);
+		System::Update();
+	}
+	REQUIRE(log == Array<String>{ U"leaf", U"enter 0", U"leaf", U"exit 1", U"exit 2" });
 	REQUIRE(runner.done() == true);
+	REQUIRE(result == 4);
 }
 
-TEST_CASE("MultiRunner::waitUntilAllDone immediate")
+Co::Task<void> NestedTaskWithConcurrentTaskTest(int32* pValue, int32* pConcurrentCount)
 {
-	Co::MultiRunner mr;
-	Co::DelayFrame(0).runAddTo(mr);
-	Co::DelayFrame(0).runAddTo(mr);
-	Co::DelayFrame(0).runAddTo(mr);
-
-	const auto runner = mr.waitUntilAllDone().runScoped();
-
-	REQUIRE(runner.done() == true);
+	// 中間の階層のタスクが同時実行タスクを持つ場合も、同時実行タスクは毎フレーム実行される
+	co_await CoReturnWithDelayTestCaller(pValue)
+		.with(Co::UpdaterTask([pConcurrentCount] { ++*pConcurrentCount; }));
+	co_await Co::NextFrame();
+	*pValue = 100;
 }
 
-TEST_CASE("MultiRunner::waitUntilAllDone empty")
+Co::Task<void> NestedTaskWithConcurrentTaskCaller(int32* pValue, int32* pConcurrentCount)
 {
-	Co::MultiRunner mr;
-
-	const auto runner = mr.waitUntilAllDone().runScoped();
-
-	REQUIRE(runner.done() == true);
+	co_await NestedTaskWithConcurrentTaskTest(pValue, pConcurrentCount);
 }
 
-TEST_CASE("MultiRunner::waitUntilAllDone added while running")
+TEST_CASE("Nested task with concurrent task")
 {
-	Co::MultiRunner mr;
-	Co::DelayFrame(1).runAddTo(mr);
-
-	const auto runner = mr.waitUntilAllDone().runScoped();
-	REQUIRE(runner.done() == false);
+	int32 value = 0;
+	int32 concurrentCount = 0;
 
-	// タスクを後から追加
-	Co::DelayFrame(2).runAddTo(mr);
+	const auto runner = NestedTaskWithConcurrentTaskCaller(&value, &concurrentCount).runScoped();
+	REQUIRE(value == 1);
+	REQUIRE(concurrentCount == 1);
 
 	System::Update();
-
-	// 後から追加されたタスクが完了していないのでまだ完了しない
-	REQUIRE(runner.done() == false);
+	REQUIRE(value == 42);
+	REQUIRE(concurrentCount == 2);
 
 	System::Update();
+	REQUIRE(value == 100);
+	REQUIRE(concurrentCount == 2);
+	REQUIRE(runner.done() == true);
+}
 
-	// 2個のタスクが完了
-	REQUIRE(mr.allDone() == true);
-
-	// ただし、後から追加されたタスクはwaitUntilAllDoneより実行順が後ろなので、waitUntilAllDoneはまだ完了しない
-	REQUIRE(runner.done() == false);
-
-	System::Update();
+Co::Task<void> NestedTaskWithPausedWhileTest(int32* pFrameCount, const bool* pIsPaused)
+{
+	co_await Co::UpdaterTask([pFrameCount] { ++*pFrameCount; }).pausedWhile([pIsPaused] { return *pIsPaused; });
+}
 
-	// ここでwaitUntilAllDoneが完了
-	REQUIRE(runner.done() == true);
+Co::Task<void> NestedTaskWithPausedWhileCaller(int32* pFrameCount, const bool* pIsPaused)
+{
+	co_await NestedTaskWithPausedWhileTest(pFrameCount, pIsPaused);
 }
 
-TEST_CASE("MultiRunner::waitUntilAnyDone")
+TEST_CASE("Nested task with pausedWhile")
 {
-	Co::MultiRunner mr;
-	Co::DelayFrame(3).runAddTo(mr);
-	Co::DelayFrame(1).runAddTo(mr);
-	Co::DelayFrame(2).runAddTo(mr);
+	int32 frameCount = 0;
+	bool isPaused = false;
 
-	const auto runner = mr.waitUntilAnyDone().runScoped();
+	const auto runner = NestedTaskWithPausedWhileCaller(&frameCount, &isPaused).runScoped();
+	REQUIRE(frameCount == 1);
 
-	// まだ完了していない
-	REQUIRE(runner.done() == false);
+	System::Update();
+	REQUIRE(frameCount == 2);
 
+	// 子孫のタスクがポーズ中の間は実行されない
+	isPaused = true;
+	System::Update();
 	System::Update();
+	REQUIRE(frameCount == 2);
 
-	// 1個のタスクが完了
-	REQUIRE(runner.done() == true);
+	isPaused = false;
+	System::Update();
+	REQUIRE(frameCount == 3);
+	REQUIRE(runner.done() == false);
 }
 
-TEST_CASE("MultiRunner::waitUntilAnyDone immediate")
+Co::Task<void> DeeplyNestedThrowExceptionTest(int32 depth)
 {
-	Co::MultiRunner mr;
-	Co::DelayFrame(0).runAddTo(mr);
-	Co::DelayFrame(0).runAddTo(mr);
-	Co::DelayFrame(0).runAddTo(mr);
+	if (depth == 0)
+	{
+		co_await ThrowExceptionWithDelayTest();
+		co_return;
+	}
+	co_await DeeplyNestedThrowExceptionTest(depth - 1);
+}
 
-	const auto runner = mr.waitUntilAnyDone().runScoped();
+TEST_CASE("Throw exception in deeply nested task")
+{
+	int32 finishCallbackCount = 0;
+	int32 cancelCallbackCount = 0;
 
-	REQUIRE(runner.done() == true);
+	const auto runner = DeeplyNestedThrowExceptionTest(5).runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
+
+	// 末端のタスクで発生した例外は、親タスクへ順に伝播する
+	REQUIRE_THROWS_WITH(Co::detail::Backend::ManualUpdate(), "test exception");
+
+	REQUIRE(finishCallbackCount == 0);
+	REQUIRE(cancelCallbackCount == 1);
 }
 
-TEST_CASE("MultiRunner::waitUntilAnyDone empty")
+TEST_CASE("TaskFinishSource<void>")
 {
-	Co::MultiRunner mr;
+	Co::TaskFinishSource<void> taskFinishSource;
+	REQUIRE(taskFinishSource.done() == false);
 
-	const auto runner = mr.waitUntilAnyDone().runScoped();
+	// 初回のリクエストではtrueが返る
+	REQUIRE(taskFinishSource.requestFinish() == true);
+	REQUIRE(taskFinishSource.done() == true);
 
-	// 10フレーム待っても完了しない
-	for (int32 i = 0; i < 10; ++i)
-	{
-		System::Update();
-		REQUIRE(runner.done() == false);
-	}
+	// 2回目以降のリクエストは受け付けない
+	REQUIRE(taskFinishSource.requestFinish() == false);
+	REQUIRE(taskFinishSource.done() == true);
 }
 
-TEST_CASE("MultiRunner::waitUntilAnyDone added while running")
+TEST_CASE("TaskFinishSource<void>::waitUntilDone")
 {
-	Co::MultiRunner mr;
-	Co::DelayFrame(3).runAddTo(mr);
+	Co::TaskFinishSource<void> taskFinishSource;
+	const auto runner = taskFinishSource.waitUntilDone().runScoped();
 
-	const auto runner = mr.waitUntilAnyDone().runScoped();
+	// まだ完了していない
 	REQUIRE(runner.done() == false);
+	REQUIRE(taskFinishSource.done() == false);
 
-	// タスクを後から追加
-	Co::DelayFrame(1).runAddTo(mr);
-
-	System::Update();
-
-	// 後から追加されたタスクが完了
-	REQUIRE(mr.anyDone() == true);
+	// 完了リクエスト
+	taskFinishSource.requestFinish();
 
-	// ただし、後から追加されたタスクはwaitUntilAnyDoneより実行順が後ろなので、waitUntilAnyDoneはまだ完了しない
+	// System::Updateが呼ばれるまでは完了しない
 	REQUIRE(runner.done() == false);
+	REQUIRE(taskFinishSource.done() == true);
 
 	System::Update();
 
-	// ここでwaitUntilAnyDoneが完了
+	// System::Updateが呼ばれたら完了する
 	REQUIRE(runner.done() == true);
+	REQUIRE(taskFinishSource.done() == true);
 }
 
-Co::Task<void> WaitForeverTest(int32* pValue)
+TEST_CASE("TaskFinishSource<int32>")
 {
-	*pValue = 1;
-	co_await Co::WaitForever();
-	*pValue = 2;
-}
+	Co::TaskFinishSource<int32> taskFinishSource;
+	REQUIRE(taskFinishSource.done() == false);
+	REQUIRE(taskFinishSource.hasResult() == false);
 
-TEST_CASE("WaitForever")
-{
-	int32 value = 0;
-	bool isFinished = false;
-	bool isCanceled = false;
+	// 結果が入るまではresultは例外を投げる
+	REQUIRE_THROWS_AS(taskFinishSource.result(), Error);
 
-	{
-		const auto runner = WaitForeverTest(&value).runScoped([&] { isFinished = true; }, [&] { isCanceled = true; });
-		REQUIRE(value == 1); // runScoped呼び出し時点で最初のsuspendまでは実行される
-		REQUIRE(isFinished == false);
-		REQUIRE(isCanceled == false);
+	// 初回のリクエストではtrueが返る
+	REQUIRE(taskFinishSource.requestFinish(42) == true);
+	REQUIRE(taskFinishSource.done() == true);
 
-		// 10回Updateしても完了しない
-		for (int32 i = 0; i < 10; ++i)
-		{
-			System::Update();
-			REQUIRE(value == 1);
-			REQUIRE(runner.done() == false);
-		}
-	}
+	// 結果が取得できる
+	REQUIRE(taskFinishSource.hasResult() == true);
+	REQUIRE(taskFinishSource.result() == 42);
 
-	// キャンセルされたのでisCanceledがtrueになる
-	REQUIRE(value == 1);
-	REQUIRE(isFinished == false);
-	REQUIRE(isCanceled == true);
-}
+	// 2回目以降の結果取得はできない
+	REQUIRE(taskFinishSource.hasResult() == false);
+	REQUIRE_THROWS_AS(taskFinishSource.result(), Error);
+	REQUIRE(taskFinishSource.done() == true);
 
-Co::Task<void> WaitUntilTest(bool* pCondition)
-{
-	co_await Co::WaitUntil([&] { return *pCondition; });
+	// 2回目以降のリクエストは受け付けない
+	REQUIRE(taskFinishSource.requestFinish(4242) == false);
+	REQUIRE(taskFinishSource.hasResult() == false);
+	REQUIRE_THROWS_AS(taskFinishSource.result(), Error);
+	REQUIRE(taskFinishSource.done() == true);
 }
 
-TEST_CASE("WaitUntil")
+TEST_CASE("TaskFinishSource<int32>::waitUntilDone")
 {
-	bool condition = false;
+	Co::TaskFinishSource<int32> taskFinishSource;
+	const auto runner = taskFinishSource.waitUntilDone().runScoped();
 
-	const auto runner = WaitUntilTest(&condition).runScoped();
+	// まだ完了していない
 	REQUIRE(runner.done() == false);
+	REQUIRE(taskFinishSource.done() == false);
 
-	// 条件を満たさないのでUpdateしても完了しない
-	System::Update();
-	REQUIRE(runner.done() == false);
+	// 完了リクエスト
+	taskFinishSource.requestFinish(42);
 
-	// 条件を満たしてもUpdateが呼ばれるまでは完了しない
-	condition = true;
+	// System::Updateが呼ばれるまでは完了しない
 	REQUIRE(runner.done() == false);
+	REQUIRE(taskFinishSource.done() == true);
 
-	// 条件を満たした後の初回のUpdateで完了する
 	System::Update();
+
+	// System::Updateが呼ばれたら完了する
 	REQUIRE(runner.done() == true);
+	REQUIRE(taskFinishSource.done() == true);
+	REQUIRE(taskFinishSource.hasResult() == true);
+	REQUIRE(taskFinishSource.result() == 42);
 }
 
-TEST_CASE("Finish WaitUntil immediately")
+TEST_CASE("TaskFinishSource<int32>::waitForResult")
 {
-	bool condition = true;
+	Co::TaskFinishSource<int32> taskFinishSource;
+	Optional<int32> result = none;
+	const auto runner = taskFinishSource.waitForResult().runScoped([&](int32 r) { result = r; });
 
-	// 既に条件を満たしているが、タスク生成時点ではまだ実行されない
-	auto task = WaitUntilTest(&condition);
-	REQUIRE(task.done() == false);
+	// まだ完了していない
+	REQUIRE(runner.done() == false);
+	REQUIRE(taskFinishSource.done() == false);
+	REQUIRE(result == none);
 
-	// 既に条件を満たしているのでrunScopedで開始すると即座に完了する
-	const auto runner = std::move(task).runScoped();
+	// 完了リクエスト
+	taskFinishSource.requestFinish(42);
+
+	// System::Updateが呼ばれるまでは完了しない
+	REQUIRE(runner.done() == false);
+	REQUIRE(taskFinishSource.done() == true);
+	REQUIRE(result == none);
+
+	System::Update();
+
+	// System::Updateが呼ばれたら完了する
 	REQUIRE(runner.done() == true);
+	REQUIRE(taskFinishSource.done() == true);
+	REQUIRE(result == 42);
+
+	// 2回目以降の結果取得はできない
+	// (waitForResult内で既に結果取得しているため2回目となる)
+	REQUIRE_THROWS_AS(taskFinishSource.result(), Error);
+	REQUIRE(taskFinishSource.done() == true);
 }
 
-Co::Task<void> WaitWhileTest(bool* pCondition)
+Co::Task<void> RequestFinishAfterFramesTest(Co::TaskFinishSource<void>* pTaskFinishSource, int32 frames)
 {
-	co_await Co::WaitWhile([&] { return *pCondition; });
+	co_await Co::DelayFrame(frames);
+	pTaskFinishSource->requestFinish();
 }
 
-TEST_CASE("WaitWhile")
+TEST_CASE("TaskFinishSource<void>::waitUntilDone wake timing")
 {
-	bool condition = true;
-
-	const auto runner = WaitWhileTest(&condition).runScoped();
-	REQUIRE(runner.done() == false);
+	Co::TaskFinishSource<void> taskFinishSource;
+	const auto runnerBefore = taskFinishSource.waitUntilDone().runScoped();
+	const auto requester = RequestFinishAfterFramesTest(&taskFinishSource, 2).runScoped();
+	const auto runnerAfter = taskFinishSource.waitUntilDone().runScoped();
 
-	// 条件を満たした状態なのでUpdateしても完了しない
 	System::Update();
-	REQUIRE(runner.done() == false);
 
-	// 条件を満たさなくなったものの、Updateが呼ばれるまでは完了しない
-	condition = false;
-	REQUIRE(runner.done() == false);
+	REQUIRE(runnerBefore.done() == false);
+	REQUIRE(runnerAfter.done() == false);
 
-	// 条件を満たさなくなった後の初回のUpdateで完了する
 	System::Update();
-	REQUIRE(runner.done() == true);
-}
 
-TEST_CASE("Finish WaitWhile immediately")
-{
-	bool condition = false;
+	// 完了リクエストより実行順が後ろのタスクは、同一フレーム内で完了する
+	REQUIRE(taskFinishSource.done() == true);
+	REQUIRE(runnerBefore.done() == false);
+	REQUIRE(runnerAfter.done() == true);
 
-	// 既に条件を満たしていないが、タスク生成時点ではまだ実行されない
-	auto task = WaitWhileTest(&condition);
-	REQUIRE(task.done() == false);
+	System::Update();
 
-	// 既に条件を満たさなくなっているのでrunScopedで開始すると即座に完了する
-	const auto runner = std::move(task).runScoped();
-	REQUIRE(runner.done() == true);
+	// 完了リクエストより実行順が前のタスクは、次フレームで完了する
+	REQUIRE(runnerBefore.done() == true);
 }
 
-TEST_CASE("WaitForResult with std::optional")
+TEST_CASE("TaskFinishSource<int32>::waitForResult in Co::All")
 {
-	std::optional<int32> result;
-	int32 ret = 0;
-
-	const auto runner = Co::WaitForResult(&result).runScoped([&](int32 r) { ret = r; });
-	REQUIRE(runner.done() == false);
-	REQUIRE(ret == 0);
+	Co::TaskFinishSource<int32> taskFinishSource;
+	Optional<int32> result = none;
+	const auto runner = Co::All(taskFinishSource.waitForResult(), Co::DelayFrame(1)).runScoped([&](const auto& r) { result = std::get<0>(r); });
 
-	// 結果が代入されるまで完了しない
 	System::Update();
-	REQUIRE(runner.done() == false);
-	REQUIRE(ret == 0);
+	System::Update();
 
-	result = 42;
+	// 待機リストで休止できない場合も、毎フレーム確認して完了する
+	REQUIRE(result == none);
+	taskFinishSource.requestFinish(42);
+	System::Update();
+	REQUIRE(runner.done() == true);
+	REQUIRE(result == 42);
+}
 
-	// 結果が代入されてもUpdateが呼ばれるまでは完了しない
-	REQUIRE(runner.done() == false);
-	REQUIRE(ret == 0);
+TEST_CASE("TaskFinishSource::waitForResult with move-only type")
+{
+	Co::TaskFinishSource<std::unique_ptr<int32>> taskFinishSource;
+	int32 result = 0;
+	const auto runner = taskFinishSource.waitForResult().runScoped([&](std::unique_ptr<int32> r) { result = *r; });
 
-	// 結果が代入された後の初回のUpdateで完了する
+	taskFinishSource.requestFinish(std::make_unique<int32>(42));
 	System::Update();
 	REQUIRE(runner.done() == true);
-	REQUIRE(ret == 42);
+	REQUIRE(result == 42);
+
+	// 結果はwaitForResultへムーブ済み
+	REQUIRE(taskFinishSource.hasResult() == false);
+	REQUIRE(taskFinishSource.done() == true);
+	REQUIRE_THROWS_AS(taskFinishSource.result(), Error);
 }
 
-TEST_CASE("Finish WaitForResult with std::optional immediately")
+struct ResultLifetimeCounter
 {
-	std::optional<int32> result = 42;
-	int32 ret = 0;
+	static inline int32 NumAlive = 0;
 
-	// 既に結果が代入されているが、タスク生成時点ではまだ実行されない
-	auto task = Co::WaitForResult(&result);
-	REQUIRE(task.done() == false);
+	int32 value;
 
-	// 既に結果が代入されているのでrunScopedで開始すると即座に完了する
-	const auto runner = std::move(task).runScoped([&](int32 r) { ret = r; });
-	REQUIRE(runner.done() == true);
-	REQUIRE(ret == 42);
+	explicit ResultLifetimeCounter(int32 v)
+		: value(v)
+	{
+		++NumAlive;
+	}
 
-	// Updateを呼んでも何も起こらない
-	System::Update();
-	REQUIRE(runner.done() == true);
-	REQUIRE(ret == 42);
+	ResultLifetimeCounter(const ResultLifetimeCounter& rhs)
+		: value(rhs.value)
+	{
+		++NumAlive;
+	}
+
+	ResultLifetimeCounter(ResultLifetimeCounter&& rhs) noexcept
+		: value(rhs.value)
+	{
+		++NumAlive;
+	}
+
+	~ResultLifetimeCounter()
+	{
+		--NumAlive;
+	}
+};
+
+Co::Task<ResultLifetimeCounter> ResultLifetimeTest()
+{
+	co_await Co::NextFrame();
+	co_return ResultLifetimeCounter{ 42 };
 }
 
-TEST_CASE("WaitForResult with Optional")
+TEST_CASE("Task result lifetime")
 {
-	Optional<int32> result;
-	int32 ret = 0;
+	ResultLifetimeCounter::NumAlive = 0;
 
-	const auto runner = Co::WaitForResult(&result).runScoped([&](int32 r) { ret = r; });
-	REQUIRE(runner.done() == false);
-	REQUIRE(ret == 0);
+	{
+		// 結果を取得しないまま破棄されたタスクの結果も破棄される
+		const auto runner = ResultLifetimeTest().runScoped();
+		System::Update();
+		REQUIRE(runner.done() == true);
+	}
+	REQUIRE(ResultLifetimeCounter::NumAlive == 0);
 
-	// 結果が代入されるまで完了しない
-	System::Update();
-	REQUIRE(runner.done() == false);
-	REQUIRE(ret == 0);
+	{
+		int32 value = 0;
+		const auto runner = ResultLifetimeTest().runScoped([&](ResultLifetimeCounter r) { value = r.value; });
+		System::Update();
+		REQUIRE(value == 42);
+	}
+	REQUIRE(ResultLifetimeCounter::NumAlive == 0);
 
-	result = 42;
+	{
+		Co::TaskFinishSource<ResultLifetimeCounter> taskFinishSource;
+		taskFinishSource.requestFinish(ResultLifetimeCounter{ 1 });
+		REQUIRE(ResultLifetimeCounter::NumAlive == 1);
+
+		// 2回目の完了リクエストは無視される
+		REQUIRE(taskFinishSource.requestFinish(ResultLifetimeCounter{ 2 }) == false);
+		REQUIRE(ResultLifetimeCounter::NumAlive == 1);
+
+		REQUIRE(taskFinishSource.result().value == 1);
+		REQUIRE(ResultLifetimeCounter::NumAlive == 0);
+	}
+	REQUIRE(ResultLifetimeCounter::NumAlive == 0);
+}
+
+TEST_CASE("ScopedTaskRunner::requestCancel")
+{
+	int32 finishCallbackCount = 0;
+	int32 cancelCallbackCount = 0;
+
+	auto runner = Co::DelayFrame(3).runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
 
-	// 結果が代入されてもUpdateが呼ばれるまでは完了しない
 	REQUIRE(runner.done() == false);
-	REQUIRE(ret == 0);
 
-	// 結果が代入された後の初回のUpdateで完了する
-	System::Update();
+	// キャンセル
+	const bool canceled = runner.requestCancel();
+	REQUIRE(canceled == true);
+
+	// 即時でキャンセルされる
 	REQUIRE(runner.done() == true);
-	REQUIRE(ret == 42);
+	REQUIRE(finishCallbackCount == 0);
+	REQUIRE(cancelCallbackCount == 1);
+
+	// 2回目以降のキャンセルは通らない
+	const bool canceled2 = runner.requestCancel();
+	REQUIRE(canceled2 == false);
+	REQUIRE(finishCallbackCount == 0);
+	REQUIRE(cancelCallbackCount == 1);
 }
 
-TEST_CASE("Finish WaitForResult with Optional immediately")
+TEST_CASE("ScopedTaskRunner::requestCancel after finished")
 {
-	Optional<int32> result = 42;
-	int32 ret = 0;
+	int32 finishCallbackCount = 0;
+	int32 cancelCallbackCount = 0;
 
-	// 既に結果が代入されているが、タスク生成時点ではまだ実行されない
-	auto task = Co::WaitForResult(&result);
-	REQUIRE(task.done() == false);
+	auto runner = Co::DelayFrame(3).runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
+	for (int32 i = 0; i < 3; ++i)
+	{
+		REQUIRE(runner.done() == false);
+		System::Update();
+	}
 
-	// 既に結果が代入されているのでrunScopedで開始すると即座に完了する
-	const auto runner = std::move(task).runScoped([&](int32 r) { ret = r; });
+	// 完了済みである
 	REQUIRE(runner.done() == true);
-	REQUIRE(ret == 42);
+	REQUIRE(finishCallbackCount == 1);
+	REQUIRE(cancelCallbackCount == 0);
 
-	// Updateを呼んでも何も起こらない
-	System::Update();
-	REQUIRE(runner.done() == true);
-	REQUIRE(ret == 42);
+	// 完了済みの場合はキャンセル要求は通らない
+	const bool canceled = runner.requestCancel();
+	REQUIRE(canceled == false);
+	REQUIRE(finishCallbackCount == 1);
+	REQUIRE(cancelCallbackCount == 0);
 }
 
-TEST_CASE("WaitUntilHasValue with std::optional")
+TEST_CASE("ScopedTaskRunner::waitUntilDone")
 {
-	std::optional<int32> result;
+	const auto runner = Co::DelayFrame(3).runScoped();
+	const auto runner2 = runner.waitUntilDone().runScoped();
 
-	const auto runner = Co::WaitUntilHasValue(&result).runScoped();
 	REQUIRE(runner.done() == false);
+	REQUIRE(runner2.done() == false);
 
-	// 結果が代入されるまで完了しない
 	System::Update();
+
 	REQUIRE(runner.done() == false);
+	REQUIRE(runner2.done() == false);
 
-	result = 42;
+	System::Update();
 
-	// 結果が代入されてもUpdateが呼ばれるまでは完了しない
 	REQUIRE(runner.done() == false);
+	REQUIRE(runner2.done() == false);
 
-	// 結果が代入された後の初回のUpdateで完了する
 	System::Update();
+
 	REQUIRE(runner.done() == true);
+	REQUIRE(runner2.done() == true);
 }
 
-TEST_CASE("Finish WaitUntilHasValue with std::optional immediately")
+TEST_CASE("ScopedTaskRunner::waitUntilDone immediate")
 {
-	std::optional<int32> result = 42;
-
-	// 既に結果が代入されているが、タスク生成時点ではまだ実行されない
-	auto task = Co::WaitUntilHasValue(&result);
-	REQUIRE(task.done() == false);
+	const auto runner = Co::DelayFrame(0).runScoped();
+	const auto runner2 = runner.waitUntilDone().runScoped();
 
-	// 既に結果が代入されているのでrunScopedで開始すると即座に完了する
-	const auto runner = std::move(task).runScoped();
 	REQUIRE(runner.done() == true);
+	REQUIRE(runner2.done() == true);
 }
 
-TEST_CASE("WaitUntilHasValue with Optional")
+TEST_CASE("ScopedTaskRunner::waitUntilDone canceled")
 {
-	Optional<int32> result;
+	Optional<Co::ScopedTaskRunner> runner = Co::DelayFrame(3).runScoped();
+	const auto runner2 = runner->waitUntilDone().runScoped();
 
-	const auto runner = Co::WaitUntilHasValue(&result).runScoped();
-	REQUIRE(runner.done() == false);
+	REQUIRE(runner->done() == false);
+	REQUIRE(runner2.done() == false);
 
-	// 結果が代入されるまで完了しない
 	System::Update();
-	REQUIRE(runner.done() == false);
 
-	result = 42;
+	// キャンセル
+	runner = none;
 
-	// 結果が代入されてもUpdateが呼ばれるまでは完了しない
-	REQUIRE(runner.done() == false);
+	// キャンセルされてもSystem::Updateが呼ばれるまでは完了しない
+	REQUIRE(runner2.done() == false);
 
-	// 結果が代入された後の初回のUpdateで完了する
 	System::Update();
-	REQUIRE(runner.done() == true);
+
+	// System::Updateが呼ばれたら完了する(doneとは、finishまたはcancelのことを指す)
+	REQUIRE(runner2.done() == true);
 }
 
-TEST_CASE("Finish WaitUntilHasValue with Optional immediately")
+TEST_CASE("ScopedTaskRunner::waitUntilDone wake timing")
 {
-	Optional<int32> result = 42;
+	Optional<Co::ScopedTaskRunner> runner;
+	Optional<Co::ScopedTaskRunner> runnerBefore;
+	Optional<Co::ScopedTaskRunner> runnerAfter;
+	runnerBefore = Co::UpdaterTask([&] {}).runScoped(); // 実行順を確保するためのダミー
+	runner = Co::DelayFrame(2).runScoped();
+	runnerAfter = runner->waitUntilDone().runScoped();
+	runnerBefore = runner->waitUntilDone().runScoped();
 
-	// 既に結果が代入されているが、タスク生成時点ではまだ実行されない
-	auto task = Co::WaitUntilHasValue(&result);
-	REQUIRE(task.done() == false);
+	System::Update();
 
-	// 既に結果が代入されているのでrunScopedで開始すると即座に完了する
-	const auto runner = std::move(task).runScoped();
-	REQUIRE(runner.done() == true);
+	REQUIRE(runnerAfter->done() == false);
+	REQUIRE(runnerBefore->done() == false);
+
+	System::Update();
+
+	// 待機対象より実行順が後ろのタスクは、同一フレーム内で完了する
+	// (後から登録したrunnerBeforeも、待機対象より実行順が後ろになる)
+	REQUIRE(runner->done() == true);
+	REQUIRE(runnerAfter->done() == true);
+	REQUIRE(runnerBefore->done() == true);
 }
 
-TEST_CASE("WaitUntilValueChanged")
+TEST_CASE("ScopedTaskRunner::waitUntilDone canceled by earlier task")
 {
-	int32 value = 0;
-	const auto runner = Co::WaitUntilValueChanged(&value).runScoped();
-	REQUIRE(runner.done() == false);
+	Optional<Co::ScopedTaskRunner> runner;
+	int32 frameCount = 0;
+	const auto canceler = Co::UpdaterTask([&] { if (++frameCount == 3) { runner.reset(); } }).runScoped();
+	runner = Co::DelayFrame(100).runScoped();
+	const auto waiter = runner->waitUntilDone().runScoped();
 
-	// 値が変わるまでは完了しない
 	System::Update();
-	REQUIRE(runner.done() == false);
-
-	// 値が変わってもUpdateが呼ばれるまでは完了しない
-	value = 42;
-	REQUIRE(runner.done() == false);
+	REQUIRE(waiter.done() == false);
 
-	// 値が変わった後の初回のUpdateで完了する
 	System::Update();
-	REQUIRE(runner.done() == true);
+
+	// キャンセルした時点で実行順がまだ来ていないタスクは、同一フレーム内で完了する
+	REQUIRE(runner == none);
+	REQUIRE(waiter.done() == true);
 }
 
-TEST_CASE("WaitForTimer")
+TEST_CASE("ScopedTaskRunner move assignment")
 {
-	TestClock clock;
+	int32 runner1FinishCount = 0;
+	int32 runner1CancelCount = 0;
+	int32 runner2FinishCount = 0;
+	int32 runner2CancelCount = 0;
 
-	Timer timer{ 1s, StartImmediately::Yes, &clock };
+	Co::ScopedTaskRunner runner = Co::DelayFrame(2).runScoped([&] { ++runner1FinishCount; }, [&] { ++runner1CancelCount; });
 
-	const auto runner = Co::WaitForTimer(&timer).runScoped();
 	REQUIRE(runner.done() == false);
+	REQUIRE(runner1FinishCount == 0);
+	REQUIRE(runner1CancelCount == 0);
+	REQUIRE(runner2FinishCount == 0);
+	REQUIRE(runner2CancelCount == 0);
 
-	// 0秒
-	clock.microsec = 0;
-	System::Update();
+	// 別のタスク実行をムーブ代入
+	runner = Co::DelayFrame(1).runScoped([&] { ++runner2FinishCount; }, [&] { ++runner2CancelCount; });
+
+	// 1個目のタスクはキャンセルされる
 	REQUIRE(runner.done() == false);
+	REQUIRE(runner1FinishCount == 0);
+	REQUIRE(runner1CancelCount == 1);
+	REQUIRE(runner2FinishCount == 0);
+	REQUIRE(runner2CancelCount == 0);
 
-	// 0.999秒
-	clock.microsec = 999'000;
 	System::Update();
-	REQUIRE(runner.done() == false);
 
-	// 1.001秒
-	clock.microsec = 1'001'000;
+	// 2個目のタスクが完了
+	REQUIRE(runner.done() == true);
+	REQUIRE(runner1FinishCount == 0);
+	REQUIRE(runner1CancelCount == 1);
+	REQUIRE(runner2FinishCount == 1);
+	REQUIRE(runner2CancelCount == 0);
+
 	System::Update();
+
+	// すでに完了しているので何も起こらない
 	REQUIRE(runner.done() == true);
+	REQUIRE(runner1FinishCount == 0);
+	REQUIRE(runner1CancelCount == 1);
+	REQUIRE(runner2FinishCount == 1);
+	REQUIRE(runner2CancelCount == 0);
 }
 
-Co::Task<void> AssignValueWithDelay(int32 value, int32* pDest, Duration delay, ISteadyClock* pSteadyClock)
+TEST_CASE("ScopedTaskRunner with reused ID slot")
 {
-	*pDest = 1;
-	co_await Co::Delay(delay, pSteadyClock);
-	*pDest = value;
-}
-
-TEST_CASE("Co::All running tasks")
-{
-	TestClock clock;
-	int32 value1 = 0;
-	int32 value2 = 0;
-	int32 value3 = 0;
-
-	auto task = Co::All(
-		AssignValueWithDelay(10, &value1, 1s, &clock),
-		AssignValueWithDelay(20, &value2, 2s, &clock),
-		AssignValueWithDelay(30, &value3, 3s, &clock));
-
-	// タスク生成時点ではまだ実行されない
-	REQUIRE(value1 == 0);
-	REQUIRE(value2 == 0);
-	REQUIRE(value3 == 0);
-
-	// runScopedで開始すると最初のsuspendまで実行される
-	const auto runner = std::move(task).runScoped();
-	REQUIRE(value1 == 1);
-	REQUIRE(value2 == 1);
-	REQUIRE(value3 == 1);
-	REQUIRE(runner.done() == false);
-
-	// 0秒
-	clock.microsec = 0;
-	System::Update();
-	REQUIRE(value1 == 1);
-	REQUIRE(value2 == 1);
-	REQUIRE(value3 == 1);
-	REQUIRE(runner.done() == false);
+	int32 runner2FinishCount = 0;
+	int32 runner2CancelCount = 0;
 
-	// 0.999秒
-	clock.microsec = 999'000;
+	Optional<Co::ScopedTaskRunner> runner1 = Co::DelayFrame(1).runScoped();
 	System::Update();
-	REQUIRE(value1 == 1);
-	REQUIRE(value2 == 1);
-	REQUIRE(value3 == 1);
-	REQUIRE(runner.done() == false);
+	REQUIRE(runner1->done() == true);
 
-	// 1.001秒
-	clock.microsec = 1'001'000;
-	System::Update();
-	REQUIRE(value1 == 10);
-	REQUIRE(value2 == 1);
-	REQUIRE(value3 == 1);
-	REQUIRE(runner.done() == false);
+	// 完了済みタスクの内部IDの枠は、後から開始したタスクで再利用される
+	const auto runner2 = Co::DelayFrame(2).runScoped([&] { ++runner2FinishCount; }, [&] { ++runner2CancelCount; });
+	REQUIRE(runner1->done() == true);
+	REQUIRE(runner2.done() == false);
 
-	// 1.999秒
-	clock.microsec = 1'999'000;
-	System::Update();
-	REQUIRE(value1 == 10);
-	REQUIRE(value2 == 1);
-	REQUIRE(value3 == 1);
-	REQUIRE(runner.done() == false);
+	// 完了済みのタスクのScopedTaskRunnerを破棄しても、後から開始したタスクには影響しない
+	runner1 = none;
+	REQUIRE(runner2.done() == false);
+	REQUIRE(runner2CancelCount == 0);
 
-	// 2.001秒
-	clock.microsec = 2'001'000;
 	System::Update();
-	REQUIRE(value1 == 10);
-	REQUIRE(value2 == 20);
-	REQUIRE(value3 == 1);
-	REQUIRE(runner.done() == false);
-
-	// 2.999秒
-	clock.microsec = 2'999'000;
 	System::Update();
-	REQUIRE(value1 == 10);
-	REQUIRE(value2 == 20);
-	REQUIRE(value3 == 1);
-	REQUIRE(runner.done() == false);
 
-	// 3.001秒
-	clock.microsec = 3'001'000;
-	System::Update();
-	REQUIRE(value1 == 10);
-	REQUIRE(value2 == 20);
-	REQUIRE(value3 == 30);
-	REQUIRE(runner.done() == true);
+	REQUIRE(runner2.done() == true);
+	REQUIRE(runner2FinishCount == 1);
+	REQUIRE(runner2CancelCount == 0);
 }
 
-Co::Task<int32> GetValueWithDelay(int32 value, Duration delay, ISteadyClock* pSteadyClock)
+TEST_CASE("Backend::IsDone with never issued ID")
 {
-	co_await Co::Delay(delay, pSteadyClock);
-	co_return value;
+	Co::Scheduler scheduler;
+	const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+	const auto backend = Co::detail::Backend::Current();
+
+	// 新しいスケジューラで最初に発行されるIDは、スロット番号0・世代番号1
+	const Co::detail::AwaiterID firstID = uint64{ 1 } << 32;
+	const Co::detail::AwaiterID secondGenerationID = uint64{ 2 } << 32;
+
+	// 未発行のIDは完了済みとみなさない
+	REQUIRE(Co::detail::Backend::IsDone(backend, 0) == false);
+	REQUIRE(Co::detail::Backend::IsDone(backend, firstID) == false);
+	{
+		const auto runner = Co::DelayFrame(1).runScoped();
+		REQUIRE(Co::detail::Backend::IsDone(backend, firstID) == false);
+		REQUIRE(Co::detail::Backend::IsDone(backend, firstID + 1) == false);
+	}
+
+	// 発行済みでスロットが解放されたIDは完了済み。解放後に進んだ世代番号のIDはまだ発行されていない
+	REQUIRE(Co::detail::Backend::IsDone(backend, firstID) == true);
+	REQUIRE(Co::detail::Backend::IsDone(backend, secondGenerationID) == false);
 }
 
-Co::Task<void> GetValueWithDelayCallerWithAll(int32* pDest1, int32* pDest2, int32* pDest3, ISteadyClock* pSteadyClock)
+Co::Task<void> PushBackEveryFrameTest(Array<int32>* pArray, int32 value)
 {
-	std::tie(*pDest1, *pDest2, *pDest3) = co_await Co::All(
-		GetValueWithDelay(10, 1s, pSteadyClock),
-		GetValueWithDelay(20, 2s, pSteadyClock),
-		GetValueWithDelay(30, 3s, pSteadyClock));
+	while (true)
+	{
+		pArray->push_back(value);
+		co_await Co::NextFrame();
+	}
 }
 
-TEST_CASE("Co::All return value")
+TEST_CASE("Execution order after removal")
 {
-	TestClock clock;
-	int32 value1 = 0;
-	int32 value2 = 0;
-	int32 value3 = 0;
-
-	const auto runner = GetValueWithDelayCallerWithAll(&value1, &value2, &value3, &clock).runScoped();
+	Array<int32> values;
 
-	REQUIRE(value1 == 0);
-	REQUIRE(value2 == 0);
-	REQUIRE(value3 == 0);
-	REQUIRE(runner.done() == false);
+	auto runner1 = PushBackEveryFrameTest(&values, 1).runScoped();
+	Optional<Co::ScopedTaskRunner> runner2 = PushBackEveryFrameTest(&values, 2).runScoped();
+	auto runner3 = PushBackEveryFrameTest(&values, 3).runScoped();
+	REQUIRE(values == Array<int32>{ 1, 2, 3 });
 
-	// 0秒
-	clock.microsec = 0;
+	values.clear();
 	System::Update();
-	REQUIRE(value1 == 0);
-	REQUIRE(value2 == 0);
-	REQUIRE(value3 == 0);
-	REQUIRE(runner.done() == false);
+	REQUIRE(values == Array<int32>{ 1, 2, 3 });
 
-	// 0.999秒
-	clock.microsec = 999'000;
+	// 途中のタスクを削除しても、残りのタスクの実行順は変わらない
+	runner2 = none;
+	values.clear();
 	System::Update();
-	REQUIRE(value1 == 0);
-	REQUIRE(value2 == 0);
-	REQUIRE(value3 == 0);
-	REQUIRE(runner.done() == false);
+	REQUIRE(values == Array<int32>{ 1, 3 });
 
-	// 1.001秒
-	clock.microsec = 1'001'000;
+	// 後から開始したタスクは、削除されたタスクの枠を再利用しても最後に実行される
+	auto runner4 = PushBackEveryFrameTest(&values, 4).runScoped();
+	values.clear();
 	System::Update();
-	REQUIRE(value1 == 0); // 全部完了するまで代入されない
-	REQUIRE(value2 == 0);
-	REQUIRE(value3 == 0);
-	REQUIRE(runner.done() == false);
+	REQUIRE(values == Array<int32>{ 1, 3, 4 });
+}
 
-	// 1.999秒
-	clock.microsec = 1'999'000;
-	System::Update();
-	REQUIRE(value1 == 0);
-	REQUIRE(value2 == 0);
-	REQUIRE(value3 == 0);
-	REQUIRE(runner.done() == false);
+TEST_CASE("MultiRunner finish")
+{
+	Co::MultiRunner mr;
+	int32 runner1FinishCount = 0;
+	int32 runner1CancelCount = 0;
+	int32 runner2FinishCount = 0;
+	int32 runner2CancelCount = 0;
 
-	// 2.001秒
-	clock.microsec = 2'001'000;
-	System::Update();
-	REQUIRE(value1 == 0);
-	REQUIRE(value2 == 0); // 全部完了するまで代入されない
-	REQUIRE(value3 == 0);
-	REQUIRE(runner.done() == false);
+	Co::DelayFrame(1).runAddTo(mr, [&] { ++runner1FinishCount; }, [&] { ++runner1CancelCount; });
+	Co::DelayFrame(2).runAddTo(mr, [&] { ++runner2FinishCount; }, [&] { ++runner2CancelCount; });
+
+	// まだ完了していない
+	REQUIRE(runner1FinishCount == 0);
+	REQUIRE(runner1CancelCount == 0);
+	REQUIRE(runner2FinishCount == 0);
+	REQUIRE(runner2CancelCount == 0);
+	REQUIRE(mr.allDone() == false);
+	REQUIRE(mr.anyDone() == false);
 
-	// 2.999秒
-	clock.microsec = 2'999'000;
 	System::Update();
-	REQUIRE(value1 == 0);
-	REQUIRE(value2 == 0);
-	REQUIRE(value3 == 0);
-	REQUIRE(runner.done() == false);
 
-	// 3.001秒
-	clock.microsec = 3'001'000;
+	// 1個目のタスクが完了
+	REQUIRE(runner1FinishCount == 1);
+	REQUIRE(runner1CancelCount == 0);
+	REQUIRE(runner2FinishCount == 0);
+	REQUIRE(runner2CancelCount == 0);
+	REQUIRE(mr.allDone() == false);
+	REQUIRE(mr.anyDone() == true);
+
 	System::Update();
-	REQUIRE(value1 == 10);
-	REQUIRE(value2 == 20);
-	REQUIRE(value3 == 30);
-	REQUIRE(runner.done() == true);
-}
 
-Co::Task<void> PushBackValueWithDelayFrame(std::vector<int32>* pVec, int32 value)
-{
-	pVec->push_back(value);
-	co_await Co::NextFrame();
-	pVec->push_back(value * 10);
+	// 2個目のタスクが完了
+	REQUIRE(runner1FinishCount == 1);
+	REQUIRE(runner1CancelCount == 0);
+	REQUIRE(runner2FinishCount == 1);
+	REQUIRE(runner2CancelCount == 0);
+	REQUIRE(mr.allDone() == true);
+	REQUIRE(mr.anyDone() == true);
 }
 
-TEST_CASE("Co::All execution order")
+TEST_CASE("MultiRunner removeDone")
 {
-	std::vector<int32> vec;
+	Co::MultiRunner mr;
+	Co::DelayFrame(1).runAddTo(mr);
+	Co::DelayFrame(2).runAddTo(mr);
 
-	const auto runner = Co::All(
-		PushBackValueWithDelayFrame(&vec, 1),
-		PushBackValueWithDelayFrame(&vec, 2),
-		PushBackValueWithDelayFrame(&vec, 3)).runScoped();
+	REQUIRE(mr.size() == 2);
 
-	// runScopedを呼んだ時点で最初のsuspendまでは実行される
-	// 渡した順番でresumeされる
-	REQUIRE(vec.size() == 3);
-	REQUIRE(vec == std::vector<int32>{ 1, 2, 3 });
-	REQUIRE(runner.done() == false);
+	// 完了していないのでremoveDoneを呼んでも削除されない
+	mr.removeDone();
+	REQUIRE(mr.size() == 2);
 
 	System::Update();
 
-	// 渡した順番でresumeされる
-	REQUIRE(vec.size() == 6);
-	REQUIRE(vec == std::vector<int32>{ 1, 2, 3, 10, 20, 30 });
-	REQUIRE(runner.done() == true);
-}
+	// 1個目のタスクが完了
+	REQUIRE(mr.size() == 2);
+	mr.removeDone();
+	REQUIRE(mr.size() == 1);
 
-Co::Task<void> AllWithImmediateTasks()
-{
-	const auto [a, b] = co_await Co::All(
-		CoReturnTest(),
-		CoReturnTest());
+	System::Update();
 
-	REQUIRE(a == 42);
-	REQUIRE(b == 42);
-}
+	// 2個目のタスクが完了
+	REQUIRE(mr.size() == 1);
+	mr.removeDone();
+	REQUIRE(mr.size() == 0);
 
-TEST_CASE("Co::All with immediate tasks")
-{
-	const auto runner = AllWithImmediateTasks().runScoped();
-	REQUIRE(runner.done() == true);
+	// すでに空なので何も起こらない
+	mr.removeDone();
+	REQUIRE(mr.size() == 0);
 }
 
-TEST_CASE("Co::Any running tasks")
+TEST_CASE("MultiRunner::requestCancelAll")
 {
-	TestClock clock;
-	int32 value1 = 0;
-	int32 value2 = 0;
-	int32 value3 = 0;
+	Co::MultiRunner mr;
+	int32 runner1FinishCount = 0;
+	int32 runner1CancelCount = 0;
+	int32 runner2FinishCount = 0;
+	int32 runner2CancelCount = 0;
+	int32 runner3FinishCount = 0;
+	int32 runner3CancelCount = 0;
 
-	const auto runner = Co::Any(
-		AssignValueWithDelay(10, &value1, 1s, &clock),
-		AssignValueWithDelay(20, &value2, 2s, &clock),
-		AssignValueWithDelay(30, &value3, 3s, &clock)).runScoped();
+	Co::DelayFrame(1).runAddTo(mr, [&] { ++runner1FinishCount; }, [&] { ++runner1CancelCount; });
+	Co::DelayFrame(2).runAddTo(mr, [&] { ++runner2FinishCount; }, [&] { ++runner2CancelCount; });
+	Co::DelayFrame(3).runAddTo(mr, [&] { ++runner3FinishCount; }, [&] { ++runner3CancelCount; });
 
-	// 呼び出し時点で最初のsuspendまでは実行される
-	REQUIRE(value1 == 1);
-	REQUIRE(value2 == 1);
-	REQUIRE(value3 == 1);
-	REQUIRE(runner.done() == false);
+	// まだ完了していない
+	REQUIRE(runner1FinishCount == 0);
+	REQUIRE(runner1CancelCount == 0);
+	REQUIRE(runner2FinishCount == 0);
+	REQUIRE(runner2CancelCount == 0);
+	REQUIRE(runner3FinishCount == 0);
+	REQUIRE(runner3CancelCount == 0);
+	REQUIRE(mr.allDone() == false);
+	REQUIRE(mr.anyDone() == false);
 
-	// 0秒
-	clock.microsec = 0;
 	System::Update();
-	REQUIRE(value1 == 1);
-	REQUIRE(value2 == 1);
-	REQUIRE(value3 == 1);
-	REQUIRE(runner.done() == false);
 
-	// 0.999秒
-	clock.microsec = 999'000;
-	System::Update();
-	REQUIRE(value1 == 1);
-	REQUIRE(value2 == 1);
-	REQUIRE(value3 == 1);
-	REQUIRE(runner.done() == false);
+	// 1個目のタスクが完了
+	REQUIRE(runner1FinishCount == 1);
+	REQUIRE(runner1CancelCount == 0);
+	REQUIRE(runner2FinishCount == 0);
+	REQUIRE(runner2CancelCount == 0);
+	REQUIRE(runner3FinishCount == 0);
+	REQUIRE(runner3CancelCount == 0);
+	REQUIRE(mr.allDone() == false);
+	REQUIRE(mr.anyDone() == true);
 
-	// 1.001秒
-	clock.microsec = 1'001'000;
-	System::Update();
-	REQUIRE(value1 == 10);
-	REQUIRE(value2 == 1);
-	REQUIRE(value3 == 1);
-	REQUIRE(runner.done() == true);
-}
+	// キャンセル
+	const bool canceled = mr.requestCancelAll();
+	REQUIRE(canceled == true);
 
-Co::Task<void> GetValueWithDelayCallerWithAny(Optional<int32>* pDest1, Optional<int32>* pDest2, Optional<int32>* pDest3, ISteadyClock* pSteadyClock)
-{
-	std::tie(*pDest1, *pDest2, *pDest3) = co_await Co::Any(
-		GetValueWithDelay(10, 1s, pSteadyClock),
-		GetValueWithDelay(20, 2s, pSteadyClock),
-		GetValueWithDelay(30, 3s, pSteadyClock));
+	// キャンセルされたので2個目のタスクは完了しない
+	REQUIRE(runner1FinishCount == 1);
+	REQUIRE(runner1CancelCount == 0);
+	REQUIRE(runner2FinishCount == 0);
+	REQUIRE(runner2CancelCount == 1);
+	REQUIRE(runner3FinishCount == 0);
+	REQUIRE(runner3CancelCount == 1);
+	REQUIRE(mr.allDone() == true);
+	REQUIRE(mr.anyDone() == true);
+
+	// 2回目以降のキャンセルは通らない
+	const bool canceled2 = mr.requestCancelAll();
+	REQUIRE(canceled2 == false);
+	REQUIRE(runner1FinishCount == 1);
+	REQUIRE(runner1CancelCount == 0);
+	REQUIRE(runner2FinishCount == 0);
+	REQUIRE(runner2CancelCount == 1);
+	REQUIRE(runner3FinishCount == 0);
+	REQUIRE(runner3CancelCount == 1);
 }
 
-TEST_CASE("Co::Any return value")
+TEST_CASE("MultiRunner::waitUntilAllDone")
 {
-	TestClock clock;
-	Optional<int32> value1 = 0;
-	Optional<int32> value2 = 0;
-	Optional<int32> value3 = 0;
+	Co::MultiRunner mr;
+	Co::DelayFrame(3).runAddTo(mr);
+	Co::DelayFrame(1).runAddTo(mr);
+	Co::DelayFrame(2).runAddTo(mr);
 
-	const auto runner = GetValueWithDelayCallerWithAny(&value1, &value2, &value3, &clock).runScoped();
+	const auto runner = mr.waitUntilAllDone().runScoped();
 
-	REQUIRE(value1 == 0);
-	REQUIRE(value2 == 0);
-	REQUIRE(value3 == 0);
+	// まだ完了していない
 	REQUIRE(runner.done() == false);
 
-	// 0秒
-	clock.microsec = 0;
 	System::Update();
-	REQUIRE(value1 == 0);
-	REQUIRE(value2 == 0);
-	REQUIRE(value3 == 0);
+
+	// 1個のタスクが完了
 	REQUIRE(runner.done() == false);
 
-	// 0.999秒
-	clock.microsec = 999'000;
 	System::Update();
-	REQUIRE(value1 == 0);
-	REQUIRE(value2 == 0);
-	REQUIRE(value3 == 0);
+
+	// 2個のタスクが完了
 	REQUIRE(runner.done() == false);
 
-	// 1.001秒
-	clock.microsec = 1'001'000;
 	System::Update();
-	REQUIRE(value1 == 10);
-	REQUIRE(value2 == none);
-	REQUIRE(value3 == none);
+
+	// 3個のタスクが完了
 	REQUIRE(runner.done() == true);
 }
 
-Co::Task<void> AnyReturnsOptionalVoidResultTest()
+TEST_CASE("MultiRunner::waitUntilAllDone immediate")
 {
-	const auto [a, b, c] = co_await Co::Any(
-		Co::DelayFrame(3),
-		Co::DelayFrame(1),
-		Co::DelayFrame(2));
+	Co::MultiRunner mr;
+	Co::DelayFrame(0).runAddTo(mr);
+	Co::DelayFrame(0).runAddTo(mr);
+	Co::DelayFrame(0).runAddTo(mr);
 
-	REQUIRE((bool)a == false);
-	REQUIRE((bool)b == true);
-	REQUIRE((bool)c == false);
+	const auto runner = mr.waitUntilAllDone().runScoped();
+
+	REQUIRE(runner.done() == true);
 }
 
-TEST_CASE("Co::Any returns VoidResult")
+TEST_CASE("MultiRunner::waitUntilAllDone empty")
 {
-	const auto runner = AnyReturnsOptionalVoidResultTest().runScoped();
+	Co::MultiRunner mr;
+
+	const auto runner = mr.waitUntilAllDone().runScoped();
 
-	REQUIRE(runner.done() == false);
-	System::Update();
 	REQUIRE(runner.done() == true);
 }
 
-Co::Task<void> AnyReturnsOptionalVoidResultMultipleTest()
+TEST_CASE("MultiRunner::waitUntilAllDone added while running")
 {
-	const auto [a, b, c, d, e] = co_await Co::Any(
-		Co::DelayFrame(4),
-		Co::DelayFrame(2),
-		Co::DelayFrame(3),
-		Co::DelayFrame(2),
-		Co::DelayFrame(2));
+	Co::MultiRunner mr;
+	Co::DelayFrame(1).runAddTo(mr);
 
-	REQUIRE((bool)a == false);
-	REQUIRE((bool)b == true);
-	REQUIRE((bool)c == false);
-	REQUIRE((bool)d == true);
-	REQUIRE((bool)e == true);
-}
+	const auto runner = mr.waitUntilAllDone().runScoped();
+	REQUIRE(runner.done() == false);
 
-TEST_CASE("Co::Any returns VoidResult multiple")
-{
-	const auto runner = AnyReturnsOptionalVoidResultMultipleTest().runScoped();
+	// タスクを後から追加
+	Co::DelayFrame(2).runAddTo(mr);
 
+	System::Update();
+
+	// 後から追加されたタスクが完了していないのでまだ完了しない
 	REQUIRE(runner.done() == false);
+
 	System::Update();
+
+	// 2個のタスクが完了
+	REQUIRE(mr.allDone() == true);
+
+	// ただし、後から追加されたタスクはwaitUntilAllDoneより実行順が後ろなので、waitUntilAllDoneはまだ完了しない
 	REQUIRE(runner.done() == false);
+
 	System::Update();
+
+	// ここでwaitUntilAllDoneが完了
 	REQUIRE(runner.done() == true);
 }
 
-TEST_CASE("Co::Any execution order")
+TEST_CASE("MultiRunner::waitUntilAnyDone")
 {
-	std::vector<int32> vec;
+	Co::MultiRunner mr;
+	Co::DelayFrame(3).runAddTo(mr);
+	Co::DelayFrame(1).runAddTo(mr);
+	Co::DelayFrame(2).runAddTo(mr);
 
-	const auto runner = Co::Any(
-		PushBackValueWithDelayFrame(&vec, 1),
-		PushBackValueWithDelayFrame(&vec, 2),
-		PushBackValueWithDelayFrame(&vec, 3)).runScoped();
+	const auto runner = mr.waitUntilAnyDone().runScoped();
 
-	// runScopedを呼んだ時点で最初のsuspendまでは実行される
-	// 渡した順番でresumeされる
-	REQUIRE(vec.size() == 3);
-	REQUIRE(vec == std::vector<int32>{ 1, 2, 3 });
+	// まだ完了していない
 	REQUIRE(runner.done() == false);
 
 	System::Update();
 
-	// 渡した順番でresumeされる
-	REQUIRE(vec.size() == 6);
-	REQUIRE(vec == std::vector<int32>{ 1, 2, 3, 10, 20, 30 });
+	// 1個のタスクが完了
 	REQUIRE(runner.done() == true);
 }
 
-Co::Task<void> AnyWithImmediateTasks()
+TEST_CASE("MultiRunner::waitUntilAnyDone immediate")
 {
-	const auto [a, b] = co_await Co::Any(
-		CoReturnTest(),
-		Co::DelayFrame(1));
+	Co::MultiRunner mr;
+	Co::DelayFrame(0).runAddTo(mr);
+	Co::DelayFrame(0).runAddTo(mr);
+	Co::DelayFrame(0).runAddTo(mr);
 
-	REQUIRE(a == 42);
-	REQUIRE((bool)b == false);
-}
+	const auto runner = mr.waitUntilAnyDone().runScoped();
 
-TEST_CASE("Co::Any with immediate tasks")
-{
-	const auto runner = AnyWithImmediateTasks().runScoped();
 	REQUIRE(runner.done() == true);
 }
 
-Co::Task<void> AnyWithNonCopyableResult()
+TEST_CASE("MultiRunner::waitUntilAnyDone added after waiting")
 {
-	const auto [a, b, c] = co_await Co::Any(
-		CoReturnWithMoveOnlyTypeAndDelayTest().discardResult(),
-		Co::DelayFrame(1),
-		Co::DelayFrame(2));
-
-	REQUIRE((bool)a == true);
-	REQUIRE((bool)b == true);
-	REQUIRE((bool)c == false);
-}
+	Co::MultiRunner mr;
+	Co::DelayFrame(100).runAddTo(mr);
 
-TEST_CASE("Co::Any with non-copyable result")
-{
-	const auto runner = AnyWithNonCopyableResult().runScoped();
-	REQUIRE(runner.done() == false);
+	const auto runner = mr.waitUntilAnyDone().runScoped();
 	System::Update();
-	REQUIRE(runner.done() == true);
-}
-
-TEST_CASE("UpdaterTask without TaskFinishSource argument")
-{
-	int32 count = 0;
-	auto task = Co::UpdaterTask([&] { ++count; });
+	System::Update();
+	REQUIRE(runner.done() == false);
 
-	// タスク生成時点ではまだ実行されない
-	REQUIRE(count == 0);
+	// 待機を開始した後に追加したタスクも待機対象になる
+	Co::DelayFrame(1).runAddTo(mr);
 
-	// runScopedで開始すると最初のsuspendまで実行される
-	const auto runner = std::move(task).runScoped();
-	REQUIRE(count == 1);
-	REQUIRE(runner.done() == false);
-	
 	System::Update();
-	REQUIRE(count == 2);
+
+	// 後から追加されたタスクはwaitUntilAnyDoneより実行順が後ろなので、waitUntilAnyDoneは次フレームで完了する
+	REQUIRE(mr.anyDone() == true);
 	REQUIRE(runner.done() == false);
 
 	System::Update();
-	REQUIRE(count == 3);
-	REQUIRE(runner.done() == false);
+
+	REQUIRE(runner.done() == true);
 }
 
-TEST_CASE("UpdaterTask with TaskFinishSource argument")
+TEST_CASE("MultiRunner::waitUntilAnyDone empty")
 {
-	int32 count = 0;
-	auto task = Co::UpdaterTask<void>(
-		[&](Co::TaskFinishSource<void>& taskFinishSource)
-		{
-			if (count == 3)
-			{
-				taskFinishSource.requestFinish();
-				return;
-			}
-			++count;
-		});
+	Co::MultiRunner mr;
 
-	// タスク生成時点ではまだ実行されない
-	REQUIRE(count == 0);
+	const auto runner = mr.waitUntilAnyDone().runScoped();
 
-	// runScopedで開始すると最初のsuspendまで実行される
-	const auto runner = std::move(task).runScoped();
-	REQUIRE(count == 1);
-	REQUIRE(runner.done() == false);
+	// 10フレーム待っても完了しない
+	for (int32 i = 0; i < 10; ++i)
+	{
+		System::Update();
+		REQUIRE(runner.done() == false);
+	}
+}
 
-	System::Update();
-	REQUIRE(count == 2);
+TEST_CASE("MultiRunner::waitUntilAnyDone added while running")
+{
+	Co::MultiRunner mr;
+	Co::DelayFrame(3).runAddTo(mr);
+
+	const auto runner = mr.waitUntilAnyDone().runScoped();
 	REQUIRE(runner.done() == false);
 
+	// タスクを後から追加
+	Co::DelayFrame(1).runAddTo(mr);
+
 	System::Update();
-	REQUIRE(count == 3);
+
+	// 後から追加されたタスクが完了
+	REQUIRE(mr.anyDone() == true);
+
+	// ただし、後から追加されたタスクはwaitUntilAnyDoneより実行順が後ろなので、waitUntilAnyDoneはまだ完了しない
 	REQUIRE(runner.done() == false);
 
-	// requestFinishが呼ばれたら完了する
 	System::Update();
-	REQUIRE(count == 3);
+
+	// ここでwaitUntilAnyDoneが完了
 	REQUIRE(runner.done() == true);
 }
 
-TEST_CASE("UpdaterTask with TaskFinishSource argument that has result")
+Co::Task<void> WaitForeverTest(int32* pValue)
 {
-	int32 count = 0;
-	auto task = Co::UpdaterTask<int32>(
-		[&](Co::TaskFinishSource<int32>& taskFinishSource)
+	*pValue = 1;
+	co_await Co::WaitForever();
+	*pValue = 2;
+}
+
+TEST_CASE("WaitForever")
+{
+	int32 value = 0;
+	bool isFinished = false;
+	bool isCanceled = false;
+
+	{
+		const auto runner = WaitForeverTest(&value).runScoped([&] { isFinished = true; }, [&] { isCanceled = true; });
+		REQUIRE(value == 1); // runScoped呼び出し時点で最初のsuspendまでは実行される
+		REQUIRE(isFinished == false);
+		REQUIRE(isCanceled == false);
+
+		// 10回Updateしても完了しない
+		for (int32 i = 0; i < 10; ++i)
 		{
-			if (count == 3)
-			{
-				taskFinishSource.requestFinish(42);
-				return;
-			}
-			++count;
-		});
+			System::Update();
+			REQUIRE(value == 1);
+			REQUIRE(runner.done() == false);
+		}
+	}
 
-	// タスク生成時点ではまだ実行されない
-	REQUIRE(count == 0);
+	// キャンセルされたのでisCanceledがtrueになる
+	REQUIRE(value == 1);
+	REQUIRE(isFinished == false);
+	REQUIRE(isCanceled == true);
+}
 
-	int32 result = 0;
+Co::Task<void> WaitUntilTest(bool* pCondition)
+{
+	co_await Co::WaitUntil([&] { return *pCondition; });
+}
 
-	// runScopedで開始すると最初のsuspendまで実行される
-	const auto runner = std::move(task).runScoped([&](int32 r) { result = r; });
-	REQUIRE(count == 1);
+TEST_CASE("WaitUntil")
+{
+	bool condition = false;
+
+	const auto runner = WaitUntilTest(&condition).runScoped();
 	REQUIRE(runner.done() == false);
-	REQUIRE(result == 0);
 
+	// 条件を満たさないのでUpdateしても完了しない
 	System::Update();
-	REQUIRE(count == 2);
 	REQUIRE(runner.done() == false);
-	REQUIRE(result == 0);
 
-	System::Update();
-	REQUIRE(count == 3);
+	// 条件を満たしてもUpdateが呼ばれるまでは完了しない
+	condition = true;
 	REQUIRE(runner.done() == false);
-	REQUIRE(result == 0);
 
-	// requestFinishが呼ばれたら完了する
+	// 条件を満たした後の初回のUpdateで完了する
 	System::Update();
-	REQUIRE(count == 3);
 	REQUIRE(runner.done() == true);
-	REQUIRE(result == 42);
 }
 
-TEST_CASE("UpdaterTask with TaskFinishSource argument that has immediate result")
+TEST_CASE("Finish WaitUntil immediately")
 {
-	int32 count = 0;
-	auto task = Co::UpdaterTask<int32>(
-		[&](Co::TaskFinishSource<int32>& taskFinishSource)
-		{
-			++count;
-			taskFinishSource.requestFinish(42);
-		});
-
-	// タスク生成時点ではまだ実行されない
-	REQUIRE(count == 0);
+	bool condition = true;
 
-	int32 result = 0;
+	// 既に条件を満たしているが、タスク生成時点ではまだ実行されない
+	auto task = WaitUntilTest(&condition);
+	REQUIRE(task.done() == false);
 
-	// runScopedで開始すると最初のsuspendまで実行されて即座に完了する
-	const auto runner = std::move(task).runScoped([&](int32 r) { result = r; });
-	REQUIRE(count == 1);
+	// 既に条件を満たしているのでrunScopedで開始すると即座に完了する
+	const auto runner = std::move(task).runScoped();
 	REQUIRE(runner.done() == true);
-	REQUIRE(result == 42);
 }
 
-TEST_CASE("UpdaterTask with TaskFinishSource argument that has move-only result")
+Co::Task<void> WaitWhileTest(bool* pCondition)
 {
-	int32 count = 0;
-	auto task = Co::UpdaterTask<std::unique_ptr<int32>>(
-		[&](Co::TaskFinishSource<std::unique_ptr<int32>>& taskFinishSource)
-		{
-			if (count == 3)
-			{
-				taskFinishSource.requestFinish(std::make_unique<int32>(42));
-				return;
-			}
-			++count;
-		});
-
-	// タスク生成時点ではまだ実行されない
-	REQUIRE(count == 0);
+	co_await Co::WaitWhile([&] { return *pCondition; });
+}
 
-	std::unique_ptr<int32> result;
+TEST_CASE("WaitWhile")
+{
+	bool condition = true;
 
-	// runScopedで開始すると最初のsuspendまで実行される
-	const auto runner = std::move(task).runScoped([&](std::unique_ptr<int32> r) { result = std::move(r); });
-	REQUIRE(count == 1);
+	const auto runner = WaitWhileTest(&condition).runScoped();
 	REQUIRE(runner.done() == false);
-	REQUIRE(result == nullptr);
 
+	// 条件を満たした状態なのでUpdateしても完了しない
 	System::Update();
-	REQUIRE(count == 2);
 	REQUIRE(runner.done() == false);
-	REQUIRE(result == nullptr);
 
-	System::Update();
-	REQUIRE(count == 3);
+	// 条件を満たさなくなったものの、Updateが呼ばれるまでは完了しない
+	condition = false;
 	REQUIRE(runner.done() == false);
-	REQUIRE(result == nullptr);
 
-	// requestFinishが呼ばれたら完了する
+	// 条件を満たさなくなった後の初回のUpdateで完了する
 	System::Update();
-	REQUIRE(count == 3);
 	REQUIRE(runner.done() == true);
-	REQUIRE(result != nullptr);
-	REQUIRE(*result == 42);
 }
 
-struct SequenceProgress
+TEST_CASE("Finish WaitWhile immediately")
 {
-	bool isPreStartStarted = false;
-	bool isPreStartFinished = false;
-	bool isStartStarted = false;
-	bool isStartFinished = false;
-	bool isFadeInStarted = false;
-	bool isFadeInFinished = false;
-	bool isFadeOutStarted = false;
-	bool isFadeOutFinished = false;
-	bool isPostFadeOutStarted = false;
-	bool isPostFadeOutFinished = false;
+	bool condition = false;
 
-	auto operator<=>(const SequenceProgress&) const = default;
+	// 既に条件を満たしていないが、タスク生成時点ではまだ実行されない
+	auto task = WaitWhileTest(&condition);
+	REQUIRE(task.done() == false);
 
-	bool allFalse() const
-	{
-		return *this == SequenceProgress{};
-	}
-};
+	// 既に条件を満たさなくなっているのでrunScopedで開始すると即座に完了する
+	const auto runner = std::move(task).runScoped();
+	REQUIRE(runner.done() == true);
+}
 
-class TestSequence : public Co::SequenceBase<int32>
+TEST_CASE("WaitForResult with std::optional")
 {
-public:
-	explicit TestSequence(int32 argValue, SequenceProgress* pProgress)
-		: m_argValue(argValue)
-		, m_pProgress(pProgress)
-	{
-	}
+	std::optional<int32> result;
+	int32 ret = 0;
 
-private:
-	int32 m_argValue;
-	SequenceProgress* m_pProgress;
+	const auto runner = Co::WaitForResult(&result).runScoped([&](int32 r) { ret = r; });
+	REQUIRE(runner.done() == false);
+	REQUIRE(ret == 0);
 
-	Co::Task<void> preStart() override
-	{
-		m_pProgress->isPreStartStarted = true;
-		co_await Co::NextFrame();
-		m_pProgress->isPreStartFinished = true;
-	}
+	// 結果が代入されるまで完了しない
+	System::Update();
+	REQUIRE(runner.done() == false);
+	REQUIRE(ret == 0);
 
-	Co::Task<void> fadeIn() override
-	{
-		m_pProgress->isFadeInStarted = true;
-		co_await Co::NextFrame();
-		m_pProgress->isFadeInFinished = true;
-	}
+	result = 42;
 
-	Co::Task<int32> start() override
-	{
-		m_pProgress->isStartStarted = true;
-		co_await Co::NextFrame();
-		m_pProgress->isStartFinished = true;
-		co_return m_argValue;
-	}
+	// 結果が代入されてもUpdateが呼ばれるまでは完了しない
+	REQUIRE(runner.done() == false);
+	REQUIRE(ret == 0);
 
-	Co::Task<void> fadeOut() override
-	{
-		m_pProgress->isFadeOutStarted = true;
-		co_await Co::NextFrame();
-		m_pProgress->isFadeOutFinished = true;
-	}
+	// 結果が代入された後の初回のUpdateで完了する
+	System::Update();
+	REQUIRE(runner.done() == true);
+	REQUIRE(ret == 42);
+}
 
-	Co::Task<void> postFadeOut() override
-	{
-		m_pProgress->isPostFadeOutStarted = true;
-		co_await Co::NextFrame();
-		m_pProgress->isPostFadeOutFinished = true;
-	}
-};
-
-TEST_CASE("Sequence")
+TEST_CASE("Finish WaitForResult with std::optional immediately")
 {
-	SequenceProgress progress;
-	TestSequence sequence{ 42, &progress };
-	const auto runner = sequence.playScoped();
-	REQUIRE(sequence.done() == false);
-	REQUIRE(runner.done() == false);
-	REQUIRE(progress.isPreStartStarted == true); // 呼び出し時点で最初のsuspendまでは実行される
-	REQUIRE(progress.isPreStartFinished == false);
-	REQUIRE(progress.isFadeInStarted == false);
-	REQUIRE(progress.isFadeInFinished == false);
-	REQUIRE(progress.isStartStarted == false);
-	REQUIRE(progress.isStartFinished == false);
-	REQUIRE(progress.isFadeOutStarted == false);
-	REQUIRE(progress.isFadeOutFinished == false);
-	REQUIRE(progress.isPostFadeOutStarted == false);
-	REQUIRE(progress.isPostFadeOutFinished == false);
-
-	System::Update();
-
-	REQUIRE(sequence.done() == false);
-	REQUIRE(runner.done() == false);
-	REQUIRE(progress.isPreStartStarted == true);
-	REQUIRE(progress.isPreStartFinished == true);
-	REQUIRE(progress.isFadeInStarted == true); // fadeInとstartは同時に実行される
-	REQUIRE(progress.isFadeInFinished == false);
-	REQUIRE(progress.isStartStarted == true); // fadeInとstartは同時に実行される
-	REQUIRE(progress.isStartFinished == false);
-	REQUIRE(progress.isFadeOutStarted == false);
-	REQUIRE(progress.isFadeOutFinished == false);
-	REQUIRE(progress.isPostFadeOutStarted == false);
-	REQUIRE(progress.isPostFadeOutFinished == false);
-
-	System::Update();
-
-	REQUIRE(sequence.done() == false);
-	REQUIRE(runner.done() == false);
-	REQUIRE(progress.isPreStartStarted == true);
-	REQUIRE(progress.isPreStartFinished == true);
-	REQUIRE(progress.isFadeInStarted == true);
-	REQUIRE(progress.isFadeInFinished == true);
-	REQUIRE(progress.isStartStarted == true);
-	REQUIRE(progress.isStartFinished == true);
-	REQUIRE(progress.isFadeOutStarted == true);
-	REQUIRE(progress.isFadeOutFinished == false);
-	REQUIRE(progress.isPostFadeOutStarted == false);
-	REQUIRE(progress.isPostFadeOutFinished == false);
+	std::optional<int32> result = 42;
+	int32 ret = 0;
 
-	System::Update();
+	// 既に結果が代入されているが、タスク生成時点ではまだ実行されない
+	auto task = Co::WaitForResult(&result);
+	REQUIRE(task.done() == false);
 
-	REQUIRE(sequence.done() == false);
-	REQUIRE(runner.done() == false);
-	REQUIRE(progress.isPreStartStarted == true);
-	REQUIRE(progress.isPreStartFinished == true);
-	REQUIRE(progress.isFadeInStarted == true);
-	REQUIRE(progress.isFadeInFinished == true);
-	REQUIRE(progress.isStartStarted == true);
-	REQUIRE(progress.isStartFinished == true);
-	REQUIRE(progress.isFadeOutStarted == true);
-	REQUIRE(progress.isFadeOutFinished == true);
-	REQUIRE(progress.isPostFadeOutStarted == true);
-	REQUIRE(progress.isPostFadeOutFinished == false);
+	// 既に結果が代入されているのでrunScopedで開始すると即座に完了する
+	const auto runner = std::move(task).runScoped([&](int32 r) { ret = r; });
+	REQUIRE(runner.done() == true);
+	REQUIRE(ret == 42);
 
+	// Updateを呼んでも何も起こらない
 	System::Update();
-
-	REQUIRE(sequence.done() == true);
 	REQUIRE(runner.done() == true);
-	REQUIRE(progress.isPreStartStarted == true);
-	REQUIRE(progress.isPreStartFinished == true);
-	REQUIRE(progress.isFadeInStarted == true);
-	REQUIRE(progress.isFadeInFinished == true);
-	REQUIRE(progress.isStartStarted == true);
-	REQUIRE(progress.isStartFinished == true);
-	REQUIRE(progress.isFadeOutStarted == true);
-	REQUIRE(progress.isFadeOutFinished == true);
-	REQUIRE(progress.isPostFadeOutStarted == true);
-	REQUIRE(progress.isPostFadeOutFinished == true);
+	REQUIRE(ret == 42);
 }
 
-Co::Task<void> PlaySequenceCaller(int32 value, int32* pDest, SequenceProgress* pProgress)
+TEST_CASE("WaitForResult with Optional")
 {
-	*pDest = co_await Co::Play<TestSequence>(value, pProgress);
-}
+	Optional<int32> result;
+	int32 ret = 0;
 
-TEST_CASE("Co::Play<TSequence>")
-{
-	int32 value = 0;
-	SequenceProgress progress;
-	const auto runner = PlaySequenceCaller(42, &value, &progress).runScoped();
+	const auto runner = Co::WaitForResult(&result).runScoped([&](int32 r) { ret = r; });
 	REQUIRE(runner.done() == false);
-	REQUIRE(progress.isPreStartStarted == true); // 呼び出し時点で最初のsuspendまでは実行される
-	REQUIRE(progress.isPreStartFinished == false);
-	REQUIRE(progress.isFadeInStarted == false);
-	REQUIRE(progress.isFadeInFinished == false);
-	REQUIRE(progress.isStartStarted == false);
-	REQUIRE(progress.isStartFinished == false);
-	REQUIRE(progress.isFadeOutStarted == false);
-	REQUIRE(progress.isFadeOutFinished == false);
-	REQUIRE(progress.isPostFadeOutStarted == false);
-	REQUIRE(progress.isPostFadeOutFinished == false);
+	REQUIRE(ret == 0);
 
+	// 結果が代入されるまで完了しない
 	System::Update();
-
 	REQUIRE(runner.done() == false);
-	REQUIRE(progress.isPreStartStarted == true);
-	REQUIRE(progress.isPreStartFinished == true);
-	REQUIRE(progress.isFadeInStarted == true); // fadeInとstartは同時に実行される
-	REQUIRE(progress.isFadeInFinished == false);
-	REQUIRE(progress.isStartStarted == true); // fadeInとstartは同時に実行される
-	REQUIRE(progress.isStartFinished == false);
-	REQUIRE(progress.isFadeOutStarted == false);
-	REQUIRE(progress.isFadeOutFinished == false);
-	REQUIRE(progress.isPostFadeOutStarted == false);
-	REQUIRE(progress.isPostFadeOutFinished == false);
+	REQUIRE(ret == 0);
 
-	System::Update();
+	result = 42;
 
+	// 結果が代入されてもUpdateが呼ばれるまでは完了しない
 	REQUIRE(runner.done() == false);
-	REQUIRE(progress.isPreStartStarted == true);
-	REQUIRE(progress.isPreStartFinished == true);
-	REQUIRE(progress.isFadeInStarted == true);
-	REQUIRE(progress.isFadeInFinished == true);
-	REQUIRE(progress.isStartStarted == true);
-	REQUIRE(progress.isStartFinished == true);
-	REQUIRE(progress.isFadeOutStarted == true);
-	REQUIRE(progress.isFadeOutFinished == false);
-	REQUIRE(progress.isPostFadeOutStarted == false);
-	REQUIRE(progress.isPostFadeOutFinished == false);
+	REQUIRE(ret == 0);
 
+	// 結果が代入された後の初回のUpdateで完了する
 	System::Update();
+	REQUIRE(runner.done() == true);
+	REQUIRE(ret == 42);
+}
 
-	REQUIRE(runner.done() == false);
-	REQUIRE(progress.isPreStartStarted == true);
-	REQUIRE(progress.isPreStartFinished == true);
-	REQUIRE(progress.isFadeInStarted == true);
-	REQUIRE(progress.isFadeInFinished == true);
-	REQUIRE(progress.isStartStarted == true);
-	REQUIRE(progress.isStartFinished == true);
-	REQUIRE(progress.isFadeOutStarted == true);
-	REQUIRE(progress.isFadeOutFinished == true);
-	REQUIRE(progress.isPostFadeOutStarted == true);
-	REQUIRE(progress.isPostFadeOutFinished == false);
+TEST_CASE("Finish WaitForResult with Optional immediately")
+{
+	Optional<int32> result = 42;
+	int32 ret = 0;
 
-	System::Update();
+	// 既に結果が代入されているが、タスク生成時点ではまだ実行されない
+	auto task = Co::WaitForResult(&result);
+	REQUIRE(task.done() == false);
 
+	// 既に結果が代入されているのでrunScopedで開始すると即座に完了する
+	const auto runner = std::move(task).runScoped([&](int32 r) { ret = r; });
 	REQUIRE(runner.done() == true);
-	REQUIRE(progress.isPreStartStarted == true);
-	REQUIRE(progress.isPreStartFinished == true);
-	REQUIRE(progress.isFadeInStarted == true);
-	REQUIRE(progress.isFadeInFinished == true);
-	REQUIRE(progress.isStartStarted == true);
-	REQUIRE(progress.isStartFinished == true);
-	REQUIRE(progress.isFadeOutStarted == true);
-	REQUIRE(progress.isFadeOutFinished == true);
-	REQUIRE(progress.isPostFadeOutStarted == true);
-	REQUIRE(progress.isPostFadeOutFinished == true);
+	REQUIRE(ret == 42);
 
-	REQUIRE(value == 42);
+	// Updateを呼んでも何も起こらない
+	System::Update();
+	REQUIRE(runner.done() == true);
+	REQUIRE(ret == 42);
 }
 
-class SequenceWithVoidResult : public Co::SequenceBase<void>
+TEST_CASE("WaitUntilHasValue with std::optional")
 {
-private:
-	Co::Task<void> start() override
-	{
-		co_await Co::NextFrame();
-	}
-};
+	std::optional<int32> result;
 
-TEST_CASE("Sequence with void result")
-{
-	const auto runner = Co::Play<SequenceWithVoidResult>().runScoped();
+	const auto runner = Co::WaitUntilHasValue(&result).runScoped();
 	REQUIRE(runner.done() == false);
 
+	// 結果が代入されるまで完了しない
 	System::Update();
-	REQUIRE(runner.done() == true);
-}
-
-class SequenceWithMoveOnlyResult : public Co::SequenceBase<std::unique_ptr<int32>>
-{
-private:
-	Co::Task<std::unique_ptr<int32>> start() override
-	{
-		co_await Co::NextFrame();
-		co_return std::make_unique<int32>(42);
-	}
+	REQUIRE(runner.done() == false);
 
-public:
-	SequenceWithMoveOnlyResult() = default;
-};
+	result = 42;
 
-TEST_CASE("Sequence with move-only result")
-{
-	std::unique_ptr<int32> value;
-	const auto runner = Co::Play<SequenceWithMoveOnlyResult>()
-		.runScoped([&](std::unique_ptr<int32>&& result) { value = std::move(result); });
+	// 結果が代入されてもUpdateが呼ばれるまでは完了しない
 	REQUIRE(runner.done() == false);
 
+	// 結果が代入された後の初回のUpdateで完了する
 	System::Update();
 	REQUIRE(runner.done() == true);
-	REQUIRE(*value == 42);
 }
 
-class TestUpdaterSequence : public Co::UpdaterSequenceBase<void>
+TEST_CASE("Finish WaitUntilHasValue with std::optional immediately")
 {
-private:
-	int m_count = 0;
+	std::optional<int32> result = 42;
 
-	void update() override
-	{
-		if (m_count == 3)
-		{
-			requestFinish();
-		}
-		++m_count;
-	}
-};
+	// 既に結果が代入されているが、タスク生成時点ではまだ実行されない
+	auto task = Co::WaitUntilHasValue(&result);
+	REQUIRE(task.done() == false);
 
-TEST_CASE("UpdaterSequence")
+	// 既に結果が代入されているのでrunScopedで開始すると即座に完了する
+	const auto runner = std::move(task).runScoped();
+	REQUIRE(runner.done() == true);
+}
+
+TEST_CASE("WaitUntilHasValue with Optional")
 {
-	const auto runner = Co::Play<TestUpdaterSequence>().runScoped();
+	Optional<int32> result;
+
+	const auto runner = Co::WaitUntilHasValue(&result).runScoped();
 	REQUIRE(runner.done() == false);
 
+	// 結果が代入されるまで完了しない
 	System::Update();
 	REQUIRE(runner.done() == false);
 
-	System::Update();
+	result = 42;
+
+	// 結果が代入されてもUpdateが呼ばれるまでは完了しない
 	REQUIRE(runner.done() == false);
 
+	// 結果が代入された後の初回のUpdateで完了する
 	System::Update();
 	REQUIRE(runner.done() == true);
 }
 
-class TestUpdaterSequenceWithResult : public Co::UpdaterSequenceBase<int32>
+TEST_CASE("Finish WaitUntilHasValue with Optional immediately")
 {
-private:
-	int m_count = 0;
+	Optional<int32> result = 42;
 
-	void update() override
-	{
-		if (m_count == 3)
-		{
-			requestFinish(42);
-		}
-		++m_count;
-	}
-};
+	// 既に結果が代入されているが、タスク生成時点ではまだ実行されない
+	auto task = Co::WaitUntilHasValue(&result);
+	REQUIRE(task.done() == false);
 
-TEST_CASE("UpdaterSequence with result")
+	// 既に結果が代入されているのでrunScopedで開始すると即座に完了する
+	const auto runner = std::move(task).runScoped();
+	REQUIRE(runner.done() == true);
+}
+
+TEST_CASE("WaitUntilValueChanged")
 {
 	int32 value = 0;
-	const auto runner = Co::Play<TestUpdaterSequenceWithResult>().runScoped([&](int32 result) { value = result; });
+	const auto runner = Co::WaitUntilValueChanged(&value).runScoped();
 	REQUIRE(runner.done() == false);
-	REQUIRE(value == 0);
 
+	// 値が変わるまでは完了しない
 	System::Update();
 	REQUIRE(runner.done() == false);
-	REQUIRE(value == 0);
 
-	System::Update();
+	// 値が変わってもUpdateが呼ばれるまでは完了しない
+	value = 42;
 	REQUIRE(runner.done() == false);
-	REQUIRE(value == 0);
 
+	// 値が変わった後の初回のUpdateで完了する
 	System::Update();
 	REQUIRE(runner.done() == true);
-	REQUIRE(value == 42);
 }
 
-class TestUpdaterSequenceWithMoveOnlyResult : public Co::UpdaterSequenceBase<std::unique_ptr<int32>>
+#ifndef COTASKLIB_NO_SIV3D
+TEST_CASE("WaitForTimer")
 {
-private:
-	int m_count = 0;
+	TestClock clock;
 
-	void update() override
-	{
-		if (m_count == 3)
-		{
-			requestFinish(std::make_unique<int32>(42));
-		}
-		++m_count;
-	}
-};
+	Timer timer{ 1s, StartImmediately::Yes, &clock };
 
-TEST_CASE("UpdaterSequence with move-only result")
-{
-	std::unique_ptr<int32> value;
-	const auto runner = Co::Play<TestUpdaterSequenceWithMoveOnlyResult>()
-		.runScoped([&](std::unique_ptr<int32>&& result) { value = std::move(result); });
+	const auto runner = Co::WaitForTimer(&timer).runScoped();
 	REQUIRE(runner.done() == false);
-	REQUIRE(value == nullptr);
 
+	// 0秒
+	clock.microsec = 0;
 	System::Update();
 	REQUIRE(runner.done() == false);
-	REQUIRE(value == nullptr);
 
+	// 0.999秒
+	clock.microsec = 999'000;
 	System::Update();
 	REQUIRE(runner.done() == false);
-	REQUIRE(value == nullptr);
 
+	// 1.001秒
+	clock.microsec = 1'001'000;
 	System::Update();
 	REQUIRE(runner.done() == true);
-	REQUIRE(value != nullptr);
-	REQUIRE(*value == 42);
 }
+#endif
 
-class TestScene : public Co::SceneBase
+Co::Task<void> AssignValueWithDelay(int32 value, int32* pDest, Duration delay, ISteadyClock* pSteadyClock)
 {
-public:
-	explicit TestScene(SequenceProgress* pProgress)
-		: m_pProgress(pProgress)
-	{
-	}
-
-private:
-	SequenceProgress* m_pProgress;
-
-	Co::Task<void> preStart() override
-	{
-		m_pProgress->isPreStartStarted = true;
-		co_await Co::NextFrame();
-		m_pProgress->isPreStartFinished = true;
-	}
-
-	Co::Task<void> fadeIn() override
-	{
-		m_pProgress->isFadeInStarted = true;
-		co_await Co::NextFrame();
-		m_pProgress->isFadeInFinished = true;
-	}
+	*pDest = 1;
+	co_await Co::Delay(delay, pSteadyClock);
+	*pDest = value;
+}
 
-	Co::Task<void> start() override
-	{
-		m_pProgress->isStartStarted = true;
-		co_await Co::NextFrame();
-		m_pProgress->isStartFinished = true;
-	}
+TEST_CASE("Co::All running tasks")
+{
+	TestClock clock;
+	int32 value1 = 0;
+	int32 value2 = 0;
+	int32 value3 = 0;
 
-	Co::Task<void> fadeOut() override
-	{
-		m_pProgress->isFadeOutStarted = true;
-		co_await Co::NextFrame();
-		m_pProgress->isFadeOutFinished = true;
-	}
+	auto task = Co::All(
+		AssignValueWithDelay(10, &value1, 1s, &clock),
+		AssignValueWithDelay(20, &value2, 2s, &clock),
+		AssignValueWithDelay(30, &value3, 3s, &clock));
 
-	Co::Task<void> postFadeOut() override
-	{
-		m_pProgress->isPostFadeOutStarted = true;
-		co_await Co::NextFrame();
-		m_pProgress->isPostFadeOutFinished = true;
-	}
-};
+	// タスク生成時点ではまだ実行されない
+	REQUIRE(value1 == 0);
+	REQUIRE(value2 == 0);
+	REQUIRE(value3 == 0);
 
-TEST_CASE("Co::PlaySceneFrom<TScene>")
-{
-	SequenceProgress progress;
-	const auto runner = Co::PlaySceneFrom<TestScene>(&progress).runScoped();
+	// runScopedで開始すると最初のsuspendまで実行される
+	const auto runner = std::move(task).runScoped();
+	REQUIRE(value1 == 1);
+	REQUIRE(value2 == 1);
+	REQUIRE(value3 == 1);
 	REQUIRE(runner.done() == false);
-	REQUIRE(progress.isPreStartStarted == true); // 呼び出し時点で最初のsuspendまでは実行される
-	REQUIRE(progress.isPreStartFinished == false);
-	REQUIRE(progress.isFadeInStarted == false);
-	REQUIRE(progress.isFadeInFinished == false);
-	REQUIRE(progress.isStartStarted == false);
-	REQUIRE(progress.isStartFinished == false);
-	REQUIRE(progress.isFadeOutStarted == false);
-	REQUIRE(progress.isFadeOutFinished == false);
-	REQUIRE(progress.isPostFadeOutStarted == false);
-	REQUIRE(progress.isPostFadeOutFinished == false);
 
+	// 0秒
+	clock.microsec = 0;
 	System::Update();
-
+	REQUIRE(value1 == 1);
+	REQUIRE(value2 == 1);
+	REQUIRE(value3 == 1);
 	REQUIRE(runner.done() == false);
-	REQUIRE(progress.isPreStartStarted == true);
-	REQUIRE(progress.isPreStartFinished == true);
-	REQUIRE(progress.isFadeInStarted == true); // fadeInとstartは同時に実行される
-	REQUIRE(progress.isFadeInFinished == false);
-	REQUIRE(progress.isStartStarted == true); // fadeInとstartは同時に実行される
-	REQUIRE(progress.isStartFinished == false);
-	REQUIRE(progress.isFadeOutStarted == false);
-	REQUIRE(progress.isFadeOutFinished == false);
-	REQUIRE(progress.isPostFadeOutStarted == false);
-	REQUIRE(progress.isPostFadeOutFinished == false);
 
+	// 0.999秒
+	clock.microsec = 999'000;
 	System::Update();
+	REQUIRE(value1 == 1);
+	REQUIRE(value2 == 1);
+	REQUIRE(value3 == 1);
+	REQUIRE(runner.done() == false);
 
+	// 1.001秒
+	clock.microsec = 1'001'000;
+	System::Update();
+	REQUIRE(value1 == 10);
+	REQUIRE(value2 == 1);
+	REQUIRE(value3 == 1);
 	REQUIRE(runner.done() == false);
-	REQUIRE(progress.isPreStartStarted == true);
-	REQUIRE(progress.isPreStartFinished == true);
-	REQUIRE(progress.isFadeInStarted == true);
-	REQUIRE(progress.isFadeInFinished == true);
-	REQUIRE(progress.isStartStarted == true);
-	REQUIRE(progress.isStartFinished == true);
-	REQUIRE(progress.isFadeOutStarted == true);
-	REQUIRE(progress.isFadeOutFinished == false);
-	REQUIRE(progress.isPostFadeOutStarted == false);
-	REQUIRE(progress.isPostFadeOutFinished == false);
 
+	// 1.999秒
+	clock.microsec = 1'999'000;
 	System::Update();
+	REQUIRE(value1 == 10);
+	REQUIRE(value2 == 1);
+	REQUIRE(value3 == 1);
+	REQUIRE(runner.done() == false);
 
+	// 2.001秒
+	clock.microsec = 2'001'000;
+	System::Update();
+	REQUIRE(value1 == 10);
+	REQUIRE(value2 == 20);
+	REQUIRE(value3 == 1);
 	REQUIRE(runner.done() == false);
-	REQUIRE(progress.isPreStartStarted == true);
-	REQUIRE(progress.isPreStartFinished == true);
-	REQUIRE(progress.isFadeInStarted == true);
-	REQUIRE(progress.isFadeInFinished == true);
-	REQUIRE(progress.isStartStarted == true);
-	REQUIRE(progress.isStartFinished == true);
-	REQUIRE(progress.isFadeOutStarted == true);
-	REQUIRE(progress.isFadeOutFinished == true);
-	REQUIRE(progress.isPostFadeOutStarted == true);
-	REQUIRE(progress.isPostFadeOutFinished == false);
 
+	// 2.999秒
+	clock.microsec = 2'999'000;
 	System::Update();
+	REQUIRE(value1 == 10);
+	REQUIRE(value2 == 20);
+	REQUIRE(value3 == 1);
+	REQUIRE(runner.done() == false);
 
+	// 3.001秒
+	clock.microsec = 3'001'000;
+	System::Update();
+	REQUIRE(value1 == 10);
+	REQUIRE(value2 == 20);
+	REQUIRE(value3 == 30);
 	REQUIRE(runner.done() == true);
-	REQUIRE(progress.isPreStartStarted == true);
-	REQUIRE(progress.isPreStartFinished == true);
-	REQUIRE(progress.isFadeInStarted == true);
-	REQUIRE(progress.isFadeInFinished == true);
-	REQUIRE(progress.isStartStarted == true);
-	REQUIRE(progress.isStartFinished == true);
-	REQUIRE(progress.isFadeOutStarted == true);
-	REQUIRE(progress.isFadeOutFinished == true);
-	REQUIRE(progress.isPostFadeOutStarted == true);
-	REQUIRE(progress.isPostFadeOutFinished == true);
 }
 
-class ChainedTestScene : public Co::SceneBase
+Co::Task<int32> GetValueWithDelay(int32 value, Duration delay, ISteadyClock* pSteadyClock)
 {
-public:
-	explicit ChainedTestScene(SequenceProgress* pProgress1, SequenceProgress* pProgress2)
-		: m_pProgress1(pProgress1)
-		, m_pProgress2(pProgress2)
-	{
-	}
-
-private:
-	SequenceProgress* m_pProgress1;
-	SequenceProgress* m_pProgress2;
+	co_await Co::Delay(delay, pSteadyClock);
+	co_return value;
+}
 
-	Co::Task<void> preStart() override
-	{
-		m_pProgress1->isPreStartStarted = true;
-		co_await Co::NextFrame();
-		m_pProgress1->isPreStartFinished = true;
-	}
+Co::Task<void> GetValueWithDelayCallerWithAll(int32* pDest1, int32* pDest2, int32* pDest3, ISteadyClock* pSteadyClock)
+{
+	std::tie(*pDest1, *pDest2, *pDest3) = co_await Co::All(
+		GetValueWithDelay(10, 1s, pSteadyClock),
+		GetValueWithDelay(20, 2s, pSteadyClock),
+		GetValueWithDelay(30, 3s, pSteadyClock));
+}
 
-	Co::Task<void> fadeIn() override
-	{
-		m_pProgress1->isFadeInStarted = true;
+TEST_CASE("Co::All return value")
+{
+	TestClock clock;
+	int32 value1 = 0;
+	int32 value2 = 0;
+	int32 value3 = 0;
+
+	const auto runner = GetValueWithDelayCallerWithAll(&value1, &value2, &value3, &clock).runScoped();
+
+	REQUIRE(value1 == 0);
+	REQUIRE(value2 == 0);
+	REQUIRE(value3 == 0);
+	REQUIRE(runner.done() == false);
+
+	// 0秒
+	clock.microsec = 0;
+	System::Update();
+	REQUIRE(value1 == 0);
+	REQUIRE(value2 == 0);
+	REQUIRE(value3 == 0);
+	REQUIRE(runner.done() == false);
+
+	// 0.999秒
+	clock.microsec = 999'000;
+	System::Update();
+	REQUIRE(value1 == 0);
+	REQUIRE(value2 == 0);
+	REQUIRE(value3 == 0);
+	REQUIRE(runner.done() == false);
+
+	// 1.001秒
+	clock.microsec = 1'001'000;
+	System::Update();
+	REQUIRE(value1 == 0); // 全部完了するまで代入されない
+	REQUIRE(value2 == 0);
+	REQUIRE(value3 == 0);
+	REQUIRE(runner.done() == false);
+
+	// 1.999秒
+	clock.microsec = 1'999'000;
+	System::Update();
+	REQUIRE(value1 == 0);
+	REQUIRE(value2 == 0);
+	REQUIRE(value3 == 0);
+	REQUIRE(runner.done() == false);
+
+	// 2.001秒
+	clock.microsec = 2'001'000;
+	System::Update();
+	REQUIRE(value1 == 0);
+	REQUIRE(value2 == 0); // 全部完了するまで代入されない
+	REQUIRE(value3 == 0);
+	REQUIRE(runner.done() == false);
+
+	// 2.999秒
+	clock.microsec = 2'999'000;
+	System::Update();
+	REQUIRE(value1 == 0);
+	REQUIRE(value2 == 0);
+	REQUIRE(value3 == 0);
+	REQUIRE(runner.done() == false);
+
+	// 3.001秒
+	clock.microsec = 3'001'000;
+	System::Update();
+	REQUIRE(value1 == 10);
+	REQUIRE(value2 == 20);
+	REQUIRE(value3 == 30);
+	REQUIRE(runner.done() == true);
+}
+
+Co::Task<void> PushBackValueWithDelayFrame(std::vector<int32>* pVec, int32 value)
+{
+	pVec->push_back(value);
+	co_await Co::NextFrame();
+	pVec->push_back(value * 10);
+}
+
+TEST_CASE("Co::All execution order")
+{
+	std::vector<int32> vec;
+
+	const auto runner = Co::All(
+		PushBackValueWithDelayFrame(&vec, 1),
+		PushBackValueWithDelayFrame(&vec, 2),
+		PushBackValueWithDelayFrame(&vec, 3)).runScoped();
+
+	// runScopedを呼んだ時点で最初のsuspendまでは実行される
+	// 渡した順番でresumeされる
+	REQUIRE(vec.size() == 3);
+	REQUIRE(vec == std::vector<int32>{ 1, 2, 3 });
+	REQUIRE(runner.done() == false);
+
+	System::Update();
+
+	// 渡した順番でresumeされる
+	REQUIRE(vec.size() == 6);
+	REQUIRE(vec == std::vector<int32>{ 1, 2, 3, 10, 20, 30 });
+	REQUIRE(runner.done() == true);
+}
+
+Co::Task<void> AllWithImmediateTasks()
+{
+	const auto [a, b] = co_await Co::All(
+		CoReturnTest(),
+		CoReturnTest());
+
+	REQUIRE(a == 42);
+	REQUIRE(b == 42);
+}
+
+TEST_CASE("Co::All with immediate tasks")
+{
+	const auto runner = AllWithImmediateTasks().runScoped();
+	REQUIRE(runner.done() == true);
+}
+
+TEST_CASE("Co::Any running tasks")
+{
+	TestClock clock;
+	int32 value1 = 0;
+	int32 value2 = 0;
+	int32 value3 = 0;
+
+	const auto runner = Co::Any(
+		AssignValueWithDelay(10, &value1, 1s, &clock),
+		AssignValueWithDelay(20, &value2, 2s, &clock),
+		AssignValueWithDelay(30, &value3, 3s, &clock)).runScoped();
+
+	// 呼び出し時点で最初のsuspendまでは実行される
+	REQUIRE(value1 == 1);
+	REQUIRE(value2 == 1);
+	REQUIRE(value3 == 1);
+	REQUIRE(runner.done() == false);
+
+	// 0秒
+	clock.microsec = 0;
+	System::Update();
+	REQUIRE(value1 == 1);
+	REQUIRE(value2 == 1);
+	REQUIRE(value3 == 1);
+	REQUIRE(runner.done() == false);
+
+	// 0.999秒
+	clock.microsec = 999'000;
+	System::Update();
+	REQUIRE(value1 == 1);
+	REQUIRE(value2 == 1);
+	REQUIRE(value3 == 1);
+	REQUIRE(runner.done() == false);
+
+	// 1.001秒
+	clock.microsec = 1'001'000;
+	System::Update();
+	REQUIRE(value1 == 10);
+	REQUIRE(value2 == 1);
+	REQUIRE(value3 == 1);
+	REQUIRE(runner.done() == true);
+}
+
+Co::Task<void> GetValueWithDelayCallerWithAny(Optional<int32>* pDest1, Optional<int32>* pDest2, Optional<int32>* pDest3, ISteadyClock* pSteadyClock)
+{
+	std::tie(*pDest1, *pDest2, *pDest3) = co_await Co::Any(
+		GetValueWithDelay(10, 1s, pSteadyClock),
+		GetValueWithDelay(20, 2s, pSteadyClock),
+		GetValueWithDelay(30, 3s, pSteadyClock));
+}
+
+TEST_CASE("Co::Any return value")
+{
+	TestClock clock;
+	Optional<int32> value1 = 0;
+	Optional<int32> value2 = 0;
+	Optional<int32> value3 = 0;
+
+	const auto runner = GetValueWithDelayCallerWithAny(&value1, &value2, &value3, &clock).runScoped();
+
+	REQUIRE(value1 == 0);
+	REQUIRE(value2 == 0);
+	REQUIRE(value3 == 0);
+	REQUIRE(runner.done() == false);
+
+	// 0秒
+	clock.microsec = 0;
+	System::Update();
+	REQUIRE(value1 == 0);
+	REQUIRE(value2 == 0);
+	REQUIRE(value3 == 0);
+	REQUIRE(runner.done() == false);
+
+	// 0.999秒
+	clock.microsec = 999'000;
+	System::Update();
+	REQUIRE(value1 == 0);
+	REQUIRE(value2 == 0);
+	REQUIRE(value3 == 0);
+	REQUIRE(runner.done() == false);
+
+	// 1.001秒
+	clock.microsec = 1'001'000;
+	System::Update();
+	REQUIRE(value1 == 10);
+	REQUIRE(value2 == none);
+	REQUIRE(value3 == none);
+	REQUIRE(runner.done() == true);
+}
+
+Co::Task<void> AnyReturnsOptionalVoidResultTest()
+{
+	const auto [a, b, c] = co_await Co::Any(
+		Co::DelayFrame(3),
+		Co::DelayFrame(1),
+		Co::DelayFrame(2));
+
+	REQUIRE((bool)a == false);
+	REQUIRE((bool)b == true);
+	REQUIRE((bool)c == false);
+}
+
+TEST_CASE("Co::Any returns VoidResult")
+{
+	const auto runner = AnyReturnsOptionalVoidResultTest().runScoped();
+
+	REQUIRE(runner.done() == false);
+	System::Update();
+	REQUIRE(runner.done() == true);
+}
+
+Co::Task<void> AnyReturnsOptionalVoidResultMultipleTest()
+{
+	const auto [a, b, c, d, e] = co_await Co::Any(
+		Co::DelayFrame(4),
+		Co::DelayFrame(2),
+		Co::DelayFrame(3),
+		Co::DelayFrame(2),
+		Co::DelayFrame(2));
+
+	REQUIRE((bool)a == false);
+	REQUIRE((bool)b == true);
+	REQUIRE((bool)c == false);
+	REQUIRE((bool)d == true);
+	REQUIRE((bool)e == true);
+}
+
+TEST_CASE("Co::Any returns VoidResult multiple")
+{
+	const auto runner = AnyReturnsOptionalVoidResultMultipleTest().runScoped();
+
+	REQUIRE(runner.done() == false);
+	System::Update();
+	REQUIRE(runner.done() == false);
+	System::Update();
+	REQUIRE(runner.done() == true);
+}
+
+TEST_CASE("Co::Any execution order")
+{
+	std::vector<int32> vec;
+
+	const auto runner = Co::Any(
+		PushBackValueWithDelayFrame(&vec, 1),
+		PushBackValueWithDelayFrame(&vec, 2),
+		PushBackValueWithDelayFrame(&vec, 3)).runScoped();
+
+	// runScopedを呼んだ時点で最初のsuspendまでは実行される
+	// 渡した順番でresumeされる
+	REQUIRE(vec.size() == 3);
+	REQUIRE(vec == std::vector<int32>{ 1, 2, 3 });
+	REQUIRE(runner.done() == false);
+
+	System::Update();
+
+	// 渡した順番でresumeされる
+	REQUIRE(vec.size() == 6);
+	REQUIRE(vec == std::vector<int32>{ 1, 2, 3, 10, 20, 30 });
+	REQUIRE(runner.done() == true);
+}
+
+Co::Task<void> AnyWithImmediateTasks()
+{
+	const auto [a, b] = co_await Co::Any(
+		CoReturnTest(),
+		Co::DelayFrame(1));
+
+	REQUIRE(a == 42);
+	REQUIRE((bool)b == false);
+}
+
+TEST_CASE("Co::Any with immediate tasks")
+{
+	const auto runner = AnyWithImmediateTasks().runScoped();
+	REQUIRE(runner.done() == true);
+}
+
+Co::Task<void> AnyWithNonCopyableResult()
+{
+	const auto [a, b, c] = co_await Co::Any(
+		CoReturnWithMoveOnlyTypeAndDelayTest().discardResult(),
+		Co::DelayFrame(1),
+		Co::DelayFrame(2));
+
+	REQUIRE((bool)a == true);
+	REQUIRE((bool)b == true);
+	REQUIRE((bool)c == false);
+}
+
+TEST_CASE("Co::Any with non-copyable result")
+{
+	const auto runner = AnyWithNonCopyableResult().runScoped();
+	REQUIRE(runner.done() == false);
+	System::Update();
+	REQUIRE(runner.done() == true);
+}
+
+Co::Task<int32> CountFramesTask(int32 frames, int32* pResumeCount)
+{
+	for (int32 i = 0; i < frames; ++i)
+	{
+		++*pResumeCount;
+		co_await Co::NextFrame();
+	}
+	co_return frames * 10;
+}
+
+TEST_CASE("Co::All with Array")
+{
+	Array<int32> resumeCounts(3, 0);
+	Array<Co::Task<int32>> tasks;
+	tasks.push_back(CountFramesTask(3, &resumeCounts[0]));
+	tasks.push_back(CountFramesTask(1, &resumeCounts[1]));
+	tasks.push_back(CountFramesTask(2, &resumeCounts[2]));
+
+	Array<int32> result;
+	const auto runner = Co::All(std::move(tasks)).runScoped([&](const Array<int32>& r) { result = r; });
+	REQUIRE(resumeCounts == Array<int32>{ 1, 1, 1 });
+
+	System::Update();
+	REQUIRE(resumeCounts == Array<int32>{ 2, 1, 2 });
+	REQUIRE(runner.done() == false);
+
+	System::Update();
+	REQUIRE(resumeCounts == Array<int32>{ 3, 1, 2 });
+	REQUIRE(runner.done() == false);
+
+	// 結果は完了順ではなく引数の配列の順に返される
+	System::Update();
+	REQUIRE(runner.done() == true);
+	REQUIRE(result == Array<int32>{ 30, 10, 20 });
+}
+
+TEST_CASE("Co::All with empty Array")
+{
+	Optional<size_t> resultSize;
+	const auto runner = Co::All(Array<Co::Task<void>>{}).runScoped([&](const Array<Co::VoidResult>& r) { resultSize = r.size(); });
+	REQUIRE(runner.done() == true);
+	REQUIRE(resultSize == 0);
+}
+
+TEST_CASE("Co::Any with Array")
+{
+	int32 resumeCount = 0;
+	Array<Co::Task<int32>> tasks;
+	tasks.push_back(CountFramesTask(3, &resumeCount));
+	tasks.push_back(CountFramesTask(2, &resumeCount));
+	tasks.push_back(CountFramesTask(2, &resumeCount));
+
+	Optional<std::pair<size_t, int32>> result;
+	const auto runner = Co::Any(std::move(tasks)).runScoped([&](const std::pair<size_t, int32>& r) { result = r; });
+	REQUIRE(resumeCount == 3);
+
+	System::Update();
+	REQUIRE(resumeCount == 6);
+	REQUIRE(runner.done() == false);
+
+	// 同一フレームで複数完了した場合は、インデックスが小さい方が返される
+	System::Update();
+	REQUIRE(runner.done() == true);
+	REQUIRE(result == std::make_pair(size_t{ 1 }, 20));
+}
+
+TEST_CASE("Co::Any with empty Array")
+{
+	auto task = Co::Any(Array<Co::Task<void>>{});
+	REQUIRE_THROWS_AS(std::move(task).runScoped(), Error);
+}
+
+TEST_CASE("UpdaterTask without TaskFinishSource argument")
+{
+	int32 count = 0;
+	auto task = Co::UpdaterTask([&] { ++count; });
+
+	// タスク生成時点ではまだ実行されない
+	REQUIRE(count == 0);
+
+	// runScopedで開始すると最初のsuspendまで実行される
+	const auto runner = std::move(task).runScoped();
+	REQUIRE(count == 1);
+	REQUIRE(runner.done() == false);
+	
+	System::Update();
+	REQUIRE(count == 2);
+	REQUIRE(runner.done() == false);
+
+	System::Update();
+	REQUIRE(count == 3);
+	REQUIRE(runner.done() == false);
+}
+
+TEST_CASE("UpdaterTask with TaskFinishSource argument")
+{
+	int32 count = 0;
+	auto task = Co::UpdaterTask<void>(
+		[&](Co::TaskFinishSource<void>& taskFinishSource)
+		{
+			if (count == 3)
+			{
+				taskFinishSource.requestFinish();
+				return;
+			}
+			++count;
+		});
+
+	// タスク生成時点ではまだ実行されない
+	REQUIRE(count == 0);
+
+	// runScopedで開始すると最初のsuspendまで実行される
+	const auto runner = std::move(task).runScoped();
+	REQUIRE(count == 1);
+	REQUIRE(runner.done() == false);
+
+	System::Update();
+	REQUIRE(count == 2);
+	REQUIRE(runner.done() == false);
+
+	System::Update();
+	REQUIRE(count == 3);
+	REQUIRE(runner.done() == false);
+
+	// requestFinishが呼ばれたら完了する
+	System::Update();
+	REQUIRE(count == 3);
+	REQUIRE(runner.done() == true);
+}
+
+TEST_CASE("UpdaterTask with TaskFinishSource argument that has result")
+{
+	int32 count = 0;
+	auto task = Co::UpdaterTask<int32>(
+		[&](Co::TaskFinishSource<int32>& taskFinishSource)
+		{
+			if (count == 3)
+			{
+				taskFinishSource.requestFinish(42);
+				return;
+			}
+			++count;
+		});
+
+	// タスク生成時点ではまだ実行されない
+	REQUIRE(count == 0);
+
+	int32 result = 0;
+
+	// runScopedで開始すると最初のsuspendまで実行される
+	const auto runner = std::move(task).runScoped([&](int32 r) { result = r; });
+	REQUIRE(count == 1);
+	REQUIRE(runner.done() == false);
+	REQUIRE(result == 0);
+
+	System::Update();
+	REQUIRE(count == 2);
+	REQUIRE(runner.done() == false);
+	REQUIRE(result == 0);
+
+	System::Update();
+	REQUIRE(count == 3);
+	REQUIRE(runner.done() == false);
+	REQUIRE(result == 0);
+
+	// requestFinishが呼ばれたら完了する
+	System::Update();
+	REQUIRE(count == 3);
+	REQUIRE(runner.done() == true);
+	REQUIRE(result == 42);
+}
+
+TEST_CASE("UpdaterTask with TaskFinishSource argument that has immediate result")
+{
+	int32 count = 0;
+	auto task = Co::UpdaterTask<int32>(
+		[&](Co::TaskFinishSource<int32>& taskFinishSource)
+		{
+			++count;
+			taskFinishSource.requestFinish(42);
+		});
+
+	// タスク生成時点ではまだ実行されない
+	REQUIRE(count == 0);
+
+	int32 result = 0;
+
+	// runScopedで開始すると最初のsuspendまで実行されて即座に完了する
+	const auto runner = std::move(task).runScoped([&](int32 r) { result = r; });
+	REQUIRE(count == 1);
+	REQUIRE(runner.done() == true);
+	REQUIRE(result == 42);
+}
+
+TEST_CASE("UpdaterTask with TaskFinishSource argument that has move-only result")
+{
+	int32 count = 0;
+	auto task = Co::UpdaterTask<std::unique_ptr<int32>>(
+		[&](Co::TaskFinishSource<std::unique_ptr<int32>>& taskFinishSource)
+		{
+			if (count == 3)
+			{
+				taskFinishSource.requestFinish(std::make_unique<int32>(42));
+				return;
+			}
+			++count;
+		});
+
+	// タスク生成時点ではまだ実行されない
+	REQUIRE(count == 0);
+
+	std::unique_ptr<int32> result;
+
+	// runScopedで開始すると最初のsuspendまで実行される
+	const auto runner = std::move(task).runScoped([&](std::unique_ptr<int32> r) { result = std::move(r); });
+	REQUIRE(count == 1);
+	REQUIRE(runner.done() == false);
+	REQUIRE(result == nullptr);
+
+	System::Update();
+	REQUIRE(count == 2);
+	REQUIRE(runner.done() == false);
+	REQUIRE(result == nullptr);
+
+	System::Update();
+	REQUIRE(count == 3);
+	REQUIRE(runner.done() == false);
+	REQUIRE(result == nullptr);
+
+	// requestFinishが呼ばれたら完了する
+	System::Update();
+	REQUIRE(count == 3);
+	REQUIRE(runner.done() == true);
+	REQUIRE(result != nullptr);
+	REQUIRE(*result == 42);
+}
+
+#ifndef COTASKLIB_NO_SIV3D
+struct SequenceProgress
+{
+	bool isPreStartStarted = false;
+	bool isPreStartFinished = false;
+	bool isStartStarted = false;
+	bool isStartFinished = false;
+	bool isFadeInStarted = false;
+	bool isFadeInFinished = false;
+	bool isFadeOutStarted = false;
+	bool isFadeOutFinished = false;
+	bool isPostFadeOutStarted = false;
+	bool isPostFadeOutFinished = false;
+
+	auto operator<=>(const SequenceProgress&) const = default;
+
+	bool allFalse() const
+	{
+		return *this == SequenceProgress{};
+	}
+};
+
+class TestSequence : public Co::SequenceBase<int32>
+{
+public:
+	explicit TestSequence(int32 argValue, SequenceProgress* pProgress)
+		: m_argValue(argValue)
+		, m_pProgress(pProgress)
+	{
+	}
+
+private:
+	int32 m_argValue;
+	SequenceProgress* m_pProgress;
+
+	Co::Task<void> preStart() override
+	{
+		m_pProgress->isPreStartStarted = true;
+		co_await Co::NextFrame();
+		m_pProgress->isPreStartFinished = true;
+	}
+
+	Co::Task<void> fadeIn() override
+	{
+		m_pProgress->isFadeInStarted = true;
+		co_await Co::NextFrame();
+		m_pProgress->isFadeInFinished = true;
+	}
+
+	Co::Task<int32> start() override
+	{
+		m_pProgress->isStartStarted = true;
+		co_await Co::NextFrame();
+		m_pProgress->isStartFinished = true;
+		co_return m_argValue;
+	}
+
+	Co::Task<void> fadeOut() override
+	{
+		m_pProgress->isFadeOutStarted = true;
+		co_await Co::NextFrame();
+		m_pProgress->isFadeOutFinished = true;
+	}
+
+	Co::Task<void> postFadeOut() override
+	{
+		m_pProgress->isPostFadeOutStarted = true;
+		co_await Co::NextFrame();
+		m_pProgress->isPostFadeOutFinished = true;
+	}
+};
+
+TEST_CASE("Sequence")
+{
+	SequenceProgress progress;
+	TestSequence sequence{ 42, &progress };
+	const auto runner = sequence.playScoped();
+	REQUIRE(sequence.done() == false);
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress.isPreStartStarted == true); // 呼び出し時点で最初のsuspendまでは実行される
+	REQUIRE(progress.isPreStartFinished == false);
+	REQUIRE(progress.isFadeInStarted == false);
+	REQUIRE(progress.isFadeInFinished == false);
+	REQUIRE(progress.isStartStarted == false);
+	REQUIRE(progress.isStartFinished == false);
+	REQUIRE(progress.isFadeOutStarted == false);
+	REQUIRE(progress.isFadeOutFinished == false);
+	REQUIRE(progress.isPostFadeOutStarted == false);
+	REQUIRE(progress.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(sequence.done() == false);
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress.isPreStartStarted == true);
+	REQUIRE(progress.isPreStartFinished == true);
+	REQUIRE(progress.isFadeInStarted == true); // fadeInとstartは同時に実行される
+	REQUIRE(progress.isFadeInFinished == false);
+	REQUIRE(progress.isStartStarted == true); // fadeInとstartは同時に実行される
+	REQUIRE(progress.isStartFinished == false);
+	REQUIRE(progress.isFadeOutStarted == false);
+	REQUIRE(progress.isFadeOutFinished == false);
+	REQUIRE(progress.isPostFadeOutStarted == false);
+	REQUIRE(progress.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(sequence.done() == false);
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress.isPreStartStarted == true);
+	REQUIRE(progress.isPreStartFinished == true);
+	REQUIRE(progress.isFadeInStarted == true);
+	REQUIRE(progress.isFadeInFinished == true);
+	REQUIRE(progress.isStartStarted == true);
+	REQUIRE(progress.isStartFinished == true);
+	REQUIRE(progress.isFadeOutStarted == true);
+	REQUIRE(progress.isFadeOutFinished == false);
+	REQUIRE(progress.isPostFadeOutStarted == false);
+	REQUIRE(progress.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(sequence.done() == false);
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress.isPreStartStarted == true);
+	REQUIRE(progress.isPreStartFinished == true);
+	REQUIRE(progress.isFadeInStarted == true);
+	REQUIRE(progress.isFadeInFinished == true);
+	REQUIRE(progress.isStartStarted == true);
+	REQUIRE(progress.isStartFinished == true);
+	REQUIRE(progress.isFadeOutStarted == true);
+	REQUIRE(progress.isFadeOutFinished == true);
+	REQUIRE(progress.isPostFadeOutStarted == true);
+	REQUIRE(progress.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(sequence.done() == true);
+	REQUIRE(runner.done() == true);
+	REQUIRE(progress.isPreStartStarted == true);
+	REQUIRE(progress.isPreStartFinished == true);
+	REQUIRE(progress.isFadeInStarted == true);
+	REQUIRE(progress.isFadeInFinished == true);
+	REQUIRE(progress.isStartStarted == true);
+	REQUIRE(progress.isStartFinished == true);
+	REQUIRE(progress.isFadeOutStarted == true);
+	REQUIRE(progress.isFadeOutFinished == true);
+	REQUIRE(progress.isPostFadeOutStarted == true);
+	REQUIRE(progress.isPostFadeOutFinished == true);
+}
+
+Co::Task<void> PlaySequenceCaller(int32 value, int32* pDest, SequenceProgress* pProgress)
+{
+	*pDest = co_await Co::Play<TestSequence>(value, pProgress);
+}
+
+TEST_CASE("Co::Play<TSequence>")
+{
+	int32 value = 0;
+	SequenceProgress progress;
+	const auto runner = PlaySequenceCaller(42, &value, &progress).runScoped();
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress.isPreStartStarted == true); // 呼び出し時点で最初のsuspendまでは実行される
+	REQUIRE(progress.isPreStartFinished == false);
+	REQUIRE(progress.isFadeInStarted == false);
+	REQUIRE(progress.isFadeInFinished == false);
+	REQUIRE(progress.isStartStarted == false);
+	REQUIRE(progress.isStartFinished == false);
+	REQUIRE(progress.isFadeOutStarted == false);
+	REQUIRE(progress.isFadeOutFinished == false);
+	REQUIRE(progress.isPostFadeOutStarted == false);
+	REQUIRE(progress.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress.isPreStartStarted == true);
+	REQUIRE(progress.isPreStartFinished == true);
+	REQUIRE(progress.isFadeInStarted == true); // fadeInとstartは同時に実行される
+	REQUIRE(progress.isFadeInFinished == false);
+	REQUIRE(progress.isStartStarted == true); // fadeInとstartは同時に実行される
+	REQUIRE(progress.isStartFinished == false);
+	REQUIRE(progress.isFadeOutStarted == false);
+	REQUIRE(progress.isFadeOutFinished == false);
+	REQUIRE(progress.isPostFadeOutStarted == false);
+	REQUIRE(progress.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress.isPreStartStarted == true);
+	REQUIRE(progress.isPreStartFinished == true);
+	REQUIRE(progress.isFadeInStarted == true);
+	REQUIRE(progress.isFadeInFinished == true);
+	REQUIRE(progress.isStartStarted == true);
+	REQUIRE(progress.isStartFinished == true);
+	REQUIRE(progress.isFadeOutStarted == true);
+	REQUIRE(progress.isFadeOutFinished == false);
+	REQUIRE(progress.isPostFadeOutStarted == false);
+	REQUIRE(progress.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress.isPreStartStarted == true);
+	REQUIRE(progress.isPreStartFinished == true);
+	REQUIRE(progress.isFadeInStarted == true);
+	REQUIRE(progress.isFadeInFinished == true);
+	REQUIRE(progress.isStartStarted == true);
+	REQUIRE(progress.isStartFinished == true);
+	REQUIRE(progress.isFadeOutStarted == true);
+	REQUIRE(progress.isFadeOutFinished == true);
+	REQUIRE(progress.isPostFadeOutStarted == true);
+	REQUIRE(progress.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(runner.done() == true);
+	REQUIRE(progress.isPreStartStarted == true);
+	REQUIRE(progress.isPreStartFinished == true);
+	REQUIRE(progress.isFadeInStarted == true);
+	REQUIRE(progress.isFadeInFinished == true);
+	REQUIRE(progress.isStartStarted == true);
+	REQUIRE(progress.isStartFinished == true);
+	REQUIRE(progress.isFadeOutStarted == true);
+	REQUIRE(progress.isFadeOutFinished == true);
+	REQUIRE(progress.isPostFadeOutStarted == true);
+	REQUIRE(progress.isPostFadeOutFinished == true);
+
+	REQUIRE(value == 42);
+}
+
+class SequenceWithVoidResult : public Co::SequenceBase<void>
+{
+private:
+	Co::Task<void> start() override
+	{
+		co_await Co::NextFrame();
+	}
+};
+
+TEST_CASE("Sequence with void result")
+{
+	const auto runner = Co::Play<SequenceWithVoidResult>().runScoped();
+	REQUIRE(runner.done() == false);
+
+	System::Update();
+	REQUIRE(runner.done() == true);
+}
+
+class SequenceWithMoveOnlyResult : public Co::SequenceBase<std::unique_ptr<int32>>
+{
+private:
+	Co::Task<std::unique_ptr<int32>> start() override
+	{
+		co_await Co::NextFrame();
+		co_return std::make_unique<int32>(42);
+	}
+
+public:
+	SequenceWithMoveOnlyResult() = default;
+};
+
+TEST_CASE("Sequence with move-only result")
+{
+	std::unique_ptr<int32> value;
+	const auto runner = Co::Play<SequenceWithMoveOnlyResult>()
+		.runScoped([&](std::unique_ptr<int32>&& result) { value = std::move(result); });
+	REQUIRE(runner.done() == false);
+
+	System::Update();
+	REQUIRE(runner.done() == true);
+	REQUIRE(*value == 42);
+}
+
+class TestUpdaterSequence : public Co::UpdaterSequenceBase<void>
+{
+private:
+	int m_count = 0;
+
+	void update() override
+	{
+		if (m_count == 3)
+		{
+			requestFinish();
+		}
+		++m_count;
+	}
+};
+
+TEST_CASE("UpdaterSequence")
+{
+	const auto runner = Co::Play<TestUpdaterSequence>().runScoped();
+	REQUIRE(runner.done() == false);
+
+	System::Update();
+	REQUIRE(runner.done() == false);
+
+	System::Update();
+	REQUIRE(runner.done() == false);
+
+	System::Update();
+	REQUIRE(runner.done() == true);
+}
+
+class TestUpdaterSequenceWithResult : public Co::UpdaterSequenceBase<int32>
+{
+private:
+	int m_count = 0;
+
+	void update() override
+	{
+		if (m_count == 3)
+		{
+			requestFinish(42);
+		}
+		++m_count;
+	}
+};
+
+TEST_CASE("UpdaterSequence with result")
+{
+	int32 value = 0;
+	const auto runner = Co::Play<TestUpdaterSequenceWithResult>().runScoped([&](int32 result) { value = result; });
+	REQUIRE(runner.done() == false);
+	REQUIRE(value == 0);
+
+	System::Update();
+	REQUIRE(runner.done() == false);
+	REQUIRE(value == 0);
+
+	System::Update();
+	REQUIRE(runner.done() == false);
+	REQUIRE(value == 0);
+
+	System::Update();
+	REQUIRE(runner.done() == true);
+	REQUIRE(value == 42);
+}
+
+class TestUpdaterSequenceWithMoveOnlyResult : public Co::UpdaterSequenceBase<std::unique_ptr<int32>>
+{
+private:
+	int m_count = 0;
+
+	void update() override
+	{
+		if (m_count == 3)
+		{
+			requestFinish(std::make_unique<int32>(42));
+		}
+		++m_count;
+	}
+};
+
+TEST_CASE("UpdaterSequence with move-only result")
+{
+	std::unique_ptr<int32> value;
+	const auto runner = Co::Play<TestUpdaterSequenceWithMoveOnlyResult>()
+		.runScoped([&](std::unique_ptr<int32>&& result) { value = std::move(result); });
+	REQUIRE(runner.done() == false);
+	REQUIRE(value == nullptr);
+
+	System::Update();
+	REQUIRE(runner.done() == false);
+	REQUIRE(value == nullptr);
+
+	System::Update();
+	REQUIRE(runner.done() == false);
+	REQUIRE(value == nullptr);
+
+	System::Update();
+	REQUIRE(runner.done() == true);
+	REQUIRE(value != nullptr);
+	REQUIRE(*value == 42);
+}
+
+class TestScene : public Co::SceneBase
+{
+public:
+	explicit TestScene(SequenceProgress* pProgress)
+		: m_pProgress(pProgress)
+	{
+	}
+
+private:
+	SequenceProgress* m_pProgress;
+
+	Co::Task<void> preStart() override
+	{
+		m_pProgress->isPreStartStarted = true;
+		co_await Co::NextFrame();
+		m_pProgress->isPreStartFinished = true;
+	}
+
+	Co::Task<void> fadeIn() override
+	{
+		m_pProgress->isFadeInStarted = true;
+		co_await Co::NextFrame();
+		m_pProgress->isFadeInFinished = true;
+	}
+
+	Co::Task<void> start() override
+	{
+		m_pProgress->isStartStarted = true;
+		co_await Co::NextFrame();
+		m_pProgress->isStartFinished = true;
+	}
+
+	Co::Task<void> fadeOut() override
+	{
+		m_pProgress->isFadeOutStarted = true;
+		co_await Co::NextFrame();
+		m_pProgress->isFadeOutFinished = true;
+	}
+
+	Co::Task<void> postFadeOut() override
+	{
+		m_pProgress->isPostFadeOutStarted = true;
+		co_await Co::NextFrame();
+		m_pProgress->isPostFadeOutFinished = true;
+	}
+};
+
+TEST_CASE("Co::PlaySceneFrom<TScene>")
+{
+	SequenceProgress progress;
+	const auto runner = Co::PlaySceneFrom<TestScene>(&progress).runScoped();
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress.isPreStartStarted == true); // 呼び出し時点で最初のsuspendまでは実行される
+	REQUIRE(progress.isPreStartFinished == false);
+	REQUIRE(progress.isFadeInStarted == false);
+	REQUIRE(progress.isFadeInFinished == false);
+	REQUIRE(progress.isStartStarted == false);
+	REQUIRE(progress.isStartFinished == false);
+	REQUIRE(progress.isFadeOutStarted == false);
+	REQUIRE(progress.isFadeOutFinished == false);
+	REQUIRE(progress.isPostFadeOutStarted == false);
+	REQUIRE(progress.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress.isPreStartStarted == true);
+	REQUIRE(progress.isPreStartFinished == true);
+	REQUIRE(progress.isFadeInStarted == true); // fadeInとstartは同時に実行される
+	REQUIRE(progress.isFadeInFinished == false);
+	REQUIRE(progress.isStartStarted == true); // fadeInとstartは同時に実行される
+	REQUIRE(progress.isStartFinished == false);
+	REQUIRE(progress.isFadeOutStarted == false);
+	REQUIRE(progress.isFadeOutFinished == false);
+	REQUIRE(progress.isPostFadeOutStarted == false);
+	REQUIRE(progress.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress.isPreStartStarted == true);
+	REQUIRE(progress.isPreStartFinished == true);
+	REQUIRE(progress.isFadeInStarted == true);
+	REQUIRE(progress.isFadeInFinished == true);
+	REQUIRE(progress.isStartStarted == true);
+	REQUIRE(progress.isStartFinished == true);
+	REQUIRE(progress.isFadeOutStarted == true);
+	REQUIRE(progress.isFadeOutFinished == false);
+	REQUIRE(progress.isPostFadeOutStarted == false);
+	REQUIRE(progress.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress.isPreStartStarted == true);
+	REQUIRE(progress.isPreStartFinished == true);
+	REQUIRE(progress.isFadeInStarted == true);
+	REQUIRE(progress.isFadeInFinished == true);
+	REQUIRE(progress.isStartStarted == true);
+	REQUIRE(progress.isStartFinished == true);
+	REQUIRE(progress.isFadeOutStarted == true);
+	REQUIRE(progress.isFadeOutFinished == true);
+	REQUIRE(progress.isPostFadeOutStarted == true);
+	REQUIRE(progress.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(runner.done() == true);
+	REQUIRE(progress.isPreStartStarted == true);
+	REQUIRE(progress.isPreStartFinished == true);
+	REQUIRE(progress.isFadeInStarted == true);
+	REQUIRE(progress.isFadeInFinished == true);
+	REQUIRE(progress.isStartStarted == true);
+	REQUIRE(progress.isStartFinished == true);
+	REQUIRE(progress.isFadeOutStarted == true);
+	REQUIRE(progress.isFadeOutFinished == true);
+	REQUIRE(progress.isPostFadeOutStarted == true);
+	REQUIRE(progress.isPostFadeOutFinished == true);
+}
+
+class ChainedTestScene : public Co::SceneBase
+{
+public:
+	explicit ChainedTestScene(SequenceProgress* pProgress1, SequenceProgress* pProgress2)
+		: m_pProgress1(pProgress1)
+		, m_pProgress2(pProgress2)
+	{
+	}
+
+private:
+	SequenceProgress* m_pProgress1;
+	SequenceProgress* m_pProgress2;
+
+	Co::Task<void> preStart() override
+	{
+		m_pProgress1->isPreStartStarted = true;
+		co_await Co::NextFrame();
+		m_pProgress1->isPreStartFinished = true;
+	}
+
+	Co::Task<void> fadeIn() override
+	{
+		m_pProgress1->isFadeInStarted = true;
 		co_await Co::NextFrame();
 		m_pProgress1->isFadeInFinished = true;
 	}
 
-	Co::Task<void> start() override
+	Co::Task<void> start() override
+	{
+		m_pProgress1->isStartStarted = true;
+		co_await Co::NextFrame();
+		REQUIRE(nextActionRequested() == false);
+		REQUIRE(requestNextScene<TestScene>(m_pProgress2) == true);
+		REQUIRE(nextActionRequested() == true);
+		m_pProgress1->isStartFinished = true;
+	}
+
+	Co::Task<void> fadeOut() override
+	{
+		m_pProgress1->isFadeOutStarted = true;
+		co_await Co::NextFrame();
+		m_pProgress1->isFadeOutFinished = true;
+	}
+
+	Co::Task<void> postFadeOut() override
+	{
+		m_pProgress1->isPostFadeOutStarted = true;
+		co_await Co::NextFrame();
+		m_pProgress1->isPostFadeOutFinished = true;
+	}
+};
+
+TEST_CASE("requestNextScene")
+{
+	SequenceProgress progress1;
+	SequenceProgress progress2;
+	const auto runner = Co::PlaySceneFrom<ChainedTestScene>(&progress1, &progress2).runScoped();
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress1.isPreStartStarted == true); // 呼び出し時点で最初のsuspendまでは実行される
+	REQUIRE(progress1.isPreStartFinished == false);
+	REQUIRE(progress1.isFadeInStarted == false);
+	REQUIRE(progress1.isFadeInFinished == false);
+	REQUIRE(progress1.isStartStarted == false);
+	REQUIRE(progress1.isStartFinished == false);
+	REQUIRE(progress1.isFadeOutStarted == false);
+	REQUIRE(progress1.isFadeOutFinished == false);
+	REQUIRE(progress1.isPostFadeOutStarted == false);
+	REQUIRE(progress1.isPostFadeOutFinished == false);
+	REQUIRE(progress2.allFalse());
+	
+	System::Update();
+
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress1.isPreStartStarted == true);
+	REQUIRE(progress1.isPreStartFinished == true);
+	REQUIRE(progress1.isFadeInStarted == true); // fadeInとstartは同時に実行される
+	REQUIRE(progress1.isFadeInFinished == false);
+	REQUIRE(progress1.isStartStarted == true); // fadeInとstartは同時に実行される
+	REQUIRE(progress1.isStartFinished == false);
+	REQUIRE(progress1.isFadeOutStarted == false);
+	REQUIRE(progress1.isFadeOutFinished == false);
+	REQUIRE(progress1.isPostFadeOutStarted == false);
+	REQUIRE(progress1.isPostFadeOutFinished == false);
+	REQUIRE(progress2.allFalse());
+
+	System::Update();
+
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress1.isPreStartStarted == true);
+	REQUIRE(progress1.isPreStartFinished == true);
+	REQUIRE(progress1.isFadeInStarted == true);
+	REQUIRE(progress1.isFadeInFinished == true);
+	REQUIRE(progress1.isStartStarted == true);
+	REQUIRE(progress1.isStartFinished == true);
+	REQUIRE(progress1.isFadeOutStarted == true);
+	REQUIRE(progress1.isFadeOutFinished == false);
+	REQUIRE(progress1.isPostFadeOutStarted == false);
+	REQUIRE(progress1.isPostFadeOutFinished == false);
+	REQUIRE(progress2.allFalse());
+
+	System::Update();
+
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress1.isPreStartStarted == true);
+	REQUIRE(progress1.isPreStartFinished == true);
+	REQUIRE(progress1.isFadeInStarted == true);
+	REQUIRE(progress1.isFadeInFinished == true);
+	REQUIRE(progress1.isStartStarted == true);
+	REQUIRE(progress1.isStartFinished == true);
+	REQUIRE(progress1.isFadeOutStarted == true);
+	REQUIRE(progress1.isFadeOutFinished == true);
+	REQUIRE(progress1.isPostFadeOutStarted == true);
+	REQUIRE(progress1.isPostFadeOutFinished == false);
+	REQUIRE(progress2.allFalse());
+
+	System::Update();
+
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress1.isPreStartStarted == true);
+	REQUIRE(progress1.isPreStartFinished == true);
+	REQUIRE(progress1.isFadeInStarted == true);
+	REQUIRE(progress1.isFadeInFinished == true);
+	REQUIRE(progress1.isStartStarted == true);
+	REQUIRE(progress1.isStartFinished == true);
+	REQUIRE(progress1.isFadeOutStarted == true);
+	REQUIRE(progress1.isFadeOutFinished == true);
+	REQUIRE(progress1.isPostFadeOutStarted == true);
+	REQUIRE(progress1.isPostFadeOutFinished == true);
+	// ここから2番目のシーンに遷移
+	REQUIRE(progress2.isPreStartStarted == true);
+	REQUIRE(progress2.isPreStartFinished == false);
+	REQUIRE(progress2.isFadeInStarted == false);
+	REQUIRE(progress2.isFadeInFinished == false);
+	REQUIRE(progress2.isStartStarted == false);
+	REQUIRE(progress2.isStartFinished == false);
+	REQUIRE(progress2.isFadeOutStarted == false);
+	REQUIRE(progress2.isFadeOutFinished == false);
+	REQUIRE(progress2.isPostFadeOutStarted == false);
+	REQUIRE(progress2.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress2.isPreStartStarted == true);
+	REQUIRE(progress2.isPreStartFinished == true);
+	REQUIRE(progress2.isFadeInStarted == true); // fadeInとstartは同時に実行される
+	REQUIRE(progress2.isFadeInFinished == false);
+	REQUIRE(progress2.isStartStarted == true); // fadeInとstartは同時に実行される
+	REQUIRE(progress2.isStartFinished == false);
+	REQUIRE(progress2.isFadeOutStarted == false);
+	REQUIRE(progress2.isFadeOutFinished == false);
+	REQUIRE(progress2.isPostFadeOutStarted == false);
+	REQUIRE(progress2.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress2.isPreStartStarted == true);
+	REQUIRE(progress2.isPreStartFinished == true);
+	REQUIRE(progress2.isFadeInStarted == true);
+	REQUIRE(progress2.isFadeInFinished == true);
+	REQUIRE(progress2.isStartStarted == true);
+	REQUIRE(progress2.isStartFinished == true);
+	REQUIRE(progress2.isFadeOutStarted == true);
+	REQUIRE(progress2.isFadeOutFinished == false);
+	REQUIRE(progress2.isPostFadeOutStarted == false);
+	REQUIRE(progress2.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(runner.done() == false);
+	REQUIRE(progress2.isPreStartStarted == true);
+	REQUIRE(progress2.isPreStartFinished == true);
+	REQUIRE(progress2.isFadeInStarted == true);
+	REQUIRE(progress2.isFadeInFinished == true);
+	REQUIRE(progress2.isStartStarted == true);
+	REQUIRE(progress2.isStartFinished == true);
+	REQUIRE(progress2.isFadeOutStarted == true);
+	REQUIRE(progress2.isFadeOutFinished == true);
+	REQUIRE(progress2.isPostFadeOutStarted == true);
+	REQUIRE(progress2.isPostFadeOutFinished == false);
+
+	System::Update();
+
+	REQUIRE(runner.done() == true);
+	REQUIRE(progress2.isPreStartStarted == true);
+	REQUIRE(progress2.isPreStartFinished == true);
+	REQUIRE(progress2.isFadeInStarted == true);
+	REQUIRE(progress2.isFadeInFinished == true);
+	REQUIRE(progress2.isStartStarted == true);
+	REQUIRE(progress2.isStartFinished == true);
+	REQUIRE(progress2.isFadeOutStarted == true);
+	REQUIRE(progress2.isFadeOutFinished == true);
+	REQUIRE(progress2.isPostFadeOutStarted == true);
+	REQUIRE(progress2.isPostFadeOutFinished == true);
+}
+
+class TestUpdaterScene : public Co::UpdaterSceneBase
+{
+private:
+	int m_count = 0;
+
+	void update() override
+	{
+		if (m_count == 3)
+		{
+			requestSceneFinish();
+		}
+		++m_count;
+	}
+};
+
+TEST_CASE("UpdaterScene")
+{
+	const auto runner = Co::PlaySceneFrom<TestUpdaterScene>().runScoped();
+	REQUIRE(runner.done() == false);
+
+	System::Update();
+	REQUIRE(runner.done() == false);
+
+	System::Update();
+	REQUIRE(runner.done() == false);
+
+	System::Update();
+	REQUIRE(runner.done() == true);
+}
+
+class FrameArenaTestScene : public Co::SceneBase
+{
+public:
+	explicit FrameArenaTestScene(Optional<std::size_t>* pNumLiveFrames)
+		: m_pNumLiveFrames(pNumLiveFrames)
+	{
+		enableFrameArena();
+	}
+
+private:
+	Optional<std::size_t>* m_pNumLiveFrames;
+
+	Co::Task<void> start() override
+	{
+		co_await Co::DelayFrame(1);
+		*m_pNumLiveFrames = frameArenaInternal()->numLiveFrames();
+	}
+};
+
+TEST_CASE("SceneBase::enableFrameArena")
+{
+	Optional<std::size_t> numLiveFrames;
+	const auto runner = Co::PlaySceneFrom<FrameArenaTestScene>(&numLiveFrames).runScoped();
+
+	while (!runner.done())
+	{
+		System::Update();
+	}
+
+	// シーン内で生成されたタスク(playInternal, startAndFadeOut, start等)のフレームはアリーナから確保される
+	REQUIRE(numLiveFrames.has_value());
+	REQUIRE(*numLiveFrames >= 3);
+}
+#endif
+
+TEST_CASE("ScopedDrawer draw order")
+{
+	Array<String> log;
+	const auto fnDrawer = [&log](String name) { return [&log, name] { log.push_back(name); }; };
+
+	Optional<Co::ScopedDrawer> drawerA;
+	drawerA.emplace(fnDrawer(U"A"), Co::Layer::Default, 0);
+	Co::ScopedDrawer drawerB{ fnDrawer(U"B"), Co::Layer::Default, -10 };
+	Co::ScopedDrawer drawerC{ fnDrawer(U"C"), Co::Layer::Default, 0 };
+	Co::ScopedDrawer drawerD{ fnDrawer(U"D"), Co::Layer::User_PreDefault_1, 100 };
+	Co::ScopedDrawer drawerE{ fnDrawer(U"E"), Co::Layer::Modal, -100 };
+
+	// レイヤー・描画順序の順に描画され、同じ場合は追加順に描画される
+	System::Update();
+	REQUIRE(log == Array<String>{ U"D", U"B", U"A", U"C", U"E" });
+
+	// 描画順序の変更
+	log.clear();
+	drawerB.setDrawIndex(10);
+	drawerC.setDrawIndex(-10);
+	System::Update();
+	REQUIRE(log == Array<String>{ U"D", U"C", U"A", U"B", U"E" });
+
+	// 描画順序が同じになった場合は追加順
+	log.clear();
+	drawerC.setDrawIndex(0);
+	System::Update();
+	REQUIRE(log == Array<String>{ U"D", U"A", U"C", U"B", U"E" });
+
+	// レイヤーの変更
+	log.clear();
+	drawerE.setLayer(Co::Layer::User_PreDefault_1);
+	drawerD.setLayer(Co::Layer::Debug);
+	System::Update();
+	REQUIRE(log == Array<String>{ U"E", U"A", U"C", U"B", U"D" });
+
+	// 削除後に追加された描画は、削除された描画のスロットを再利用しても後から追加された扱いになる
+	log.clear();
+	drawerA.reset();
+	Co::ScopedDrawer drawerF{ fnDrawer(U"F"), Co::Layer::Default, 0 };
+	System::Update();
+	REQUIRE(log == Array<String>{ U"E", U"C", U"F", U"B", U"D" });
+	REQUIRE(Co::HasActiveDrawerInLayer(Co::Layer::Default) == true);
+	REQUIRE(Co::HasActiveDrawerInLayer(Co::Layer::Modal) == false);
+}
+
+TEST_CASE("Co::ActiveLayersMask")
+{
+	REQUIRE(Co::ActiveLayersMask().contains(Co::Layer::Modal) == false);
+	REQUIRE(Co::HasActiveTransition() == false);
+
+	{
+		const Co::ScopedDrawer drawer1{ [] {}, Co::Layer::Modal };
+		const Co::ScopedDrawer drawer2{ [] {}, Co::Layer::Modal };
+		Optional<Co::ScopedDrawer> drawer3;
+		drawer3.emplace([] {}, Co::Layer::Transition_General);
+
+		const Co::LayerMask activeLayers = Co::ActiveLayersMask();
+		REQUIRE(activeLayers.contains(Co::Layer::Modal) == true);
+		REQUIRE(activeLayers.contains(Co::Layer::Transition_General) == true);
+		REQUIRE(activeLayers.contains(Co::Layer::Debug) == false);
+		REQUIRE(activeLayers.intersects(Co::LayerMask{ Co::Layer::Default, Co::Layer::Modal }) == true);
+		REQUIRE(activeLayers.intersects(Co::LayerMask{ Co::Layer::Default, Co::Layer::Debug }) == false);
+		REQUIRE(Co::HasActiveModal() == true);
+		REQUIRE(Co::HasActiveTransition() == true);
+		REQUIRE(Co::HasActiveGeneralTransition() == true);
+		REQUIRE(Co::HasActiveFadeInTransition() == false);
+
+		drawer3.reset();
+		REQUIRE(Co::HasActiveTransition() == false);
+		REQUIRE(Co::HasActiveModal() == true);
+	}
+
+	// 全てのDrawerが削除されたレイヤーは含まれない
+	REQUIRE(Co::ActiveLayersMask().contains(Co::Layer::Modal) == false);
+	REQUIRE(Co::HasActiveModal() == false);
+}
+
+TEST_CASE("Co::Scheduler")
+{
+	Co::Scheduler scheduler;
+
+	int32 count = 0;
+	Optional<Co::ScopedTaskRunner> runner;
+	{
+		// スコープ内で実行開始したタスクはschedulerに登録される
+		const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+		runner.emplace(CountFramesTask(3, &count).runScoped());
+	}
+	REQUIRE(count == 1);
+
+	// 既定のスケジューラの更新では実行されない
+	System::Update();
+	REQUIRE(count == 1);
+
+	// schedulerの更新で実行される(スコープ外からも完了を確認できる)
+	scheduler.update();
+	REQUIRE(count == 2);
+	REQUIRE(runner->done() == false);
+	scheduler.update();
+	REQUIRE(count == 3);
+	REQUIRE(runner->done() == false);
+	scheduler.update();
+	REQUIRE(runner->done() == true);
+	REQUIRE(scheduler.frameCount() == 3);
+}
+
+TEST_CASE("Co::Scheduler cancel and delay")
+{
+	Co::Scheduler scheduler;
+
+	int32 value = 0;
+	Optional<Co::ScopedTaskRunner> runner;
+	{
+		const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+		runner.emplace(Co::Delay(1s).runScoped([&value] { value = 1; }));
+	}
+
+	// Delayはschedulerの時刻で判定される
+	scheduler.update(0.5s);
+	REQUIRE(value == 0);
+	REQUIRE(scheduler.time() == Approx(0.5));
+	scheduler.update(0.6s);
+	REQUIRE(value == 1);
+
+	// スコープ外でランナーを破棄しても、登録先のschedulerから削除される
+	int32 count = 0;
+	{
+		const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+		runner.emplace(CountFramesTask(100, &count).runScoped());
+	}
+	runner.reset();
+	scheduler.update();
+	REQUIRE(count == 1);
+}
+
+TEST_CASE("Co::Scheduler with ScopedDrawer")
+{
+	Co::Scheduler scheduler;
+
+	int32 drawCount = 0;
+	Optional<Co::ScopedDrawer> drawer;
+	{
+		const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+		drawer.emplace([&drawCount] { ++drawCount; }, Co::Layer::Modal);
+
+		// スコープ内では、schedulerのレイヤーが参照される
+		REQUIRE(Co::HasActiveModal() == true);
+	}
+	REQUIRE(Co::HasActiveModal() == false);
+
+	System::Update();
+	REQUIRE(drawCount == 0);
+	scheduler.draw();
+	REQUIRE(drawCount == 1);
+
+	drawer.reset();
+	scheduler.draw();
+	REQUIRE(drawCount == 1);
+}
+
+TEST_CASE("Co::Scheduler with TaskFinishSource")
+{
+	Co::Scheduler scheduler;
+	Co::TaskFinishSource<int32> taskFinishSource;
+
+	int32 result = 0;
+	Optional<Co::ScopedTaskRunner> runner;
+	{
+		const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+		runner.emplace(taskFinishSource.waitForResult().runScoped([&result](int32 r) { result = r; }));
+	}
+	scheduler.update();
+	REQUIRE(result == 0);
+
+	// スコープ外から完了させても、待機しているタスクはschedulerで起床する
+	taskFinishSource.requestFinish(42);
+	System::Update();
+	REQUIRE(result == 0);
+	scheduler.update();
+	REQUIRE(result == 42);
+}
+
+TEST_CASE("Co::Scheduler on multiple threads")
+{
+	constexpr int32 NumThreads = 4;
+	constexpr int32 NumTasksPerThread = 100;
+	constexpr int32 NumFrames = 50;
+
+	Array<int32> results(NumThreads, 0);
+	{
+		Array<std::thread> threads;
+		for (int32 i = 0; i < NumThreads; ++i)
+		{
+			threads.emplace_back([i, &results]
+				{
+					// スレッドごとに独立したスケジューラで実行する
+					Co::Scheduler scheduler;
+					Array<int32> counts(NumTasksPerThread, 0);
+					Co::MultiRunner multiRunner;
+					{
+						const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+						for (int32& count : counts)
+						{
+							CountFramesTask(NumFrames, &count).runScoped().addTo(multiRunner);
+						}
+					}
+					while (!multiRunner.allDone())
+					{
+						scheduler.update();
+					}
+					results[i] = std::accumulate(counts.begin(), counts.end(), 0);
+				});
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	for (const int32 result : results)
+	{
+		REQUIRE(result == NumTasksPerThread * NumFrames);
+	}
+}
+
+TEST_CASE("Co::RunOnThreadPool")
+{
+	const auto mainThreadId = std::this_thread::get_id();
+	std::atomic<bool> funcFinished = false;
+	std::thread::id funcThreadId;
+
+	Optional<int32> result;
+	const auto runner = Co::RunOnThreadPool([&]
+		{
+			funcThreadId = std::this_thread::get_id();
+			funcFinished = true;
+			return 42;
+		}).runScoped([&](int32 value) { result = value; });
+
+	while (!funcFinished)
+	{
+		std::this_thread::yield();
+	}
+
+	// 関数が終了しても、完了はupdate時に通知される
+	REQUIRE(result == none);
+	while (!runner.done())
+	{
+		System::Update();
+	}
+	REQUIRE(result == 42);
+	REQUIRE(funcThreadId != mainThreadId);
+}
+
+Co::Task<void> RunOnThreadPoolVoidAndExceptionTest(int32* pValue, String* pMessage)
+{
+	co_await Co::RunOnThreadPool([pValue] { *pValue = 1; });
+	try
+	{
+		co_await Co::RunOnThreadPool([]() -> int32 { throw Error{ U"test exception" }; });
+	}
+	catch (const Error& e)
+	{
+		// 関数内で発生した例外は、待機しているタスクへ再送出される
+		*pMessage = e.messageW();
+	}
+}
+
+TEST_CASE("Co::RunOnThreadPool with void and exception")
+{
+	int32 value = 0;
+	String message;
+	const auto runner = RunOnThreadPoolVoidAndExceptionTest(&value, &message).runScoped();
+
+	while (!runner.done())
+	{
+		System::Update();
+	}
+	REQUIRE(value == 1);
+	REQUIRE(message == U"test exception");
+}
+
+TEST_CASE("Co::RunOnThreadPool with priority and max concurrency")
+{
+	Co::Scheduler scheduler;
+
+	std::atomic<bool> blockerStarted = false;
+	std::atomic<bool> blockerReleased = false;
+	std::atomic<int32> numRunningJobs = 0;
+	std::atomic<int32> maxNumRunningJobs = 0;
+	std::mutex orderMutex;
+	Array<int32> order;
+
+	const auto pushOrder = [&](int32 value)
+		{
+			const int32 numRunning = ++numRunningJobs;
+			maxNumRunningJobs = std::max(maxNumRunningJobs.load(), numRunning);
+			{
+				const std::lock_guard lock{ orderMutex };
+				order.push_back(value);
+			}
+			--numRunningJobs;
+		};
+
+	Co::MultiRunner multiRunner;
+	{
+		const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+		Co::SetThreadPoolMaxConcurrency(1);
+		Co::RunOnThreadPool([&]
+			{
+				blockerStarted = true;
+				while (!blockerReleased)
+				{
+					std::this_thread::yield();
+				}
+			}).runScoped().addTo(multiRunner);
+	}
+	while (!blockerStarted)
+	{
+		std::this_thread::yield();
+	}
+
+	// 同時実行数の上限が1のため、後から投入したジョブは優先度の高い順に実行される
+	{
+		const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+		Co::RunOnThreadPool([&] { pushOrder(1); }, Co::ThreadPoolPriority::Low).runScoped().addTo(multiRunner);
+		Co::RunOnThreadPool([&] { pushOrder(2); }, Co::ThreadPoolPriority::Normal).runScoped().addTo(multiRunner);
+		Co::RunOnThreadPool([&] { pushOrder(3); }, Co::ThreadPoolPriority::High).runScoped().addTo(multiRunner);
+	}
+	blockerReleased = true;
+
+	while (!multiRunner.allDone())
+	{
+		scheduler.update();
+	}
+	REQUIRE(order == Array<int32>{ 3, 2, 1 });
+	REQUIRE(maxNumRunningJobs == 1);
+}
+
+TEST_CASE("Co::RunOnThreadPool cancel")
+{
+	std::atomic<bool> blockerStarted = false;
+	std::atomic<bool> blockerReleased = false;
+	std::atomic<bool> cancelledJobExecuted = false;
+	{
+		Co::Scheduler scheduler;
+		Optional<Co::ScopedTaskRunner> blockerRunner;
+		Optional<Co::ScopedTaskRunner> runner;
+		{
+			const Co::ScopedCurrentScheduler currentScheduler{ scheduler };
+			Co::SetThreadPoolMaxConcurrency(1);
+			blockerRunner.emplace(Co::RunOnThreadPool([&]
+				{
+					blockerStarted = true;
+					while (!blockerReleased)
+					{
+						std::this_thread::yield();
+					}
+				}).runScoped());
+			while (!blockerStarted)
+			{
+				std::this_thread::yield();
+			}
+			runner.emplace(Co::RunOnThreadPool([&] { cancelledJobExecuted = true; }).runScoped());
+		}
+
+		// 実行前にタスクを破棄した場合、ジョブは実行されない
+		runner.reset();
+		blockerReleased = true;
+		while (!blockerRunner->done())
+		{
+			scheduler.update();
+		}
+	}
+	REQUIRE(cancelledJobExecuted == false);
+}
+
+TEST_CASE("ThreadPool destroyed with queued jobs")
+{
+	Co::detail::CompletionQueue completionQueue;
+	std::atomic<bool> blockerStarted = false;
+	std::atomic<bool> blockerReleased = false;
+	std::atomic<bool> queuedJobExecuted = false;
+
+	auto blockerFunc = [&]
+		{
+			blockerStarted = true;
+			while (!blockerReleased)
+			{
+				std::this_thread::yield();
+			}
+		};
+	auto queuedFunc = [&]
+		{
+			queuedJobExecuted = true;
+			return 1;
+		};
+	const auto blockerJob = std::make_shared<Co::detail::ThreadPoolJob<void, decltype(blockerFunc)>>(std::move(blockerFunc), &completionQueue);
+	const auto queuedJob = std::make_shared<Co::detail::ThreadPoolJob<int32, decltype(queuedFunc)>>(std::move(queuedFunc), &completionQueue);
+	{
+		auto threadPool = std::make_unique<Co::detail::ThreadPool>(1);
+		threadPool->submit(blockerJob, Co::ThreadPoolPriority::Normal);
+		while (!blockerStarted)
+		{
+			std::this_thread::yield();
+		}
+		threadPool->submit(queuedJob, Co::ThreadPoolPriority::Normal);
+
+		// 破棄の開始後に実行中のジョブを完了させる
+		std::thread releaser{ [&]
+			{
+				std::this_thread::sleep_for(0.1s);
+				blockerReleased = true;
+			} };
+		threadPool.reset();
+		releaser.join();
+	}
+
+	// 未実行のジョブは実行されず、取り消されたことが完了キューから通知される
+	REQUIRE(queuedJobExecuted == false);
+	REQUIRE(queuedJob->isCompleted() == false);
+	completionQueue.drain();
+	REQUIRE(blockerJob->isCompleted() == true);
+	REQUIRE(queuedJob->isCompleted() == true);
+	REQUIRE_THROWS_WITH(queuedJob->release(), "RunOnThreadPool: Thread pool was destroyed before the job was run");
+}
+
+TEST_CASE("Co::ThreadSafeTaskFinishSource")
+{
+	Co::ThreadSafeTaskFinishSource<int32> taskFinishSource;
+
+	Optional<int32> result;
+	const auto runner = taskFinishSource.waitForResult().runScoped([&](int32 value) { result = value; });
+
+	// 複数のスレッドから同時にrequestFinishしても、最初の1回のみ成功する
+	std::atomic<int32> successCount = 0;
+	{
+		Array<std::thread> threads;
+		for (int32 i = 0; i < 4; ++i)
+		{
+			threads.emplace_back([&] { if (taskFinishSource.requestFinish(42)) ++successCount; });
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+	}
+	REQUIRE(successCount == 1);
+	REQUIRE(taskFinishSource.done() == true);
+
+	// 待機しているタスクは、次回の更新時に起床される
+	REQUIRE(result == none);
+	System::Update();
+	REQUIRE(runner.done() == true);
+	REQUIRE(result == 42);
+	REQUIRE(taskFinishSource.hasResult() == false);
+	REQUIRE_THROWS_AS(taskFinishSource.result(), Error);
+}
+
+TEST_CASE("Co::ThreadSafeTaskFinishSource<void>")
+{
+	int32 finishCount = 0;
+	Optional<Co::ScopedTaskRunner> runner;
+	{
+		// 待機中にThreadSafeTaskFinishSourceが破棄されても、通知は安全に破棄される
+		Co::ThreadSafeTaskFinishSource<void> taskFinishSource;
+		runner.emplace(taskFinishSource.waitUntilDone().runScoped([&] { ++finishCount; }));
+		std::thread{ [&] { taskFinishSource.requestFinish(); } }.join();
+		System::Update();
+		REQUIRE(finishCount == 1);
+
+		Co::ThreadSafeTaskFinishSource<void> destroyedTaskFinishSource;
+		std::thread{ [&] { destroyedTaskFinishSource.requestFinish(); } }.join();
+	}
+	System::Update();
+	REQUIRE(finishCount == 1);
+}
+
+TEST_CASE("Co::ThreadSafeTaskFinishSource destroyed as soon as hasResult")
+{
+	// 結果の公開直後に所有スレッドが破棄しても、requestFinish中のスレッドが解放済みの領域に書き込まない
+	// (ThreadSanitizer・AddressSanitizerでの検出を想定し、タイミングを変えながら繰り返す)
+	for (int32 i = 0; i < 200; ++i)
+	{
+		Optional<Co::ThreadSafeTaskFinishSource<int32>> taskFinishSource;
+		taskFinishSource.emplace();
+		auto* const pTaskFinishSource = &*taskFinishSource;
+		std::thread thread{ [pTaskFinishSource] { (void)pTaskFinishSource->requestFinish(42); } };
+		while (!taskFinishSource->hasResult())
+		{
+			std::this_thread::yield();
+		}
+		REQUIRE(taskFinishSource->result() == 42);
+		taskFinishSource.reset();
+		thread.join();
+		System::Update();
+	}
+}
+
+TEST_CASE("Co::PostToMainThread")
+{
+	constexpr int32 NumThreads = 4;
+
+	// キューの容量を超える数を渡しても、スレッドごとの順序を保って全て実行される
+	constexpr int32 NumPostsPerThread = static_cast<int32>(Co::detail::MainThreadPostQueue::Capacity);
+
+	const auto mainThreadId = std::this_thread::get_id();
+	Array<Array<int32>> receivedValues(NumThreads);
+	int32 receivedCount = 0;
+	bool allOnMainThread = true;
+	{
+		Array<std::thread> threads;
+		for (int32 i = 0; i < NumThreads; ++i)
+		{
+			threads.emplace_back([&, i]
+				{
+					for (int32 value = 0; value < NumPostsPerThread; ++value)
+					{
+						Co::PostToMainThread([&, i, value]
+							{
+								allOnMainThread = allOnMainThread && (std::this_thread::get_id() == mainThreadId);
+								receivedValues[i].push_back(value);
+								++receivedCount;
+							});
+					}
+				});
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	REQUIRE(receivedCount == 0);
+	while (receivedCount < NumThreads * NumPostsPerThread)
+	{
+		System::Update();
+	}
+	REQUIRE(allOnMainThread == true);
+	for (const auto& values : receivedValues)
+	{
+		REQUIRE(values.size() == static_cast<size_t>(NumPostsPerThread));
+		REQUIRE(std::is_sorted(values.begin(), values.end()));
+	}
+}
+
+TEST_CASE("Co::PostToMainThread with large function object")
+{
+	// 内部の領域に収まらない関数オブジェクトも渡せる
+	std::array<int32, 64> values{};
+	values.back() = 42;
+
+	int32 result = 0;
+	std::thread{ [&result, values] { Co::PostToMainThread([&result, values] { result = values.back(); }); } }.join();
+	System::Update();
+	REQUIRE(result == 42);
+}
+
+TEST_CASE("Co::PostToMainThread queue is owned by the first registered instance")
+{
+	// 既定のキューは最初に登録されたインスタンスが保持するため、他のキューは登録できない
+	Co::detail::MainThreadPostQueue otherQueue;
+	REQUIRE(otherQueue.tryRegister() == false);
+
+	bool posted = false;
+	std::thread{ [&]
+		{
+#ifdef COTASKLIB_NO_SIV3D
+			// 他のスレッドで登録したインスタンスが破棄されても、既定のキューは引き続き関数を受け付ける
+			{
+				const Co::ManualBackend otherBackend;
+			}
+#endif
+			posted = Co::PostToMainThread([&] { posted = false; });
+		} }.join();
+	REQUIRE(posted == true);
+	System::Update();
+	REQUIRE(posted == false);
+}
+
+Co::Task<void> ChannelReceiveLoopTest(Co::Channel<int32>* pChannel, Array<int32>* pReceived)
+{
+	while (true)
 	{
-		m_pProgress1->isStartStarted = true;
-		co_await Co::NextFrame();
-		REQUIRE(nextActionRequested() == false);
-		REQUIRE(requestNextScene<TestScene>(m_pProgress2) == true);
-		REQUIRE(nextActionRequested() == true);
-		m_pProgress1->isStartFinished = true;
+		pReceived->push_back(co_await pChannel->receive());
 	}
+}
 
-	Co::Task<void> fadeOut() override
+Co::Task<void> ChannelReceiveAllTest(Co::Channel<int32>* pChannel, Array<int32>* pReceived, int32 count)
+{
+	while (pReceived->size() < static_cast<size_t>(count))
 	{
-		m_pProgress1->isFadeOutStarted = true;
-		co_await Co::NextFrame();
-		m_pProgress1->isFadeOutFinished = true;
+		// まとめて受信する
+		for (const int32 value : co_await pChannel->receiveAll())
+		{
+			pReceived->push_back(value);
+		}
 	}
+}
 
-	Co::Task<void> postFadeOut() override
+Co::Task<void> ChannelSendTest(Co::Channel<int32>* pChannel, int32* pSentCount, int32 count)
+{
+	for (int32 i = 0; i < count; ++i)
 	{
-		m_pProgress1->isPostFadeOutStarted = true;
-		co_await Co::NextFrame();
-		m_pProgress1->isPostFadeOutFinished = true;
+		co_await pChannel->send(i);
+		++*pSentCount;
 	}
-};
+}
 
-TEST_CASE("requestNextScene")
+TEST_CASE("Co::Channel")
 {
-	SequenceProgress progress1;
-	SequenceProgress progress2;
-	const auto runner = Co::PlaySceneFrom<ChainedTestScene>(&progress1, &progress2).runScoped();
-	REQUIRE(runner.done() == false);
-	REQUIRE(progress1.isPreStartStarted == true); // 呼び出し時点で最初のsuspendまでは実行される
-	REQUIRE(progress1.isPreStartFinished == false);
-	REQUIRE(progress1.isFadeInStarted == false);
-	REQUIRE(progress1.isFadeInFinished == false);
-	REQUIRE(progress1.isStartStarted == false);
-	REQUIRE(progress1.isStartFinished == false);
-	REQUIRE(progress1.isFadeOutStarted == false);
-	REQUIRE(progress1.isFadeOutFinished == false);
-	REQUIRE(progress1.isPostFadeOutStarted == false);
-	REQUIRE(progress1.isPostFadeOutFinished == false);
-	REQUIRE(progress2.allFalse());
-	
-	System::Update();
+	Co::Channel<int32> channel{ 4 };
+	REQUIRE(channel.capacity() == 4);
 
-	REQUIRE(runner.done() == false);
-	REQUIRE(progress1.isPreStartStarted == true);
-	REQUIRE(progress1.isPreStartFinished == true);
-	REQUIRE(progress1.isFadeInStarted == true); // fadeInとstartは同時に実行される
-	REQUIRE(progress1.isFadeInFinished == false);
-	REQUIRE(progress1.isStartStarted == true); // fadeInとstartは同時に実行される
-	REQUIRE(progress1.isStartFinished == false);
-	REQUIRE(progress1.isFadeOutStarted == false);
-	REQUIRE(progress1.isFadeOutFinished == false);
-	REQUIRE(progress1.isPostFadeOutStarted == false);
-	REQUIRE(progress1.isPostFadeOutFinished == false);
-	REQUIRE(progress2.allFalse());
+	Array<int32> received;
+	const auto runner = ChannelReceiveLoopTest(&channel, &received).runScoped();
+	REQUIRE(received.empty());
 
+	// 同じスケジューラからの送信時は、同一フレーム内で受信される
+	for (int32 i = 1; i <= 4; ++i)
+	{
+		REQUIRE(channel.trySend(i) == true);
+	}
+	REQUIRE(channel.trySend(5) == false);
 	System::Update();
+	REQUIRE(received == Array<int32>{ 1, 2, 3, 4 });
 
-	REQUIRE(runner.done() == false);
-	REQUIRE(progress1.isPreStartStarted == true);
-	REQUIRE(progress1.isPreStartFinished == true);
-	REQUIRE(progress1.isFadeInStarted == true);
-	REQUIRE(progress1.isFadeInFinished == true);
-	REQUIRE(progress1.isStartStarted == true);
-	REQUIRE(progress1.isStartFinished == true);
-	REQUIRE(progress1.isFadeOutStarted == true);
-	REQUIRE(progress1.isFadeOutFinished == false);
-	REQUIRE(progress1.isPostFadeOutStarted == false);
-	REQUIRE(progress1.isPostFadeOutFinished == false);
-	REQUIRE(progress2.allFalse());
+	// 他のスレッドからの送信時は、次回の更新時に受信される
+	bool sent = false;
+	std::thread{ [&] { sent = channel.trySend(5); } }.join();
+	REQUIRE(sent == true);
+	REQUIRE(received.size() == 4);
+	System::Update();
+	REQUIRE(received == Array<int32>{ 1, 2, 3, 4, 5 });
+}
+
+TEST_CASE("Co::Channel capacity is not rounded up")
+{
+	for (const std::size_t capacity : { 1, 3, 5 })
+	{
+		Co::Channel<int32> channel{ capacity };
+		REQUIRE(channel.capacity() == capacity);
+
+		// 2周分送受信しても、指定した容量を超えて送信されない
+		for (int32 round = 0; round < 2; ++round)
+		{
+			for (std::size_t i = 0; i < capacity; ++i)
+			{
+				REQUIRE(channel.trySend(static_cast<int32>(i)) == true);
+			}
+			REQUIRE(channel.trySend(-1) == false);
+
+			bool sent = true;
+			std::thread{ [&] { sent = channel.trySend(-1); } }.join();
+			REQUIRE(sent == false);
+
+			for (std::size_t i = 0; i < capacity; ++i)
+			{
+				REQUIRE(channel.tryReceive() == static_cast<int32>(i));
+			}
+			REQUIRE(channel.tryReceive() == none);
+		}
+	}
+
+	REQUIRE_THROWS_WITH(Co::Channel<int32>{ 0 }, "BoundedMPMCQueue: capacity must be greater than 0");
+}
+
+TEST_CASE("Co::Channel send with backpressure")
+{
+	Co::Channel<int32> channel{ 2 };
 
+	int32 sentCount = 0;
+	const auto sender = ChannelSendTest(&channel, &sentCount, 5).runScoped();
+
+	// 満杯の間は送信側が待機する
+	REQUIRE(sentCount == 2);
 	System::Update();
+	REQUIRE(sentCount == 2);
 
-	REQUIRE(runner.done() == false);
-	REQUIRE(progress1.isPreStartStarted == true);
-	REQUIRE(progress1.isPreStartFinished == true);
-	REQUIRE(progress1.isFadeInStarted == true);
-	REQUIRE(progress1.isFadeInFinished == true);
-	REQUIRE(progress1.isStartStarted == true);
-	REQUIRE(progress1.isStartFinished == true);
-	REQUIRE(progress1.isFadeOutStarted == true);
-	REQUIRE(progress1.isFadeOutFinished == true);
-	REQUIRE(progress1.isPostFadeOutStarted == true);
-	REQUIRE(progress1.isPostFadeOutFinished == false);
-	REQUIRE(progress2.allFalse());
+	// 受信すると送信側が起床される
+	REQUIRE(channel.tryReceive() == 0);
+	System::Update();
+	REQUIRE(sentCount == 3);
+
+	Array<int32> received;
+	const auto receiver = ChannelReceiveAllTest(&channel, &received, 4).runScoped();
+	while (!receiver.done())
+	{
+		System::Update();
+	}
+	REQUIRE(sender.done() == true);
+	REQUIRE(received == Array<int32>{ 1, 2, 3, 4 });
+}
+
+TEST_CASE("Co::Channel from worker thread")
+{
+	constexpr int32 NumValues = 10000;
+
+	Co::Channel<int32> channel{ 64 };
+
+	Array<int32> received;
+	const auto receiver = ChannelReceiveAllTest(&channel, &received, NumValues).runScoped();
+
+	std::thread producer{ [&]
+		{
+			for (int32 i = 0; i < NumValues; ++i)
+			{
+				while (!channel.trySend(i))
+				{
+					std::this_thread::yield();
+				}
+			}
+		} };
+	while (!receiver.done())
+	{
+		System::Update();
+	}
+	producer.join();
+
+	REQUIRE(received.size() == static_cast<size_t>(NumValues));
+	for (int32 i = 0; i < NumValues; ++i)
+	{
+		REQUIRE(received[i] == i);
+	}
+}
+
+Co::Generator<int32> GeneratorCountTest(int32 count, int32 framesPerValue)
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		co_yield i;
+		co_await Co::DelayFrame(framesPerValue);
+	}
+}
+
+Co::Task<void> GeneratorReceiveTest(Co::Generator<int32>* pGenerator, Array<int32>* pReceived, bool* pFinished)
+{
+	while (const auto value = co_await pGenerator->next())
+	{
+		pReceived->push_back(*value);
+	}
+	*pFinished = true;
+}
+
+Co::Generator<String> GeneratorThrowTest()
+{
+	co_yield U"A";
+	co_await Co::NextFrame();
+	throw std::runtime_error{ "error" };
+}
+
+Co::Task<void> GeneratorThrowReceiveTest(Co::Generator<String>* pGenerator, Array<String>* pReceived, bool* pCaught)
+{
+	try
+	{
+		while (auto value = co_await pGenerator->next())
+		{
+			pReceived->push_back(std::move(*value));
+		}
+	}
+	catch (const std::runtime_error&)
+	{
+		*pCaught = true;
+	}
+}
+
+Co::Generator<std::unique_ptr<int32>> GeneratorMoveOnlyTest()
+{
+	co_yield std::make_unique<int32>(1);
+	co_yield std::make_unique<int32>(2);
+}
+
+TEST_CASE("Co::Generator")
+{
+	Co::Generator<int32> generator = GeneratorCountTest(3, 1);
+	REQUIRE(generator.done() == false);
+
+	Array<int32> received;
+	bool finished = false;
+	const auto runner = GeneratorReceiveTest(&generator, &received, &finished).runScoped();
+
+	// 最初の値はフレーム待ちなしで得られる
+	REQUIRE(received == Array<int32>{ 0 });
 
+	// 以降はco_yieldごとに1フレーム待機する
 	System::Update();
+	REQUIRE(received == Array<int32>{ 0, 1 });
+	System::Update();
+	REQUIRE(received == Array<int32>{ 0, 1, 2 });
+	REQUIRE(finished == false);
 
-	REQUIRE(runner.done() == false);
-	REQUIRE(progress1.isPreStartStarted == true);
-	REQUIRE(progress1.isPreStartFinished == true);
-	REQUIRE(progress1.isFadeInStarted == true);
-	REQUIRE(progress1.isFadeInFinished == true);
-	REQUIRE(progress1.isStartStarted == true);
-	REQUIRE(progress1.isStartFinished == true);
-	REQUIRE(progress1.isFadeOutStarted == true);
-	REQUIRE(progress1.isFadeOutFinished == true);
-	REQUIRE(progress1.isPostFadeOutStarted == true);
-	REQUIRE(progress1.isPostFadeOutFinished == true);
-	// ここから2番目のシーンに遷移
-	REQUIRE(progress2.isPreStartStarted == true);
-	REQUIRE(progress2.isPreStartFinished == false);
-	REQUIRE(progress2.isFadeInStarted == false);
-	REQUIRE(progress2.isFadeInFinished == false);
-	REQUIRE(progress2.isStartStarted == false);
-	REQUIRE(progress2.isStartFinished == false);
-	REQUIRE(progress2.isFadeOutStarted == false);
-	REQUIRE(progress2.isFadeOutFinished == false);
-	REQUIRE(progress2.isPostFadeOutStarted == false);
-	REQUIRE(progress2.isPostFadeOutFinished == false);
+	// ジェネレータが終了するとnoneが返る
+	System::Update();
+	REQUIRE(finished == true);
+	REQUIRE(generator.done() == true);
+	REQUIRE(runner.done() == true);
+}
+
+TEST_CASE("Co::Generator with multiple values in one frame")
+{
+	Co::Generator<int32> generator = GeneratorCountTest(5, 0);
+
+	Array<int32> received;
+	bool finished = false;
+	const auto runner = GeneratorReceiveTest(&generator, &received, &finished).runScoped();
+
+	// フレーム待ちがなければ、同一フレーム内ですべての値が得られる
+	REQUIRE(received == Array<int32>{ 0, 1, 2, 3, 4 });
+	REQUIRE(finished == true);
+}
+
+TEST_CASE("Co::Generator with exception")
+{
+	Co::Generator<String> generator = GeneratorThrowTest();
+
+	Array<String> received;
+	bool caught = false;
+	const auto runner = GeneratorThrowReceiveTest(&generator, &received, &caught).runScoped();
+	REQUIRE(received == Array<String>{ U"A" });
+	REQUIRE(caught == false);
 
+	// ジェネレータ内の例外はnext()の待機側へ伝搬する
 	System::Update();
+	REQUIRE(caught == true);
+	REQUIRE(generator.done() == true);
+}
+
+TEST_CASE("Co::Generator forEach")
+{
+	Array<int32> received;
+	const auto runner = GeneratorCountTest(3, 2)
+		.forEach([&received](int32 value) { received.push_back(value); })
+		.runScoped();
+	REQUIRE(received == Array<int32>{ 0 });
 
+	for (int32 i = 0; i < 4; ++i)
+	{
+		System::Update();
+	}
+	REQUIRE(received == Array<int32>{ 0, 1, 2 });
 	REQUIRE(runner.done() == false);
-	REQUIRE(progress2.isPreStartStarted == true);
-	REQUIRE(progress2.isPreStartFinished == true);
-	REQUIRE(progress2.isFadeInStarted == true); // fadeInとstartは同時に実行される
-	REQUIRE(progress2.isFadeInFinished == false);
-	REQUIRE(progress2.isStartStarted == true); // fadeInとstartは同時に実行される
-	REQUIRE(progress2.isStartFinished == false);
-	REQUIRE(progress2.isFadeOutStarted == false);
-	REQUIRE(progress2.isFadeOutFinished == false);
-	REQUIRE(progress2.isPostFadeOutStarted == false);
-	REQUIRE(progress2.isPostFadeOutFinished == false);
 
 	System::Update();
+	System::Update();
+	REQUIRE(runner.done() == true);
 
-	REQUIRE(runner.done() == false);
-	REQUIRE(progress2.isPreStartStarted == true);
-	REQUIRE(progress2.isPreStartFinished == true);
-	REQUIRE(progress2.isFadeInStarted == true);
-	REQUIRE(progress2.isFadeInFinished == true);
-	REQUIRE(progress2.isStartStarted == true);
-	REQUIRE(progress2.isStartFinished == true);
-	REQUIRE(progress2.isFadeOutStarted == true);
-	REQUIRE(progress2.isFadeOutFinished == false);
-	REQUIRE(progress2.isPostFadeOutStarted == false);
-	REQUIRE(progress2.isPostFadeOutFinished == false);
+	// ムーブのみ可能な型もco_yieldできる
+	int32 sum = 0;
+	const auto moveOnlyRunner = GeneratorMoveOnlyTest()
+		.forEach([&sum](std::unique_ptr<int32> value) { sum += *value; })
+		.runScoped();
+	REQUIRE(sum == 3);
+	REQUIRE(moveOnlyRunner.done() == true);
+}
+
+Co::Task<void> SemaphoreWorkTest(Co::Semaphore* pSemaphore, int32 id, int32 frames, Array<int32>* pAcquiredOrder, int32* pRunningCount, int32* pMaxRunningCount)
+{
+	const auto permit = co_await pSemaphore->acquire();
+	pAcquiredOrder->push_back(id);
+	++*pRunningCount;
+	*pMaxRunningCount = std::max(*pMaxRunningCount, *pRunningCount);
+	co_await Co::DelayFrame(frames);
+	--*pRunningCount;
+}
+
+Co::Task<void> MutexLockTest(Co::Mutex* pMutex, int32 id, Array<int32>* pLog)
+{
+	const auto lock = co_await pMutex->lock();
+	pLog->push_back(id);
+	co_await Co::NextFrame();
+	pLog->push_back(-id);
+}
+
+TEST_CASE("Co::Semaphore")
+{
+	Co::Semaphore semaphore{ 2 };
+	REQUIRE(semaphore.available() == 2);
+
+	Array<int32> acquiredOrder;
+	int32 runningCount = 0;
+	int32 maxRunningCount = 0;
+	Co::MultiRunner mr;
+	for (int32 i = 0; i < 5; ++i)
+	{
+		SemaphoreWorkTest(&semaphore, i, 2, &acquiredOrder, &runningCount, &maxRunningCount).runAddTo(mr);
+	}
+
+	// 上限を超えたタスクは待機する
+	REQUIRE(acquiredOrder == Array<int32>{ 0, 1 });
+	REQUIRE(semaphore.available() == 0);
+	REQUIRE(semaphore.waiterCount() == 3);
+
+	while (!mr.allDone())
+	{
+		System::Update();
+	}
+
+	// 待機開始順に許可を取得する
+	REQUIRE(acquiredOrder == Array<int32>{ 0, 1, 2, 3, 4 });
+	REQUIRE(maxRunningCount == 2);
+	REQUIRE(semaphore.available() == 2);
+	REQUIRE(semaphore.waiterCount() == 0);
+}
+
+TEST_CASE("Co::Semaphore tryAcquire")
+{
+	Co::Semaphore semaphore{ 1 };
+	{
+		auto permit = semaphore.tryAcquire();
+		REQUIRE(permit.has_value());
+		REQUIRE(semaphore.tryAcquire().has_value() == false);
 
-	System::Update();
+		// 破棄を待たずに解放できる
+		permit->release();
+		REQUIRE(semaphore.available() == 1);
 
-	REQUIRE(runner.done() == false);
-	REQUIRE(progress2.isPreStartStarted == true);
-	REQUIRE(progress2.isPreStartFinished == true);
-	REQUIRE(progress2.isFadeInStarted == true);
-	REQUIRE(progress2.isFadeInFinished == true);
-	REQUIRE(progress2.isStartStarted == true);
-	REQUIRE(progress2.isStartFinished == true);
-	REQUIRE(progress2.isFadeOutStarted == true);
-	REQUIRE(progress2.isFadeOutFinished == true);
-	REQUIRE(progress2.isPostFadeOutStarted == true);
-	REQUIRE(progress2.isPostFadeOutFinished == false);
+		auto permit2 = semaphore.tryAcquire();
+		REQUIRE(permit2.has_value());
+	}
+	REQUIRE(semaphore.available() == 1);
 
-	System::Update();
+	REQUIRE_THROWS_AS(Co::Semaphore{ 0 }, Error);
+}
 
-	REQUIRE(runner.done() == true);
-	REQUIRE(progress2.isPreStartStarted == true);
-	REQUIRE(progress2.isPreStartFinished == true);
-	REQUIRE(progress2.isFadeInStarted == true);
-	REQUIRE(progress2.isFadeInFinished == true);
-	REQUIRE(progress2.isStartStarted == true);
-	REQUIRE(progress2.isStartFinished == true);
-	REQUIRE(progress2.isFadeOutStarted == true);
-	REQUIRE(progress2.isFadeOutFinished == true);
-	REQUIRE(progress2.isPostFadeOutStarted == true);
-	REQUIRE(progress2.isPostFadeOutFinished == true);
+TEST_CASE("Co::Semaphore waiter canceled")
+{
+	Co::Semaphore semaphore{ 1 };
+	auto permit = semaphore.tryAcquire();
+
+	Array<int32> acquiredOrder;
+	int32 runningCount = 0;
+	int32 maxRunningCount = 0;
+	Optional<Co::ScopedTaskRunner> runner1 = SemaphoreWorkTest(&semaphore, 1, 1, &acquiredOrder, &runningCount, &maxRunningCount).runScoped();
+	const auto runner2 = SemaphoreWorkTest(&semaphore, 2, 1, &acquiredOrder, &runningCount, &maxRunningCount).runScoped();
+	REQUIRE(semaphore.waiterCount() == 2);
+
+	// 待機中のタスクが破棄された場合は待機列から外れる
+	runner1.reset();
+	REQUIRE(semaphore.waiterCount() == 1);
+
+	permit.reset();
+	System::Update();
+	REQUIRE(acquiredOrder == Array<int32>{ 2 });
 }
 
-class TestUpdaterScene : public Co::UpdaterSceneBase
+TEST_CASE("Co::Semaphore waiter canceled after granted")
 {
-private:
-	int m_count = 0;
+	Co::Semaphore semaphore{ 1 };
+	auto permit = semaphore.tryAcquire();
 
-	void update() override
+	Array<int32> acquiredOrder;
+	int32 runningCount = 0;
+	int32 maxRunningCount = 0;
+	Optional<Co::ScopedTaskRunner> runner1 = SemaphoreWorkTest(&semaphore, 1, 1, &acquiredOrder, &runningCount, &maxRunningCount).runScoped();
+	const auto runner2 = SemaphoreWorkTest(&semaphore, 2, 1, &acquiredOrder, &runningCount, &maxRunningCount).runScoped();
+
+	// 許可が譲渡された後、受け取る前に破棄された場合は次のタスクへ譲渡される
+	permit.reset();
+	REQUIRE(semaphore.waiterCount() == 1);
+	runner1.reset();
+	System::Update();
+	REQUIRE(acquiredOrder == Array<int32>{ 2 });
+
+	while (!runner2.done())
 	{
-		if (m_count == 3)
-		{
-			requestSceneFinish();
-		}
-		++m_count;
+		System::Update();
 	}
-};
+	REQUIRE(semaphore.available() == 1);
+}
 
-TEST_CASE("UpdaterScene")
+TEST_CASE("Co::Mutex")
 {
-	const auto runner = Co::PlaySceneFrom<TestUpdaterScene>().runScoped();
-	REQUIRE(runner.done() == false);
+	Co::Mutex mutex;
+	REQUIRE(mutex.isLocked() == false);
 
-	System::Update();
-	REQUIRE(runner.done() == false);
+	Array<int32> log;
+	Co::MultiRunner mr;
+	for (int32 i = 1; i <= 3; ++i)
+	{
+		MutexLockTest(&mutex, i, &log).runAddTo(mr);
+	}
+	REQUIRE(mutex.isLocked() == true);
+	REQUIRE(mutex.waiterCount() == 2);
+	REQUIRE(mutex.tryLock().has_value() == false);
 
-	System::Update();
-	REQUIRE(runner.done() == false);
+	while (!mr.allDone())
+	{
+		System::Update();
+	}
 
-	System::Update();
-	REQUIRE(runner.done() == true);
+	// ロック区間が重ならない
+	REQUIRE(log == Array<int32>{ 1, -1, 2, -2, 3, -3 });
+	REQUIRE(mutex.isLocked() == false);
+	REQUIRE(mutex.tryLock().has_value() == true);
 }
 
+#ifndef COTASKLIB_NO_SIV3D
 TEST_CASE("Co::Ease")
 {
 	TestClock clock;
@@ -3076,57 +5313,339 @@ TEST_CASE("Co::LinearEase with zero duration")
 		.play()
 		.runScoped();
 
-	// 即座に終了
+	// 即座に終了
+	REQUIRE(runner.done() == true);
+	REQUIRE(value == 100.0);
+}
+
+TEST_CASE("Co::LinearEase and Co::Delay ends at the same time")
+{
+	TestClock clock;
+
+	double value = -1.0;
+	auto easeTask = Co::LinearEase(&value, 1s).fromTo(0.0, 1.0).setClock(&clock).play();
+
+	Optional<Co::VoidResult> easeResult;
+	Optional<Co::VoidResult> delayResult;
+
+	const auto runner = Co::Any(
+		std::move(easeTask),
+		Co::Delay(1s, &clock)).runScoped([&](const auto& result) { std::tie(easeResult, delayResult) = result; });
+
+	REQUIRE(runner.done() == false);
+	REQUIRE((bool)easeResult == false);
+	REQUIRE((bool)delayResult == false);
+
+	// 0秒
+	clock.microsec = 0;
+	System::Update();
+	REQUIRE(runner.done() == false);
+	REQUIRE((bool)easeResult == false);
+	REQUIRE((bool)delayResult == false);
+
+	// 0.5秒
+	clock.microsec = 500'000;
+	System::Update();
+	REQUIRE(runner.done() == false);
+	REQUIRE((bool)easeResult == false);
+	REQUIRE((bool)delayResult == false);
+
+	// 0.999秒
+	clock.microsec = 999'000;
+	System::Update();
+	REQUIRE(runner.done() == false);
+	REQUIRE((bool)easeResult == false);
+	REQUIRE((bool)delayResult == false);
+
+	// 1.001秒
+	clock.microsec = 1'001'000;
+	System::Update();
+	REQUIRE(runner.done() == true);
+	REQUIRE((bool)easeResult == true);
+	REQUIRE((bool)delayResult == true);
+	REQUIRE(value == 1.0);
+}
+
+TEST_CASE("Co::TweenSystem")
+{
+	TestClock clock;
+	Co::TweenSystem tweenSystem{ &clock };
+
+	double value = -1.0;
+	Vec2 pos{ -1, -1 };
+	auto easeTask = Co::Ease(&value, 1s)
+		.from(0.0)
+		.to(100.0)
+		.setTweenSystem(&tweenSystem)
+		.play();
+
+	// Task生成時点ではまだ実行されない
+	REQUIRE(easeTask.done() == false);
+	REQUIRE(value == -1.0);
+	REQUIRE(tweenSystem.size() == 0);
+
+	const auto runner = std::move(easeTask).runScoped();
+	const auto posRunner = tweenSystem.play(&pos, Vec2{ 0, 0 }, Vec2{ 100, 200 }, 2s, Easing::Linear).runScoped();
+
+	// runScopedで開始すると初期値が代入される
+	REQUIRE(runner.done() == false);
+	REQUIRE(value == 0.0);
+	REQUIRE(pos == Vec2{ 0, 0 });
+	REQUIRE(tweenSystem.size() == 2);
+
+	// 0秒
+	clock.microsec = 0;
+	System::Update();
+	REQUIRE(runner.done() == false);
+	REQUIRE(value == 0.0);
+
+	// 0.5秒
+	clock.microsec = 500'000;
+	System::Update();
+	REQUIRE(runner.done() == false);
+	REQUIRE(value == Approx(EaseOutQuad(0.5) * 100.0));
+	REQUIRE(pos.x == Approx(25.0));
+	REQUIRE(pos.y == Approx(50.0));
+
+	// 0.999秒
+	clock.microsec = 999'000;
+	System::Update();
+	REQUIRE(runner.done() == false);
+	REQUIRE(value == Approx(EaseOutQuad(0.999) * 100.0));
+
+	// 1.001秒
+	clock.microsec = 1'001'000;
+	System::Update();
+	REQUIRE(runner.done() == true);
+	REQUIRE(value == 100.0);
+	REQUIRE(posRunner.done() == false);
+	REQUIRE(tweenSystem.size() == 1);
+
+	// 2.001秒
+	clock.microsec = 2'001'000;
+	System::Update();
+	REQUIRE(posRunner.done() == true);
+	REQUIRE(pos == Vec2{ 100, 200 });
+	REQUIRE(tweenSystem.size() == 0);
+}
+
+TEST_CASE("Co::TweenSystem with zero duration")
+{
+	Co::TweenSystem tweenSystem;
+
+	ColorF color{ 0.0, 0.0, 0.0, 0.0 };
+	const auto runner = tweenSystem.play(&color, ColorF{ 0.0, 0.0, 0.0, 0.0 }, ColorF{ 1.0, 0.5, 0.25, 1.0 }, 0s).runScoped();
+
+	// 即座に終了
+	REQUIRE(runner.done() == true);
+	REQUIRE(color.g == 0.5);
+	REQUIRE(tweenSystem.size() == 0);
+}
+
+TEST_CASE("Co::TweenSystem and Co::Delay ends at the same time")
+{
+	TestClock clock;
+	Co::TweenSystem tweenSystem{ &clock };
+
+	double value = -1.0;
+	auto easeTask = Co::Ease(&value, 1s).fromTo(0.0, 1.0).setTweenSystem(&tweenSystem).play();
+
+	Optional<Co::VoidResult> easeResult;
+	Optional<Co::VoidResult> delayResult;
+
+	const auto runner = Co::Any(
+		std::move(easeTask),
+		Co::Delay(1s, &clock)).runScoped([&](const auto& result) { std::tie(easeResult, delayResult) = result; });
+
+	// 0秒
+	clock.microsec = 0;
+	System::Update();
+	REQUIRE(runner.done() == false);
+
+	// 0.999秒
+	clock.microsec = 999'000;
+	System::Update();
+	REQUIRE(runner.done() == false);
+	REQUIRE((bool)easeResult == false);
+	REQUIRE((bool)delayResult == false);
+
+	// 1.001秒
+	clock.microsec = 1'001'000;
+	System::Update();
+	REQUIRE(runner.done() == true);
+	REQUIRE((bool)easeResult == true);
+	REQUIRE((bool)delayResult == true);
+	REQUIRE(value == 1.0);
+}
+
+TEST_CASE("Co::TweenSystem canceled")
+{
+	TestClock clock;
+	Co::TweenSystem tweenSystem{ &clock };
+
+	Array<double> values(100, 0.0);
+	Optional<Co::MultiRunner> mr;
+	mr.emplace();
+	for (auto& value : values)
+	{
+		tweenSystem.play(&value, 0.0, 1.0, 1s, Easing::Linear).runAddTo(*mr);
+	}
+	REQUIRE(tweenSystem.size() == 100);
+
+	clock.microsec = 0;
+	System::Update();
+	clock.microsec = 500'000;
+	System::Update();
+	REQUIRE(values.front() == Approx(0.5));
+	REQUIRE(values.back() == Approx(0.5));
+
+	// 待機しているタスクが破棄されると、トゥイーンも削除される
+	mr.reset();
+	REQUIRE(tweenSystem.size() == 0);
+
+	clock.microsec = 1'000'000;
+	System::Update();
+	REQUIRE(values.front() == Approx(0.5));
+}
+
+TEST_CASE("Co::TweenSystem destroyed before task")
+{
+	double value = 0.0;
+	Optional<Co::ScopedTaskRunner> runner;
+	{
+		Co::TweenSystem tweenSystem;
+		runner.emplace(tweenSystem.play(&value, 0.0, 1.0, 10s).runScoped());
+		REQUIRE(runner->done() == false);
+	}
+
+	// TweenSystemが先に破棄された場合、再生中のタスクは終了する
+	System::Update();
+	REQUIRE(runner->done() == true);
+}
+
+TEST_CASE("Co::TweenSystem with multiple ease functions")
+{
+	TestClock clock;
+	Co::TweenSystem tweenSystem{ &clock };
+
+	// イージング関数ごとのグループに分かれても、それぞれの値が正しく補間される
+	// (EaseInBounceは展開した実装を持たないため、関数ポインタ経由で呼び出される)
+	std::array<double, 8> values{};
+	constexpr std::array<double(*)(double), 4> EaseFuncs{ EaseInQuad, EaseOutQuad, EaseInBounce, Easing::Linear };
+	Co::MultiRunner mr;
+	Optional<Co::ScopedTaskRunner> canceledRunner;
+	for (std::size_t i = 0; i < values.size(); ++i)
+	{
+		auto task = tweenSystem.play(&values[i], 0.0, 100.0, 1s, EaseFuncs[i % EaseFuncs.size()]);
+		if (i == 1)
+		{
+			canceledRunner.emplace(std::move(task).runScoped());
+		}
+		else
+		{
+			std::move(task).runAddTo(mr);
+		}
+	}
+	REQUIRE(tweenSystem.size() == 8);
+
+	clock.microsec = 0;
+	System::Update();
+
+	// グループの途中の要素を削除しても、他の要素に影響しない
+	canceledRunner.reset();
+	REQUIRE(tweenSystem.size() == 7);
+
+	clock.microsec = 500'000;
+	System::Update();
+	for (std::size_t i = 0; i < values.size(); ++i)
+	{
+		if (i == 1)
+		{
+			REQUIRE(values[i] == Approx(EaseOutQuad(0.0) * 100.0));
+			continue;
+		}
+		REQUIRE(values[i] == Approx(EaseFuncs[i % EaseFuncs.size()](0.5) * 100.0));
+	}
+
+	clock.microsec = 1'000'000;
+	System::Update();
+	REQUIRE(mr.allDone());
+	REQUIRE(tweenSystem.size() == 0);
+	REQUIRE(values[0] == 100.0);
+	REQUIRE(values[7] == 100.0);
+}
+
+TEST_CASE("Co::TweenSystem play with EaseTaskBuilder")
+{
+	TestClock clock;
+	Co::TweenSystem tweenSystem{ &clock };
+
+	Vec2 pos{ -1, -1 };
+	const auto runner = tweenSystem.play(Co::Ease(&pos, 1s).fromTo(Vec2{ 0, 0 }, Vec2{ 100, 200 }).setEase(EaseInQuad)).runScoped();
+	REQUIRE(pos == Vec2{ 0, 0 });
+	REQUIRE(tweenSystem.size() == 1);
+
+	clock.microsec = 0;
+	System::Update();
+	clock.microsec = 500'000;
+	System::Update();
+	REQUIRE(pos.x == Approx(EaseInQuad(0.5) * 100.0));
+	REQUIRE(pos.y == Approx(EaseInQuad(0.5) * 200.0));
+
+	clock.microsec = 1'000'000;
+	System::Update();
 	REQUIRE(runner.done() == true);
-	REQUIRE(value == 100.0);
+	REQUIRE(pos == Vec2{ 100, 200 });
+
+	// 値のポインタを指定せずに生成したEaseTaskBuilderは指定できない
+	const Co::EaseTaskBuilder<double> callbackBuilder{ [](double) {}, 1s, 0.0, 1.0, EaseOutQuad, nullptr };
+	REQUIRE_THROWS_AS(tweenSystem.play(callbackBuilder), Error);
 }
 
-TEST_CASE("Co::LinearEase and Co::Delay ends at the same time")
+TEST_CASE("Co::TweenSystem start and stop")
 {
 	TestClock clock;
+	Co::TweenSystem tweenSystem{ &clock };
 
-	double value = -1.0;
-	auto easeTask = Co::LinearEase(&value, 1s).fromTo(0.0, 1.0).setClock(&clock).play();
-
-	Optional<Co::VoidResult> easeResult;
-	Optional<Co::VoidResult> delayResult;
-
-	const auto runner = Co::Any(
-		std::move(easeTask),
-		Co::Delay(1s, &clock)).runScoped([&](const auto& result) { std::tie(easeResult, delayResult) = result; });
-
-	REQUIRE(runner.done() == false);
-	REQUIRE((bool)easeResult == false);
-	REQUIRE((bool)delayResult == false);
+	// 待機用のタスクを生成せずに再生できる
+	Array<double> values(100, -1.0);
+	for (auto& value : values)
+	{
+		tweenSystem.start(&value, 0.0, 1.0, 1s, Easing::Linear);
+	}
+	ColorF color{ 0.0 };
+	tweenSystem.start(Co::Ease(&color, 2s).fromTo(ColorF{ 0.0 }, ColorF{ 1.0 }).setEase(Easing::Linear));
+	REQUIRE(tweenSystem.size() == 101);
+	REQUIRE(values.front() == 0.0);
 
-	// 0秒
 	clock.microsec = 0;
 	System::Update();
-	REQUIRE(runner.done() == false);
-	REQUIRE((bool)easeResult == false);
-	REQUIRE((bool)delayResult == false);
-
-	// 0.5秒
 	clock.microsec = 500'000;
 	System::Update();
-	REQUIRE(runner.done() == false);
-	REQUIRE((bool)easeResult == false);
-	REQUIRE((bool)delayResult == false);
+	REQUIRE(values.front() == Approx(0.5));
+	REQUIRE(values.back() == Approx(0.5));
+	REQUIRE(color.r == Approx(0.25));
 
-	// 0.999秒
-	clock.microsec = 999'000;
+	// 停止したトゥイーンの値はそのまま残る
+	tweenSystem.stop(&values.front());
+	tweenSystem.stop(&color);
+	REQUIRE(tweenSystem.size() == 99);
+
+	clock.microsec = 1'000'000;
 	System::Update();
-	REQUIRE(runner.done() == false);
-	REQUIRE((bool)easeResult == false);
-	REQUIRE((bool)delayResult == false);
+	REQUIRE(values.front() == Approx(0.5));
+	REQUIRE(values.back() == 1.0);
+	REQUIRE(color.r == Approx(0.25));
+	REQUIRE(tweenSystem.size() == 0);
 
-	// 1.001秒
-	clock.microsec = 1'001'000;
+	// playで再生したトゥイーンを停止すると、待機しているタスクも終了する
+	double value = 0.0;
+	const auto runner = tweenSystem.play(&value, 0.0, 1.0, 1s).runScoped();
+	REQUIRE(runner.done() == false);
+	tweenSystem.stop(&value);
 	System::Update();
 	REQUIRE(runner.done() == true);
-	REQUIRE((bool)easeResult == true);
-	REQUIRE((bool)delayResult == true);
-	REQUIRE(value == 1.0);
+	REQUIRE(value == 0.0);
 }
 
 TEST_CASE("Co::Typewriter")
@@ -3342,6 +5861,415 @@ TEST_CASE("s3d::AsyncTask with move-only result")
 	REQUIRE(*result == 420);
 }
 
+TEST_CASE("s3d::AsyncTask many in flight")
+{
+	constexpr int32 NumTasks = 200;
+
+	// 完了順が前後しても、それぞれの結果が受け取れることを確認
+	Array<int32> results(NumTasks, 0);
+	Co::MultiRunner multiRunner;
+	for (int32 i = 0; i < NumTasks; ++i)
+	{
+		AsyncTaskCaller([i] { std::this_thread::sleep_for(std::chrono::milliseconds{ (NumTasks - i) % 10 + 1 }); return i; })
+			.runScoped([&results, i](int32 result) { results[i] = result + 1; })
+			.addTo(multiRunner);
+	}
+
+	while (!multiRunner.allDone())
+	{
+		System::Update();
+	}
+	for (int32 i = 0; i < NumTasks; ++i)
+	{
+		REQUIRE(results[i] == i + 1);
+	}
+}
+
+TEST_CASE("s3d::AsyncTask canceled after completion before update")
+{
+	std::atomic<bool> finished = false;
+	int32 finishCallbackCount = 0;
+	int32 cancelCallbackCount = 0;
+	{
+		const auto runner = AsyncTaskCaller([&] { std::this_thread::sleep_for(0.01s); finished = true; return 42; })
+			.runScoped([&](int32) { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
+		REQUIRE(runner.done() == false);
+
+		// 関数は完了したが、update時の完了の確認はまだ行われていない状態にする
+		while (!finished)
+		{
+			std::this_thread::yield();
+		}
+		std::this_thread::sleep_for(0.05s);
+	}
+
+	// 完了の確認前にタスクが破棄された場合は確認対象から外れるため、次回の更新で通知されない
+	System::Update();
+	REQUIRE(finishCallbackCount == 0);
+	REQUIRE(cancelCallbackCount == 1);
+}
+
+TEST_CASE("s3d::AsyncHTTPTask with local server")
+{
+	// テスト用のローカルHTTPサーバーとして、接続を受け付けたら固定の応答を返して切断する
+	constexpr uint16 Port = 50080;
+	TCPServer server;
+	server.startAccept(Port);
+	const auto serverRunner = Co::UpdaterTask([&server]
+		{
+			if (server.hasSession() && server.available() > 0)
+			{
+				server.skip(server.available());
+				const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nOK";
+				server.send(response.data(), response.size());
+				server.disconnect();
+			}
+		}).runScoped();
+
+	// 同じAsyncHTTPTaskのコピーを複数のタスクから待機しても、それぞれ完了する
+	const AsyncHTTPTask httpTask = SimpleHTTP::GetAsync(U"http://127.0.0.1:50080/", {});
+	Optional<bool> isOK1;
+	Optional<bool> isOK2;
+	const auto runner1 = [](const AsyncHTTPTask& task) -> Co::Task<bool> { co_return (co_await task).isOK(); }(httpTask)
+		.runScoped([&](bool isOK) { isOK1 = isOK; });
+	const auto runner2 = [](AsyncHTTPTask task) -> Co::Task<bool> { co_return (co_await std::move(task)).isOK(); }(httpTask)
+		.runScoped([&](bool isOK) { isOK2 = isOK; });
+
+	const auto deadline = std::chrono::steady_clock::now() + 5s;
+	while (!(runner1.done() && runner2.done()) && std::chrono::steady_clock::now() < deadline)
+	{
+		System::Update();
+		std::this_thread::sleep_for(1ms);
+	}
+	REQUIRE(httpTask.isReady());
+	REQUIRE(isOK1 == true);
+	REQUIRE(isOK2 == true);
+}
+
+TEST_CASE("Co::Async")
+{
+	int32 value = 0;
+	const auto runner = Co::Async([](int32 a, int32 b) { std::this_thread::sleep_for(0.01s); return a * b; }, 6, 7)
+		.runScoped([&value](int32 result) { value = result; });
+	REQUIRE(runner.done() == false);
+
+	while (!runner.done())
+	{
+		System::Update();
+	}
+	REQUIRE(value == 42);
+}
+
+TEST_CASE("Co::Async with move-only result")
+{
+	std::unique_ptr<int32> result = nullptr;
+	const auto runner = Co::Async([] { return std::make_unique<int32>(42); })
+		.runScoped([&](std::unique_ptr<int32>&& r) { result = std::move(r); });
+
+	while (!runner.done())
+	{
+		System::Update();
+	}
+	REQUIRE(result != nullptr);
+	REQUIRE(*result == 42);
+}
+
+TEST_CASE("Co::Async with exception")
+{
+	int32 finishCallbackCount = 0;
+	int32 cancelCallbackCount = 0;
+	const auto runner = Co::Async([] { std::this_thread::sleep_for(0.01s); throw std::runtime_error("test exception"); })
+		.runScoped([&] { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
+
+	const auto fnWait = [&runner]
+		{
+			while (!runner.done())
+			{
+				std::this_thread::sleep_for(0.01s);
+
+				// System::Update内で例外が発生すると以降のテスト実行に影響が出る可能性があるため、手動resumeでテスト
+				Co::detail::Backend::ManualUpdate();
+			}
+		};
+
+	// 関数を実行したスレッドで発生した例外が、待機しているタスクへ再送出される
+	REQUIRE_THROWS_WITH(fnWait(), "test exception");
+	REQUIRE(finishCallbackCount == 0);
+	REQUIRE(cancelCallbackCount == 1);
+}
+
+TEST_CASE("Co::Async canceled after completion is queued")
+{
+	std::atomic<bool> finished = false;
+	int32 finishCallbackCount = 0;
+	int32 cancelCallbackCount = 0;
+	{
+		const auto runner = Co::Async([&] { finished = true; return 42; })
+			.runScoped([&](int32) { ++finishCallbackCount; }, [&] { ++cancelCallbackCount; });
+
+		// 関数が完了キューへ追加し終えるまで待つ
+		while (!finished)
+		{
+			std::this_thread::yield();
+		}
+		std::this_thread::sleep_for(0.05s);
+	}
+
+	// 通知待ちの間にタスクが破棄されても、次回の更新で安全に破棄される
+	System::Update();
+	REQUIRE(finishCallbackCount == 0);
+	REQUIRE(cancelCallbackCount == 1);
+}
+
+TEST_CASE("Co::Async many in flight")
+{
+	constexpr int32 NumTasks = 200;
+
+	Array<int32> results(NumTasks, 0);
+	Co::MultiRunner multiRunner;
+	for (int32 i = 0; i < NumTasks; ++i)
+	{
+		Co::Async([i] { std::this_thread::sleep_for(std::chrono::milliseconds{ (NumTasks - i) % 10 + 1 }); return i; })
+			.runScoped([&results, i](int32 result) { results[i] = result + 1; })
+			.addTo(multiRunner);
+	}
+
+	while (!multiRunner.allDone())
+	{
+		System::Update();
+	}
+	for (int32 i = 0; i < NumTasks; ++i)
+	{
+		REQUIRE(results[i] == i + 1);
+	}
+}
+#endif
+
+TEST_CASE("Frame allocator reuses freed frames")
+{
+	// 同じサイズクラスのフレームが一度解放されていれば、次回はフリーリストから確保される
+	{
+		const auto runner = Co::DelayFrame(1).runScoped();
+	}
+	const auto statsBefore = Co::GetFrameAllocatorStats();
+	{
+		const auto runner = Co::DelayFrame(1).runScoped();
+		REQUIRE(Co::GetFrameAllocatorStats().liveFrames == statsBefore.liveFrames + 1);
+		REQUIRE(Co::GetFrameAllocatorStats().liveBytes > statsBefore.liveBytes);
+	}
+	const auto statsAfter = Co::GetFrameAllocatorStats();
+	REQUIRE(statsAfter.liveFrames == statsBefore.liveFrames);
+	REQUIRE(statsAfter.liveBytes == statsBefore.liveBytes);
+	REQUIRE(statsAfter.hits == statsBefore.hits + 1);
+	REQUIRE(statsAfter.misses == statsBefore.misses);
+}
+
+TEST_CASE("Frame allocator stats with frame freed on another thread")
+{
+	const auto statsBefore = Co::GetFrameAllocatorStats();
+	{
+		Optional<Co::Task<void>> task = Co::DelayFrame(1);
+		REQUIRE(Co::GetFrameAllocatorStats().liveFrames == statsBefore.liveFrames + 1);
+
+		// 別スレッドで解放しても、生存中のフレーム数は全体で集計される
+		std::thread{ [&] { task.reset(); } }.join();
+	}
+	const auto statsAfter = Co::GetFrameAllocatorStats();
+	REQUIRE(statsAfter.liveFrames == statsBefore.liveFrames);
+	REQUIRE(statsAfter.liveBytes == statsBefore.liveBytes);
+
+	// 終了したスレッドで確保したフレームを解放した場合も同様
+	{
+		Optional<Co::Task<void>> task;
+		std::thread{ [&] { task.emplace(Co::DelayFrame(1)); } }.join();
+		REQUIRE(Co::GetFrameAllocatorStats().liveFrames == statsBefore.liveFrames + 1);
+		task.reset();
+	}
+	const auto statsAfterExitedThread = Co::GetFrameAllocatorStats();
+	REQUIRE(statsAfterExitedThread.liveFrames == statsBefore.liveFrames);
+	REQUIRE(statsAfterExitedThread.liveBytes == statsBefore.liveBytes);
+}
+
+Co::Task<void> FrameArenaChildTest(int32* pValue)
+{
+	co_await Co::NextFrame();
+	++*pValue;
+}
+
+Co::Task<void> FrameArenaParentTest(int32* pValue)
+{
+	co_await Co::NextFrame();
+
+	// アリーナから確保されたタスクの実行中に生成された子タスクも、同じアリーナから確保される
+	co_await FrameArenaChildTest(pValue);
+	co_await FrameArenaChildTest(pValue);
+}
+
+TEST_CASE("FrameArena")
+{
+	Co::FrameArena arena;
+	int32 value = 0;
+
+	Optional<Co::ScopedTaskRunner> runner;
+	{
+		const Co::ScopedFrameArena scopedFrameArena{ arena };
+		runner = FrameArenaParentTest(&value).runScoped();
+	}
+	REQUIRE(arena.numChunks() == 1);
+	REQUIRE(arena.numLiveFrames() == 1);
+
+	// スコープ外で生成したタスクはアリーナから確保されない
+	const auto otherRunner = Co::DelayFrame(10).runScoped();
+	REQUIRE(arena.numLiveFrames() == 1);
+
+	System::Update();
+	REQUIRE(arena.numLiveFrames() == 2);
+
+	System::Update();
+	System::Update();
+	System::Update();
+	REQUIRE(value == 2);
+	REQUIRE(runner->done() == true);
+
+	runner.reset();
+	REQUIRE(arena.numLiveFrames() == 0);
+
+	// 全フレームが解放されたチャンクは再利用される
+	{
+		const Co::ScopedFrameArena scopedFrameArena{ arena };
+		runner = FrameArenaParentTest(&value).runScoped();
+	}
+	REQUIRE(arena.numChunks() == 1);
+	REQUIRE(arena.numLiveFrames() == 1);
+}
+
+TEST_CASE("FrameArena destroyed before frames")
+{
+	int32 value = 0;
+	Optional<Co::ScopedTaskRunner> runner;
+	{
+		Co::FrameArena arena;
+		const Co::ScopedFrameArena scopedFrameArena{ arena };
+		runner = FrameArenaParentTest(&value).runScoped();
+	}
+
+	// アリーナの破棄後もフレームは最後まで有効
+	while (!runner->done())
+	{
+		System::Update();
+	}
+	REQUIRE(value == 2);
+}
+
+Co::Task<void> BenchmarkNextFrameLoop()
+{
+	while (true)
+	{
+		co_await Co::NextFrame();
+	}
+}
+
+Co::Task<void> BenchmarkNestedNextFrameLoop(int32 depth)
+{
+	if (depth == 0)
+	{
+		co_await BenchmarkNextFrameLoop();
+		co_return;
+	}
+	co_await BenchmarkNestedNextFrameLoop(depth - 1);
+}
+
+// 実行中タスク数ごとのBackend::updateの処理時間を計測するベンチマーク
+// (通常のテスト実行では実行されないため、計測時は"[!benchmark]"タグを指定して実行する)
+TEST_CASE("Backend::update benchmark", "[!benchmark]")
+{
+	for (const int32 numTasks : { 1000, 10000, 100000 })
+	{
+		Array<Co::ScopedTaskRunner> runners;
+		runners.reserve(numTasks);
+		for (int32 i = 0; i < numTasks; ++i)
+		{
+			runners.push_back(BenchmarkNextFrameLoop().runScoped());
+		}
+
+		BENCHMARK("update with " + std::to_string(numTasks) + " tasks")
+		{
+			Co::detail::Backend::ManualUpdate();
+		};
+
+		BENCHMARK("runScoped and remove with " + std::to_string(numTasks) + " tasks")
+		{
+			const auto runner = BenchmarkNextFrameLoop().runScoped();
+		};
+	}
+
+	for (const int32 numTasks : { 1000, 10000, 100000 })
+	{
+		Array<Co::ScopedTaskRunner> runners;
+		runners.reserve(numTasks);
+		for (int32 i = 0; i < numTasks; ++i)
+		{
+			runners.push_back(BenchmarkNestedNextFrameLoop(8).runScoped());
+		}
+
+		BENCHMARK("update with " + std::to_string(numTasks) + " tasks nested 8 levels deep")
+		{
+			Co::detail::Backend::ManualUpdate();
+		};
+	}
+
+	for (const int32 numTasks : { 1000, 10000, 100000 })
+	{
+		Array<Co::ScopedTaskRunner> runners;
+		runners.reserve(numTasks);
+		for (int32 i = 0; i < numTasks; ++i)
+		{
+			runners.push_back(Co::Delay(1h).runScoped());
+		}
+
+		BENCHMARK("update with " + std::to_string(numTasks) + " tasks in Delay")
+		{
+			Co::detail::Backend::ManualUpdate();
+		};
+	}
+
+	for (const int32 numTasks : { 1000, 10000, 100000 })
+	{
+		Co::TaskFinishSource<void> taskFinishSource;
+		Array<Co::ScopedTaskRunner> runners;
+		runners.reserve(numTasks);
+		for (int32 i = 0; i < numTasks; ++i)
+		{
+			runners.push_back(taskFinishSource.waitUntilDone().runScoped());
+		}
+
+		BENCHMARK("update with " + std::to_string(numTasks) + " tasks waiting for TaskFinishSource")
+		{
+			Co::detail::Backend::ManualUpdate();
+		};
+	}
+
+	BENCHMARK("create and destroy Delay task")
+	{
+		return Co::Delay(1s);
+	};
+
+	BENCHMARK("runScoped and finish DelayFrame(1)")
+	{
+		const auto runner = Co::DelayFrame(1).runScoped();
+		Co::detail::Backend::ManualUpdate();
+	};
+}
+
+#ifdef COTASKLIB_NO_SIV3D
+int main(int argc, char* argv[])
+{
+	Co::ManualBackend manualBackend;
+	s_pManualBackend = &manualBackend;
+
+	return Catch::Session().run(argc, argv);
+}
+#else
 void Main()
 {
 	Co::Init();
@@ -3353,3 +6281,4 @@ void Main()
 	{
 	}
 }
+#endif